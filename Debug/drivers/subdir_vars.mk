@@ -5,26 +5,32 @@
 # Add inputs and outputs from these tool invocations to the build variables 
 C_SRCS += \
 ../drivers/buttons.c \
-../drivers/rgb.c 
+../drivers/rgb.c \
+../drivers/cycles.c 
 
 C_DEPS += \
 ./drivers/buttons.d \
-./drivers/rgb.d 
+./drivers/rgb.d \
+./drivers/cycles.d 
 
 OBJS += \
 ./drivers/buttons.obj \
-./drivers/rgb.obj 
+./drivers/rgb.obj \
+./drivers/cycles.obj 
 
 OBJS__QUOTED += \
 "drivers/buttons.obj" \
-"drivers/rgb.obj" 
+"drivers/rgb.obj" \
+"drivers/cycles.obj" 
 
 C_DEPS__QUOTED += \
 "drivers/buttons.d" \
-"drivers/rgb.d" 
+"drivers/rgb.d" \
+"drivers/cycles.d" 
 
 C_SRCS__QUOTED += \
 "../drivers/buttons.c" \
-"../drivers/rgb.c" 
+"../drivers/rgb.c" \
+"../drivers/cycles.c" 
 
 
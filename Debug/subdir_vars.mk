@@ -9,31 +9,133 @@ CMD_SRCS += \
 C_SRCS += \
 ../startup_ccs.c \
 ../usb_dev_gamepad.c \
-../usb_gamepad_structs.c 
+../usb_gamepad_structs.c \
+../gamepad_input.c \
+../gamepad_feature.c \
+../latency.c \
+../isrprof.c \
+../stackmon.c \
+../clockgov.c \
+../suspend.c \
+../boot.c \
+../fault.c \
+../supervisor.c \
+../board.c \
+../bench.c \
+../trace.c \
+../recorder.c \
+../replay.c \
+../macro.c \
+../remap.c 
 
 C_DEPS += \
 ./startup_ccs.d \
 ./usb_dev_gamepad.d \
-./usb_gamepad_structs.d 
+./usb_gamepad_structs.d \
+./gamepad_input.d \
+./gamepad_feature.d \
+./latency.d \
+./isrprof.d \
+./stackmon.d \
+./clockgov.d \
+./suspend.d \
+./boot.d \
+./fault.d \
+./supervisor.d \
+./board.d \
+./bench.d \
+./trace.d \
+./recorder.d \
+./replay.d \
+./macro.d \
+./remap.d 
 
 OBJS += \
 ./startup_ccs.obj \
 ./usb_dev_gamepad.obj \
-./usb_gamepad_structs.obj 
+./usb_gamepad_structs.obj \
+./gamepad_input.obj \
+./gamepad_feature.obj \
+./latency.obj \
+./isrprof.obj \
+./stackmon.obj \
+./clockgov.obj \
+./suspend.obj \
+./boot.obj \
+./fault.obj \
+./supervisor.obj \
+./board.obj \
+./bench.obj \
+./trace.obj \
+./recorder.obj \
+./replay.obj \
+./macro.obj \
+./remap.obj 
 
 OBJS__QUOTED += \
 "startup_ccs.obj" \
 "usb_dev_gamepad.obj" \
-"usb_gamepad_structs.obj" 
+"usb_gamepad_structs.obj" \
+"gamepad_input.obj" \
+"gamepad_feature.obj" \
+"latency.obj" \
+"isrprof.obj" \
+"stackmon.obj" \
+"clockgov.obj" \
+"suspend.obj" \
+"boot.obj" \
+"fault.obj" \
+"supervisor.obj" \
+"board.obj" \
+"bench.obj" \
+"trace.obj" \
+"recorder.obj" \
+"replay.obj" \
+"macro.obj" \
+"remap.obj" 
 
 C_DEPS__QUOTED += \
 "startup_ccs.d" \
 "usb_dev_gamepad.d" \
-"usb_gamepad_structs.d" 
+"usb_gamepad_structs.d" \
+"gamepad_input.d" \
+"gamepad_feature.d" \
+"latency.d" \
+"isrprof.d" \
+"stackmon.d" \
+"clockgov.d" \
+"suspend.d" \
+"boot.d" \
+"fault.d" \
+"supervisor.d" \
+"board.d" \
+"bench.d" \
+"trace.d" \
+"recorder.d" \
+"replay.d" \
+"macro.d" \
+"remap.d" 
 
 C_SRCS__QUOTED += \
 "../startup_ccs.c" \
 "../usb_dev_gamepad.c" \
-"../usb_gamepad_structs.c" 
+"../usb_gamepad_structs.c" \
+"../gamepad_input.c" \
+"../gamepad_feature.c" \
+"../latency.c" \
+"../isrprof.c" \
+"../stackmon.c" \
+"../clockgov.c" \
+"../suspend.c" \
+"../boot.c" \
+"../fault.c" \
+"../supervisor.c" \
+"../board.c" \
+"../bench.c" \
+"../trace.c" \
+"../recorder.c" \
+"../replay.c" \
+"../macro.c" \
+"../remap.c" 
 
 
@@ -0,0 +1,454 @@
+//*****************************************************************************
+//
+// bench.c - Micro-benchmarks for the input to report path.
+//
+// Copyright (c) Aditya Challamarad.  All rights reserved.
+//
+// Each kernel runs one stage of the path over a fixed set of pseudo random
+// inputs: ADC samples across the full range and button patterns that bounce
+// often enough to keep the debounce busy.  The inputs are the same every
+// time, on the target and on the host, so runs compare.
+//
+// Kernels that read the tuning run once with the defaults, the original
+// untuned path, and once with dead zones, curves and filtering turned on.
+// The live tuning is put back afterwards.  The USB interrupt is masked
+// while the tuning is swapped, so a config page written meanwhile waits and
+// is not overwritten by the put back.  The remap runs the same way, with
+// the identity and with a layered layout.  The "overhead" kernel is the
+// loop and call with no work, to subtract from the others if wanted.
+//
+//*****************************************************************************
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "inc/hw_ints.h"
+#include "inc/hw_types.h"
+#include "driverlib/interrupt.h"
+#include "driverlib/rom.h"
+#include "driverlib/rom_map.h"
+#include "usblib/usblib.h"
+#include "usblib/device/usbdhidgamepad.h"
+#include "drivers/buttons.h"
+#include "drivers/cycles.h"
+#include "utils/uartstdio.h"
+#include "gamepad_input.h"
+#include "remap.h"
+#include "bench.h"
+
+static uint32_t g_pui32BenchADC[BENCH_SAMPLES];
+static uint8_t g_pui8BenchButtons[BENCH_SAMPLES];
+
+// Kept so the compiler cannot drop a kernel's results.
+static volatile uint32_t g_ui32BenchSink;
+
+// Tuning for the *_tuned kernels, every optional step on.
+static const tGamepadConfig g_sBenchTuned =
+{
+    128,                        // ui16StickDeadzone
+    64,                         // ui16TriggerDeadzone
+    GAMEPAD_CURVE_CUBIC,        // ui8StickCurve
+    GAMEPAD_CURVE_QUADRATIC,    // ui8TriggerCurve
+    2,                          // ui8FilterShift
+    0                           // ui8ReportInterval
+};
+
+// Layout for remap_layered: the joystick switch shifts to a second layer,
+// the stick is turned a quarter, LT presses button 4 past half and button 4
+// in layer 1 pulls RT all the way.
+static const tRemapConfig g_sBenchLayout =
+{
+    JOYSTICK_MASK,                                  // ui8Shift
+    {                                               // ppui8Buttons
+        { BUTTON1_MASK, BUTTON2_MASK, BUTTON3_MASK, BUTTON4_MASK, 0 },
+        { BUTTON3_MASK, BUTTON4_MASK, BUTTON1_MASK | BUTTON2_MASK, 0, 0 }
+    },
+    {                                               // pui8Axis
+        REMAP_AXIS_Y | REMAP_AXIS_INVERT,
+        REMAP_AXIS_X,
+        REMAP_AXIS_LT | (4 << REMAP_AXIS_PRESS_S),
+        REMAP_AXIS_RT
+    },
+    { 0, 0, 128, 0 },                               // pui8Threshold
+    { 0, 0, 0, JOYSTICK_MASK | BUTTON4_MASK },      // pui8Drive
+    { 0, 0, 0, 255 }                                // pui8DriveValue
+};
+
+//*****************************************************************************
+//
+// Kernels.
+//
+//*****************************************************************************
+
+static uint32_t BenchOverhead(uint32_t ui32Calls)
+{
+    uint32_t ui32Sum = 0, ui32Idx;
+
+    while(ui32Calls--)
+    {
+        for(ui32Idx = 0; ui32Idx < BENCH_SAMPLES; ui32Idx++)
+        {
+            ui32Sum += g_pui32BenchADC[ui32Idx];
+        }
+    }
+
+    return(ui32Sum);
+}
+
+// What ButtonsPoll() does, GPIO reads included, but on a debounce state of
+// its own.  The live state is left alone so the main loop sees no press or
+// release the bench made up.
+static uint32_t BenchButtonsPoll(uint32_t ui32Calls)
+{
+    tButtonDebounce sState = { 0, 0, 0 };
+    uint32_t ui32Sum = 0, ui32Idx;
+    uint8_t ui8Delta;
+
+    while(ui32Calls--)
+    {
+        for(ui32Idx = 0; ui32Idx < BENCH_SAMPLES; ui32Idx++)
+        {
+            ui32Sum += ButtonsDebounce(&sState, ButtonsRead(), &ui8Delta) +
+                       ui8Delta;
+        }
+    }
+
+    return(ui32Sum);
+}
+
+static uint32_t BenchDebounce(uint32_t ui32Calls)
+{
+    tButtonDebounce sState = { 0, 0, 0 };
+    uint32_t ui32Sum = 0, ui32Idx;
+    uint8_t ui8Delta;
+
+    while(ui32Calls--)
+    {
+        for(ui32Idx = 0; ui32Idx < BENCH_SAMPLES; ui32Idx++)
+        {
+            ui32Sum += ButtonsDebounce(&sState, g_pui8BenchButtons[ui32Idx],
+                                       &ui8Delta) + ui8Delta;
+        }
+    }
+
+    return(ui32Sum);
+}
+
+static uint32_t BenchConvert8Bit(uint32_t ui32Calls)
+{
+    uint32_t ui32Sum = 0, ui32Idx;
+
+    while(ui32Calls--)
+    {
+        for(ui32Idx = 0; ui32Idx < BENCH_SAMPLES; ui32Idx++)
+        {
+            ui32Sum += (uint8_t)Convert8Bit(g_pui32BenchADC[ui32Idx]);
+        }
+    }
+
+    return(ui32Sum);
+}
+
+static uint32_t BenchStickMap(uint32_t ui32Calls)
+{
+    uint32_t ui32Sum = 0, ui32Idx;
+
+    while(ui32Calls--)
+    {
+        for(ui32Idx = 0; ui32Idx < BENCH_SAMPLES; ui32Idx++)
+        {
+            ui32Sum += (uint8_t)GamepadStickMap(g_pui32BenchADC[ui32Idx]);
+        }
+    }
+
+    return(ui32Sum);
+}
+
+// The potentiometer split into LT and RT.
+static uint32_t BenchTriggerMap(uint32_t ui32Calls)
+{
+    uint32_t ui32Sum = 0, ui32Idx;
+    uint8_t ui8LT, ui8RT;
+
+    while(ui32Calls--)
+    {
+        for(ui32Idx = 0; ui32Idx < BENCH_SAMPLES; ui32Idx++)
+        {
+            GamepadTriggerMap(g_pui32BenchADC[ui32Idx], &ui8LT, &ui8RT);
+            ui32Sum += ui8LT + ui8RT;
+        }
+    }
+
+    return(ui32Sum);
+}
+
+static uint32_t BenchFilter(uint32_t ui32Calls)
+{
+    uint32_t ui32Sum = 0, ui32Idx, ui32State = GAMEPAD_ADC_CENTER << 4;
+
+    while(ui32Calls--)
+    {
+        for(ui32Idx = 0; ui32Idx < BENCH_SAMPLES; ui32Idx++)
+        {
+            ui32Sum += GamepadFilter(&ui32State, g_pui32BenchADC[ui32Idx]);
+        }
+    }
+
+    return(ui32Sum);
+}
+
+static uint32_t BenchButtonsPack(uint32_t ui32Calls)
+{
+    uint32_t ui32Sum = 0, ui32Idx;
+
+    while(ui32Calls--)
+    {
+        for(ui32Idx = 0; ui32Idx < BENCH_SAMPLES; ui32Idx++)
+        {
+            ui32Sum += GamepadButtonsPack(g_pui8BenchButtons[ui32Idx]);
+        }
+    }
+
+    return(ui32Sum);
+}
+
+// A whole report from a button state and three ADC samples, as the main
+// loop and ADCUpdate() build it.
+static uint32_t BenchReportPack(uint32_t ui32Calls)
+{
+    uint32_t pui32Filter[3], ui32Sum = 0, ui32Idx;
+    tGamepadReport sReport;
+    uint8_t ui8LT, ui8RT;
+
+    pui32Filter[0] = pui32Filter[1] = pui32Filter[2] = GAMEPAD_ADC_CENTER << 4;
+
+    while(ui32Calls--)
+    {
+        for(ui32Idx = 0; ui32Idx < BENCH_SAMPLES; ui32Idx++)
+        {
+            sReport.ui8Buttons = GamepadButtonsPack(g_pui8BenchButtons[ui32Idx]);
+            sReport.i8XPos = GamepadStickMap(GamepadTrim(GAMEPAD_AXIS_X,
+                GamepadFilter(&pui32Filter[0], g_pui32BenchADC[ui32Idx])));
+            sReport.i8YPos = GamepadStickMap(GamepadTrim(GAMEPAD_AXIS_Y,
+                GamepadFilter(&pui32Filter[2],
+                              g_pui32BenchADC[(ui32Idx + 1) % BENCH_SAMPLES])));
+            GamepadTriggerMap(GamepadFilter(&pui32Filter[1],
+                                  g_pui32BenchADC[(ui32Idx + 2) % BENCH_SAMPLES]),
+                              &ui8LT, &ui8RT);
+            sReport.i8LT = (int8_t)ui8LT;
+            sReport.i8RT = (int8_t)ui8RT;
+
+            ui32Sum += (uint8_t)sReport.i8XPos + (uint8_t)sReport.i8YPos +
+                       ui8LT + ui8RT + sReport.ui8Buttons;
+        }
+    }
+
+    return(ui32Sum);
+}
+
+// A report through the compiled remap, from a button state and four axis
+// bytes.
+static uint32_t BenchRemapRun(uint32_t ui32Calls)
+{
+    uint8_t pui8Input[REMAP_REPORT_SIZE], pui8Report[REMAP_REPORT_SIZE];
+    uint32_t ui32Sum = 0, ui32Idx, ui32Field;
+
+    while(ui32Calls--)
+    {
+        for(ui32Idx = 0; ui32Idx < BENCH_SAMPLES; ui32Idx++)
+        {
+            for(ui32Field = 0; ui32Field < REMAP_AXES; ui32Field++)
+            {
+                pui8Input[ui32Field] = (uint8_t)
+                    (g_pui32BenchADC[(ui32Idx + ui32Field) % BENCH_SAMPLES] >> 4);
+            }
+            pui8Input[REMAP_FIELD_BUTTONS] =
+                GamepadButtonsPack(g_pui8BenchButtons[ui32Idx]);
+
+            RemapApply(pui8Input, pui8Report);
+
+            ui32Sum += pui8Report[0] + pui8Report[1] + pui8Report[2] +
+                       pui8Report[3] + pui8Report[4];
+        }
+    }
+
+    return(ui32Sum);
+}
+
+// Kernels that read the tuning are listed twice, untuned and then tuned.
+static uint32_t BenchStickMapTuned(uint32_t ui32Calls);
+static uint32_t BenchTriggerMapTuned(uint32_t ui32Calls);
+static uint32_t BenchFilterTuned(uint32_t ui32Calls);
+static uint32_t BenchReportPackTuned(uint32_t ui32Calls);
+static uint32_t BenchRemapIdentity(uint32_t ui32Calls);
+static uint32_t BenchRemapLayered(uint32_t ui32Calls);
+
+const tBenchKernel g_psBenchKernels[] =
+{
+    { "overhead", BenchOverhead },
+    { "buttons_poll", BenchButtonsPoll },
+    { "debounce", BenchDebounce },
+    { "convert8bit", BenchConvert8Bit },
+    { "stick_map", BenchStickMap },
+    { "stick_map_tuned", BenchStickMapTuned },
+    { "trigger_map", BenchTriggerMap },
+    { "trigger_map_tuned", BenchTriggerMapTuned },
+    { "filter", BenchFilter },
+    { "filter_tuned", BenchFilterTuned },
+    { "buttons_pack", BenchButtonsPack },
+    { "report_pack", BenchReportPack },
+    { "report_pack_tuned", BenchReportPackTuned },
+    { "remap", BenchRemapIdentity },
+    { "remap_layered", BenchRemapLayered },
+};
+
+const uint32_t g_ui32BenchKernels = sizeof(g_psBenchKernels) /
+                                    sizeof(g_psBenchKernels[0]);
+
+// Run pfnRun with the tuned parameters in place of the live ones.  Only
+// called from BenchRun(), with the USB interrupt masked.
+static uint32_t BenchTuned(uint32_t (*pfnRun)(uint32_t), uint32_t ui32Calls)
+{
+    tGamepadConfig sLive = g_sGamepadConfig;
+    uint32_t ui32Sum;
+
+    g_sGamepadConfig = g_sBenchTuned;
+    ui32Sum = pfnRun(ui32Calls);
+    g_sGamepadConfig = sLive;
+
+    return(ui32Sum);
+}
+
+static uint32_t BenchStickMapTuned(uint32_t ui32Calls)
+{
+    return(BenchTuned(BenchStickMap, ui32Calls));
+}
+
+static uint32_t BenchTriggerMapTuned(uint32_t ui32Calls)
+{
+    return(BenchTuned(BenchTriggerMap, ui32Calls));
+}
+
+static uint32_t BenchFilterTuned(uint32_t ui32Calls)
+{
+    return(BenchTuned(BenchFilter, ui32Calls));
+}
+
+static uint32_t BenchReportPackTuned(uint32_t ui32Calls)
+{
+    return(BenchTuned(BenchReportPack, ui32Calls));
+}
+
+// Run the remap with psLayout compiled in place of the live layout.
+static uint32_t BenchRemap(const tRemapConfig *psLayout, uint32_t ui32Calls)
+{
+    uint32_t ui32Sum;
+
+    RemapCompile(psLayout);
+    ui32Sum = BenchRemapRun(ui32Calls);
+    RemapCompile(&g_sRemapConfig);
+
+    return(ui32Sum);
+}
+
+static uint32_t BenchRemapIdentity(uint32_t ui32Calls)
+{
+    tRemapConfig sIdentity;
+
+    RemapConfigDefaults(&sIdentity);
+
+    return(BenchRemap(&sIdentity, ui32Calls));
+}
+
+static uint32_t BenchRemapLayered(uint32_t ui32Calls)
+{
+    return(BenchRemap(&g_sBenchLayout, ui32Calls));
+}
+
+//*****************************************************************************
+//
+// Drivers.
+//
+//*****************************************************************************
+
+// Fill in the inputs.  A fixed seed, so every run sees the same ones.
+void BenchInit(void)
+{
+    uint32_t ui32Seed = 0x12345678, ui32Idx;
+
+    for(ui32Idx = 0; ui32Idx < BENCH_SAMPLES; ui32Idx++)
+    {
+        ui32Seed = (ui32Seed * 1664525) + 1013904223;
+        g_pui32BenchADC[ui32Idx] = (ui32Seed >> 8) & GAMEPAD_ADC_MAX;
+
+        // a button changes on roughly one sample in four
+        g_pui8BenchButtons[ui32Idx] = (uint8_t)
+            ((ui32Idx ? g_pui8BenchButtons[ui32Idx - 1] : 0) ^
+             (((ui32Seed >> 24) & 3) ? 0 : (1 << ((ui32Seed >> 26) % 5))));
+    }
+}
+
+// Run kernel ui32Kernel ui32Calls times with the untuned parameters.  The
+// config page is written from the USB interrupt, so that is held off until
+// the live tuning is back.
+uint32_t BenchRun(uint32_t ui32Kernel, uint32_t ui32Calls)
+{
+    tGamepadConfig sLive;
+    uint32_t ui32Sum;
+    bool bUSB;
+
+    bUSB = MAP_IntIsEnabled(INT_USB0);
+    MAP_IntDisable(INT_USB0);
+
+    sLive = g_sGamepadConfig;
+    GamepadConfigDefaults(&g_sGamepadConfig);
+    ui32Sum = g_psBenchKernels[ui32Kernel].pfnRun(ui32Calls);
+    g_sGamepadConfig = sLive;
+
+    if(bUSB)
+    {
+        MAP_IntEnable(INT_USB0);
+    }
+
+    g_ui32BenchSink += ui32Sum;
+
+    return(ui32Sum);
+}
+
+// Time every kernel with the cycle counter and print the cycles per input,
+// to two decimals.  Interrupts stay on, the fastest of the runs is taken.
+void BenchPrint(void)
+{
+#ifdef BENCH
+    uint32_t ui32Kernel, ui32Run, ui32Start, ui32Cycles, ui32Best, ui32Per100;
+
+    BenchInit();
+
+    UARTprintf("\nbench (cycles per input, best of %u)\n", BENCH_TARGET_RUNS);
+
+    for(ui32Kernel = 0; ui32Kernel < g_ui32BenchKernels; ui32Kernel++)
+    {
+        ui32Best = 0xffffffff;
+
+        // the first call warms the prefetch buffer
+        BenchRun(ui32Kernel, 1);
+
+        for(ui32Run = 0; ui32Run < BENCH_TARGET_RUNS; ui32Run++)
+        {
+            ui32Start = CyclesGet();
+            BenchRun(ui32Kernel, BENCH_TARGET_CALLS);
+            ui32Cycles = CyclesSince(ui32Start);
+
+            if(ui32Cycles < ui32Best)
+            {
+                ui32Best = ui32Cycles;
+            }
+        }
+
+        ui32Per100 = (ui32Best * 100) / (BENCH_TARGET_CALLS * BENCH_SAMPLES);
+        UARTprintf("bench %s %u.%02u\n", g_psBenchKernels[ui32Kernel].pcName,
+                   ui32Per100 / 100, ui32Per100 % 100);
+    }
+#else
+    UARTprintf("\nbenchmarks not built in (define BENCH)\n");
+#endif
+}
@@ -0,0 +1,56 @@
+//*****************************************************************************
+//
+// bench.h - Micro-benchmarks for the input to report path.
+//
+// Copyright (c) Aditya Challamarad.  All rights reserved.
+//
+//*****************************************************************************
+
+#ifndef _BENCH_H_
+#define _BENCH_H_
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+//
+// The same kernels run on the target, timed with the DWT cycle counter and
+// printed over the UART, and on the host by host/gamepad_bench.c.  Each
+// kernel call processes BENCH_SAMPLES inputs.
+//
+// The console command is opt-in.  Build with BENCH defined to include it,
+// without it BenchPrint() only says so.
+//
+
+// Inputs per kernel call.
+#define BENCH_SAMPLES           64
+
+// Kernel calls and repeats per kernel on the target.  The fastest repeat is
+// kept, the others may have been hit by interrupts.  The whole set takes a
+// few tens of milliseconds, well inside what the supervisor allows the loop.
+#define BENCH_TARGET_CALLS      8
+#define BENCH_TARGET_RUNS       3
+
+typedef struct
+{
+    // Name in the output and the baselines.
+    const char *pcName;
+
+    // Run ui32Calls times over the inputs, returning a checksum of the
+    // results so none of the work can be optimized away.
+    uint32_t (*pfnRun)(uint32_t ui32Calls);
+} tBenchKernel;
+
+extern const tBenchKernel g_psBenchKernels[];
+extern const uint32_t g_ui32BenchKernels;
+
+extern void BenchInit(void);
+extern uint32_t BenchRun(uint32_t ui32Kernel, uint32_t ui32Calls);
+extern void BenchPrint(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,167 @@
+//*****************************************************************************
+//
+// board.c - One pass bring-up of the pins and peripherals in board.h.
+//
+// Copyright (c) Aditya Challamarad.  All rights reserved.
+//
+// Everything here is generated from the tables in board.h.  The per port
+// pin masks are compile time constants, so each port costs one clock enable
+// and one driverlib call per function it has pins for, however many pins
+// there are.
+//
+//*****************************************************************************
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "inc/hw_memmap.h"
+#include "inc/hw_types.h"
+#include "driverlib/gpio.h"
+#include "driverlib/pin_map.h"
+#include "driverlib/rom.h"
+#include "driverlib/rom_map.h"
+#include "driverlib/sysctl.h"
+#include "board.h"
+
+// One GPIO port and the pins of each function on it.
+typedef struct
+{
+    uint32_t ui32Periph;
+    uint32_t ui32Base;
+    bool bAHB;
+    uint8_t ui8Input;
+    uint8_t ui8UART;
+    uint8_t ui8ADC;
+    uint8_t ui8USB;
+    uint8_t ui8Timer;
+} tBoardPort;
+
+#define BOARD_BASE_APB(port)    GPIO_PORT##port##_BASE
+#define BOARD_BASE_AHB(port)    GPIO_PORT##port##_AHB_BASE
+
+#define BOARD_PORT_ENTRY(port, bus)                                           \
+    {                                                                         \
+        SYSCTL_PERIPH_GPIO##port, BOARD_BASE_##bus(port),                     \
+        BOARD_BASE_##bus(port) != BOARD_BASE_APB(port),                       \
+        BOARD_PIN_MASK(BOARD_PORT_##port, BOARD_FN_INPUT),                    \
+        BOARD_PIN_MASK(BOARD_PORT_##port, BOARD_FN_UART),                     \
+        BOARD_PIN_MASK(BOARD_PORT_##port, BOARD_FN_ADC),                      \
+        BOARD_PIN_MASK(BOARD_PORT_##port, BOARD_FN_USB),                      \
+        BOARD_PIN_MASK(BOARD_PORT_##port, BOARD_FN_TIMER)                     \
+    },
+
+static const tBoardPort g_psBoardPorts[] =
+{
+    BOARD_PORTS(BOARD_PORT_ENTRY)
+};
+
+#define BOARD_NUM_PORTS         (sizeof(g_psBoardPorts) / sizeof(tBoardPort))
+
+#define BOARD_PERIPH_ENTRY(name)    SYSCTL_PERIPH_##name,
+
+static const uint32_t g_pui32BoardPeriphs[] =
+{
+    BOARD_PERIPHS(BOARD_PERIPH_ENTRY)
+};
+
+#define BOARD_NUM_PERIPHS       (sizeof(g_pui32BoardPeriphs) / sizeof(uint32_t))
+
+// Pin mux settings, the table entries without one are skipped.
+#define BOARD_MUX_ENTRY(x, y, name, port, pin, fn, mux) mux,
+
+static const uint32_t g_pui32BoardMux[] =
+{
+    BOARD_PINS(BOARD_MUX_ENTRY, 0, 0)
+};
+
+#define BOARD_NUM_MUX           (sizeof(g_pui32BoardMux) / sizeof(uint32_t))
+
+// True if a port has any pins in the table.
+static bool BoardPortUsed(const tBoardPort *psPort)
+{
+    return((psPort->ui8Input | psPort->ui8UART | psPort->ui8ADC |
+            psPort->ui8USB | psPort->ui8Timer) != 0);
+}
+
+// Enable every port and peripheral in the table, then set up the pins.
+// Timer pins are left to the driver that owns the timer, which switches
+// the pin between the timer and GPIO as it starts and stops.
+void BoardInit(void)
+{
+    const tBoardPort *psPort;
+    uint32_t ui32Idx;
+
+    // Clock everything first and wait once, rather than per peripheral.
+    for(ui32Idx = 0; ui32Idx < BOARD_NUM_PORTS; ui32Idx++)
+    {
+        psPort = &g_psBoardPorts[ui32Idx];
+
+        if(BoardPortUsed(psPort))
+        {
+            if(psPort->bAHB)
+            {
+                SysCtlGPIOAHBEnable(psPort->ui32Periph);
+            }
+
+            MAP_SysCtlPeripheralEnable(psPort->ui32Periph);
+        }
+    }
+
+    for(ui32Idx = 0; ui32Idx < BOARD_NUM_PERIPHS; ui32Idx++)
+    {
+        MAP_SysCtlPeripheralEnable(g_pui32BoardPeriphs[ui32Idx]);
+    }
+
+    for(ui32Idx = 0; ui32Idx < BOARD_NUM_PORTS; ui32Idx++)
+    {
+        if(BoardPortUsed(&g_psBoardPorts[ui32Idx]))
+        {
+            while(!MAP_SysCtlPeripheralReady(g_psBoardPorts[ui32Idx].ui32Periph))
+            {
+            }
+        }
+    }
+
+    for(ui32Idx = 0; ui32Idx < BOARD_NUM_PERIPHS; ui32Idx++)
+    {
+        while(!MAP_SysCtlPeripheralReady(g_pui32BoardPeriphs[ui32Idx]))
+        {
+        }
+    }
+
+    for(ui32Idx = 0; ui32Idx < BOARD_NUM_MUX; ui32Idx++)
+    {
+        if(g_pui32BoardMux[ui32Idx])
+        {
+            MAP_GPIOPinConfigure(g_pui32BoardMux[ui32Idx]);
+        }
+    }
+
+    // One call per function per port.
+    for(ui32Idx = 0; ui32Idx < BOARD_NUM_PORTS; ui32Idx++)
+    {
+        psPort = &g_psBoardPorts[ui32Idx];
+
+        if(psPort->ui8Input)
+        {
+            MAP_GPIODirModeSet(psPort->ui32Base, psPort->ui8Input,
+                               GPIO_DIR_MODE_IN);
+            MAP_GPIOPadConfigSet(psPort->ui32Base, psPort->ui8Input,
+                                 GPIO_STRENGTH_2MA, GPIO_PIN_TYPE_STD_WPU);
+        }
+
+        if(psPort->ui8UART)
+        {
+            MAP_GPIOPinTypeUART(psPort->ui32Base, psPort->ui8UART);
+        }
+
+        if(psPort->ui8ADC)
+        {
+            MAP_GPIOPinTypeADC(psPort->ui32Base, psPort->ui8ADC);
+        }
+
+        if(psPort->ui8USB)
+        {
+            MAP_GPIOPinTypeUSBAnalog(psPort->ui32Base, psPort->ui8USB);
+        }
+    }
+}
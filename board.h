@@ -0,0 +1,124 @@
+//*****************************************************************************
+//
+// board.h - Pin and peripheral resource table for the gamepad board.
+//
+// Copyright (c) Aditya Challamarad.  All rights reserved.
+//
+//*****************************************************************************
+
+#ifndef _BOARD_H_
+#define _BOARD_H_
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+//
+// Every pin and peripheral the firmware uses is listed here once.  BoardInit()
+// enables each GPIO port and peripheral a single time and configures all the
+// pins of a port that share a function in one call.  Nothing else should
+// enable a port or a peripheral in this table.
+//
+// A pin or peripheral listed twice is a compile error, for example
+//
+//   error: redeclaration of enumerator "BOARD_PIN_USED_PF2"
+//
+// so a new input cannot quietly take over a pin something else depends on.
+//
+
+// GPIO ports and the bus each is used through.  Ports D and E are on the
+// high performance bus, see the GPIO_PORTx_AHB_BASE users.
+#define BOARD_PORTS(PORT)                                                     \
+    PORT(A, APB)                                                              \
+    PORT(B, APB)                                                              \
+    PORT(C, APB)                                                              \
+    PORT(D, AHB)                                                              \
+    PORT(E, AHB)                                                              \
+    PORT(F, APB)
+
+// Pin functions.
+#define BOARD_FN_INPUT          0   // GPIO input, weak pull up
+#define BOARD_FN_UART           1   // UART, muxed by BoardInit()
+#define BOARD_FN_ADC            2   // analog input
+#define BOARD_FN_USB            3   // USB analog
+#define BOARD_FN_TIMER          4   // timer CCP, muxed by the owning driver
+
+//
+// PIN(x, y, name, port, pin, function, mux).  x and y are passed through
+// untouched for the macros below.  mux is the GPIO_Pxx_ value for
+// GPIOPinConfigure(), 0 if the pin has no alternate function.
+//
+// Green and blue of the LaunchPad RGB LED (PF3 T1CCP1, PF2 T1CCP0) are not
+// listed because buttons 1 and 2 use those pins.
+//
+#define BOARD_PINS(PIN, x, y)                                                 \
+    PIN(x, y, UART0_RX,     A, 0, UART,  GPIO_PA0_U0RX)                       \
+    PIN(x, y, UART0_TX,     A, 1, UART,  GPIO_PA1_U0TX)                       \
+    PIN(x, y, JOYSTICK_SW,  A, 5, INPUT, 0)                                   \
+    PIN(x, y, BUTTON3,      B, 3, INPUT, 0)                                   \
+    PIN(x, y, BUTTON4,      C, 4, INPUT, 0)                                   \
+    PIN(x, y, USB0_DM,      D, 4, USB,   0)                                   \
+    PIN(x, y, USB0_DP,      D, 5, USB,   0)                                   \
+    PIN(x, y, STICK_Y,      E, 1, ADC,   0)     /* AIN2 */                    \
+    PIN(x, y, POT,          E, 4, ADC,   0)     /* AIN9 */                    \
+    PIN(x, y, STICK_X,      E, 5, ADC,   0)     /* AIN8 */                    \
+    PIN(x, y, LED_RED,      F, 1, TIMER, 0)     /* T0CCP1 */                  \
+    PIN(x, y, BUTTON1,      F, 2, INPUT, 0)                                   \
+    PIN(x, y, BUTTON2,      F, 3, INPUT, 0)
+
+//
+// PERIPH(name), the SYSCTL_PERIPH_ suffix, with the owner alongside.
+//
+#define BOARD_PERIPHS(PERIPH)                                                 \
+    PERIPH(UART0)       /* console */                                         \
+    PERIPH(ADC0)        /* sticks and trigger, gated in suspend */            \
+    PERIPH(USB0)        /* HID gamepad */                                     \
+    PERIPH(TIMER0)      /* status LED PWM */                                  \
+    PERIPH(TIMER2)      /* suspend stick poll */                              \
+    PERIPH(TIMER3)      /* input replay */                                    \
+    PERIPH(TIMER4)      /* macro and turbo frames */                          \
+    PERIPH(WTIMER5)     /* status LED animation frames */                     \
+    PERIPH(WDOG0)       /* supervisor */
+
+// Port numbers for the table.
+#define BOARD_PORT_A            0
+#define BOARD_PORT_B            1
+#define BOARD_PORT_C            2
+#define BOARD_PORT_D            3
+#define BOARD_PORT_E            4
+#define BOARD_PORT_F            5
+
+//
+// The pin mask of every pin on port p with function f, a compile time
+// constant.  For example BOARD_PIN_MASK(BOARD_PORT_E, BOARD_FN_ADC).
+//
+#define BOARD_PIN_SELECT(p, f, name, port, pin, fn, mux)                      \
+    | (((BOARD_PORT_##port == (p)) && (BOARD_FN_##fn == (f))) ?               \
+       (1 << (pin)) : 0)
+#define BOARD_PIN_MASK(p, f)    (0 BOARD_PINS(BOARD_PIN_SELECT, p, f))
+
+//
+// BOARD_PIN_<name> is the GPIO_PIN_ mask of each pin in the table.  The
+// BOARD_PIN_USED_ and BOARD_PERIPH_USED_ enumerators exist only to catch a
+// pin or peripheral listed twice.
+//
+#define BOARD_PIN_ENUM(x, y, name, port, pin, fn, mux)                        \
+    BOARD_PIN_##name = (1 << (pin)),                                          \
+    BOARD_PIN_USED_P##port##pin,
+#define BOARD_PERIPH_ENUM(name) BOARD_PERIPH_USED_##name,
+
+enum
+{
+    BOARD_PINS(BOARD_PIN_ENUM, 0, 0)
+    BOARD_PERIPHS(BOARD_PERIPH_ENUM)
+    BOARD_RESOURCES
+};
+
+extern void BoardInit(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
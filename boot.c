@@ -0,0 +1,137 @@
+//*****************************************************************************
+//
+// boot.c - Boot milestone timestamps.
+//
+// Copyright (c) Aditya Challamarad.  All rights reserved.
+//
+// main() starts the cycle counter as soon as the clock is set and marks each
+// stage of bring-up as it completes.  Only the first time through counts,
+// so a later reconfiguration by the host does not overwrite the boot
+// figures.  The time from reset to the clock being set (stack painting and
+// the C runtime start up) is not included.
+//
+// The cycle counter wraps after about 85 seconds at 50MHz, and a host can
+// attach much later than that.  The time is kept in 64 bits, advanced from
+// the main loop until every milestone is in, like the recorder's clock.
+//
+//*****************************************************************************
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "inc/hw_types.h"
+#include "driverlib/interrupt.h"
+#include "driverlib/sysctl.h"
+#include "drivers/cycles.h"
+#include "utils/uartstdio.h"
+#include "clockgov.h"
+#include "fault.h"
+#include "boot.h"
+
+uint32_t g_pui32BootUs[BOOT_NUM_MILESTONES];
+
+static const char * const g_ppcBootMilestone[BOOT_NUM_MILESTONES] =
+{
+    "usb init", "peripherals", "calibrated", "configured", "first report"
+};
+
+// Cycles per microsecond at the current clock, the counter when the time was
+// last advanced, the cycles short of a whole microsecond then and the time.
+static uint32_t g_ui32BootPerUs;
+static uint32_t g_ui32BootCycles;
+static uint32_t g_ui32BootRem;
+static uint64_t g_ui64BootUs;
+
+// Milestones not reached yet.
+static uint32_t g_ui32BootLeft = BOOT_NUM_MILESTONES;
+
+// Advance the time to now.  Called from the main loop and the USB
+// interrupt, so not interruptible.
+static uint64_t BootNow(void)
+{
+    uint32_t ui32Now, ui32Cycles;
+    bool bMasked;
+
+    bMasked = IntMasterDisable();
+
+    ui32Now = CyclesGet();
+    ui32Cycles = (ui32Now - g_ui32BootCycles) + g_ui32BootRem;
+
+    g_ui32BootCycles = ui32Now;
+    g_ui64BootUs += ui32Cycles / g_ui32BootPerUs;
+    g_ui32BootRem = ui32Cycles % g_ui32BootPerUs;
+
+    if(!bMasked)
+    {
+        IntMasterEnable();
+    }
+
+    return(g_ui64BootUs);
+}
+
+// Clock governor hook.  The cycles so far were at the old clock.
+static void BootClock(uint32_t ui32SysClock)
+{
+    BootNow();
+    g_ui32BootPerUs = ui32SysClock / 1000000;
+}
+
+// Call right after CyclesInit().
+void BootInit(void)
+{
+    g_ui32BootPerUs = SysCtlClockGet() / 1000000;
+    g_ui32BootCycles = CyclesGet();
+    g_ui64BootUs = g_ui32BootCycles / g_ui32BootPerUs;
+    g_ui32BootRem = g_ui32BootCycles % g_ui32BootPerUs;
+
+    if(!ClockGovHookRegister(BootClock))
+    {
+        FaultReset(FAULT_TYPE_SETUP);
+    }
+}
+
+// Once a pass from the main loop: keep the time from wrapping until the
+// last milestone.
+void BootPoll(void)
+{
+    if(g_ui32BootLeft)
+    {
+        BootNow();
+    }
+}
+
+// Record a milestone if it has not been reached before.  Past about 71
+// minutes it reads as the most a uint32_t holds.
+void BootMark(uint32_t ui32Milestone)
+{
+    uint64_t ui64Us;
+
+    if(g_pui32BootUs[ui32Milestone] == 0)
+    {
+        ui64Us = BootNow();
+
+        g_pui32BootUs[ui32Milestone] = (ui64Us > 0xffffffff) ? 0xffffffff :
+                                       ((ui64Us == 0) ? 1 : (uint32_t)ui64Us);
+        g_ui32BootLeft--;
+    }
+}
+
+// Dump the milestones to the UART console.
+void BootPrint(void)
+{
+    uint32_t ui32Milestone;
+
+    UARTprintf("\nboot (us from clock set)\n");
+
+    for(ui32Milestone = 0; ui32Milestone < BOOT_NUM_MILESTONES;
+        ui32Milestone++)
+    {
+        if(g_pui32BootUs[ui32Milestone] == 0)
+        {
+            UARTprintf("%s: not yet\n", g_ppcBootMilestone[ui32Milestone]);
+            continue;
+        }
+
+        UARTprintf("%s: %u\n", g_ppcBootMilestone[ui32Milestone],
+                   g_pui32BootUs[ui32Milestone]);
+    }
+}
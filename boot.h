@@ -0,0 +1,38 @@
+//*****************************************************************************
+//
+// boot.h - Boot milestone timestamps.
+//
+// Copyright (c) Aditya Challamarad.  All rights reserved.
+//
+//*****************************************************************************
+
+#ifndef _BOOT_H_
+#define _BOOT_H_
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+// Points in the boot sequence, in the order they normally happen.  All are
+// timed from the cycle counter start, right after the clock is set.
+#define BOOT_USB_INIT           0   // USB stack up, host can enumerate
+#define BOOT_PERIPH             1   // buttons, ADC and wake sources up
+#define BOOT_CALIBRATED         2   // stick rest position measured
+#define BOOT_CONFIGURED         3   // host set the configuration
+#define BOOT_FIRST_REPORT       4   // first report handed to the host
+#define BOOT_NUM_MILESTONES     5
+
+// Microseconds to each milestone, 0 if not reached yet.
+extern uint32_t g_pui32BootUs[BOOT_NUM_MILESTONES];
+
+extern void BootInit(void);
+extern void BootPoll(void);
+extern void BootMark(uint32_t ui32Milestone);
+extern void BootPrint(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,155 @@
+//*****************************************************************************
+//
+// clockgov.c - Input activity driven system clock governor.
+//
+// Copyright (c) Aditya Challamarad.  All rights reserved.
+//
+// The main loop reports input activity and the USB frame number on every
+// pass.  After CLOCKGOV_IDLE_FRAMES frames with no activity the system clock
+// drops to CLOCKGOV_IDLE_SYSDIV, and the first input puts it straight back.
+// Only the PLL divider changes and the PLL stays locked, so the switch back
+// takes microseconds, well inside one USB frame.
+//
+// The UART runs from PIOSC and the ADC from the PLL, so neither notices the
+// change.  Anything clocked from the system clock, such as a general purpose
+// timer, registers a hook to reload its divider.
+//
+//*****************************************************************************
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "inc/hw_types.h"
+#include "driverlib/rom.h"
+#include "driverlib/rom_map.h"
+#include "driverlib/sysctl.h"
+#include "drivers/cycles.h"
+#include "utils/uartstdio.h"
+#include "clockgov.h"
+
+// Oscillator and PLL settings shared by both clocks.
+#define CLOCKGOV_OSC            (SYSCTL_USE_PLL | SYSCTL_OSC_MAIN |           \
+                                 SYSCTL_XTAL_16MHZ)
+
+tClockGovStats g_sClockGovStats;
+
+static tClockGovHook g_ppfnClockGovHook[CLOCKGOV_MAX_HOOKS];
+static uint32_t g_ui32ClockGovHooks;
+
+// SysCtlClockSet() divider for full speed, from main().
+static uint32_t g_ui32ClockGovFull;
+
+// Frames since the last input and the frame number last seen, if any.
+static uint32_t g_ui32ClockGovQuiet;
+static uint32_t g_ui32ClockGovFrame;
+static bool g_bClockGovFrameValid;
+
+static bool g_bClockGovIdle;
+
+// Switch the system clock and tell everyone who depends on it.
+static void ClockGovSet(uint32_t ui32SysDiv)
+{
+    uint32_t ui32Hook, ui32Clock;
+
+    MAP_SysCtlClockSet(ui32SysDiv | CLOCKGOV_OSC);
+    ui32Clock = SysCtlClockGet();
+
+    for(ui32Hook = 0; ui32Hook < g_ui32ClockGovHooks; ui32Hook++)
+    {
+        g_ppfnClockGovHook[ui32Hook](ui32Clock);
+    }
+}
+
+// Start the governor at full speed.  ui32FullConfig is the SYSCTL_SYSDIV_*
+// value main() set the clock up with.
+void ClockGovInit(uint32_t ui32FullConfig)
+{
+    g_ui32ClockGovFull = ui32FullConfig;
+    g_ui32ClockGovQuiet = 0;
+    g_bClockGovFrameValid = false;
+    g_bClockGovIdle = false;
+}
+
+// Add a clock change hook.  Returns false if the table is full.
+bool ClockGovHookRegister(tClockGovHook pfnHook)
+{
+    if(g_ui32ClockGovHooks == CLOCKGOV_MAX_HOOKS)
+    {
+        return(false);
+    }
+
+    g_ppfnClockGovHook[g_ui32ClockGovHooks++] = pfnHook;
+    return(true);
+}
+
+// There was input, go to full speed now if idle.
+void ClockGovActivity(void)
+{
+    uint32_t ui32Start, ui32Cycles;
+
+    g_ui32ClockGovQuiet = 0;
+
+    if(!g_bClockGovIdle)
+    {
+        return;
+    }
+
+    // the cycle counter keeps counting across the switch, the time is the
+    // number of cycles over whichever clock they ran at
+    ui32Start = CyclesGet();
+    ClockGovSet(g_ui32ClockGovFull);
+    ui32Cycles = CyclesSince(ui32Start);
+
+    if(ui32Cycles > g_sClockGovStats.ui32MaxWakeCycles)
+    {
+        g_sClockGovStats.ui32MaxWakeCycles = ui32Cycles;
+    }
+
+    g_bClockGovIdle = false;
+    g_sClockGovStats.ui32ToFull++;
+}
+
+// Count quiet frames and drop to the idle clock once there have been enough.
+// ui32Frame is the 11 bit USB frame number.
+void ClockGovPoll(uint32_t ui32Frame)
+{
+    if(g_bClockGovFrameValid)
+    {
+        g_ui32ClockGovQuiet += (ui32Frame - g_ui32ClockGovFrame) & 0x7ff;
+    }
+
+    g_ui32ClockGovFrame = ui32Frame;
+    g_bClockGovFrameValid = true;
+
+    if(g_ui32ClockGovQuiet >= CLOCKGOV_IDLE_FRAMES)
+    {
+        ClockGovIdle();
+    }
+}
+
+// Drop to the idle clock now, regardless of activity.
+void ClockGovIdle(void)
+{
+    if(g_bClockGovIdle)
+    {
+        return;
+    }
+
+    ClockGovSet(CLOCKGOV_IDLE_SYSDIV);
+
+    g_bClockGovIdle = true;
+    g_sClockGovStats.ui32ToIdle++;
+}
+
+bool ClockGovIsIdle(void)
+{
+    return(g_bClockGovIdle);
+}
+
+// Dump the governor state to the UART console.
+void ClockGovPrint(void)
+{
+    UARTprintf("\nclock %uMHz (%s), idle %u full %u, max wake %u cycles\n",
+               SysCtlClockGet() / 1000000, g_bClockGovIdle ? "idle" : "full",
+               g_sClockGovStats.ui32ToIdle, g_sClockGovStats.ui32ToFull,
+               g_sClockGovStats.ui32MaxWakeCycles);
+}
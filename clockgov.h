@@ -0,0 +1,57 @@
+//*****************************************************************************
+//
+// clockgov.h - Input activity driven system clock governor.
+//
+// Copyright (c) Aditya Challamarad.  All rights reserved.
+//
+//*****************************************************************************
+
+#ifndef _CLOCKGOV_H_
+#define _CLOCKGOV_H_
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+// USB frames (1ms) with no input before the clock drops to the idle rate.
+#define CLOCKGOV_IDLE_FRAMES    2000
+
+// Axis movement, in report counts, needed to count as input.  Smaller
+// changes are ADC noise and would keep the clock up forever.
+#define CLOCKGOV_AXIS_THRESHOLD 2
+
+// Idle clock, 200MHz / 10.  The USB controller needs at least 20MHz.
+#define CLOCKGOV_IDLE_SYSDIV    SYSCTL_SYSDIV_10
+
+// Most clock change hooks that can be registered.  Boot, the status LED,
+// the supervisor and the recorder use four.  A module whose hook does not
+// fit cannot follow the clock, so its init resets with FAULT_TYPE_SETUP.
+#define CLOCKGOV_MAX_HOOKS      8
+
+// Called with the new system clock in Hz after every change, so timers
+// clocked from the system clock can reload their dividers.
+typedef void (*tClockGovHook)(uint32_t ui32SysClock);
+
+typedef struct
+{
+    uint32_t ui32ToIdle;        // full speed to idle switches
+    uint32_t ui32ToFull;        // idle to full speed switches
+    uint32_t ui32MaxWakeCycles; // longest switch back to full speed
+} tClockGovStats;
+
+extern tClockGovStats g_sClockGovStats;
+
+extern void ClockGovInit(uint32_t ui32FullConfig);
+extern bool ClockGovHookRegister(tClockGovHook pfnHook);
+extern void ClockGovActivity(void);
+extern void ClockGovPoll(uint32_t ui32Frame);
+extern void ClockGovIdle(void);
+extern bool ClockGovIsIdle(void);
+extern void ClockGovPrint(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -33,6 +33,7 @@
 #include "driverlib/rom_map.h"
 #include "driverlib/sysctl.h"
 #include "drivers/buttons.h"
+#include "hal.h"
 
 //*****************************************************************************
 //
@@ -43,14 +44,102 @@
 
 //*****************************************************************************
 //
-// Holds the current, debounced state of each button.  A 0 in a bit indicates
-// that that button is currently pressed, otherwise it is released.
-// We assume that we start with all the buttons released (though if one is
-// pressed when the application starts, this will be detected).
+// Holds the current, debounced state of each button and the debounce clocks.
+// A 0 in a bit indicates that that button is currently pressed, otherwise it
+// is released.  We assume that we start with all the buttons released (though
+// if one is pressed when the application starts, this will be detected).
 //
 //*****************************************************************************
-static uint8_t g_ui8ButtonStates = ALL_BUTTONS;
+static tButtonDebounce g_sButtonDebounce = { ALL_BUTTONS, 0, 0 };
 
+//*****************************************************************************
+//
+//! Debounces one sample of a set of buttons.
+//!
+//! \param psState points to the debounce state of the buttons.
+//! \param ui8Raw is the raw state of the buttons, a 1 where a button reads
+//! high.
+//! \param pui8Delta points to a character that will be written to indicate
+//! which button states changed with this sample.
+//!
+//! This is the debounce behind ButtonsPoll().  A button must read the same
+//! for four calls in a row before its debounced state follows.  It keeps no
+//! state of its own, so any number of button sets can be debounced side by
+//! side.
+//!
+//! \return Returns the debounced state of the buttons.
+//
+//*****************************************************************************
+uint8_t
+ButtonsDebounce(tButtonDebounce *psState, uint8_t ui8Raw, uint8_t *pui8Delta)
+{
+    uint32_t ui32Delta;
+
+    //
+    // Determine the switches that are at a different state than the debounced
+    // state.
+    //
+    ui32Delta = ui8Raw ^ psState->ui8States;
+
+    //
+    // Increment the clocks by one.
+    //
+    psState->ui8ClockA ^= psState->ui8ClockB;
+    psState->ui8ClockB = ~psState->ui8ClockB;
+
+    //
+    // Reset the clocks corresponding to switches that have not changed state.
+    //
+    psState->ui8ClockA &= ui32Delta;
+    psState->ui8ClockB &= ui32Delta;
+
+    //
+    // Get the new debounced switch state.
+    //
+    psState->ui8States &= psState->ui8ClockA | psState->ui8ClockB;
+    psState->ui8States |= (~(psState->ui8ClockA | psState->ui8ClockB)) & ui8Raw;
+
+    //
+    // Determine the switches that just changed debounced state.
+    //
+    ui32Delta ^= (psState->ui8ClockA | psState->ui8ClockB);
+
+    if(pui8Delta)
+    {
+        *pui8Delta = (uint8_t)ui32Delta;
+    }
+
+    return(psState->ui8States);
+}
+
+
+//*****************************************************************************
+//
+//! Reads the raw state of the buttons.
+//!
+//! This is the read behind ButtonsPoll(), without the debounce.  It changes
+//! no state, so it can be called at any time.
+//!
+//! \return Returns the raw state of the buttons, a 1 where a button is
+//! pressed.
+//
+//*****************************************************************************
+uint8_t
+ButtonsRead(void)
+{
+    uint32_t ui32Data;
+
+    ui32Data = 0;
+
+    if (HALPinRead(BUTTON1_GPIO_BASE, BUTTON1_PIN) & BUTTON1_PIN) ui32Data |= BUTTON1_MASK; //button 1
+    if (HALPinRead(BUTTON2_GPIO_BASE, BUTTON2_PIN) & BUTTON2_PIN) ui32Data |= BUTTON2_MASK;
+    if (HALPinRead(BUTTON3_GPIO_BASE, BUTTON3_PIN) & BUTTON3_PIN) ui32Data |= BUTTON3_MASK;
+    if (HALPinRead(BUTTON4_GPIO_BASE, BUTTON4_PIN) & BUTTON4_PIN) ui32Data |= BUTTON4_MASK; // button 4
+
+    if (HALPinRead(JOYSTICK_SW_GPIO_BASE, JOYSTICK_SW_PIN) & JOYSTICK_SW_PIN) ui32Data |= JOYSTICK_MASK; // Joystick button
+
+    return((uint8_t)ui32Data);
+}
 
 //*****************************************************************************
 //
@@ -84,26 +173,14 @@ static uint8_t g_ui8ButtonStates = ALL_BUTTONS;
 uint8_t
 ButtonsPoll(uint8_t *pui8Delta, uint8_t *pui8RawState)
 {
-    uint32_t ui32Delta;
     uint32_t ui32Data;
-    static uint8_t ui8SwitchClockA = 0;
-    static uint8_t ui8SwitchClockB = 0;
 
     //
     // Read the raw state of the push buttons.  Save the raw state
     // (inverting the bit sense) if the caller supplied storage for the
     // raw value.
     //
-
-    ui32Data = 0;
-
-    if (MAP_GPIOPinRead(BUTTON1_GPIO_BASE, BUTTON1_PIN) & BUTTON1_PIN) ui32Data |= BUTTON1_MASK; //button 1
-    if (MAP_GPIOPinRead(BUTTON2_GPIO_BASE, BUTTON2_PIN) & BUTTON2_PIN) ui32Data |= BUTTON2_MASK;
-    if (MAP_GPIOPinRead(BUTTON3_GPIO_BASE, BUTTON3_PIN) & BUTTON3_PIN) ui32Data |= BUTTON3_MASK;
-    if (MAP_GPIOPinRead(BUTTON4_GPIO_BASE, BUTTON4_PIN) & BUTTON4_PIN) ui32Data |= BUTTON4_MASK; // button 4
-
-    if (MAP_GPIOPinRead(JOYSTICK_SW_GPIO_BASE, JOYSTICK_SW_PIN) & JOYSTICK_SW_PIN) ui32Data |= JOYSTICK_MASK; // Joystick button
-
+    ui32Data = ButtonsRead();
 
     if(pui8RawState)
     {
@@ -111,49 +188,12 @@ ButtonsPoll(uint8_t *pui8Delta, uint8_t *pui8RawState)
     }
 
     //
-    // Determine the switches that are at a different state than the debounced
-    // state.
-    //
-    ui32Delta = ui32Data ^ g_ui8ButtonStates;
-
-    //
-    // Increment the clocks by one.
-    //
-    ui8SwitchClockA ^= ui8SwitchClockB;
-    ui8SwitchClockB = ~ui8SwitchClockB; 
-
-    //
-    // Reset the clocks corresponding to switches that have not changed state.
-    //
-    ui8SwitchClockA &= ui32Delta;
-    ui8SwitchClockB &= ui32Delta;
-
-    //
-    // Get the new debounced switch state.
-    //
-    g_ui8ButtonStates &= ui8SwitchClockA | ui8SwitchClockB;
-    g_ui8ButtonStates |= (~(ui8SwitchClockA | ui8SwitchClockB)) & ui32Data;
-
-    //
-    // Determine the switches that just changed debounced state.
-    //
-    ui32Delta ^= (ui8SwitchClockA | ui8SwitchClockB);
-
-    //
-    // Store the bit mask for the buttons that have changed for return to
-    // caller.
-    //
-    if(pui8Delta)
-    {
-        *pui8Delta = (uint8_t)ui32Delta;
-    }
-
-    //
-    // Return the debounced buttons states to the caller.  DONT Invert the bit
-    // sense so that a '1' indicates the button is pressed, which is a
-    // sensible way to interpret the return value.
+    // Debounce the sample and return the debounced buttons states to the
+    // caller, along with the bit mask for the buttons that have changed.
+    // DONT Invert the bit sense so that a '1' indicates the button is
+    // pressed, which is a sensible way to interpret the return value.
     //
-    return(g_ui8ButtonStates);
+    return(ButtonsDebounce(&g_sButtonDebounce, (uint8_t)ui32Data, pui8Delta));
 }
 
 //*****************************************************************************
@@ -171,38 +211,17 @@ ButtonsPoll(uint8_t *pui8Delta, uint8_t *pui8RawState)
 void
 ButtonsInit(void)
 {
-    //
-    // Enable the GPIO port to which the pushbuttons are connected.
-    //
-    MAP_SysCtlPeripheralEnable(BUTTON1_GPIO_PERIPH);
-    MAP_SysCtlPeripheralEnable(BUTTON2_GPIO_PERIPH);
-    MAP_SysCtlPeripheralEnable(BUTTON3_GPIO_PERIPH);
-    MAP_SysCtlPeripheralEnable(BUTTON4_GPIO_PERIPH);
-    MAP_SysCtlPeripheralEnable(JOYSTICK_SW_PERIPH);
-
-
-    // Set all the directions of each button to inputs
-    MAP_GPIODirModeSet(BUTTON1_GPIO_BASE, BUTTON1_PIN, GPIO_DIR_MODE_IN);
-    MAP_GPIODirModeSet(BUTTON2_GPIO_BASE, BUTTON2_PIN, GPIO_DIR_MODE_IN);
-    MAP_GPIODirModeSet(BUTTON3_GPIO_BASE, BUTTON3_PIN, GPIO_DIR_MODE_IN);
-    MAP_GPIODirModeSet(BUTTON4_GPIO_BASE, BUTTON4_PIN, GPIO_DIR_MODE_IN);
-    MAP_GPIODirModeSet(JOYSTICK_SW_GPIO_BASE, JOYSTICK_SW_PIN, GPIO_DIR_MODE_IN);
-
-    // Enable pull up resistor for each input
-    MAP_GPIOPadConfigSet(BUTTON1_GPIO_BASE, BUTTON1_PIN, GPIO_STRENGTH_2MA, GPIO_PIN_TYPE_STD_WPU);
-    MAP_GPIOPadConfigSet(BUTTON2_GPIO_BASE, BUTTON2_PIN, GPIO_STRENGTH_2MA, GPIO_PIN_TYPE_STD_WPU);
-    MAP_GPIOPadConfigSet(BUTTON3_GPIO_BASE, BUTTON3_PIN, GPIO_STRENGTH_2MA, GPIO_PIN_TYPE_STD_WPU);
-    MAP_GPIOPadConfigSet(BUTTON4_GPIO_BASE, BUTTON4_PIN, GPIO_STRENGTH_2MA, GPIO_PIN_TYPE_STD_WPU);
-    MAP_GPIOPadConfigSet(JOYSTICK_SW_GPIO_BASE, JOYSTICK_SW_PIN, GPIO_STRENGTH_2MA, GPIO_PIN_TYPE_STD_WPU);
+    // The ports are enabled and the pins set up as inputs with pull ups by
+    // BoardInit(), see the BOARD_FN_INPUT pins in board.h.
 
     // Poll current state of each button
     uint8_t initial = 0;
-    if (MAP_GPIOPinRead(BUTTON1_GPIO_BASE, BUTTON1_PIN) & BUTTON1_PIN) initial |= BUTTON1_MASK;
-    if (MAP_GPIOPinRead(BUTTON2_GPIO_BASE, BUTTON2_PIN) & BUTTON2_PIN) initial |= BUTTON2_MASK;
-    if (MAP_GPIOPinRead(BUTTON3_GPIO_BASE, BUTTON3_PIN) & BUTTON3_PIN) initial |= BUTTON3_MASK;
-    if (MAP_GPIOPinRead(BUTTON4_GPIO_BASE, BUTTON4_PIN) & BUTTON4_PIN) initial |= BUTTON4_MASK;
-    if (MAP_GPIOPinRead(JOYSTICK_SW_GPIO_BASE, JOYSTICK_SW_PIN) & JOYSTICK_SW_PIN) initial |= JOYSTICK_MASK;
-    g_ui8ButtonStates = initial;
+    if (HALPinRead(BUTTON1_GPIO_BASE, BUTTON1_PIN) & BUTTON1_PIN) initial |= BUTTON1_MASK;
+    if (HALPinRead(BUTTON2_GPIO_BASE, BUTTON2_PIN) & BUTTON2_PIN) initial |= BUTTON2_MASK;
+    if (HALPinRead(BUTTON3_GPIO_BASE, BUTTON3_PIN) & BUTTON3_PIN) initial |= BUTTON3_MASK;
+    if (HALPinRead(BUTTON4_GPIO_BASE, BUTTON4_PIN) & BUTTON4_PIN) initial |= BUTTON4_MASK;
+    if (HALPinRead(JOYSTICK_SW_GPIO_BASE, JOYSTICK_SW_PIN) & JOYSTICK_SW_PIN) initial |= JOYSTICK_MASK;
+    g_sButtonDebounce.ui8States = initial;
 
 }
 
@@ -25,6 +25,8 @@
 #ifndef __BUTTONS_H__
 #define __BUTTONS_H__
 
+#include "board.h"
+
 //*****************************************************************************
 //
 // If building with a C++ compiler, make all of the definitions in this header
@@ -63,12 +65,12 @@ extern "C"
 #define BUTTON4_GPIO_BASE       GPIO_PORTC_BASE
 #define JOYSTICK_SW_GPIO_BASE   GPIO_PORTA_BASE
 
-// Button Pin Numbers
-#define BUTTON1_PIN             GPIO_PIN_2
-#define BUTTON2_PIN             GPIO_PIN_3
-#define BUTTON3_PIN             GPIO_PIN_3
-#define BUTTON4_PIN             GPIO_PIN_4
-#define JOYSTICK_SW_PIN         GPIO_PIN_5
+// Button Pin Numbers, from the board resource table
+#define BUTTON1_PIN             BOARD_PIN_BUTTON1
+#define BUTTON2_PIN             BOARD_PIN_BUTTON2
+#define BUTTON3_PIN             BOARD_PIN_BUTTON3
+#define BUTTON4_PIN             BOARD_PIN_BUTTON4
+#define JOYSTICK_SW_PIN         BOARD_PIN_JOYSTICK_SW
 
 //
 #define ALL_BUTTONS   (BUTTON1_PIN | BUTTON2_PIN | BUTTON3_PIN | BUTTON4_PIN | JOYSTICK_SW_PIN)
@@ -103,6 +105,21 @@ extern "C"
 {
 #endif
 
+//*****************************************************************************
+//
+// The debounce state of a set of buttons.  ui8States holds the debounced
+// state, the two clock bits of each button count the samples it has read
+// different from it.
+//
+//*****************************************************************************
+typedef struct
+{
+    uint8_t ui8States;
+    uint8_t ui8ClockA;
+    uint8_t ui8ClockB;
+}
+tButtonDebounce;
+
 //*****************************************************************************
 //
 // Functions exported from buttons.c
@@ -111,6 +128,9 @@ extern "C"
 extern void ButtonsInit(void);
 extern uint8_t ButtonsPoll(uint8_t *pui8Delta,
                              uint8_t *pui8Raw);
+extern uint8_t ButtonsRead(void);
+extern uint8_t ButtonsDebounce(tButtonDebounce *psState, uint8_t ui8Raw,
+                               uint8_t *pui8Delta);
 
 //*****************************************************************************
 //
@@ -0,0 +1,52 @@
+//*****************************************************************************
+//
+// cycles.c - Driver for the Cortex-M4 DWT cycle counter.
+//
+// Copyright (c) Aditya Challamarad.  All rights reserved.
+//
+//*****************************************************************************
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "inc/hw_types.h"
+#include "drivers/cycles.h"
+
+//*****************************************************************************
+//
+//! \addtogroup cycles_api
+//! @{
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+//! Enables the free running DWT cycle counter.
+//!
+//! This function turns on the trace block and starts CYCCNT counting from
+//! zero.  It is safe to call more than once; later calls simply restart the
+//! count.  The counter keeps running with or without a debugger attached.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+CyclesInit(void)
+{
+    //
+    // The DWT is gated by the trace enable bit in DEMCR.
+    //
+    HWREG(CYCLES_DEMCR) |= CYCLES_DEMCR_TRCENA;
+
+    //
+    // Reset and start the counter.
+    //
+    HWREG(CYCLES_DWT_CYCCNT) = 0;
+    HWREG(CYCLES_DWT_CTRL) |= CYCLES_DWT_CTRL_CYCCNTENA;
+}
+
+//*****************************************************************************
+//
+// Close the Doxygen group.
+//! @}
+//
+//*****************************************************************************
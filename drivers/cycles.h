@@ -0,0 +1,63 @@
+//*****************************************************************************
+//
+// cycles.h - Prototypes for the Cortex-M4 DWT cycle counter driver.
+//
+// Copyright (c) Aditya Challamarad.  All rights reserved.
+//
+//*****************************************************************************
+
+#ifndef __CYCLES_H__
+#define __CYCLES_H__
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+//*****************************************************************************
+//
+// Debug and trace registers used by the cycle counter.  These live in the
+// Cortex-M4 private peripheral bus and are not covered by inc/hw_nvic.h.
+//
+//*****************************************************************************
+#define CYCLES_DEMCR            0xE000EDFC  // Debug Exception and Monitor Ctl
+#define CYCLES_DEMCR_TRCENA     0x01000000  // Enable DWT and ITM blocks
+#define CYCLES_DWT_CTRL         0xE0001000  // DWT Control
+#define CYCLES_DWT_CTRL_CYCCNTENA                                             \
+                                0x00000001  // Enable CYCCNT
+#define CYCLES_DWT_CYCCNT       0xE0001004  // DWT Cycle Count
+
+//*****************************************************************************
+//
+// Useful macros for timing code with the cycle counter.  The counter runs at
+// the system clock and wraps every 2^32 cycles, so differences taken with
+// unsigned arithmetic are valid for intervals up to ~85 seconds at 50MHz.
+//
+//*****************************************************************************
+#define CyclesGet()             (HWREG(CYCLES_DWT_CYCCNT))
+
+#define CyclesSince(ui32Start)  ((uint32_t)(CyclesGet() - (ui32Start)))
+
+//*****************************************************************************
+//
+// Functions exported from cycles.c
+//
+//*****************************************************************************
+extern void CyclesInit(void);
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __CYCLES_H__
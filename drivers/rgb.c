@@ -52,29 +52,190 @@
 // LED through simple PWM output mode of the GP Timers.
 //
 // A global array contains the current relative color of each of the three
-// LEDs. A global float variable controls intensity of the overall mixed color.
+// LEDs and a 16.16 fixed point intensity scales the mixed color.  Colors and
+// intensity are perceived brightness; a gamma table turns them into PWM duty
+// so fades look even to the eye.  There is no floating point in the driver.
+//
+// Blinks and fades run from the wide timer interrupt, one frame at a time,
+// so once a pattern is set the application does nothing to keep it going.
+// The frame timer only runs while a pattern or the heartbeat needs it.
 //
 // This implementation consumes the following hardware resources
-// 	- Wide Timer 5B for blinking the entire RGB unit.
+// 	- Wide Timer 5B for the animation frames.
 // 	- Timer 0B intensity of an RGB element
 // 	- Timer 1A intensity of an RGB element
 // 	- Timer 1B intensity of an RGB element
 //
 //*****************************************************************************
-static uint32_t  g_ui32Colors[3];
-static float g_fIntensity = 0.3f;
+static uint32_t g_ui32Colors[3];
+static uint32_t g_ui32Intensity = (RGB_FULL * 3) / 10;
+static uint32_t g_ui32Enabled;
+static uint32_t g_ui32SysClock;
+static bool g_bRGBOn;
+
+//
+// Current pattern, its phase as a fraction of the period in 0.16 fixed
+// point, and the phase step per frame.
+//
+static uint32_t g_ui32Pattern = RGB_PATTERN_SOLID;
+static uint32_t g_ui32PeriodMs;
+static uint32_t g_ui32Phase;
+static uint32_t g_ui32PhaseStep;
+
+//
+// Heartbeat counter, its last value, the count per flash and the count not
+// yet flashed for.
+//
+static const volatile uint32_t *g_pui32HeartbeatCount;
+static uint32_t g_ui32HeartbeatLast;
+static uint32_t g_ui32HeartbeatDivide;
+static uint32_t g_ui32HeartbeatPending;
+
+//
+// Gamma 2.2 from perceived brightness to PWM duty, 64 steps plus the end
+// point.  Values in between are interpolated.
+//
+static const uint16_t g_pui16Gamma[65] =
+{
+        0,     7,    32,    78,   147,   240,   359,   504,
+      676,   875,  1104,  1361,  1648,  1966,  2314,  2693,
+     3104,  3547,  4022,  4530,  5072,  5646,  6255,  6897,
+     7574,  8286,  9033,  9815, 10632, 11486, 12375, 13301,
+    14263, 15262, 16298, 17371, 18482, 19630, 20816, 22040,
+    23303, 24604, 25943, 27322, 28739, 30196, 31692, 33227,
+    34802, 36417, 38072, 39768, 41503, 43280, 45097, 46954,
+    48853, 50793, 52774, 54796, 56860, 58966, 61114, 63303,
+    65535
+};
+
+//*****************************************************************************
+//
+// Convert a perceived brightness, 0x0000 to 0xFFFF, to a PWM duty.
+//
+//*****************************************************************************
+static uint32_t
+RGBGamma(uint32_t ui32Level)
+{
+    uint32_t ui32Index, ui32Frac, ui32Low;
+
+    ui32Index = ui32Level >> 10;
+    ui32Frac = ui32Level & 0x3FF;
+    ui32Low = g_pui16Gamma[ui32Index];
+
+    return(ui32Low +
+           (((g_pui16Gamma[ui32Index + 1] - ui32Low) * ui32Frac) >> 10));
+}
+
+//*****************************************************************************
+//
+// Write the duty for each enabled color at the given animation level, 16.16
+// fixed point from 0 to RGB_FULL.
+//
+//*****************************************************************************
+static void
+RGBOutput(uint32_t ui32Level)
+{
+    uint32_t ui32Color[3];
+    uint32_t ui32Index;
+
+    for(ui32Index = 0; ui32Index < 3; ui32Index++)
+    {
+        ui32Color[ui32Index] = (g_ui32Colors[ui32Index] * g_ui32Intensity) >> 16;
+        ui32Color[ui32Index] = (ui32Color[ui32Index] * ui32Level) >> 16;
+
+        if(ui32Color[ui32Index] > 0xFFFF)
+        {
+            ui32Color[ui32Index] = 0xFFFF;
+        }
+
+        ui32Color[ui32Index] = RGBGamma(ui32Color[ui32Index]);
+    }
+
+    if(g_ui32Enabled & RGB_RED_EN)
+    {
+        MAP_TimerMatchSet(RED_TIMER_BASE, RED_TIMER, ui32Color[RED]);
+    }
+
+    if(g_ui32Enabled & RGB_GREEN_EN)
+    {
+        MAP_TimerMatchSet(GREEN_TIMER_BASE, GREEN_TIMER, ui32Color[GREEN]);
+    }
+
+    if(g_ui32Enabled & RGB_BLUE_EN)
+    {
+        MAP_TimerMatchSet(BLUE_TIMER_BASE, BLUE_TIMER, ui32Color[BLUE]);
+    }
+}
+
+//*****************************************************************************
+//
+// Animation level for the current pattern and phase.
+//
+//*****************************************************************************
+static uint32_t
+RGBPatternLevel(void)
+{
+    switch(g_ui32Pattern)
+    {
+        case RGB_PATTERN_BLINK:
+        {
+            return((g_ui32Phase < 0x8000) ? RGB_FULL : 0);
+        }
+
+        case RGB_PATTERN_PULSE:
+        {
+            return((g_ui32Phase < 0x8000) ? (g_ui32Phase << 1) :
+                                            ((0x10000 - g_ui32Phase) << 1));
+        }
+
+        default:
+        {
+            return(RGB_FULL);
+        }
+    }
+}
 
 //*****************************************************************************
 //
-//! Wide Timer interrupt to handle blinking effect of the RGB 
+// Start the frame timer if a pattern or the heartbeat needs it, stop it
+// otherwise, and show the current level.
+//
+//*****************************************************************************
+static void
+RGBFrameUpdate(void)
+{
+    bool bAnimate;
+
+    bAnimate = g_bRGBOn && ((g_ui32Pattern != RGB_PATTERN_SOLID) ||
+                            (g_pui32HeartbeatCount != 0));
+
+    if(bAnimate)
+    {
+        MAP_TimerLoadSet(WTIMER5_BASE, TIMER_B,
+                         g_ui32SysClock / RGB_FRAME_HZ);
+        MAP_TimerEnable(WTIMER5_BASE, TIMER_B);
+    }
+    else
+    {
+        MAP_TimerDisable(WTIMER5_BASE, TIMER_B);
+    }
+
+    if(g_bRGBOn)
+    {
+        RGBOutput(RGBPatternLevel());
+    }
+}
+
+//*****************************************************************************
+//
+//! Wide Timer interrupt to animate the RGB
 //!
 //! This function is called by the hardware interrupt controller on a timeout
-//! of the wide timer.  This function must be in the NVIC table in the startup
-//! file.  When called will toggle the enable flag to turn on or off the entire
-//! RGB unit.  This creates a blinking effect.  A wide timer is used since the 
-//! blink is intended to be visible to the human eye and thus is expected to 
-//! have a frequency between 15 and 0.1 hz. Currently blink duty is fixed at
-//! 50%.
+//! of the wide timer, RGB_FRAME_HZ times a second while a pattern or the
+//! heartbeat is active.  This function must be in the NVIC table in the
+//! startup file.  When called it advances the pattern by one frame and
+//! updates the PWM duty.  A heartbeat frame inverts the level, so the LED
+//! flickers at a rate that follows the heartbeat counter.
 //!
 //! \return None.
 //
@@ -82,96 +243,116 @@ static float g_fIntensity = 0.3f;
 void
 RGBBlinkIntHandler(void)
 {
-    static unsigned long ulFlags;
-
+    uint32_t ui32Level, ui32Count;
 
     //
     // Clear the timer interrupt.
     //
     MAP_TimerIntClear(WTIMER5_BASE, TIMER_TIMB_TIMEOUT);
 
-    //
-    // Toggle the flag for the blink timer.
-    //
-    ulFlags ^= 1;
+    g_ui32Phase = (g_ui32Phase + g_ui32PhaseStep) & 0xFFFF;
+    ui32Level = RGBPatternLevel();
 
-    if(ulFlags)
-    {
-        RGBEnable();
-    }
-    else
+    if(g_pui32HeartbeatCount)
     {
-        RGBDisable();
+        ui32Count = *g_pui32HeartbeatCount;
+        g_ui32HeartbeatPending += ui32Count - g_ui32HeartbeatLast;
+        g_ui32HeartbeatLast = ui32Count;
+
+        //
+        // Never fall more than one flash behind.
+        //
+        if(g_ui32HeartbeatPending >= (2 * g_ui32HeartbeatDivide))
+        {
+            g_ui32HeartbeatPending = g_ui32HeartbeatDivide;
+        }
+
+        if(g_ui32HeartbeatPending >= g_ui32HeartbeatDivide)
+        {
+            g_ui32HeartbeatPending -= g_ui32HeartbeatDivide;
+            ui32Level = (ui32Level > (RGB_FULL / 2)) ? 0 : RGB_FULL;
+        }
     }
 
+    RGBOutput(ui32Level);
 }
 
 //*****************************************************************************
 //
 //! Initializes the Timer and GPIO functionality associated with the RGB LED
 //!
-//! \param ui32Enable enables RGB immediately if set.
+//! \param ui32Enable is the set of colors to drive, any of RGB_RED_EN,
+//! RGB_GREEN_EN and RGB_BLUE_EN.
+//! \param ui32SysClock is the system clock in Hz.
 //!
 //! This function must be called during application initialization to
-//! configure the GPIO pins to which the LEDs are attached.  It enables
-//! the port used by the LEDs and configures each color's Timer. It optionally
-//! enables the RGB LED by configuring the GPIO pins and starting the timers.
+//! configure the Timer of each selected color.  The GPIO port, the color
+//! timers and Wide Timer 5 must already be clocked, the application does
+//! that for all its peripherals in one place.  The pins of the other colors
+//! are not touched.  Call RGBEnable() to start the LED.
 //!
 //! \return None.
 //
 //*****************************************************************************
 void
-RGBInit(uint32_t ui32Enable)
+RGBInit(uint32_t ui32Enable, uint32_t ui32SysClock)
 {
-    //
-    // Enable the GPIO Port and Timer for each LED
-    //
-    MAP_SysCtlPeripheralEnable(RED_GPIO_PERIPH);
-    MAP_SysCtlPeripheralEnable(RED_TIMER_PERIPH);
-
-    MAP_SysCtlPeripheralEnable(GREEN_GPIO_PERIPH);
-    MAP_SysCtlPeripheralEnable(GREEN_TIMER_PERIPH);
-
-    MAP_SysCtlPeripheralEnable(BLUE_GPIO_PERIPH);
-    MAP_SysCtlPeripheralEnable(BLUE_TIMER_PERIPH);
+    g_ui32Enabled = ui32Enable;
+    g_ui32SysClock = ui32SysClock;
 
     //
-    // Configure each timer for output mode
+    // Configure the timer of each LED for output mode.
     //
-    HWREG(GREEN_TIMER_BASE + TIMER_O_CFG)   = 0x04;
-    HWREG(GREEN_TIMER_BASE + TIMER_O_TAMR)  = 0x0A;
-    HWREG(GREEN_TIMER_BASE + TIMER_O_TAILR) = 0xFFFF;
-
-    HWREG(BLUE_TIMER_BASE + TIMER_O_CFG)   = 0x04;
-    HWREG(BLUE_TIMER_BASE + TIMER_O_TBMR)  = 0x0A;
-    HWREG(BLUE_TIMER_BASE + TIMER_O_TBILR) = 0xFFFF;
-
-    HWREG(RED_TIMER_BASE + TIMER_O_CFG)   = 0x04;
-    HWREG(RED_TIMER_BASE + TIMER_O_TBMR)  = 0x0A;
-    HWREG(RED_TIMER_BASE + TIMER_O_TBILR) = 0xFFFF;
+    if(ui32Enable & RGB_GREEN_EN)
+    {
+        HWREG(GREEN_TIMER_BASE + TIMER_O_CFG)   = 0x04;
+        HWREG(GREEN_TIMER_BASE + TIMER_O_TAMR)  = 0x0A;
+        HWREG(GREEN_TIMER_BASE + TIMER_O_TAILR) = 0xFFFF;
+        HWREG(GREEN_TIMER_BASE + TIMER_O_CTL)   |= 0x40;
+    }
 
-    //
-    // Invert the output signals.
-    //
-    HWREG(RED_TIMER_BASE + TIMER_O_CTL)   |= 0x4000;
-    HWREG(GREEN_TIMER_BASE + TIMER_O_CTL)   |= 0x40;
-    HWREG(BLUE_TIMER_BASE + TIMER_O_CTL)   |= 0x4000;
+    if(ui32Enable & RGB_BLUE_EN)
+    {
+        HWREG(BLUE_TIMER_BASE + TIMER_O_CFG)   = 0x04;
+        HWREG(BLUE_TIMER_BASE + TIMER_O_TBMR)  = 0x0A;
+        HWREG(BLUE_TIMER_BASE + TIMER_O_TBILR) = 0xFFFF;
+        HWREG(BLUE_TIMER_BASE + TIMER_O_CTL)   |= 0x4000;
+    }
 
-    if(ui32Enable)
+    if(ui32Enable & RGB_RED_EN)
     {
-        RGBEnable();
+        HWREG(RED_TIMER_BASE + TIMER_O_CFG)   = 0x04;
+        HWREG(RED_TIMER_BASE + TIMER_O_TBMR)  = 0x0A;
+        HWREG(RED_TIMER_BASE + TIMER_O_TBILR) = 0xFFFF;
+        HWREG(RED_TIMER_BASE + TIMER_O_CTL)   |= 0x4000;
     }
 
     //
-    // Setup the blink functionality
+    // Setup the animation frame timer, started when a pattern needs it.
     //
-    MAP_SysCtlPeripheralEnable(SYSCTL_PERIPH_WTIMER5);
     MAP_TimerConfigure(WTIMER5_BASE, TIMER_CFG_B_PERIODIC | TIMER_CFG_SPLIT_PAIR);
-    MAP_TimerLoadSet64(WTIMER5_BASE, 0xFFFFFFFFFFFFFFFF);
     MAP_IntEnable(INT_WTIMER5B);
     MAP_TimerIntEnable(WTIMER5_BASE, TIMER_TIMB_TIMEOUT);
+}
 
-
+//*****************************************************************************
+//
+//! Tell the driver the system clock has changed
+//!
+//! \param ui32SysClock is the new system clock in Hz.
+//!
+//! The animation frame timer runs from the system clock.  This function
+//! reloads it so patterns keep their speed, and fits the clock governor's
+//! hook signature so it can be registered directly.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+RGBClockSet(uint32_t ui32SysClock)
+{
+    g_ui32SysClock = ui32SysClock;
+    MAP_TimerLoadSet(WTIMER5_BASE, TIMER_B, ui32SysClock / RGB_FRAME_HZ);
 }
 
 //*****************************************************************************
@@ -181,7 +362,7 @@ RGBInit(uint32_t ui32Enable)
 //! This function or RGBDisable should be called during application
 //! initialization to configure the GPIO pins to which the LEDs are attached.
 //! This function enables the timers and configures the GPIO pins as timer
-//! outputs.
+//! outputs.  It does nothing if the LED is already enabled.
 //!
 //! \return None.
 //
@@ -189,31 +370,45 @@ RGBInit(uint32_t ui32Enable)
 void
 RGBEnable(void)
 {
+    if(g_bRGBOn)
+    {
+        return;
+    }
 
-    //
-    // Enable timers to begin counting
-    //
-    MAP_TimerEnable(RED_TIMER_BASE, TIMER_BOTH);
-    MAP_TimerEnable(GREEN_TIMER_BASE, TIMER_BOTH);
-    MAP_TimerEnable(BLUE_TIMER_BASE, TIMER_BOTH);
+    g_bRGBOn = true;
 
     //
-    // Reconfigure each LED's GPIO pad for timer control
+    // Enable timers to begin counting and reconfigure each LED's GPIO pad for
+    // timer control
     //
-    MAP_GPIOPinConfigure(GREEN_GPIO_PIN_CFG);
-    MAP_GPIOPinTypeTimer(GREEN_GPIO_BASE, GREEN_GPIO_PIN);
-    MAP_GPIOPadConfigSet(GREEN_GPIO_BASE, GREEN_GPIO_PIN, GPIO_STRENGTH_8MA_SC,
-                     GPIO_PIN_TYPE_STD);
-
-    MAP_GPIOPinConfigure(BLUE_GPIO_PIN_CFG);
-    MAP_GPIOPinTypeTimer(BLUE_GPIO_BASE, BLUE_GPIO_PIN);
-    MAP_GPIOPadConfigSet(BLUE_GPIO_BASE, BLUE_GPIO_PIN, GPIO_STRENGTH_8MA_SC,
-                     GPIO_PIN_TYPE_STD);
-
-    MAP_GPIOPinConfigure(RED_GPIO_PIN_CFG);
-    MAP_GPIOPinTypeTimer(RED_GPIO_BASE, RED_GPIO_PIN);
-    MAP_GPIOPadConfigSet(RED_GPIO_BASE, RED_GPIO_PIN, GPIO_STRENGTH_8MA_SC,
-                     GPIO_PIN_TYPE_STD);
+    if(g_ui32Enabled & RGB_GREEN_EN)
+    {
+        MAP_TimerEnable(GREEN_TIMER_BASE, GREEN_TIMER);
+        MAP_GPIOPinConfigure(GREEN_GPIO_PIN_CFG);
+        MAP_GPIOPinTypeTimer(GREEN_GPIO_BASE, GREEN_GPIO_PIN);
+        MAP_GPIOPadConfigSet(GREEN_GPIO_BASE, GREEN_GPIO_PIN,
+                             GPIO_STRENGTH_8MA_SC, GPIO_PIN_TYPE_STD);
+    }
+
+    if(g_ui32Enabled & RGB_BLUE_EN)
+    {
+        MAP_TimerEnable(BLUE_TIMER_BASE, BLUE_TIMER);
+        MAP_GPIOPinConfigure(BLUE_GPIO_PIN_CFG);
+        MAP_GPIOPinTypeTimer(BLUE_GPIO_BASE, BLUE_GPIO_PIN);
+        MAP_GPIOPadConfigSet(BLUE_GPIO_BASE, BLUE_GPIO_PIN,
+                             GPIO_STRENGTH_8MA_SC, GPIO_PIN_TYPE_STD);
+    }
+
+    if(g_ui32Enabled & RGB_RED_EN)
+    {
+        MAP_TimerEnable(RED_TIMER_BASE, RED_TIMER);
+        MAP_GPIOPinConfigure(RED_GPIO_PIN_CFG);
+        MAP_GPIOPinTypeTimer(RED_GPIO_BASE, RED_GPIO_PIN);
+        MAP_GPIOPadConfigSet(RED_GPIO_BASE, RED_GPIO_PIN,
+                             GPIO_STRENGTH_8MA_SC, GPIO_PIN_TYPE_STD);
+    }
+
+    RGBFrameUpdate();
 }
 
 //*****************************************************************************
@@ -222,8 +417,8 @@ RGBEnable(void)
 //!
 //! This function or RGBEnable should be called during application
 //! initialization to configure the GPIO pins to which the LEDs are attached.
-//! This function disables the timers and configures the GPIO pins as inputs
-//! for minimum current draw.
+//! This function disables the timers, including the frame timer, and
+//! configures the GPIO pins as inputs for minimum current draw.
 //!
 //! \return None.
 //
@@ -231,19 +426,31 @@ RGBEnable(void)
 void
 RGBDisable(void)
 {
-    //
-    // Configure the GPIO pads as general purpose inputs.
-    //
-    MAP_GPIOPinTypeGPIOInput(RED_GPIO_BASE, RED_GPIO_PIN);
-    MAP_GPIOPinTypeGPIOInput(GREEN_GPIO_BASE, GREEN_GPIO_PIN);
-    MAP_GPIOPinTypeGPIOInput(BLUE_GPIO_BASE, BLUE_GPIO_PIN);
+    g_bRGBOn = false;
 
     //
-    // Stop the timer counting.
+    // Configure the GPIO pads as general purpose inputs and stop the timers
+    // counting.
     //
-    MAP_TimerDisable(RED_TIMER_BASE, TIMER_BOTH);
-    MAP_TimerDisable(GREEN_TIMER_BASE, TIMER_BOTH);
-    MAP_TimerDisable(BLUE_TIMER_BASE, TIMER_BOTH);
+    if(g_ui32Enabled & RGB_GREEN_EN)
+    {
+        MAP_GPIOPinTypeGPIOInput(GREEN_GPIO_BASE, GREEN_GPIO_PIN);
+        MAP_TimerDisable(GREEN_TIMER_BASE, GREEN_TIMER);
+    }
+
+    if(g_ui32Enabled & RGB_BLUE_EN)
+    {
+        MAP_GPIOPinTypeGPIOInput(BLUE_GPIO_BASE, BLUE_GPIO_PIN);
+        MAP_TimerDisable(BLUE_TIMER_BASE, BLUE_TIMER);
+    }
+
+    if(g_ui32Enabled & RGB_RED_EN)
+    {
+        MAP_GPIOPinTypeGPIOInput(RED_GPIO_BASE, RED_GPIO_PIN);
+        MAP_TimerDisable(RED_TIMER_BASE, RED_TIMER);
+    }
+
+    MAP_TimerDisable(WTIMER5_BASE, TIMER_B);
 }
 
 //*****************************************************************************
@@ -254,9 +461,8 @@ RGBDisable(void)
 //! relative intensity of each color.  Red is element 0, Green is element 1,
 //! Blue is element 2. 0x0000 is off.  0xFFFF is fully on.
 //!
-//! \param fIntensity is used to scale the intensity of all three colors by
-//! the same amount.  fIntensity should be between 0.0 and 1.0.  This scale
-//! factor is applied to all three colors.
+//! \param ui32Intensity is used to scale the intensity of all three colors by
+//! the same amount.  ui32Intensity is 16.16 fixed point from 0 to RGB_FULL.
 //!
 //! This function should be called by the application to set the color and
 //! intensity of the RGB LED.
@@ -265,10 +471,10 @@ RGBDisable(void)
 //
 //*****************************************************************************
 void
-RGBSet(volatile uint32_t * pui32RGBColor,  float fIntensity)
+RGBSet(volatile uint32_t * pui32RGBColor, uint32_t ui32Intensity)
 {
+    g_ui32Intensity = ui32Intensity;
     RGBColorSet(pui32RGBColor);
-    RGBIntensitySet(fIntensity);
 }
 
 //*****************************************************************************
@@ -288,33 +494,25 @@ RGBSet(volatile uint32_t * pui32RGBColor,  float fIntensity)
 void
 RGBColorSet(volatile uint32_t * pui32RGBColor)
 {
-    uint32_t ui32Color[3];
     uint32_t ui32Index;
 
     for(ui32Index=0; ui32Index < 3; ui32Index++)
     {
         g_ui32Colors[ui32Index] = pui32RGBColor[ui32Index];
-        ui32Color[ui32Index] = (uint32_t) (((float) pui32RGBColor[ui32Index]) *
-                            g_fIntensity + 0.5f);
-
-        if(ui32Color[ui32Index] > 0xFFFF)
-        {
-            ui32Color[ui32Index] = 0xFFFF;
-        }
     }
 
-    MAP_TimerMatchSet(RED_TIMER_BASE, RED_TIMER, ui32Color[RED]);
-    MAP_TimerMatchSet(GREEN_TIMER_BASE, GREEN_TIMER, ui32Color[GREEN]);
-    MAP_TimerMatchSet(BLUE_TIMER_BASE, BLUE_TIMER, ui32Color[BLUE]);
+    if(g_bRGBOn)
+    {
+        RGBOutput(RGBPatternLevel());
+    }
 }
 
 //*****************************************************************************
 //
 //! Set the current output intensity.
 //!
-//! \param fIntensity is used to scale the intensity of all three colors by
-//! the same amount.  fIntensity should be between 0.0 and 1.0.  This scale
-//! factor is applied individually to all three colors.
+//! \param ui32Intensity is used to scale the intensity of all three colors by
+//! the same amount.  ui32Intensity is 16.16 fixed point from 0 to RGB_FULL.
 //!
 //! This function should be called by the application to set the intensity
 //! of the RGB LED.
@@ -323,51 +521,121 @@ RGBColorSet(volatile uint32_t * pui32RGBColor)
 //
 //*****************************************************************************
 void
-RGBIntensitySet(float fIntensity)
+RGBIntensitySet(uint32_t ui32Intensity)
 {
-    g_fIntensity = fIntensity;
+    g_ui32Intensity = ui32Intensity;
     RGBColorSet(g_ui32Colors);
 }
 
+//*****************************************************************************
+//
+//! Set the animation pattern
+//!
+//! \param ui32Pattern is one of RGB_PATTERN_SOLID, RGB_PATTERN_BLINK or
+//! RGB_PATTERN_PULSE.
+//! \param ui32PeriodMs is the length of one blink or fade cycle in
+//! milliseconds, ignored for RGB_PATTERN_SOLID.
+//!
+//! The pattern runs from the frame timer interrupt.  Setting the pattern
+//! that is already running does not restart it.  May be called from
+//! interrupt context.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+RGBPatternSet(uint32_t ui32Pattern, uint32_t ui32PeriodMs)
+{
+    bool bMasked;
+
+    if((ui32Pattern == g_ui32Pattern) && (ui32PeriodMs == g_ui32PeriodMs))
+    {
+        return;
+    }
+
+    bMasked = IntMasterDisable();
+
+    g_ui32Pattern = ui32Pattern;
+    g_ui32PeriodMs = ui32PeriodMs;
+    g_ui32Phase = 0;
+    g_ui32PhaseStep = 0;
+
+    if((ui32Pattern != RGB_PATTERN_SOLID) && ui32PeriodMs)
+    {
+        g_ui32PhaseStep = (0x10000 * 1000) / (ui32PeriodMs * RGB_FRAME_HZ);
+    }
+
+    RGBFrameUpdate();
+
+    if(!bMasked)
+    {
+        IntMasterEnable();
+    }
+}
+
 //*****************************************************************************
 //
 //! Sets the blink rate of the RGB Led
 //!
-//! \param fRate is the blink rate in hertz.
+//! \param ui32MilliHz is the blink rate in thousandths of a hertz.
 //!
 //! This function controls the blink rate of the RGB LED in auto blink mode.
-//! to enable blinking pass a non-zero floating pointer number.  To disable
-//! pass 0.0f as the argument. Calling this function will override the current
-//! RGBDisable or RGBEnable status.
+//! To enable blinking pass a non-zero rate.  To disable pass 0 as the
+//! argument, the LED is then steady.
 //!
 //! \return None.
 //
 //*****************************************************************************
 void
-RGBBlinkRateSet(float fRate)
+RGBBlinkRateSet(uint32_t ui32MilliHz)
 {
-    uint64_t ui64Load;
-
-    if(fRate == 0.0f)
+    if(ui32MilliHz == 0)
     {
-        //
-        // Disable the timer and enable the RGB.  If blink rate is zero we
-        // assume we want the RGB to be enabled. To disable call RGBDisable
-        //
-        MAP_TimerDisable(WTIMER5_BASE, TIMER_B);
-        RGBEnable();
+        RGBPatternSet(RGB_PATTERN_SOLID, 0);
     }
     else
     {
-        //
-        // Keep the math in floating pointing until the end so that we keep as
-        // much precision as we can.
-        //
-        ui64Load = (uint64_t) (((float)SysCtlClockGet()) / (fRate * 2.0f));
-        MAP_TimerLoadSet(WTIMER5_BASE, TIMER_B, ui64Load);
-        MAP_TimerEnable(WTIMER5_BASE, TIMER_B);
+        RGBPatternSet(RGB_PATTERN_BLINK, 1000000 / ui32MilliHz);
     }
+}
 
+//*****************************************************************************
+//
+//! Flicker the LED as a counter advances
+//!
+//! \param pui32Count points to a counter that something else increments, or
+//! is 0 to turn the heartbeat off.
+//! \param ui32Divide is how many counts make one flicker.
+//!
+//! Once a frame the driver reads the counter and inverts the LED for that
+//! frame for every ui32Divide counts, so the flicker rate follows the rate
+//! of whatever is being counted without the counting code touching the LED.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+RGBHeartbeatSet(const volatile uint32_t *pui32Count, uint32_t ui32Divide)
+{
+    bool bMasked;
+
+    bMasked = IntMasterDisable();
+
+    g_pui32HeartbeatCount = pui32Count;
+    g_ui32HeartbeatDivide = ui32Divide ? ui32Divide : 1;
+    g_ui32HeartbeatPending = 0;
+
+    if(pui32Count)
+    {
+        g_ui32HeartbeatLast = *pui32Count;
+    }
+
+    RGBFrameUpdate();
+
+    if(!bMasked)
+    {
+        IntMasterEnable();
+    }
 }
 
 //*****************************************************************************
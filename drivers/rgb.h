@@ -49,11 +49,38 @@
 #define BLUE                    2
 
 //
-// Ratio for percent of full on that should be "true" white.
+// Bits for RGBInit() selecting the colors the driver owns.  Pins of colors
+// that are not selected are left alone so they can be used for other things.
 //
-#define RED_WHITE_BALANCE        0.497f
-#define GREEN_WHITE_BALANCE      0.6f
-#define BLUE_WHITE_BALANCE       1.0f
+#define RGB_RED_EN              0x00000001
+#define RGB_GREEN_EN            0x00000002
+#define RGB_BLUE_EN             0x00000004
+#define RGB_ALL_EN              0x00000007
+
+//
+// Full intensity, intensities are 16.16 fixed point from 0 to RGB_FULL.
+//
+#define RGB_FULL                0x00010000
+
+//
+// Ratio for percent of full on that should be "true" white, 16.16 fixed
+// point.
+//
+#define RED_WHITE_BALANCE       32571   // 0.497
+#define GREEN_WHITE_BALANCE     39322   // 0.6
+#define BLUE_WHITE_BALANCE      65536   // 1.0
+
+//
+// Animation patterns for RGBPatternSet().
+//
+#define RGB_PATTERN_SOLID       0       // steady at the set color
+#define RGB_PATTERN_BLINK       1       // on for half the period, then off
+#define RGB_PATTERN_PULSE       2       // fade up and down over the period
+
+//
+// Animation frames per second.  Each frame is one wide timer interrupt.
+//
+#define RGB_FRAME_HZ            50
 
 //
 // GPIO, Timer, Peripheral, and Pin assignments for the colors
@@ -113,16 +140,21 @@ extern "C"
 // Functions exported from rgb.c
 //
 //*****************************************************************************
-extern void RGBInit(uint32_t ui32Enable);
+extern void RGBInit(uint32_t ui32Enable, uint32_t ui32SysClock);
+extern void RGBClockSet(uint32_t ui32SysClock);
 
 extern void RGBEnable(void);
 extern void RGBDisable(void);
-extern void RGBSet(volatile uint32_t * pui32RGBColor, float fIntensity);
+extern void RGBSet(volatile uint32_t * pui32RGBColor, uint32_t ui32Intensity);
 extern void RGBColorSet(volatile uint32_t * pui32RGBColor);
 
-extern void RGBIntensitySet(float fIntensity);
-extern void RGBBlinkRateSet(float fRate);
-extern void RGBGet(uint32_t * pui32RGBColor, float * pfIntensity);
+extern void RGBIntensitySet(uint32_t ui32Intensity);
+extern void RGBBlinkRateSet(uint32_t ui32MilliHz);
+extern void RGBPatternSet(uint32_t ui32Pattern, uint32_t ui32PeriodMs);
+extern void RGBHeartbeatSet(const volatile uint32_t *pui32Count,
+                            uint32_t ui32Divide);
+extern void RGBColorGet(uint32_t * pui32RGBColor);
+extern void RGBBlinkIntHandler(void);
 
 //*****************************************************************************
 //
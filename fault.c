@@ -0,0 +1,269 @@
+//*****************************************************************************
+//
+// fault.c - Fault capture and watchdog reset recovery.
+//
+// Copyright (c) Aditya Challamarad.  All rights reserved.
+//
+// The NMI, hard fault and unexpected interrupt vectors all land here instead
+// of spinning forever.  A short assembly entry finds the stacked exception
+// frame and passes it to FaultCapture(), which copies the registers and the
+// fault status into a record in .TI.noinit and resets through the watchdog.
+// The record survives the reset, so after the host has enumerated the
+// controller again it is printed on the console and can be read from the
+// fault feature page.  The controller is back in well under a second.
+//
+// With a debugger attached the handler stops at a breakpoint instead, so the
+// state can be examined where it happened.
+//
+//*****************************************************************************
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "inc/hw_memmap.h"
+#include "inc/hw_nvic.h"
+#include "inc/hw_types.h"
+#include "driverlib/interrupt.h"
+#include "driverlib/rom.h"
+#include "driverlib/rom_map.h"
+#include "driverlib/sysctl.h"
+#include "driverlib/watchdog.h"
+#include "utils/uartstdio.h"
+#include "fault.h"
+
+// Marks a record written by FaultCapture().
+#define FAULT_MAGIC             0xFA017ED0
+
+// On-chip SRAM, a stacked frame outside it cannot be read.
+#define FAULT_SRAM_START        0x20000000
+#define FAULT_SRAM_END          0x20008000
+
+#pragma NOINIT(g_sFaultRecord)
+tFaultRecord g_sFaultRecord;
+
+static const char * const g_ppcFaultType[] =
+{
+    "none", "nmi", "hard fault", "unexpected interrupt", "supervisor", "setup"
+};
+
+// Set once the record has been printed after boot.
+static bool g_bFaultReported;
+
+void FaultCapture(uint32_t *pui32Frame, uint32_t ui32Type);
+static void FaultRestart(void);
+
+//
+// Exception entry.  Bit 2 of the EXC_RETURN value in lr says which stack the
+// frame went to.  Hands the frame and the fault type to FaultCapture().
+//
+#define FAULT_STR(x)            #x
+#define FAULT_XSTR(x)           FAULT_STR(x)
+#define FAULT_ENTRY(pfnName, ui32Type)                                        \
+__asm("    .sect \".text:" #pfnName "\"\n"                                    \
+      "    .clink\n"                                                          \
+      "    .thumbfunc " #pfnName "\n"                                         \
+      "    .thumb\n"                                                          \
+      "    .align 2\n"                                                        \
+      "    .global " #pfnName "\n"                                            \
+      #pfnName ":\n"                                                          \
+      "    tst     lr, #4\n"                                                  \
+      "    ite     eq\n"                                                      \
+      "    mrseq   r0, msp\n"                                                 \
+      "    mrsne   r0, psp\n"                                                 \
+      "    movs    r1, #" FAULT_XSTR(ui32Type) "\n"                           \
+      "    b.w     FaultCapture\n");
+
+FAULT_ENTRY(NmiSR, FAULT_TYPE_NMI)
+FAULT_ENTRY(FaultISR, FAULT_TYPE_HARD)
+FAULT_ENTRY(IntDefaultHandler, FAULT_TYPE_UNEXPECTED)
+
+// Checksum over the record, so garbage left in SRAM at power on is not taken
+// for a crash.
+static uint32_t FaultChecksum(const tFaultRecord *psRecord)
+{
+    const uint32_t *pui32Word = (const uint32_t *)psRecord;
+    uint32_t ui32Words = (sizeof(tFaultRecord) / 4) - 1;
+    uint32_t ui32Sum = 0x5a5a5a5a;
+
+    while(ui32Words--)
+    {
+        ui32Sum = ((ui32Sum << 5) | (ui32Sum >> 27)) ^ *pui32Word++;
+    }
+
+    return(ui32Sum);
+}
+
+// Start a new record, keeping the count from a previous one.
+static void FaultBegin(uint32_t ui32Type)
+{
+    uint32_t ui32Count, ui32Idx;
+
+    ui32Count = FaultValid() ? g_sFaultRecord.ui32Count : 0;
+
+    g_sFaultRecord.ui32Magic = FAULT_MAGIC;
+    g_sFaultRecord.ui32Type = ui32Type;
+    g_sFaultRecord.ui32Count = ui32Count + 1;
+    g_sFaultRecord.ui32Vector = HWREG(NVIC_INT_CTRL) & NVIC_INT_CTRL_VEC_ACT_M;
+    g_sFaultRecord.ui32SP = 0;
+
+    for(ui32Idx = 0; ui32Idx < 8; ui32Idx++)
+    {
+        g_sFaultRecord.pui32Regs[ui32Idx] = 0;
+    }
+
+    g_sFaultRecord.ui32CFSR = HWREG(NVIC_FAULT_STAT);
+    g_sFaultRecord.ui32HFSR = HWREG(NVIC_HFAULT_STAT);
+
+    if(g_sFaultRecord.ui32CFSR & NVIC_FAULT_STAT_BFARV)
+    {
+        g_sFaultRecord.ui32Addr = HWREG(NVIC_FAULT_ADDR);
+    }
+    else if(g_sFaultRecord.ui32CFSR & NVIC_FAULT_STAT_MMARV)
+    {
+        g_sFaultRecord.ui32Addr = HWREG(NVIC_MM_ADDR);
+    }
+    else
+    {
+        g_sFaultRecord.ui32Addr = 0;
+    }
+}
+
+// Called from the entry stubs with the exception frame.  Does not return.
+void FaultCapture(uint32_t *pui32Frame, uint32_t ui32Type)
+{
+    uint32_t ui32Idx;
+
+    IntMasterDisable();
+
+    FaultBegin(ui32Type);
+
+    g_sFaultRecord.ui32SP = (uint32_t)pui32Frame;
+
+    // the frame may not be there at all after a stack overflow
+    if(((uint32_t)pui32Frame >= FAULT_SRAM_START) &&
+       ((uint32_t)pui32Frame <= (FAULT_SRAM_END - 32)))
+    {
+        for(ui32Idx = 0; ui32Idx < 8; ui32Idx++)
+        {
+            g_sFaultRecord.pui32Regs[ui32Idx] = pui32Frame[ui32Idx];
+        }
+    }
+
+    g_sFaultRecord.ui32Check = FaultChecksum(&g_sFaultRecord);
+
+    // leave it for the debugger if there is one
+    if(HWREG(NVIC_DBG_CTRL) & NVIC_DBG_CTRL_C_DEBUGEN)
+    {
+        __asm("    bkpt    #0");
+    }
+
+    FaultRestart();
+}
+
+// Reset the system through the watchdog, for anything that decides the
+// firmware cannot carry on; pass the reason as ui32Type.  Always writes a
+// new record, a valid one here is from an earlier reset and only its count
+// is kept.
+void FaultReset(uint32_t ui32Type)
+{
+    IntMasterDisable();
+
+    FaultBegin(ui32Type);
+    g_sFaultRecord.ui32Check = FaultChecksum(&g_sFaultRecord);
+
+    FaultRestart();
+}
+
+// Reset through the watchdog once the record is written.  Does not return.
+static void FaultRestart(void)
+{
+    uint32_t ui32Wait;
+
+    // The watchdog may already be running, reprogram it either way.
+    MAP_SysCtlPeripheralEnable(SYSCTL_PERIPH_WDOG0);
+
+    if(MAP_WatchdogLockState(WATCHDOG0_BASE))
+    {
+        MAP_WatchdogUnlock(WATCHDOG0_BASE);
+    }
+
+    MAP_WatchdogReloadSet(WATCHDOG0_BASE, FAULT_RESET_CYCLES);
+    MAP_WatchdogResetEnable(WATCHDOG0_BASE);
+    MAP_WatchdogEnable(WATCHDOG0_BASE);
+
+    // two timeouts, then fall back on a software reset in case the watchdog
+    // could not be started
+    for(ui32Wait = 0; ui32Wait < FAULT_RESET_CYCLES; ui32Wait++)
+    {
+    }
+
+    MAP_SysCtlReset();
+}
+
+// Check the record left by the last reset.  Call early in main(); a record
+// that is not backed by a watchdog reset is stale and is dropped.
+void FaultInit(void)
+{
+    uint32_t ui32Cause = MAP_SysCtlResetCauseGet();
+
+    MAP_SysCtlResetCauseClear(ui32Cause);
+
+    if(!(ui32Cause & (SYSCTL_CAUSE_WDOG0 | SYSCTL_CAUSE_SW)))
+    {
+        FaultClear();
+    }
+
+    g_bFaultReported = !FaultValid();
+}
+
+// True if there is a crash record.
+bool FaultValid(void)
+{
+    return((g_sFaultRecord.ui32Magic == FAULT_MAGIC) &&
+           (g_sFaultRecord.ui32Check == FaultChecksum(&g_sFaultRecord)));
+}
+
+// Forget the crash record.
+void FaultClear(void)
+{
+    g_sFaultRecord.ui32Magic = 0;
+    g_sFaultRecord.ui32Count = 0;
+}
+
+// Print the crash record once, the first time this is called after boot.
+// Called when the host is connected, so the report follows re-enumeration.
+void FaultReport(void)
+{
+    if(g_bFaultReported)
+    {
+        return;
+    }
+
+    g_bFaultReported = true;
+    FaultPrint();
+}
+
+// Dump the crash record to the UART console.
+void FaultPrint(void)
+{
+    uint32_t *pui32Regs = g_sFaultRecord.pui32Regs;
+
+    if(!FaultValid())
+    {
+        UARTprintf("\nno fault recorded\n");
+        return;
+    }
+
+    UARTprintf("\nrecovered from %s (vector %u), %u since power on\n",
+               g_ppcFaultType[(g_sFaultRecord.ui32Type <=
+                               FAULT_TYPE_SETUP) ?
+                              g_sFaultRecord.ui32Type : 0],
+               g_sFaultRecord.ui32Vector, g_sFaultRecord.ui32Count);
+    UARTprintf("pc %08x lr %08x psr %08x sp %08x\n",
+               pui32Regs[FAULT_REG_PC], pui32Regs[FAULT_REG_LR],
+               pui32Regs[FAULT_REG_XPSR], g_sFaultRecord.ui32SP);
+    UARTprintf("r0 %08x r1 %08x r2 %08x r3 %08x r12 %08x\n",
+               pui32Regs[0], pui32Regs[1], pui32Regs[2], pui32Regs[3],
+               pui32Regs[FAULT_REG_R12]);
+    UARTprintf("cfsr %08x hfsr %08x addr %08x\n", g_sFaultRecord.ui32CFSR,
+               g_sFaultRecord.ui32HFSR, g_sFaultRecord.ui32Addr);
+}
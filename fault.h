@@ -0,0 +1,71 @@
+//*****************************************************************************
+//
+// fault.h - Fault capture and watchdog reset recovery.
+//
+// Copyright (c) Aditya Challamarad.  All rights reserved.
+//
+//*****************************************************************************
+
+#ifndef _FAULT_H_
+#define _FAULT_H_
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+// What caught the fault.
+#define FAULT_TYPE_NMI          1
+#define FAULT_TYPE_HARD         2
+#define FAULT_TYPE_UNEXPECTED   3   // interrupt with no handler
+#define FAULT_TYPE_SUPERVISOR   4   // reset by the pipeline supervisor
+#define FAULT_TYPE_SETUP        5   // a module could not be set up at boot
+
+// System clock cycles from the watchdog being armed to the reset.  The
+// watchdog resets on its second timeout.
+#define FAULT_RESET_CYCLES      1000
+
+//
+// Crash record, kept in .TI.noinit so it survives the reset.  The stacked
+// registers are only filled in if the stack pointer was sane at the time.
+//
+typedef struct
+{
+    uint32_t ui32Magic;
+    uint32_t ui32Type;          // FAULT_TYPE_*
+    uint32_t ui32Vector;        // active exception number
+    uint32_t ui32Count;         // fault resets since power on
+    uint32_t ui32SP;            // stack pointer at the fault
+    uint32_t pui32Regs[8];      // r0-r3, r12, lr, pc, xpsr as stacked
+    uint32_t ui32CFSR;          // configurable fault status
+    uint32_t ui32HFSR;          // hard fault status
+    uint32_t ui32Addr;          // faulting address if valid, else 0
+    uint32_t ui32Check;         // checksum of everything above
+} tFaultRecord;
+
+// Indexes into pui32Regs.
+#define FAULT_REG_R0            0
+#define FAULT_REG_R12           4
+#define FAULT_REG_LR            5
+#define FAULT_REG_PC            6
+#define FAULT_REG_XPSR          7
+
+extern tFaultRecord g_sFaultRecord;
+
+extern void FaultInit(void);
+extern bool FaultValid(void);
+extern void FaultClear(void);
+extern void FaultReset(uint32_t ui32Type);
+extern void FaultReport(void);
+extern void FaultPrint(void);
+
+// Vector table entries, see startup_ccs.c.
+extern void NmiSR(void);
+extern void FaultISR(void);
+extern void IntDefaultHandler(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
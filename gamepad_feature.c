@@ -0,0 +1,472 @@
+//*****************************************************************************
+//
+// gamepad_feature.c - Vendor feature report protocol for the gamepad.
+//
+// Copyright (c) Aditya Challamarad.  All rights reserved.
+//
+// GamepadHandler forwards feature GET_REPORT/SET_REPORT requests here.  All
+// of these run from the USB0 interrupt.
+//
+//*****************************************************************************
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "driverlib/sysctl.h"
+#include "gamepad_input.h"
+#include "latency.h"
+#include "isrprof.h"
+#include "stackmon.h"
+#include "fault.h"
+#include "hal.h"
+#include "recorder.h"
+#include "replay.h"
+#include "macro.h"
+#include "remap.h"
+#include "gamepad_feature.h"
+
+volatile tGamepadStats g_sGamepadStats;
+
+// Buffer for the feature report in both directions.
+static uint8_t g_pui8Feature[GAMEPAD_FEATURE_SIZE];
+
+// The page returned by the next GET_REPORT.
+static uint8_t g_ui8FeaturePage = GAMEPAD_PAGE_CONFIG;
+
+// Payload bytes 2 and 3 of the last page select, for pages that need an
+// index such as the latency histograms.
+static uint8_t g_pui8FeatureArg[2];
+
+static void PutU16(uint8_t *pui8Data, uint16_t ui16Value)
+{
+    pui8Data[0] = (uint8_t)ui16Value;
+    pui8Data[1] = (uint8_t)(ui16Value >> 8);
+}
+
+static void PutU32(uint8_t *pui8Data, uint32_t ui32Value)
+{
+    pui8Data[0] = (uint8_t)ui32Value;
+    pui8Data[1] = (uint8_t)(ui32Value >> 8);
+    pui8Data[2] = (uint8_t)(ui32Value >> 16);
+    pui8Data[3] = (uint8_t)(ui32Value >> 24);
+}
+
+static uint16_t GetU16(const uint8_t *pui8Data)
+{
+    return((uint16_t)(pui8Data[0] | (pui8Data[1] << 8)));
+}
+
+// Apply a configuration page written by the host.
+static void ConfigWrite(const uint8_t *pui8Data)
+{
+    tGamepadConfig sConfig;
+
+    sConfig.ui16StickDeadzone = GetU16(&pui8Data[2]);
+    sConfig.ui16TriggerDeadzone = GetU16(&pui8Data[4]);
+    sConfig.ui8StickCurve = pui8Data[6];
+    sConfig.ui8TriggerCurve = pui8Data[7];
+    sConfig.ui8FilterShift = pui8Data[8];
+    sConfig.ui8ReportInterval = pui8Data[9];
+
+    if(GamepadConfigValid(&sConfig))
+    {
+        g_sGamepadConfig = sConfig;
+    }
+}
+
+// Fill in the latency page for the selected stage and buckets.
+static void LatencyPageGet(uint8_t *pui8Data)
+{
+    tLatencyHistogram *psHist;
+    uint32_t ui32Stage, ui32Bucket, ui32Idx;
+
+    ui32Stage = g_pui8FeatureArg[0];
+    ui32Bucket = g_pui8FeatureArg[1];
+
+    pui8Data[2] = (uint8_t)ui32Stage;
+    pui8Data[3] = (uint8_t)ui32Bucket;
+
+    if(ui32Stage >= LATENCY_NUM_STAGES)
+    {
+        return;
+    }
+
+    psHist = &g_psLatency[ui32Stage];
+    PutU32(&pui8Data[4], psHist->ui32Count);
+    PutU32(&pui8Data[8], psHist->ui32Min);
+    PutU32(&pui8Data[12], psHist->ui32Max);
+
+    for(ui32Idx = 0; ui32Idx < GAMEPAD_LATENCY_BUCKETS; ui32Idx++)
+    {
+        if(ui32Bucket + ui32Idx < LATENCY_NUM_BUCKETS)
+        {
+            PutU32(&pui8Data[16 + (ui32Idx * 4)],
+                   psHist->pui32Buckets[ui32Bucket + ui32Idx]);
+        }
+    }
+}
+
+// Fill in the interrupt profile page for the selected handler.
+static void ISRProfPageGet(uint8_t *pui8Data)
+{
+    tISRProfile *psProf;
+    uint32_t ui32Slot = g_pui8FeatureArg[0];
+
+    pui8Data[2] = (uint8_t)ui32Slot;
+#ifdef ISR_PROFILE
+    pui8Data[3] = ISR_PROF_NUM;
+#endif
+
+    if(ui32Slot >= ISR_PROF_NUM)
+    {
+        return;
+    }
+
+    psProf = &g_psISRProfile[ui32Slot];
+    PutU32(&pui8Data[4], psProf->ui32Count);
+    PutU32(&pui8Data[8], psProf->ui32Min);
+    PutU32(&pui8Data[12], psProf->ui32Max);
+    PutU32(&pui8Data[16], ISRProfMean(ui32Slot));
+    PutU16(&pui8Data[20], (uint16_t)ISRProfCPULoad());
+    PutU16(&pui8Data[22], (uint16_t)ISRProfISRLoad());
+}
+
+// Fill in the SRAM budget page.
+static void RAMPageGet(uint8_t *pui8Data)
+{
+    tRAMBudget sBudget;
+
+    RAMBudgetGet(&sBudget);
+    PutU16(&pui8Data[2], (uint16_t)sBudget.ui32SRAM);
+    PutU16(&pui8Data[4], (uint16_t)sBudget.ui32Vtable);
+    PutU16(&pui8Data[6], (uint16_t)sBudget.ui32Data);
+    PutU16(&pui8Data[8], (uint16_t)sBudget.ui32Bss);
+    PutU16(&pui8Data[10], (uint16_t)sBudget.ui32Stack);
+    PutU16(&pui8Data[12], (uint16_t)sBudget.ui32StackUsed);
+    PutU16(&pui8Data[14], (uint16_t)sBudget.ui32Free);
+    PutU16(&pui8Data[16], (uint16_t)sBudget.ui32RamFunc);
+    PutU16(&pui8Data[18], (uint16_t)sBudget.ui32NoInit);
+    PutU16(&pui8Data[20], (uint16_t)sBudget.ui32Heap);
+}
+
+// Fill in the crash record page, all zero if there is no record.
+static void FaultPageGet(uint8_t *pui8Data)
+{
+    if(!FaultValid())
+    {
+        return;
+    }
+
+    pui8Data[2] = (uint8_t)g_sFaultRecord.ui32Type;
+    pui8Data[3] = (uint8_t)g_sFaultRecord.ui32Vector;
+    PutU16(&pui8Data[4], (uint16_t)g_sFaultRecord.ui32Count);
+    PutU32(&pui8Data[6], g_sFaultRecord.pui32Regs[FAULT_REG_PC]);
+    PutU32(&pui8Data[10], g_sFaultRecord.pui32Regs[FAULT_REG_LR]);
+    PutU32(&pui8Data[14], g_sFaultRecord.pui32Regs[FAULT_REG_XPSR]);
+    PutU32(&pui8Data[18], g_sFaultRecord.ui32CFSR);
+    PutU32(&pui8Data[22], g_sFaultRecord.ui32HFSR);
+    PutU32(&pui8Data[26], g_sFaultRecord.ui32Addr);
+}
+
+// Fill in the trace page with the selected chunk of the trace region.
+static void TracePageGet(uint8_t *pui8Data)
+{
+    uint32_t ui32Chunk, ui32Offset, ui32Idx;
+    const uint8_t *pui8Flash;
+
+    ui32Chunk = g_pui8FeatureArg[0] | (g_pui8FeatureArg[1] << 8);
+    ui32Offset = ui32Chunk * GAMEPAD_TRACE_CHUNK;
+
+    PutU16(&pui8Data[2], (uint16_t)ui32Chunk);
+    pui8Data[4] = (uint8_t)RecorderState();
+    pui8Data[5] = (uint8_t)ReplayState();
+    PutU32(&pui8Data[6], g_sRecorderStats.ui32Bytes);
+    PutU32(&pui8Data[10], g_sRecorderStats.ui32Records);
+
+    if(ui32Offset >= RECORDER_FLASH_SIZE)
+    {
+        return;
+    }
+
+    pui8Flash = HALFlash(RECORDER_FLASH_BASE + ui32Offset);
+
+    for(ui32Idx = 0; ui32Idx < GAMEPAD_TRACE_CHUNK; ui32Idx++)
+    {
+        pui8Data[16 + ui32Idx] = pui8Flash[ui32Idx];
+    }
+}
+
+// Fill in the macro page.
+static void MacroPageGet(uint8_t *pui8Data)
+{
+    uint32_t ui32Idx;
+
+    for(ui32Idx = 0; ui32Idx < MACRO_NUM_BUTTONS; ui32Idx++)
+    {
+        pui8Data[2 + ui32Idx] = g_pui8MacroTurbo[ui32Idx];
+    }
+
+    pui8Data[7] = MacroEnabled();
+    pui8Data[8] = (uint8_t)MacroRunning();
+    pui8Data[9] = (uint8_t)MacroCount();
+    PutU32(&pui8Data[10], g_sMacroStats.ui32Runs);
+    PutU32(&pui8Data[14], g_sMacroStats.ui32Frames);
+    PutU32(&pui8Data[18], g_sMacroStats.ui32LateFrames);
+}
+
+// Fill in the remap page.
+static void RemapPageGet(uint8_t *pui8Data)
+{
+    const tRemapConfig *psConfig = &g_sRemapConfig;
+    uint32_t ui32Idx;
+
+    pui8Data[2] = psConfig->ui8Shift;
+
+    for(ui32Idx = 0; ui32Idx < REMAP_BUTTONS; ui32Idx++)
+    {
+        pui8Data[3 + ui32Idx] = psConfig->ppui8Buttons[0][ui32Idx];
+        pui8Data[8 + ui32Idx] = psConfig->ppui8Buttons[1][ui32Idx];
+    }
+
+    for(ui32Idx = 0; ui32Idx < REMAP_AXES; ui32Idx++)
+    {
+        pui8Data[13 + ui32Idx] = psConfig->pui8Axis[ui32Idx];
+        pui8Data[17 + ui32Idx] = psConfig->pui8Threshold[ui32Idx];
+        pui8Data[21 + ui32Idx] = psConfig->pui8Drive[ui32Idx];
+        pui8Data[25 + ui32Idx] = psConfig->pui8DriveValue[ui32Idx];
+    }
+}
+
+// Post a remap layout from a write, if it is valid.
+static void RemapWrite(const uint8_t *pui8Data)
+{
+    tRemapConfig sConfig;
+    uint32_t ui32Idx;
+
+    sConfig.ui8Shift = pui8Data[2];
+
+    for(ui32Idx = 0; ui32Idx < REMAP_BUTTONS; ui32Idx++)
+    {
+        sConfig.ppui8Buttons[0][ui32Idx] = pui8Data[3 + ui32Idx];
+        sConfig.ppui8Buttons[1][ui32Idx] = pui8Data[8 + ui32Idx];
+    }
+
+    for(ui32Idx = 0; ui32Idx < REMAP_AXES; ui32Idx++)
+    {
+        sConfig.pui8Axis[ui32Idx] = pui8Data[13 + ui32Idx];
+        sConfig.pui8Threshold[ui32Idx] = pui8Data[17 + ui32Idx];
+        sConfig.pui8Drive[ui32Idx] = pui8Data[21 + ui32Idx];
+        sConfig.pui8DriveValue[ui32Idx] = pui8Data[25 + ui32Idx];
+    }
+
+    if(RemapConfigValid(&sConfig))
+    {
+        RemapSet(&sConfig);
+    }
+}
+
+// Build the selected page and return the report buffer to send.
+uint8_t *GamepadFeatureGet(void)
+{
+    uint8_t *pui8Data = g_pui8Feature;
+    uint32_t ui32Idx;
+
+    for(ui32Idx = 0; ui32Idx < GAMEPAD_FEATURE_SIZE; ui32Idx++)
+    {
+        pui8Data[ui32Idx] = 0;
+    }
+
+    pui8Data[GAMEPAD_FEATURE_PAGE] = g_ui8FeaturePage;
+    pui8Data[GAMEPAD_FEATURE_VER] = GAMEPAD_FEATURE_VERSION;
+
+    switch(g_ui8FeaturePage)
+    {
+        case GAMEPAD_PAGE_CONFIG:
+        {
+            PutU16(&pui8Data[2], g_sGamepadConfig.ui16StickDeadzone);
+            PutU16(&pui8Data[4], g_sGamepadConfig.ui16TriggerDeadzone);
+            pui8Data[6] = g_sGamepadConfig.ui8StickCurve;
+            pui8Data[7] = g_sGamepadConfig.ui8TriggerCurve;
+            pui8Data[8] = g_sGamepadConfig.ui8FilterShift;
+            pui8Data[9] = g_sGamepadConfig.ui8ReportInterval;
+            break;
+        }
+
+        case GAMEPAD_PAGE_STATS:
+        {
+            PutU32(&pui8Data[2], g_sGamepadStats.ui32ReportsSent);
+            PutU32(&pui8Data[6], g_sGamepadStats.ui32ReportsDropped);
+            PutU32(&pui8Data[10], g_sGamepadStats.ui32MaxLoopCycles);
+            PutU32(&pui8Data[14], g_sGamepadStats.ui32MaxISRCycles);
+            PutU32(&pui8Data[18], SysCtlClockGet());
+            break;
+        }
+
+        case GAMEPAD_PAGE_LATENCY:
+        {
+            LatencyPageGet(pui8Data);
+            break;
+        }
+
+        case GAMEPAD_PAGE_ISRPROF:
+        {
+            ISRProfPageGet(pui8Data);
+            break;
+        }
+
+        case GAMEPAD_PAGE_RAM:
+        {
+            RAMPageGet(pui8Data);
+            break;
+        }
+
+        case GAMEPAD_PAGE_FAULT:
+        {
+            FaultPageGet(pui8Data);
+            break;
+        }
+
+        case GAMEPAD_PAGE_TRACE:
+        {
+            TracePageGet(pui8Data);
+            break;
+        }
+
+        case GAMEPAD_PAGE_MACRO:
+        {
+            MacroPageGet(pui8Data);
+            break;
+        }
+
+        case GAMEPAD_PAGE_REMAP:
+        {
+            RemapPageGet(pui8Data);
+            break;
+        }
+
+        default:
+        {
+            break;
+        }
+    }
+
+    return(pui8Data);
+}
+
+// The host is about to send a feature report of ui32Length bytes.
+uint8_t *GamepadFeatureBuffer(uint32_t ui32Length)
+{
+    if(ui32Length > GAMEPAD_FEATURE_SIZE)
+    {
+        return(0);
+    }
+
+    return(g_pui8Feature);
+}
+
+// A feature report has arrived from the host.
+void GamepadFeatureSet(const uint8_t *pui8Data, uint32_t ui32Length)
+{
+    bool bWrite;
+
+    if((ui32Length < GAMEPAD_FEATURE_DATA) ||
+       (ui32Length > GAMEPAD_FEATURE_SIZE))
+    {
+        return;
+    }
+
+    g_ui8FeaturePage = pui8Data[GAMEPAD_FEATURE_PAGE];
+    bWrite = (pui8Data[GAMEPAD_FEATURE_VER] & GAMEPAD_FEATURE_WRITE) != 0;
+
+    g_pui8FeatureArg[0] = (ui32Length > 2) ? pui8Data[2] : 0;
+    g_pui8FeatureArg[1] = (ui32Length > 3) ? pui8Data[3] : 0;
+
+    if(!bWrite)
+    {
+        return;
+    }
+
+    switch(g_ui8FeaturePage)
+    {
+        case GAMEPAD_PAGE_CONFIG:
+        {
+            if(ui32Length >= 10)
+            {
+                ConfigWrite(pui8Data);
+            }
+            break;
+        }
+
+        case GAMEPAD_PAGE_STATS:
+        {
+            g_sGamepadStats.ui32ReportsSent = 0;
+            g_sGamepadStats.ui32ReportsDropped = 0;
+            g_sGamepadStats.ui32MaxLoopCycles = 0;
+            g_sGamepadStats.ui32MaxISRCycles = 0;
+            break;
+        }
+
+        case GAMEPAD_PAGE_LATENCY:
+        {
+            LatencyReset();
+            break;
+        }
+
+        case GAMEPAD_PAGE_ISRPROF:
+        {
+            ISRProfReset();
+            break;
+        }
+
+        case GAMEPAD_PAGE_FAULT:
+        {
+            FaultClear();
+            break;
+        }
+
+        case GAMEPAD_PAGE_TRACE:
+        {
+            if(g_pui8FeatureArg[0] == GAMEPAD_TRACE_RECORD)
+            {
+                RecorderStart((uint32_t)g_pui8FeatureArg[1] * 1024);
+            }
+            else if(g_pui8FeatureArg[0] == GAMEPAD_TRACE_PLAY)
+            {
+                ReplayStart(false);
+            }
+            else if(g_pui8FeatureArg[0] == GAMEPAD_TRACE_LOOP)
+            {
+                ReplayStart(true);
+            }
+            else
+            {
+                RecorderStop();
+                ReplayStop();
+            }
+            break;
+        }
+
+        case GAMEPAD_PAGE_MACRO:
+        {
+            if(ui32Length >= 8)
+            {
+                MacroTurboSet(&pui8Data[2]);
+                MacroEnable(pui8Data[7] != 0);
+            }
+            break;
+        }
+
+        case GAMEPAD_PAGE_REMAP:
+        {
+            if(ui32Length >= GAMEPAD_REMAP_SIZE)
+            {
+                RemapWrite(pui8Data);
+            }
+            break;
+        }
+
+        default:
+        {
+            break;
+        }
+    }
+}
@@ -0,0 +1,180 @@
+//*****************************************************************************
+//
+// gamepad_feature.h - Vendor feature report protocol for the gamepad.
+//
+// Copyright (c) Aditya Challamarad.  All rights reserved.
+//
+//*****************************************************************************
+
+#ifndef _GAMEPAD_FEATURE_H_
+#define _GAMEPAD_FEATURE_H_
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+//
+// The gamepad exposes a single vendor defined feature report of
+// GAMEPAD_FEATURE_SIZE bytes.  The host writes a report (SET_REPORT) to
+// select a page and optionally update it, then reads the report back
+// (GET_REPORT) to get the contents of the selected page.
+//
+//  byte 0      page ID, GAMEPAD_PAGE_*
+//  byte 1      protocol version, GAMEPAD_FEATURE_VERSION
+//  byte 2..    page payload, multi-byte fields are little endian
+//
+#define GAMEPAD_FEATURE_SIZE    32
+#define GAMEPAD_FEATURE_VERSION 1
+
+#define GAMEPAD_FEATURE_PAGE    0
+#define GAMEPAD_FEATURE_VER     1
+#define GAMEPAD_FEATURE_DATA    2
+
+//
+// GAMEPAD_PAGE_CONFIG - the live tuning parameters (tGamepadConfig).  A write
+// with byte 1 set to GAMEPAD_FEATURE_WRITE applies the payload, anything else
+// only selects the page.  Invalid parameters are ignored, so the host should
+// read the page back to confirm.
+//
+//  2-3 stick dead zone     4-5 trigger dead zone   6 stick curve
+//  7 trigger curve         8 filter shift          9 report interval
+//
+#define GAMEPAD_PAGE_CONFIG     0x01
+
+//
+// GAMEPAD_PAGE_STATS - runtime counters (tGamepadStats), read only.  A write
+// with byte 1 set to GAMEPAD_FEATURE_WRITE clears them.
+//
+//  2-5 reports sent        6-9 reports dropped     10-13 max loop cycles
+//  14-17 max ISR cycles    18-21 system clock in Hz
+//
+#define GAMEPAD_PAGE_STATS      0x02
+
+//
+// GAMEPAD_PAGE_LATENCY - one latency histogram (tLatencyHistogram), read
+// only.  The host selects the stage with byte 2 and the first bucket with
+// byte 3 when it selects the page, then reads 4 buckets at a time.  A write
+// with byte 1 set to GAMEPAD_FEATURE_WRITE clears all histograms.
+//
+//  2 stage                 3 first bucket          4-7 count
+//  8-11 min cycles         12-15 max cycles        16-31 buckets
+//
+#define GAMEPAD_PAGE_LATENCY    0x03
+#define GAMEPAD_LATENCY_BUCKETS 4
+
+//
+// GAMEPAD_PAGE_ISRPROF - interrupt handler profile (tISRProfile) and CPU
+// load, read only.  The host selects the handler with byte 2.  Byte 3 reads
+// back the number of profiled handlers, 0 if the firmware was built without
+// ISR_PROFILE.  A write with byte 1 set to GAMEPAD_FEATURE_WRITE clears the
+// profile.
+//
+//  2 handler               3 handler count         4-7 count
+//  8-11 min cycles         12-15 max cycles        16-19 mean cycles
+//  20-21 CPU busy, 0.1%    22-23 ISR load, 0.1%
+//
+#define GAMEPAD_PAGE_ISRPROF    0x04
+
+//
+// GAMEPAD_PAGE_RAM - SRAM budget and stack high water mark (tRAMBudget) in
+// bytes, read only.
+//
+//  2-3 total SRAM          4-5 vtable              6-7 data
+//  8-9 bss                 10-11 stack             12-13 stack high water
+//  14-15 free              16-17 ramfunc           18-19 noinit
+//  20-21 heap
+//
+#define GAMEPAD_PAGE_RAM        0x05
+
+//
+// GAMEPAD_PAGE_FAULT - crash record left by the last fault reset
+// (tFaultRecord), read only.  Byte 2 is 0 and the rest is zero if there is
+// no record.  A write with byte 1 set to GAMEPAD_FEATURE_WRITE clears it.
+//
+//  2 FAULT_TYPE_*          3 vector                4-5 resets since power on
+//  6-9 pc                  10-13 lr                14-17 xpsr
+//  18-21 CFSR              22-25 HFSR              26-29 fault address
+//
+#define GAMEPAD_PAGE_FAULT      0x06
+
+//
+// GAMEPAD_PAGE_TRACE - the input recorder (recorder.h) and the trace region
+// in flash, read only.  The host selects a 16 byte chunk of the region with
+// bytes 2-3 when it selects the page.  The region starts with the trace
+// header (trace.h).  Bytes and records are those of the recording in
+// progress, or the last one since power on.  A write with byte 1 set to
+// GAMEPAD_FEATURE_WRITE sets what the recorder and the replay engine
+// (replay.h) do from byte 2, GAMEPAD_TRACE_*.  A recording takes the length
+// of the region to erase for it in KB from byte 3, 0 for the default.
+//
+//  2-3 chunk               4 RECORDER_* state      5 REPLAY_* state
+//  6-9 bytes of records    10-13 records           16-31 the chunk
+//
+#define GAMEPAD_PAGE_TRACE      0x07
+#define GAMEPAD_TRACE_CHUNK     16
+
+#define GAMEPAD_TRACE_STOP      0   // stop recording or playing
+#define GAMEPAD_TRACE_RECORD    1   // start a new recording
+#define GAMEPAD_TRACE_PLAY      2   // play the trace once
+#define GAMEPAD_TRACE_LOOP      3   // play the trace until stopped
+
+//
+// GAMEPAD_PAGE_MACRO - the macro and turbo engine (macro.h).  Turbo rates
+// are half periods in USB frames, 0 for off, for the report buttons in bit
+// order.  A write with byte 1 set to GAMEPAD_FEATURE_WRITE sets the turbo
+// rates from bytes 2-6 and turns the chords on or off from byte 7.  The
+// sequence running counts from 1, 0 for none.
+//
+//  2-6 turbo frames        7 chords on             8 sequence running
+//  9 sequences             10-13 sequences run     14-17 frames followed
+//  18-21 frames seen late
+//
+#define GAMEPAD_PAGE_MACRO      0x08
+
+//
+// GAMEPAD_PAGE_REMAP - the button and axis remap layout (tRemapConfig,
+// remap.h).  Button bits are report buttons.  A write with byte 1 set to
+// GAMEPAD_FEATURE_WRITE and all 29 bytes replaces the layout, a layout with
+// a field out of range is ignored.  The main loop compiles it before the
+// next report.
+//
+//  2 shift button          3-7 layer 0 buttons     8-12 layer 1 buttons
+//  13-16 axis sources      17-20 thresholds        21-24 drive buttons
+//  25-28 drive values
+//
+#define GAMEPAD_PAGE_REMAP      0x09
+#define GAMEPAD_REMAP_SIZE      29
+
+#define GAMEPAD_FEATURE_WRITE   0x80
+
+//
+// Runtime counters.  Cycle counts are DWT cycles at the system clock.
+//
+typedef struct
+{
+    // Reports handed to the HID driver successfully.
+    uint32_t ui32ReportsSent;
+
+    // Reports the HID driver refused to send.
+    uint32_t ui32ReportsDropped;
+
+    // Longest single pass of the main loop.
+    uint32_t ui32MaxLoopCycles;
+
+    // Longest time spent in GamepadHandler, which runs from the USB0
+    // interrupt.
+    uint32_t ui32MaxISRCycles;
+} tGamepadStats;
+
+extern volatile tGamepadStats g_sGamepadStats;
+
+extern uint8_t *GamepadFeatureGet(void);
+extern uint8_t *GamepadFeatureBuffer(uint32_t ui32Length);
+extern void GamepadFeatureSet(const uint8_t *pui8Data, uint32_t ui32Length);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,219 @@
+//*****************************************************************************
+//
+// gamepad_input.c - Analog input conditioning for the gamepad.
+//
+// Copyright (c) Aditya Challamarad.  All rights reserved.
+//
+// The raw 12 bit ADC samples for the joystick and potentiometer go through
+// three optional steps before they land in the report: a first order low
+// pass filter, a dead zone around center and a response curve.  All of it is
+// integer math so it is cheap enough to run on every sample.
+//
+//*****************************************************************************
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "gamepad_input.h"
+#include "hotpath.h"
+#include "drivers/buttons.h"
+
+// Report bits that carry a button.
+#define GAMEPAD_BUTTONS         (BUTTON1_MASK | BUTTON2_MASK | BUTTON3_MASK | \
+                                 BUTTON4_MASK | JOYSTICK_MASK)
+
+// The active tuning parameters, written by the configuration feature report.
+tGamepadConfig g_sGamepadConfig =
+{
+    0,                          // ui16StickDeadzone
+    0,                          // ui16TriggerDeadzone
+    GAMEPAD_CURVE_LINEAR,       // ui8StickCurve
+    GAMEPAD_CURVE_LINEAR,       // ui8TriggerCurve
+    0,                          // ui8FilterShift
+    0                           // ui8ReportInterval
+};
+
+int16_t g_pi16GamepadTrim[GAMEPAD_NUM_AXES];
+
+// Fill in the default (untuned) parameters.
+void GamepadConfigDefaults(tGamepadConfig *psConfig)
+{
+    psConfig->ui16StickDeadzone = 0;
+    psConfig->ui16TriggerDeadzone = 0;
+    psConfig->ui8StickCurve = GAMEPAD_CURVE_LINEAR;
+    psConfig->ui8TriggerCurve = GAMEPAD_CURVE_LINEAR;
+    psConfig->ui8FilterShift = 0;
+    psConfig->ui8ReportInterval = 0;
+}
+
+// Range check a set of parameters before they are applied.  A dead zone that
+// covers the whole travel would divide by zero in the rescale below.
+bool GamepadConfigValid(const tGamepadConfig *psConfig)
+{
+    if(psConfig->ui16StickDeadzone >= (GAMEPAD_ADC_CENTER - 1))
+    {
+        return(false);
+    }
+
+    if(psConfig->ui16TriggerDeadzone >= (GAMEPAD_ADC_CENTER - 1))
+    {
+        return(false);
+    }
+
+    if((psConfig->ui8StickCurve > GAMEPAD_CURVE_CUBIC) ||
+       (psConfig->ui8TriggerCurve > GAMEPAD_CURVE_CUBIC))
+    {
+        return(false);
+    }
+
+    if(psConfig->ui8FilterShift > GAMEPAD_FILTER_SHIFT_MAX)
+    {
+        return(false);
+    }
+
+    return(true);
+}
+
+// Take ui32Rest, the averaged sample with the stick let go, as the center of
+// an axis.  Returns false, leaving the axis untrimmed, if it is too far off
+// center to be a rest position.
+bool GamepadCalibrate(uint32_t ui32Axis, uint32_t ui32Rest)
+{
+    int32_t i32Offset = (int32_t)ui32Rest - 0x7ff; // 0x7ff maps to 0, see Convert8Bit
+
+    if((i32Offset > GAMEPAD_TRIM_MAX) || (i32Offset < -GAMEPAD_TRIM_MAX))
+    {
+        g_pi16GamepadTrim[ui32Axis] = 0;
+        return(false);
+    }
+
+    g_pi16GamepadTrim[ui32Axis] = (int16_t)i32Offset;
+    return(true);
+}
+
+// Shift a stick sample by the axis rest offset, clamped to the ADC range.
+HOT_FUNC uint32_t GamepadTrim(uint32_t ui32Axis, uint32_t ui32Sample)
+{
+    int32_t i32Sample = (int32_t)ui32Sample - g_pi16GamepadTrim[ui32Axis];
+
+    if(i32Sample < 0)
+    {
+        return(0);
+    }
+
+    if(i32Sample > GAMEPAD_ADC_MAX)
+    {
+        return(GAMEPAD_ADC_MAX);
+    }
+
+    return((uint32_t)i32Sample);
+}
+
+// Low pass filter one ADC channel.  The state is kept with 4 extra fraction
+// bits so small shifts do not stall short of the input.  With a shift of 0
+// the sample passes straight through and the state just tracks it.
+HOT_FUNC uint32_t GamepadFilter(uint32_t *pui32State, uint32_t ui32Sample)
+{
+    uint32_t ui32Shift = g_sGamepadConfig.ui8FilterShift;
+    int32_t i32Error;
+
+    if(ui32Shift == 0)
+    {
+        *pui32State = ui32Sample << 4;
+        return(ui32Sample);
+    }
+
+    i32Error = (int32_t)(ui32Sample << 4) - (int32_t)*pui32State;
+    *pui32State = (uint32_t)((int32_t)*pui32State + (i32Error >> ui32Shift));
+
+    return(*pui32State >> 4);
+}
+
+// Apply a response curve to a magnitude in the range 0 to ui32Max.
+HOT_FUNC static uint32_t CurveApply(uint32_t ui32Mag, uint32_t ui32Max, uint8_t ui8Curve)
+{
+    switch(ui8Curve)
+    {
+        case GAMEPAD_CURVE_QUADRATIC:
+        {
+            return((ui32Mag * ui32Mag) / ui32Max);
+        }
+
+        case GAMEPAD_CURVE_CUBIC:
+        {
+            return((((ui32Mag * ui32Mag) / ui32Max) * ui32Mag) / ui32Max);
+        }
+
+        default:
+        {
+            return(ui32Mag);
+        }
+    }
+}
+
+// Map a stick ADC sample to a signed 8 bit axis, 127 to -128.
+HOT_FUNC int8_t GamepadStickMap(uint32_t ui32Sample)
+{
+    uint32_t ui32Deadzone = g_sGamepadConfig.ui16StickDeadzone;
+    uint8_t ui8Curve = g_sGamepadConfig.ui8StickCurve;
+    int32_t i32Pos;
+    uint32_t ui32Mag;
+
+    // untuned sticks take the original direct path
+    if((ui32Deadzone == 0) && (ui8Curve == GAMEPAD_CURVE_LINEAR))
+    {
+        return(Convert8Bit(ui32Sample));
+    }
+
+    i32Pos = 0x7ff - (int32_t)ui32Sample; // -2048 to 2047, same sense as Convert8Bit
+    ui32Mag = (i32Pos < 0) ? (uint32_t)-i32Pos : (uint32_t)i32Pos;
+
+    if(ui32Mag <= ui32Deadzone)
+    {
+        return(0);
+    }
+
+    // rescale so the edge of the dead zone is zero and full travel is unchanged
+    ui32Mag = ((ui32Mag - ui32Deadzone) * GAMEPAD_ADC_CENTER) /
+              (GAMEPAD_ADC_CENTER - ui32Deadzone);
+    ui32Mag = CurveApply(ui32Mag, GAMEPAD_ADC_CENTER, ui8Curve) >> 4;
+
+    if(i32Pos < 0)
+    {
+        return((int8_t)-(int32_t)((ui32Mag > 128) ? 128 : ui32Mag));
+    }
+
+    return((int8_t)((ui32Mag > 127) ? 127 : ui32Mag));
+}
+
+// Split the potentiometer into the two triggers.  Below center drives LT,
+// above center drives RT, each 0 to 255.
+HOT_FUNC void GamepadTriggerMap(uint32_t ui32Sample, uint8_t *pui8LT, uint8_t *pui8RT)
+{
+    uint32_t ui32Deadzone = g_sGamepadConfig.ui16TriggerDeadzone;
+    uint8_t ui8Curve = g_sGamepadConfig.ui8TriggerCurve;
+    uint32_t ui32Mag;
+
+    *pui8LT = 0;
+    *pui8RT = 0;
+
+    if(ui32Sample + ui32Deadzone < GAMEPAD_ADC_CENTER) // left is triggered
+    {
+        ui32Mag = ((GAMEPAD_ADC_CENTER - ui32Deadzone - ui32Sample) * 255) /
+                  (GAMEPAD_ADC_CENTER - ui32Deadzone);
+        *pui8LT = (uint8_t)CurveApply(ui32Mag, 255, ui8Curve);
+    }
+    else if(ui32Sample > GAMEPAD_ADC_CENTER + ui32Deadzone) // right is triggered
+    {
+        ui32Mag = ((ui32Sample - GAMEPAD_ADC_CENTER - ui32Deadzone) * 255) /
+                  (GAMEPAD_ADC_MAX - GAMEPAD_ADC_CENTER - ui32Deadzone);
+        *pui8RT = (uint8_t)CurveApply(ui32Mag, 255, ui8Curve);
+    }
+}
+
+// Turn the debounced button states into the report's button byte.  The
+// joystick switch reads low when pressed, the others high.  Plain bit
+// operations, so the cost does not depend on which buttons are held.
+HOT_FUNC uint8_t GamepadButtonsPack(uint8_t ui8Buttons)
+{
+    return((ui8Buttons ^ JOYSTICK_MASK) & GAMEPAD_BUTTONS);
+}
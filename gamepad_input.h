@@ -0,0 +1,89 @@
+//*****************************************************************************
+//
+// gamepad_input.h - Analog input conditioning for the gamepad.
+//
+// Copyright (c) Aditya Challamarad.  All rights reserved.
+//
+//*****************************************************************************
+
+#ifndef _GAMEPAD_INPUT_H_
+#define _GAMEPAD_INPUT_H_
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+// This maps the values from the ADC that range from 0 to 2047 over to 127 to -128.
+#define Convert8Bit(ui32Value)  ((int8_t)((0x7ff - ui32Value) >> 4))
+
+// ADC full scale and the center used by the sticks and the trigger split.
+#define GAMEPAD_ADC_MAX         4095
+#define GAMEPAD_ADC_CENTER      2048
+
+// Response curves applied after the dead zone.
+#define GAMEPAD_CURVE_LINEAR    0
+#define GAMEPAD_CURVE_QUADRATIC 1
+#define GAMEPAD_CURVE_CUBIC     2
+
+// Largest filter shift accepted, higher values make the stick unusably slow.
+#define GAMEPAD_FILTER_SHIFT_MAX 6
+
+// Stick axes with a calibrated rest position.
+#define GAMEPAD_AXIS_X          0
+#define GAMEPAD_AXIS_Y          1
+#define GAMEPAD_NUM_AXES        2
+
+// Samples averaged to find the rest position at boot.
+#define GAMEPAD_CAL_SAMPLES     16
+
+// Largest rest offset, in ADC counts, calibration accepts.  Anything further
+// off center means the stick was being held, so it is left uncalibrated.
+#define GAMEPAD_TRIM_MAX        256
+
+//
+// Live tuning parameters.  These can be changed at runtime through the
+// configuration feature report, so the defaults reproduce the original
+// untuned behaviour.
+//
+typedef struct
+{
+    // ADC counts either side of center that read as zero on X/Y.
+    uint16_t ui16StickDeadzone;
+
+    // ADC counts either side of the potentiometer center that read as no
+    // trigger on LT/RT.
+    uint16_t ui16TriggerDeadzone;
+
+    // GAMEPAD_CURVE_* applied to the sticks and triggers.
+    uint8_t ui8StickCurve;
+    uint8_t ui8TriggerCurve;
+
+    // IIR low pass strength, y += (x - y) >> shift.  0 disables filtering.
+    uint8_t ui8FilterShift;
+
+    // Minimum USB frames (1ms) between reports.  0 sends as fast as the host
+    // takes them.
+    uint8_t ui8ReportInterval;
+} tGamepadConfig;
+
+extern tGamepadConfig g_sGamepadConfig;
+
+// Rest offset of each stick axis from the ADC center, set by calibration.
+extern int16_t g_pi16GamepadTrim[GAMEPAD_NUM_AXES];
+
+extern void GamepadConfigDefaults(tGamepadConfig *psConfig);
+extern bool GamepadConfigValid(const tGamepadConfig *psConfig);
+extern bool GamepadCalibrate(uint32_t ui32Axis, uint32_t ui32Rest);
+extern uint32_t GamepadTrim(uint32_t ui32Axis, uint32_t ui32Sample);
+extern uint32_t GamepadFilter(uint32_t *pui32State, uint32_t ui32Sample);
+extern int8_t GamepadStickMap(uint32_t ui32Sample);
+extern void GamepadTriggerMap(uint32_t ui32Sample, uint8_t *pui8LT,
+                              uint8_t *pui8RT);
+extern uint8_t GamepadButtonsPack(uint8_t ui8Buttons);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
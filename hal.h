@@ -0,0 +1,54 @@
+//*****************************************************************************
+//
+// hal.h - Thin GPIO/ADC/USB hardware abstraction for the input path.
+//
+// Copyright (c) Aditya Challamarad.  All rights reserved.
+//
+//*****************************************************************************
+
+#ifndef _HAL_H_
+#define _HAL_H_
+
+//
+// The input path reads buttons, the ADC sequencer and the USB frame counter
+// through these calls instead of driverlib, so the same code can also be
+// built for a Linux host.  Everything is a static inline function resolved
+// at compile time; there is no table of function pointers and no state.
+//
+// On the TM4C123 (hal_tm4c.h) each call is the register access the
+// driverlib function would have done, inlined, so the hot path loses the
+// call overhead and gains nothing.  Build with HAL_HOST defined to get
+// hal_host.h instead, where the same calls read and write a simulated
+// peripheral state that a test harness drives.
+//
+// The calls:
+//
+//  HALPinRead(port, pins)            pin levels, like GPIOPinRead()
+//  HALPinWrite(port, pins, value)    like GPIOPinWrite()
+//  HALADCDone(base, seq)             raw sequence interrupt status
+//  HALADCClear(base, seq)            clear it
+//  HALADCTrigger(base, seq)          start a conversion
+//  HALADCRead(base, seq, data)       drain the FIFO, returns the count
+//  HALUSBFrame(base)                 current 11 bit USB frame number
+//  HALFlash(addr)                    read pointer to flash at addr
+//  HALLoop()                         top of every main loop pass
+//
+// port and base are the usual *_BASE addresses, pins the GPIO_PIN_ mask.
+//
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#ifdef HAL_HOST
+#include "hal_host.h"
+#else
+#include "hal_tm4c.h"
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
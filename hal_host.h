@@ -0,0 +1,172 @@
+//*****************************************************************************
+//
+// hal_host.h - Simulated peripheral backend for hal.h on a Linux host.
+//
+// Copyright (c) Aditya Challamarad.  All rights reserved.
+//
+//*****************************************************************************
+
+#ifndef _HAL_HOST_H_
+#define _HAL_HOST_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// GPIO ports A to F, the steps of ADC sequencer 0, and the flash.
+#define HAL_HOST_PORTS          6
+#define HAL_HOST_ADC_STEPS      8
+#define HAL_HOST_FLASH_SIZE     0x00040000
+
+//
+// The simulated peripherals.  A test harness sets the pin levels and ADC
+// samples, the firmware sees them through the HAL calls.  One host source
+// file must define the instance with HAL_HOST_STATE.
+//
+typedef struct
+{
+    // Pin levels of each port, bit n is pin n.
+    uint8_t pui8GPIO[HAL_HOST_PORTS];
+
+    // Samples the next HALADCRead() returns, and how many.
+    uint32_t pui32ADC[HAL_HOST_ADC_STEPS];
+    uint32_t ui32ADCSteps;
+
+    // Conversion finished, and conversions started so far.
+    bool bADCDone;
+    uint32_t ui32ADCTriggers;
+
+    // Called on every HALADCTrigger() so the harness can load the next
+    // samples.  With none the conversion completes at once.
+    void (*pfnADCTrigger)(void);
+
+    // USB frame counter, the harness advances it.
+    uint32_t ui32USBFrame;
+
+    // Flash contents, erased and programmed through the driverlib calls.
+    uint8_t pui8Flash[HAL_HOST_FLASH_SIZE];
+
+    // Called on every HALLoop(), and whenever the firmware polls the ADC
+    // and finds it still busy, so a simulator can move time on.
+    void (*pfnLoop)(void);
+    void (*pfnPoll)(void);
+} tHALHost;
+
+extern tHALHost g_sHALHost;
+
+#define HAL_HOST_STATE          tHALHost g_sHALHost
+
+//
+// Port index from a GPIO base address, APB or AHB.  Ports A-D and E-F are
+// two separate runs in the APB map.
+//
+static inline uint32_t
+HALHostPort(uint32_t ui32Port)
+{
+    if(ui32Port >= 0x40058000)
+    {
+        return((ui32Port - 0x40058000) >> 12);
+    }
+
+    if(ui32Port >= 0x40024000)
+    {
+        return(4 + ((ui32Port - 0x40024000) >> 12));
+    }
+
+    return((ui32Port - 0x40004000) >> 12);
+}
+
+static inline uint32_t
+HALPinRead(uint32_t ui32Port, uint32_t ui32Pins)
+{
+    return(g_sHALHost.pui8GPIO[HALHostPort(ui32Port)] & ui32Pins);
+}
+
+static inline void
+HALPinWrite(uint32_t ui32Port, uint32_t ui32Pins, uint32_t ui32Value)
+{
+    uint8_t *pui8Data = &g_sHALHost.pui8GPIO[HALHostPort(ui32Port)];
+
+    *pui8Data = (uint8_t)((*pui8Data & ~ui32Pins) | (ui32Value & ui32Pins));
+}
+
+static inline bool
+HALADCDone(uint32_t ui32Base, uint32_t ui32Seq)
+{
+    (void)ui32Base;
+    (void)ui32Seq;
+
+    if(!g_sHALHost.bADCDone && g_sHALHost.pfnPoll)
+    {
+        g_sHALHost.pfnPoll();
+    }
+
+    return(g_sHALHost.bADCDone);
+}
+
+static inline void
+HALADCClear(uint32_t ui32Base, uint32_t ui32Seq)
+{
+    (void)ui32Base;
+    (void)ui32Seq;
+
+    g_sHALHost.bADCDone = false;
+}
+
+static inline void
+HALADCTrigger(uint32_t ui32Base, uint32_t ui32Seq)
+{
+    (void)ui32Base;
+    (void)ui32Seq;
+
+    g_sHALHost.ui32ADCTriggers++;
+
+    if(g_sHALHost.pfnADCTrigger)
+    {
+        g_sHALHost.pfnADCTrigger();
+    }
+    else
+    {
+        g_sHALHost.bADCDone = true;
+    }
+}
+
+static inline uint32_t
+HALADCRead(uint32_t ui32Base, uint32_t ui32Seq, uint32_t *pui32Data)
+{
+    uint32_t ui32Count;
+
+    (void)ui32Base;
+    (void)ui32Seq;
+
+    for(ui32Count = 0; ui32Count < g_sHALHost.ui32ADCSteps; ui32Count++)
+    {
+        pui32Data[ui32Count] = g_sHALHost.pui32ADC[ui32Count];
+    }
+
+    return(ui32Count);
+}
+
+static inline uint32_t
+HALUSBFrame(uint32_t ui32Base)
+{
+    (void)ui32Base;
+
+    return(g_sHALHost.ui32USBFrame & 0x7ff);
+}
+
+static inline const uint8_t *
+HALFlash(uint32_t ui32Addr)
+{
+    return(&g_sHALHost.pui8Flash[ui32Addr]);
+}
+
+static inline void
+HALLoop(void)
+{
+    if(g_sHALHost.pfnLoop)
+    {
+        g_sHALHost.pfnLoop();
+    }
+}
+
+#endif
@@ -0,0 +1,90 @@
+//*****************************************************************************
+//
+// hal_tm4c.h - TM4C123 register backend for hal.h.
+//
+// Copyright (c) Aditya Challamarad.  All rights reserved.
+//
+//*****************************************************************************
+
+#ifndef _HAL_TM4C_H_
+#define _HAL_TM4C_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "inc/hw_adc.h"
+#include "inc/hw_gpio.h"
+#include "inc/hw_types.h"
+#include "inc/hw_usb.h"
+
+// Distance between the registers of one ADC sample sequencer and the next.
+#define HAL_ADC_SEQ_STEP        (ADC_O_SSMUX1 - ADC_O_SSMUX0)
+
+// The GPIO data register is masked by address bits 9:2, so reading or
+// writing only the wanted pins is a single access.
+static inline uint32_t
+HALPinRead(uint32_t ui32Port, uint32_t ui32Pins)
+{
+    return(HWREG(ui32Port + (GPIO_O_DATA + (ui32Pins << 2))));
+}
+
+static inline void
+HALPinWrite(uint32_t ui32Port, uint32_t ui32Pins, uint32_t ui32Value)
+{
+    HWREG(ui32Port + (GPIO_O_DATA + (ui32Pins << 2))) = ui32Value;
+}
+
+static inline bool
+HALADCDone(uint32_t ui32Base, uint32_t ui32Seq)
+{
+    return((HWREG(ui32Base + ADC_O_RIS) & (1 << ui32Seq)) != 0);
+}
+
+static inline void
+HALADCClear(uint32_t ui32Base, uint32_t ui32Seq)
+{
+    HWREG(ui32Base + ADC_O_ISC) = 1 << ui32Seq;
+}
+
+static inline void
+HALADCTrigger(uint32_t ui32Base, uint32_t ui32Seq)
+{
+    HWREG(ui32Base + ADC_O_PSSI) = 1 << ui32Seq;
+}
+
+// Read up to the 8 entry depth of the FIFO.
+static inline uint32_t
+HALADCRead(uint32_t ui32Base, uint32_t ui32Seq, uint32_t *pui32Data)
+{
+    uint32_t ui32Count = 0;
+
+    ui32Base += HAL_ADC_SEQ_STEP * ui32Seq;
+
+    while(!(HWREG(ui32Base + ADC_O_SSFSTAT0) & ADC_SSFSTAT0_EMPTY) &&
+          (ui32Count < 8))
+    {
+        pui32Data[ui32Count++] = HWREG(ui32Base + ADC_O_SSFIFO0);
+    }
+
+    return(ui32Count);
+}
+
+static inline uint32_t
+HALUSBFrame(uint32_t ui32Base)
+{
+    return(HWREGH(ui32Base + USB_O_FRAME));
+}
+
+// Flash is mapped from address 0.
+static inline const uint8_t *
+HALFlash(uint32_t ui32Addr)
+{
+    return((const uint8_t *)ui32Addr);
+}
+
+// Only the host has anything to do per pass.
+static inline void
+HALLoop(void)
+{
+}
+
+#endif
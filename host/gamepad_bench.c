@@ -0,0 +1,230 @@
+//*****************************************************************************
+//
+// gamepad_bench.c - Runs the hot path micro-benchmarks on the host.
+//
+// Copyright (c) Aditya Challamarad.  All rights reserved.
+//
+// usage: gamepad_bench [-r repeats] [-t ms] [-k name] [-j file]
+//
+//   -r count   timed repeats per kernel, the fastest is reported (11)
+//   -t ms      length of each repeat (20)
+//   -k name    only run kernels whose name contains name
+//   -j file    also write the results as JSON, for tools/benchcheck.py
+//
+// The kernels are the ones in bench.c, built for the host with the rest of
+// the firmware, so they are the same code the 'k' console command times on
+// the target with the cycle counter.  Each kernel is calibrated to run for
+// about the repeat length, then timed with CLOCK_MONOTONIC.  The fastest of
+// the repeats is reported, in nanoseconds per input and inputs per second,
+// as on the target: the slower ones were hit by something else running.  The
+// median is printed alongside to show how noisy the machine is.
+//
+// Host numbers say how the code changed, not how fast the target is.  They
+// are only comparable on the same machine and compiler, which the JSON
+// records so benchcheck.py can tell.
+//
+//*****************************************************************************
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/utsname.h>
+#include "bench.h"
+
+#define BENCH_MAX_REPEATS       101
+
+static uint64_t NowNs(void)
+{
+    struct timespec sNow;
+
+    clock_gettime(CLOCK_MONOTONIC, &sNow);
+
+    return(((uint64_t)sNow.tv_sec * 1000000000ull) + (uint64_t)sNow.tv_nsec);
+}
+
+static int CompareDouble(const void *pvA, const void *pvB)
+{
+    double dA = *(const double *)pvA, dB = *(const double *)pvB;
+
+    return((dA > dB) - (dA < dB));
+}
+
+// The CPU model and kernel architecture, from /proc/cpuinfo where there is
+// one.
+static void Machine(char *pcBuf, size_t szBuf)
+{
+    struct utsname sName;
+    char pcLine[256], *pcModel = 0;
+    FILE *psFile;
+
+    uname(&sName);
+    snprintf(pcBuf, szBuf, "%s", sName.machine);
+
+    psFile = fopen("/proc/cpuinfo", "r");
+
+    if(!psFile)
+    {
+        return;
+    }
+
+    while(fgets(pcLine, sizeof(pcLine), psFile))
+    {
+        if(!strncmp(pcLine, "model name", 10) && (pcModel = strchr(pcLine, ':')))
+        {
+            pcModel += 2;
+            pcModel[strcspn(pcModel, "\n")] = 0;
+            snprintf(pcBuf, szBuf, "%s %s", sName.machine, pcModel);
+            break;
+        }
+    }
+
+    fclose(psFile);
+}
+
+// Calls of kernel ui32Kernel that take about ui64TargetNs.
+static uint32_t Calibrate(uint32_t ui32Kernel, uint64_t ui64TargetNs)
+{
+    uint32_t ui32Calls = 1;
+    uint64_t ui64Start, ui64Ns;
+
+    for(;;)
+    {
+        ui64Start = NowNs();
+        BenchRun(ui32Kernel, ui32Calls);
+        ui64Ns = NowNs() - ui64Start;
+
+        if((ui64Ns >= (ui64TargetNs / 8)) || (ui32Calls >= 0x10000000))
+        {
+            break;
+        }
+
+        ui32Calls *= 2;
+    }
+
+    if(!ui64Ns)
+    {
+        return(ui32Calls);
+    }
+
+    return((uint32_t)(((double)ui32Calls * ui64TargetNs) / ui64Ns) + 1);
+}
+
+static int Usage(void)
+{
+    fprintf(stderr, "usage: gamepad_bench [-r repeats] [-t ms] [-k name] "
+            "[-j file]\n");
+
+    return(2);
+}
+
+int main(int argc, char *argv[])
+{
+    double pdNs[BENCH_MAX_REPEATS], dNs;
+    uint32_t ui32Kernel, ui32Repeat, ui32Repeats = 11, ui32Calls;
+    uint64_t ui64RepeatNs = 20000000, ui64Start;
+    const char *pcFilter = 0, *pcJSON = 0;
+    char pcMachine[256];
+    bool bFirst = true;
+    FILE *psJSON = 0;
+    int iArg;
+
+    for(iArg = 1; iArg < argc; iArg++)
+    {
+        if((iArg + 1) >= argc)
+        {
+            return(Usage());
+        }
+        else if(!strcmp(argv[iArg], "-r"))
+        {
+            ui32Repeats = (uint32_t)strtoul(argv[++iArg], 0, 0);
+        }
+        else if(!strcmp(argv[iArg], "-t"))
+        {
+            ui64RepeatNs = (uint64_t)(strtod(argv[++iArg], 0) * 1000000.0);
+        }
+        else if(!strcmp(argv[iArg], "-k"))
+        {
+            pcFilter = argv[++iArg];
+        }
+        else if(!strcmp(argv[iArg], "-j"))
+        {
+            pcJSON = argv[++iArg];
+        }
+        else
+        {
+            return(Usage());
+        }
+    }
+
+    if(!ui32Repeats || (ui32Repeats > BENCH_MAX_REPEATS) || !ui64RepeatNs)
+    {
+        return(Usage());
+    }
+
+    Machine(pcMachine, sizeof(pcMachine));
+
+    if(pcJSON)
+    {
+        psJSON = fopen(pcJSON, "w");
+
+        if(!psJSON)
+        {
+            perror(pcJSON);
+            return(1);
+        }
+
+        fprintf(psJSON, "{\n  \"machine\": \"%s\",\n  \"compiler\": \"%s\",\n"
+                "  \"samples\": %u,\n  \"kernels\": {", pcMachine, __VERSION__,
+                BENCH_SAMPLES);
+    }
+
+    BenchInit();
+
+    printf("%s, %s\n", pcMachine, __VERSION__);
+    printf("%-20s %12s %12s %16s\n", "kernel", "ns/sample", "median",
+           "samples/s");
+
+    for(ui32Kernel = 0; ui32Kernel < g_ui32BenchKernels; ui32Kernel++)
+    {
+        if(pcFilter && !strstr(g_psBenchKernels[ui32Kernel].pcName, pcFilter))
+        {
+            continue;
+        }
+
+        ui32Calls = Calibrate(ui32Kernel, ui64RepeatNs);
+
+        for(ui32Repeat = 0; ui32Repeat < ui32Repeats; ui32Repeat++)
+        {
+            ui64Start = NowNs();
+            BenchRun(ui32Kernel, ui32Calls);
+            pdNs[ui32Repeat] = (double)(NowNs() - ui64Start) /
+                               ((double)ui32Calls * BENCH_SAMPLES);
+        }
+
+        qsort(pdNs, ui32Repeats, sizeof(pdNs[0]), CompareDouble);
+        dNs = pdNs[0];
+
+        printf("%-20s %12.3f %12.3f %16.0f\n",
+               g_psBenchKernels[ui32Kernel].pcName, dNs,
+               pdNs[ui32Repeats / 2], 1e9 / dNs);
+
+        if(psJSON)
+        {
+            fprintf(psJSON, "%s\n    \"%s\": { \"ns_per_sample\": %.4f, "
+                    "\"samples_per_s\": %.0f }", bFirst ? "" : ",",
+                    g_psBenchKernels[ui32Kernel].pcName, dNs, 1e9 / dNs);
+            bFirst = false;
+        }
+    }
+
+    if(psJSON)
+    {
+        fprintf(psJSON, "\n  }\n}\n");
+        fclose(psJSON);
+    }
+
+    return(0);
+}
@@ -0,0 +1,1455 @@
+//*****************************************************************************
+//
+// gamepad_load.c - Runs many virtual gamepads at once to load a host.
+//
+// Copyright (c) Aditya Challamarad.  All rights reserved.
+//
+// usage: gamepad_load [options]
+//
+//   -n count   virtual gamepads (64)
+//   -t count   worker threads the gamepads are split over (one per CPU)
+//   -a         pin each worker to a CPU
+//   -d s       run length in seconds (10)
+//   -P us      host polling interval, one report per gamepad each (1000)
+//   -p count   button samples per report, the main loop passes (4)
+//   -f         flat out, no pacing to real time
+//   -i script  drive every gamepad from a gamepad_sim script, looped
+//   -R file    drive every gamepad from a recorded report log, looped
+//   -g us      random gap of up to this long between generated inputs,
+//              when there is no script or recording (20000)
+//   -s seed    random seed (1)
+//   -u         hand the reports to the kernel, one /dev/uhid device each
+//   -m name    publish the reports to the shared memory ring name (see
+//              report_ring.h), one lane per worker
+//   -o file    write per gamepad results as CSV
+//
+// Each gamepad is the firmware's input path on its own state: the button
+// debounce from buttons.c and the filter, trim, stick and trigger maps from
+// gamepad_input.c, packed into the firmware's report once per polling
+// interval.  The firmware's main loop and USB stack keep their state in
+// globals, so they are not run here; gamepad_sim and gamepad_uhid do that
+// for a single gamepad.
+//
+// Inputs come from a script's pin and adc lines, from a log of reports
+// (gamepad_sim -o, gamepad_uhid -o or hidraw_analyzer --raw) turned back
+// into pin levels and ADC counts, or are generated at random.  Every
+// gamepad starts at its own random point.  An input that changes the report
+// is timed from when it happens to the end of the polling interval whose
+// report shows it.  With pacing that is the real time the report left the
+// worker, so it includes the worker running late.  Flat out it is the
+// gamepad's own time only, and the run shows how many gamepads a core can
+// carry.
+//
+// Reports go to an in-process sink, with -u to the kernel or with -m to a
+// ring other processes read.  Feature report requests from the kernel are
+// refused, there is no firmware behind them here.  A ring record is stamped
+// with the gamepad's time the report went out.
+//
+//*****************************************************************************
+
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <pthread.h>
+#include <sched.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <linux/uhid.h>
+#include "inc/hw_memmap.h"
+#include "usblib/usblib.h"
+#include "usblib/device/usbdhidgamepad.h"
+#include "drivers/buttons.h"
+#include "gamepad_input.h"
+#include "usb_gamepad_structs.h"
+#include "report_ring.h"
+#include "sim.h"
+
+#define LOAD_MAX_DEVICES        4096
+#define LOAD_MAX_THREADS        256
+#define LOAD_MAX_PASSES         64
+#define LOAD_LINE               256
+
+// Give up on timing an input after this long.
+#define LOAD_TIMEOUT_NS         (100 * SIM_MS)
+
+// Per gamepad latency histogram, coarser than the aggregate one.
+#define LOAD_DEV_BUCKETS        1024
+#define LOAD_DEV_BUCKET_NS      (100 * SIM_US)
+
+// How often each gamepad's uhid device is checked for kernel requests, in
+// polling intervals.
+#define LOAD_UHID_SERVICE       64
+
+// Records each lane of a -m ring holds.
+#define LOAD_RING_SLOTS         65536
+
+// The ADC sequence steps, in the order ADCInit() configures them.
+#define LOAD_ADC_X              0
+#define LOAD_ADC_POT            1
+#define LOAD_ADC_Y              2
+#define LOAD_ADC_STEPS          3
+
+#define LOAD_ALL_BUTTONS        (BUTTON1_MASK | BUTTON2_MASK | BUTTON3_MASK | \
+                                 BUTTON4_MASK | JOYSTICK_MASK)
+
+// The joystick switch is active low, so at rest its pin reads high.
+#define LOAD_RAW_REST           JOYSTICK_MASK
+
+#define BUS_USB                 0x03
+
+//
+// The raw inputs after one step of a script or recording.
+//
+typedef struct
+{
+    uint64_t ui64Ns;
+    uint8_t ui8Raw;
+    uint16_t pui16ADC[LOAD_ADC_STEPS];
+} tLoadStep;
+
+//
+// One virtual gamepad.
+//
+typedef struct
+{
+    uint32_t ui32Index;
+    uint64_t ui64Random;
+
+    // Pin levels and ADC counts, and when they next change.
+    uint8_t ui8Raw;
+    uint32_t pui32ADC[LOAD_ADC_STEPS];
+    uint64_t ui64NextNs;
+    uint32_t ui32Step;
+    uint64_t ui64TapeBase;
+
+    // The firmware's input state.
+    tButtonDebounce sDebounce;
+    uint32_t pui32Filter[LOAD_ADC_STEPS];
+    uint8_t pui8Report[SIM_REPORT_SIZE];
+
+    // The input being timed, the report bytes it changes and what they held
+    // before it.
+    bool bWaiting;
+    uint64_t ui64InputNs;
+    uint8_t pui8Mask[SIM_REPORT_SIZE];
+    uint8_t pui8Before[SIM_REPORT_SIZE];
+
+    // Results.
+    uint64_t ui64Reports;
+    uint64_t ui64Changed;
+    uint32_t ui32Inputs;
+    uint32_t ui32Lost;
+    uint64_t ui64MinNs;
+    uint64_t ui64MaxNs;
+    double dSum;
+    uint32_t pui32Hist[LOAD_DEV_BUCKETS];
+
+    int iUHID;
+} tLoadDevice;
+
+//
+// One worker thread and the gamepads it runs.
+//
+typedef struct
+{
+    pthread_t sThread;
+    uint32_t ui32Worker;
+    uint32_t ui32First;
+    uint32_t ui32Count;
+
+    uint64_t ui64Ticks;
+    uint64_t ui64Overruns;
+    uint64_t ui64LateMaxNs;
+    double dLateSum;
+    uint32_t ui32SinkErrors;
+    uint32_t ui32Checksum;
+
+    tSimLatency sLatency;
+} tLoadWorker;
+
+//
+// Where a worker hands each report, at the gamepad time ui64Now.  Returns
+// false if it could not take it.
+//
+typedef bool (*tLoadSink)(tLoadDevice *psDev, tLoadWorker *psWorker,
+                          uint64_t ui64Now);
+
+static tLoadDevice *g_psDevices;
+static uint32_t g_ui32Devices = 64;
+static tLoadWorker *g_psWorkers;
+static uint32_t g_ui32Workers;
+static bool g_bAffinity;
+static bool g_bFlat;
+static bool g_bUHID;
+static tLoadSink g_pfnSink;
+static tReportRing g_sRing;
+static uint64_t g_ui64RunNs = 10 * SIM_S;
+static uint64_t g_ui64PollNs = 1 * SIM_MS;
+static uint32_t g_ui32Passes = 4;
+static uint64_t g_ui64GapNs = 20 * SIM_MS;
+static uint64_t g_ui64Seed = 1;
+
+// The script or recording every gamepad plays, and how long it is.
+static tLoadStep *g_psTape;
+static uint32_t g_ui32TapeSteps;
+static uint64_t g_ui64TapeNs;
+
+// Real time the run started at, gamepad time 0.
+static uint64_t g_ui64RealStart;
+static volatile sig_atomic_t g_bStop;
+
+static uint64_t MonotonicNs(void)
+{
+    struct timespec sNow;
+
+    clock_gettime(CLOCK_MONOTONIC, &sNow);
+
+    return(((uint64_t)sNow.tv_sec * SIM_S) + (uint64_t)sNow.tv_nsec);
+}
+
+// xorshift64*, one per gamepad so runs repeat exactly flat out.
+static uint64_t LoadRandom(tLoadDevice *psDev)
+{
+    psDev->ui64Random ^= psDev->ui64Random >> 12;
+    psDev->ui64Random ^= psDev->ui64Random << 25;
+    psDev->ui64Random ^= psDev->ui64Random >> 27;
+
+    return(psDev->ui64Random * 2685821657736338717ULL);
+}
+
+//*****************************************************************************
+//
+// The firmware's input path.
+//
+//*****************************************************************************
+
+// The report the inputs would make with no debounce or filtering, to tell
+// which report bytes an input changes.
+static void LoadTarget(uint8_t ui8Raw, const uint32_t *pui32ADC,
+                       uint8_t *pui8Out)
+{
+    pui8Out[0] = (uint8_t)GamepadStickMap(GamepadTrim(GAMEPAD_AXIS_X,
+                                                      pui32ADC[LOAD_ADC_X]));
+    pui8Out[1] = (uint8_t)GamepadStickMap(GamepadTrim(GAMEPAD_AXIS_Y,
+                                                      pui32ADC[LOAD_ADC_Y]));
+    GamepadTriggerMap(pui32ADC[LOAD_ADC_POT], &pui8Out[2], &pui8Out[3]);
+    pui8Out[4] = (ui8Raw ^ JOYSTICK_MASK) & LOAD_ALL_BUTTONS;
+}
+
+// Pack the report for one polling interval, as ADCUpdate() and the main
+// loop do.
+static void LoadPack(tLoadDevice *psDev)
+{
+    tGamepadReport sReport;
+    uint8_t ui8LT, ui8RT;
+
+    sReport.ui8Buttons = (psDev->sDebounce.ui8States ^ JOYSTICK_MASK) &
+                         LOAD_ALL_BUTTONS;
+
+    sReport.i8XPos = GamepadStickMap(GamepadTrim(GAMEPAD_AXIS_X,
+                         GamepadFilter(&psDev->pui32Filter[LOAD_ADC_X],
+                                       psDev->pui32ADC[LOAD_ADC_X])));
+    sReport.i8YPos = GamepadStickMap(GamepadTrim(GAMEPAD_AXIS_Y,
+                         GamepadFilter(&psDev->pui32Filter[LOAD_ADC_Y],
+                                       psDev->pui32ADC[LOAD_ADC_Y])));
+
+    GamepadTriggerMap(GamepadFilter(&psDev->pui32Filter[LOAD_ADC_POT],
+                                    psDev->pui32ADC[LOAD_ADC_POT]),
+                      &ui8LT, &ui8RT);
+    sReport.i8LT = (int8_t)ui8LT;
+    sReport.i8RT = (int8_t)ui8RT;
+
+    memcpy(psDev->pui8Report, &sReport, SIM_REPORT_SIZE);
+}
+
+//*****************************************************************************
+//
+// Inputs.
+//
+//*****************************************************************************
+
+// Change the raw inputs at ui64Ns, and start timing the change if nothing
+// else is being timed and the report should show it.
+static void LoadInput(tLoadDevice *psDev, uint64_t ui64Ns, uint8_t ui8Raw,
+                      const uint32_t *pui32ADC)
+{
+    uint8_t pui8Old[SIM_REPORT_SIZE], pui8New[SIM_REPORT_SIZE];
+    bool bChange = false;
+    uint32_t ui32Byte;
+
+    LoadTarget(psDev->ui8Raw, psDev->pui32ADC, pui8Old);
+    LoadTarget(ui8Raw, pui32ADC, pui8New);
+
+    psDev->ui8Raw = ui8Raw;
+    memcpy(psDev->pui32ADC, pui32ADC, sizeof(psDev->pui32ADC));
+
+    if(psDev->bWaiting)
+    {
+        return;
+    }
+
+    for(ui32Byte = 0; ui32Byte < SIM_REPORT_SIZE; ui32Byte++)
+    {
+        psDev->pui8Mask[ui32Byte] = (pui8Old[ui32Byte] != pui8New[ui32Byte]) ?
+                                    0xff : 0;
+        bChange |= (psDev->pui8Mask[ui32Byte] != 0);
+    }
+
+    if(bChange)
+    {
+        memcpy(psDev->pui8Before, psDev->pui8Report, SIM_REPORT_SIZE);
+        psDev->ui64InputNs = ui64Ns;
+        psDev->bWaiting = true;
+    }
+}
+
+// A random input: a button, a stick or the pot, moved far enough to show.
+static void LoadGenerate(tLoadDevice *psDev, uint64_t ui64Ns)
+{
+    uint32_t pui32ADC[LOAD_ADC_STEPS];
+    uint8_t ui8Raw = psDev->ui8Raw;
+    uint64_t ui64Pick = LoadRandom(psDev);
+    uint32_t ui32Step;
+
+    memcpy(pui32ADC, psDev->pui32ADC, sizeof(pui32ADC));
+
+    if(ui64Pick & 1)
+    {
+        ui8Raw ^= (uint8_t)(1 << ((ui64Pick >> 8) % 5));
+    }
+    else
+    {
+        ui32Step = (uint32_t)((ui64Pick >> 8) % LOAD_ADC_STEPS);
+        pui32ADC[ui32Step] = (pui32ADC[ui32Step] + 256 +
+                              (uint32_t)((ui64Pick >> 16) % 3584)) % 4096;
+    }
+
+    LoadInput(psDev, ui64Ns, ui8Raw, pui32ADC);
+}
+
+// Apply the inputs due by ui64Ns.
+static void LoadInputsDue(tLoadDevice *psDev, uint64_t ui64Ns)
+{
+    uint32_t pui32ADC[LOAD_ADC_STEPS];
+    const tLoadStep *psStep;
+    uint32_t ui32Idx;
+
+    while(psDev->ui64NextNs <= ui64Ns)
+    {
+        if(!g_psTape)
+        {
+            // the next input waits for this one to be seen
+            if(psDev->bWaiting)
+            {
+                return;
+            }
+
+            LoadGenerate(psDev, psDev->ui64NextNs);
+
+            // one the report cannot show is not waited for
+            psDev->ui64NextNs = psDev->bWaiting ? ~0ULL :
+                                (psDev->ui64NextNs + 1 +
+                                 (g_ui64GapNs ? (LoadRandom(psDev) % g_ui64GapNs) :
+                                  0));
+            continue;
+        }
+
+        psStep = &g_psTape[psDev->ui32Step];
+
+        for(ui32Idx = 0; ui32Idx < LOAD_ADC_STEPS; ui32Idx++)
+        {
+            pui32ADC[ui32Idx] = psStep->pui16ADC[ui32Idx];
+        }
+
+        LoadInput(psDev, psDev->ui64NextNs, psStep->ui8Raw, pui32ADC);
+
+        if(++psDev->ui32Step == g_ui32TapeSteps)
+        {
+            psDev->ui32Step = 0;
+            psDev->ui64TapeBase += g_ui64TapeNs;
+        }
+
+        psDev->ui64NextNs = psDev->ui64TapeBase +
+                            g_psTape[psDev->ui32Step].ui64Ns;
+    }
+}
+
+//*****************************************************************************
+//
+// Results.
+//
+//*****************************************************************************
+
+static void LoadSeen(tLoadDevice *psDev, tLoadWorker *psWorker,
+                     uint64_t ui64Ns)
+{
+    uint64_t ui64Bucket = ui64Ns / LOAD_DEV_BUCKET_NS;
+
+    if(!psDev->ui32Inputs || (ui64Ns < psDev->ui64MinNs))
+    {
+        psDev->ui64MinNs = ui64Ns;
+    }
+
+    if(ui64Ns > psDev->ui64MaxNs)
+    {
+        psDev->ui64MaxNs = ui64Ns;
+    }
+
+    psDev->ui32Inputs++;
+    psDev->dSum += (double)ui64Ns;
+    psDev->pui32Hist[(ui64Bucket < LOAD_DEV_BUCKETS) ? ui64Bucket :
+                     (LOAD_DEV_BUCKETS - 1)]++;
+
+    SimLatencyAdd(&psWorker->sLatency, ui64Ns);
+}
+
+// Check a report that has gone out against the input being timed.
+// ui64Now is the time it went out, in gamepad time.
+static void LoadObserve(tLoadDevice *psDev, tLoadWorker *psWorker,
+                        uint64_t ui64Now)
+{
+    uint32_t ui32Byte;
+
+    if(!psDev->bWaiting)
+    {
+        return;
+    }
+
+    for(ui32Byte = 0; ui32Byte < SIM_REPORT_SIZE; ui32Byte++)
+    {
+        if((psDev->pui8Report[ui32Byte] ^ psDev->pui8Before[ui32Byte]) &
+           psDev->pui8Mask[ui32Byte])
+        {
+            break;
+        }
+    }
+
+    if(ui32Byte < SIM_REPORT_SIZE)
+    {
+        LoadSeen(psDev, psWorker, ui64Now - psDev->ui64InputNs);
+    }
+    else if((ui64Now - psDev->ui64InputNs) >= LOAD_TIMEOUT_NS)
+    {
+        psDev->ui32Lost++;
+    }
+    else
+    {
+        return;
+    }
+
+    psDev->bWaiting = false;
+
+    if(!g_psTape)
+    {
+        psDev->ui64NextNs = ui64Now +
+                            (g_ui64GapNs ? (LoadRandom(psDev) % g_ui64GapNs) :
+                             0);
+    }
+}
+
+// Gamepad psDev's latency below which ui32PerMille thousandths of its inputs
+// fall.
+static uint64_t LoadDevicePercentile(const tLoadDevice *psDev,
+                                     uint32_t ui32PerMille)
+{
+    uint64_t ui64Want, ui64Seen = 0;
+    uint32_t ui32Bucket;
+
+    ui64Want = (((uint64_t)psDev->ui32Inputs * ui32PerMille) + 999) / 1000;
+
+    for(ui32Bucket = 0; ui32Bucket < LOAD_DEV_BUCKETS; ui32Bucket++)
+    {
+        ui64Seen += psDev->pui32Hist[ui32Bucket];
+
+        if(ui64Seen && (ui64Seen >= ui64Want))
+        {
+            return((uint64_t)(ui32Bucket + 1) * LOAD_DEV_BUCKET_NS);
+        }
+    }
+
+    return(psDev->ui64MaxNs);
+}
+
+//*****************************************************************************
+//
+// Sinks.
+//
+//*****************************************************************************
+
+// The in-process sink reads every report, as a consumer would.
+static bool LoadSinkLocal(tLoadDevice *psDev, tLoadWorker *psWorker,
+                          uint64_t ui64Now)
+{
+    uint32_t ui32Byte;
+
+    (void)ui64Now;
+
+    for(ui32Byte = 0; ui32Byte < SIM_REPORT_SIZE; ui32Byte++)
+    {
+        psWorker->ui32Checksum = (psWorker->ui32Checksum ^
+                                  psDev->pui8Report[ui32Byte]) * 16777619;
+    }
+
+    return(true);
+}
+
+static bool LoadSinkUHID(tLoadDevice *psDev, tLoadWorker *psWorker,
+                         uint64_t ui64Now)
+{
+    struct uhid_event sEvent;
+
+    // uhid takes an event cut short after the data, which saves copying 4K
+    // per report
+    size_t szEvent = sizeof(sEvent.type) + sizeof(sEvent.u.input2.size) +
+                     SIM_REPORT_SIZE;
+
+    sEvent.type = UHID_INPUT2;
+    sEvent.u.input2.size = SIM_REPORT_SIZE;
+    memcpy(sEvent.u.input2.data, psDev->pui8Report, SIM_REPORT_SIZE);
+
+    (void)psWorker;
+    (void)ui64Now;
+
+    return(write(psDev->iUHID, &sEvent, szEvent) == (ssize_t)szEvent);
+}
+
+// Each worker publishes to its own lane, so every lane has one producer.
+static bool LoadSinkRing(tLoadDevice *psDev, tLoadWorker *psWorker,
+                         uint64_t ui64Now)
+{
+    return(ReportRingPush(&g_sRing, psWorker->ui32Worker, ui64Now,
+                          (uint16_t)psDev->ui32Index, psDev->pui8Report,
+                          SIM_REPORT_SIZE));
+}
+
+// Refuse the kernel's feature report requests, so readers do not wait out
+// the kernel's timeout.
+static void LoadServiceUHID(tLoadDevice *psDev)
+{
+    struct uhid_event sEvent, sReply;
+
+    while(read(psDev->iUHID, &sEvent, sizeof(sEvent)) > 0)
+    {
+        memset(&sReply, 0, sizeof(sReply));
+
+        if(sEvent.type == UHID_GET_REPORT)
+        {
+            sReply.type = UHID_GET_REPORT_REPLY;
+            sReply.u.get_report_reply.id = sEvent.u.get_report.id;
+            sReply.u.get_report_reply.err = EIO;
+        }
+        else if(sEvent.type == UHID_SET_REPORT)
+        {
+            sReply.type = UHID_SET_REPORT_REPLY;
+            sReply.u.set_report_reply.id = sEvent.u.set_report.id;
+            sReply.u.set_report_reply.err = EIO;
+        }
+        else
+        {
+            continue;
+        }
+
+        if(write(psDev->iUHID, &sReply, sizeof(sReply)) < 0)
+        {
+            break;
+        }
+    }
+}
+
+// Copy a USB string descriptor into pcOut as ASCII.
+static void StringDescriptor(uint32_t ui32Index, char *pcOut, size_t szOut)
+{
+    const uint8_t *pui8Desc;
+    size_t szChar = 0;
+    uint32_t ui32Byte;
+
+    if(ui32Index < g_sGamepadDevice.ui32NumStringDescriptors)
+    {
+        pui8Desc = g_sGamepadDevice.ppui8StringDescriptors[ui32Index];
+
+        for(ui32Byte = 2; ((ui32Byte + 1) < pui8Desc[0]) &&
+                          ((szChar + 1) < szOut); ui32Byte += 2)
+        {
+            pcOut[szChar++] = (char)pui8Desc[ui32Byte];
+        }
+    }
+
+    pcOut[szChar] = 0;
+}
+
+// Create gamepad psDev's uhid device from the firmware's descriptors.  Each
+// gets its own serial number and phys so they can be told apart.
+static bool LoadCreateUHID(tLoadDevice *psDev)
+{
+    struct uhid_event sEvent;
+    char pcManufacturer[64], pcProduct[64], pcSerial[32];
+
+    psDev->iUHID = open("/dev/uhid", O_RDWR | O_CLOEXEC | O_NONBLOCK);
+
+    if(psDev->iUHID < 0)
+    {
+        fprintf(stderr, "/dev/uhid: %s\n", strerror(errno));
+        return(false);
+    }
+
+    memset(&sEvent, 0, sizeof(sEvent));
+    sEvent.type = UHID_CREATE2;
+
+    StringDescriptor(1, pcManufacturer, sizeof(pcManufacturer));
+    StringDescriptor(2, pcProduct, sizeof(pcProduct));
+    StringDescriptor(3, pcSerial, sizeof(pcSerial));
+    snprintf((char *)sEvent.u.create2.name, sizeof(sEvent.u.create2.name),
+             "%s %s", pcManufacturer, pcProduct);
+    snprintf((char *)sEvent.u.create2.uniq, sizeof(sEvent.u.create2.uniq),
+             "%s-%u", pcSerial, psDev->ui32Index);
+    snprintf((char *)sEvent.u.create2.phys, sizeof(sEvent.u.create2.phys),
+             "gamepad-load/%d/%u", (int)getpid(), psDev->ui32Index);
+
+    sEvent.u.create2.rd_size = (uint16_t)g_sGamepadDevice.ui32DescriptorSize;
+    memcpy(sEvent.u.create2.rd_data, g_sGamepadDevice.pui8ReportDescriptor,
+           g_sGamepadDevice.ui32DescriptorSize);
+    sEvent.u.create2.bus = BUS_USB;
+    sEvent.u.create2.vendor = g_sGamepadDevice.ui16VID;
+    sEvent.u.create2.product = g_sGamepadDevice.ui16PID;
+
+    if(write(psDev->iUHID, &sEvent, sizeof(sEvent)) != (ssize_t)sizeof(sEvent))
+    {
+        fprintf(stderr, "uhid create: %s\n", strerror(errno));
+        return(false);
+    }
+
+    return(true);
+}
+
+//*****************************************************************************
+//
+// Workers.
+//
+//*****************************************************************************
+
+// One polling interval of one gamepad, ending at ui64End.  The buttons are
+// sampled and debounced once per main loop pass, the ADC once per report.
+static void LoadTick(tLoadDevice *psDev, uint64_t ui64End)
+{
+    uint64_t ui64Start = ui64End - g_ui64PollNs;
+    uint32_t ui32Pass;
+
+    for(ui32Pass = 1; ui32Pass <= g_ui32Passes; ui32Pass++)
+    {
+        LoadInputsDue(psDev, ui64Start +
+                             ((g_ui64PollNs * ui32Pass) / g_ui32Passes));
+        ButtonsDebounce(&psDev->sDebounce, psDev->ui8Raw, 0);
+    }
+
+    LoadPack(psDev);
+}
+
+static void *LoadWorker(void *pvArg)
+{
+    tLoadWorker *psWorker = (tLoadWorker *)pvArg;
+    tLoadDevice *psDev, *psEnd;
+    uint64_t ui64End, ui64Due, ui64Wake, ui64Late = 0;
+    uint8_t pui8Last[SIM_REPORT_SIZE];
+    struct timespec sDue;
+    cpu_set_t sCPUs;
+
+    if(g_bAffinity)
+    {
+        CPU_ZERO(&sCPUs);
+        CPU_SET(psWorker->ui32Worker % (uint32_t)sysconf(_SC_NPROCESSORS_ONLN),
+                &sCPUs);
+        pthread_setaffinity_np(pthread_self(), sizeof(sCPUs), &sCPUs);
+    }
+
+    psEnd = g_psDevices + psWorker->ui32First + psWorker->ui32Count;
+
+    for(ui64End = g_ui64PollNs; (ui64End <= g_ui64RunNs) && !g_bStop;
+        ui64End += g_ui64PollNs)
+    {
+        if(!g_bFlat)
+        {
+            ui64Due = g_ui64RealStart + ui64End;
+            sDue.tv_sec = (time_t)(ui64Due / SIM_S);
+            sDue.tv_nsec = (long)(ui64Due % SIM_S);
+
+            while(clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &sDue, 0) ==
+                  EINTR)
+            {
+            }
+
+            ui64Wake = MonotonicNs();
+            ui64Late = ui64Wake - ui64Due;
+            psWorker->dLateSum += (double)ui64Late;
+
+            if(ui64Late > psWorker->ui64LateMaxNs)
+            {
+                psWorker->ui64LateMaxNs = ui64Late;
+            }
+        }
+
+        for(psDev = g_psDevices + psWorker->ui32First; psDev < psEnd; psDev++)
+        {
+            memcpy(pui8Last, psDev->pui8Report, SIM_REPORT_SIZE);
+            LoadTick(psDev, ui64End);
+
+            if(!g_pfnSink(psDev, psWorker, ui64End))
+            {
+                psWorker->ui32SinkErrors++;
+                continue;
+            }
+
+            psDev->ui64Reports++;
+            psDev->ui64Changed += (memcmp(pui8Last, psDev->pui8Report,
+                                          SIM_REPORT_SIZE) != 0);
+
+            // paced, the report went out this late in real time
+            if(!g_bFlat)
+            {
+                ui64Late = MonotonicNs() - g_ui64RealStart - ui64End;
+            }
+
+            LoadObserve(psDev, psWorker, ui64End + ui64Late);
+
+            if(g_bUHID && !(psWorker->ui64Ticks % LOAD_UHID_SERVICE))
+            {
+                LoadServiceUHID(psDev);
+            }
+        }
+
+        psWorker->ui64Ticks++;
+
+        if(!g_bFlat &&
+           ((MonotonicNs() - g_ui64RealStart) > (ui64End + g_ui64PollNs)))
+        {
+            psWorker->ui64Overruns++;
+        }
+    }
+
+    return(0);
+}
+
+//*****************************************************************************
+//
+// Scripts and recordings.
+//
+//*****************************************************************************
+
+static bool LoadTapeAdd(uint64_t ui64Ns, uint8_t ui8Raw,
+                        const uint32_t *pui32ADC)
+{
+    static uint32_t ui32Size;
+    tLoadStep *psStep;
+    uint32_t ui32Idx;
+
+    if(g_ui32TapeSteps && (ui64Ns < g_psTape[g_ui32TapeSteps - 1].ui64Ns))
+    {
+        return(false);
+    }
+
+    if(g_ui32TapeSteps == ui32Size)
+    {
+        ui32Size = ui32Size ? (ui32Size * 2) : 256;
+        g_psTape = realloc(g_psTape, ui32Size * sizeof(tLoadStep));
+
+        if(!g_psTape)
+        {
+            return(false);
+        }
+    }
+
+    psStep = &g_psTape[g_ui32TapeSteps++];
+    psStep->ui64Ns = ui64Ns;
+    psStep->ui8Raw = ui8Raw;
+
+    for(ui32Idx = 0; ui32Idx < LOAD_ADC_STEPS; ui32Idx++)
+    {
+        psStep->pui16ADC[ui32Idx] = (uint16_t)pui32ADC[ui32Idx];
+    }
+
+    return(true);
+}
+
+// The button bit a board pin reads into, or 0.
+static uint8_t LoadButtonMask(uint32_t ui32Port, uint8_t ui8Pin)
+{
+    static const struct
+    {
+        uint32_t ui32Port;
+        uint8_t ui8Pin;
+        uint8_t ui8Mask;
+    }
+    psButtons[] =
+    {
+        { BUTTON1_GPIO_BASE, BUTTON1_PIN, BUTTON1_MASK },
+        { BUTTON2_GPIO_BASE, BUTTON2_PIN, BUTTON2_MASK },
+        { BUTTON3_GPIO_BASE, BUTTON3_PIN, BUTTON3_MASK },
+        { BUTTON4_GPIO_BASE, BUTTON4_PIN, BUTTON4_MASK },
+        { JOYSTICK_SW_GPIO_BASE, JOYSTICK_SW_PIN, JOYSTICK_MASK },
+    };
+    uint32_t ui32Idx;
+
+    for(ui32Idx = 0; ui32Idx < (sizeof(psButtons) / sizeof(psButtons[0]));
+        ui32Idx++)
+    {
+        if((psButtons[ui32Idx].ui32Port == ui32Port) &&
+           (psButtons[ui32Idx].ui8Pin == ui8Pin))
+        {
+            return(psButtons[ui32Idx].ui8Mask);
+        }
+    }
+
+    return(0);
+}
+
+// The sequence step an ADC channel is sampled in, or -1.
+static int32_t LoadADCStep(int32_t i32Channel)
+{
+    switch(i32Channel)
+    {
+        case 8:
+        {
+            return(LOAD_ADC_X);
+        }
+
+        case 9:
+        {
+            return(LOAD_ADC_POT);
+        }
+
+        case 2:
+        {
+            return(LOAD_ADC_Y);
+        }
+
+        default:
+        {
+            return(-1);
+        }
+    }
+}
+
+// Take the pin and adc lines of a gamepad_sim script.  The rest, USB and
+// console stimuli and settings, mean nothing here and are skipped.  The
+// script loops at its end line, or 1ms after its last step.
+static bool LoadScript(const char *pcPath)
+{
+    char pcLine[LOAD_LINE], *pcCmd, *pcName, *pcValue;
+    uint32_t pui32ADC[LOAD_ADC_STEPS] = { 2048, 2048, 2048 };
+    uint8_t ui8Raw = LOAD_RAW_REST, ui8Mask, ui8Pin;
+    uint32_t ui32LineNo = 0, ui32Port;
+    int32_t i32Channel, i32Step;
+    uint64_t ui64Ns, ui64EndNs = 0;
+    FILE *pfScript;
+
+    pfScript = fopen(pcPath, "r");
+
+    if(!pfScript)
+    {
+        fprintf(stderr, "%s: cannot open\n", pcPath);
+        return(false);
+    }
+
+    while(fgets(pcLine, sizeof(pcLine), pfScript))
+    {
+        ui32LineNo++;
+        pcLine[strcspn(pcLine, "#\r\n")] = 0;
+
+        pcCmd = strtok(pcLine, " \t");
+
+        if(!pcCmd || !strcmp(pcCmd, "set"))
+        {
+            continue;
+        }
+
+        ui64Ns = (uint64_t)(strtod(pcCmd, 0) * SIM_MS);
+        pcCmd = strtok(0, " \t");
+        pcName = strtok(0, " \t");
+        pcValue = strtok(0, " \t");
+
+        if(pcCmd && !strcmp(pcCmd, "end"))
+        {
+            ui64EndNs = ui64Ns;
+            break;
+        }
+
+        if(!pcCmd || (strcmp(pcCmd, "pin") && strcmp(pcCmd, "adc")))
+        {
+            continue;
+        }
+
+        if(!pcName || !pcValue ||
+           !SimBoardPin(pcName, &ui32Port, &ui8Pin, &i32Channel))
+        {
+            fprintf(stderr, "%s:%u: bad line\n", pcPath, ui32LineNo);
+            fclose(pfScript);
+            return(false);
+        }
+
+        if(!strcmp(pcCmd, "pin"))
+        {
+            ui8Mask = LoadButtonMask(ui32Port, ui8Pin);
+            ui8Raw = strtoul(pcValue, 0, 0) ? (ui8Raw | ui8Mask) :
+                                              (ui8Raw & ~ui8Mask);
+        }
+        else if((i32Step = LoadADCStep(i32Channel)) >= 0)
+        {
+            pui32ADC[i32Step] = (uint32_t)strtoul(pcValue, 0, 0) & 0xfff;
+        }
+
+        if(!LoadTapeAdd(ui64Ns, ui8Raw, pui32ADC))
+        {
+            fprintf(stderr, "%s:%u: out of order\n", pcPath, ui32LineNo);
+            fclose(pfScript);
+            return(false);
+        }
+    }
+
+    fclose(pfScript);
+
+    if(!g_ui32TapeSteps)
+    {
+        fprintf(stderr, "%s: no pin or adc lines\n", pcPath);
+        return(false);
+    }
+
+    g_ui64TapeNs = (ui64EndNs > g_psTape[g_ui32TapeSteps - 1].ui64Ns) ?
+                   ui64EndNs : (g_psTape[g_ui32TapeSteps - 1].ui64Ns + SIM_MS);
+
+    return(true);
+}
+
+// ADC counts that map back to a stick axis value with untuned settings.
+static uint32_t LoadStickADC(int8_t i8Axis)
+{
+    int32_t i32ADC = 0x7ff - ((int32_t)i8Axis * 16) - 8;
+
+    return((i32ADC < 0) ? 0 : (uint32_t)i32ADC);
+}
+
+// Take a log of reports, turned back into the pin levels and ADC counts that
+// make them with untuned settings.  The lines are time_us, then x, y, lt,
+// rt and buttons last, as gamepad_sim and gamepad_uhid write them, or
+// time_us and the report in hex, as hidraw_analyzer --raw writes them.
+static bool LoadRecording(const char *pcPath)
+{
+    char pcLine[LOAD_LINE], *pcField[8], *pcNext;
+    uint32_t pui32ADC[LOAD_ADC_STEPS];
+    uint8_t pui8Report[SIM_REPORT_SIZE];
+    uint64_t ui64First = 0, ui64Ns;
+    uint32_t ui32Fields, ui32Byte, ui32LineNo = 0;
+    FILE *pfLog;
+
+    pfLog = fopen(pcPath, "r");
+
+    if(!pfLog)
+    {
+        fprintf(stderr, "%s: cannot open\n", pcPath);
+        return(false);
+    }
+
+    while(fgets(pcLine, sizeof(pcLine), pfLog))
+    {
+        ui32LineNo++;
+        pcLine[strcspn(pcLine, "\r\n")] = 0;
+
+        // the header, or a comment
+        if((pcLine[0] < '0') || (pcLine[0] > '9'))
+        {
+            continue;
+        }
+
+        for(ui32Fields = 0, pcNext = pcLine; pcNext && (ui32Fields < 8);
+            ui32Fields++)
+        {
+            pcField[ui32Fields] = pcNext;
+            pcNext = strchr(pcNext, ',');
+
+            if(pcNext)
+            {
+                *pcNext++ = 0;
+            }
+        }
+
+        if(ui32Fields == 2)
+        {
+            for(ui32Byte = 0; ui32Byte < SIM_REPORT_SIZE; ui32Byte++)
+            {
+                if(sscanf(pcField[1] + (ui32Byte * 2), "%2hhx",
+                          &pui8Report[ui32Byte]) != 1)
+                {
+                    break;
+                }
+            }
+        }
+        else if(ui32Fields >= 6)
+        {
+            for(ui32Byte = 0; ui32Byte < SIM_REPORT_SIZE; ui32Byte++)
+            {
+                pui8Report[ui32Byte] = (uint8_t)strtol(
+                    pcField[ui32Fields - SIM_REPORT_SIZE + ui32Byte], 0, 0);
+            }
+        }
+        else
+        {
+            ui32Byte = 0;
+        }
+
+        if(ui32Byte != SIM_REPORT_SIZE)
+        {
+            fprintf(stderr, "%s:%u: bad line\n", pcPath, ui32LineNo);
+            fclose(pfLog);
+            return(false);
+        }
+
+        ui64Ns = strtoull(pcField[0], 0, 10) * SIM_US;
+
+        if(!g_ui32TapeSteps)
+        {
+            ui64First = ui64Ns;
+        }
+
+        pui32ADC[LOAD_ADC_X] = LoadStickADC((int8_t)pui8Report[0]);
+        pui32ADC[LOAD_ADC_Y] = LoadStickADC((int8_t)pui8Report[1]);
+
+        // one trigger at a time, the pot cannot be both sides of center
+        if(pui8Report[2])
+        {
+            pui32ADC[LOAD_ADC_POT] = GAMEPAD_ADC_CENTER - 1 -
+                                     ((pui8Report[2] * (GAMEPAD_ADC_CENTER - 1)) /
+                                      255);
+        }
+        else
+        {
+            pui32ADC[LOAD_ADC_POT] = GAMEPAD_ADC_CENTER + 1 +
+                                     ((pui8Report[3] *
+                                       (GAMEPAD_ADC_MAX - GAMEPAD_ADC_CENTER - 1)) /
+                                      255);
+        }
+
+        if(!LoadTapeAdd(ui64Ns - ui64First,
+                        (pui8Report[4] ^ JOYSTICK_MASK) & LOAD_ALL_BUTTONS,
+                        pui32ADC))
+        {
+            fprintf(stderr, "%s:%u: out of order\n", pcPath, ui32LineNo);
+            fclose(pfLog);
+            return(false);
+        }
+    }
+
+    fclose(pfLog);
+
+    if(!g_ui32TapeSteps)
+    {
+        fprintf(stderr, "%s: no reports\n", pcPath);
+        return(false);
+    }
+
+    g_ui64TapeNs = g_psTape[g_ui32TapeSteps - 1].ui64Ns + g_ui64PollNs;
+
+    return(true);
+}
+
+//*****************************************************************************
+//
+// The run.
+//
+//*****************************************************************************
+
+static void LoadDeviceInit(tLoadDevice *psDev, uint32_t ui32Index)
+{
+    uint32_t ui32Idx;
+
+    memset(psDev, 0, sizeof(*psDev));
+    psDev->ui32Index = ui32Index;
+    psDev->ui64Random = (g_ui64Seed * 0x9e3779b97f4a7c15ULL) + ui32Index + 1;
+    psDev->iUHID = -1;
+
+    psDev->ui8Raw = LOAD_RAW_REST;
+    psDev->sDebounce.ui8States = LOAD_RAW_REST;
+
+    for(ui32Idx = 0; ui32Idx < LOAD_ADC_STEPS; ui32Idx++)
+    {
+        psDev->pui32ADC[ui32Idx] = GAMEPAD_ADC_CENTER;
+        psDev->pui32Filter[ui32Idx] = GAMEPAD_ADC_CENTER << 4;
+    }
+
+    LoadTarget(psDev->ui8Raw, psDev->pui32ADC, psDev->pui8Report);
+
+    // start at a random point of the script or the gaps between inputs
+    if(g_psTape)
+    {
+        psDev->ui64TapeBase = LoadRandom(psDev) % g_ui64TapeNs;
+        psDev->ui64NextNs = psDev->ui64TapeBase + g_psTape[0].ui64Ns;
+    }
+    else
+    {
+        psDev->ui64NextNs = g_ui64GapNs ? (LoadRandom(psDev) % g_ui64GapNs) :
+                                          0;
+    }
+}
+
+static void PrintLatency(const tSimLatency *psLat)
+{
+    double dMean, dVar;
+
+    printf("latency over %u inputs, %u lost", psLat->ui32Inputs,
+           psLat->ui32Lost);
+
+    if(!psLat->ui32Inputs)
+    {
+        printf("\n");
+        return;
+    }
+
+    dMean = psLat->dSum / psLat->ui32Inputs;
+    dVar = (psLat->dSumSq / psLat->ui32Inputs) - (dMean * dMean);
+
+    printf("\n  min %.1fus mean %.1fus max %.1fus jitter (stddev) %.1fus\n",
+           psLat->ui64MinNs / 1e3, dMean / 1e3, psLat->ui64MaxNs / 1e3,
+           sqrt((dVar > 0) ? dVar : 0) / 1e3);
+    printf("  p50 %lluus p90 %lluus p99 %lluus p99.9 %lluus\n",
+           (unsigned long long)(SimLatencyPercentile(psLat, 500) / SIM_US),
+           (unsigned long long)(SimLatencyPercentile(psLat, 900) / SIM_US),
+           (unsigned long long)(SimLatencyPercentile(psLat, 990) / SIM_US),
+           (unsigned long long)(SimLatencyPercentile(psLat, 999) / SIM_US));
+}
+
+static int CompareU64(const void *pvA, const void *pvB)
+{
+    uint64_t ui64A = *(const uint64_t *)pvA, ui64B = *(const uint64_t *)pvB;
+
+    return((ui64A > ui64B) - (ui64A < ui64B));
+}
+
+// The spread of the gamepads' own p99 latencies, best, median and worst.
+static void PrintDevices(void)
+{
+    uint64_t *pui64P99;
+    uint32_t ui32Dev, ui32Timed = 0, ui32Worst = 0;
+    uint64_t ui64Worst = 0;
+
+    pui64P99 = malloc(g_ui32Devices * sizeof(uint64_t));
+
+    if(!pui64P99)
+    {
+        return;
+    }
+
+    for(ui32Dev = 0; ui32Dev < g_ui32Devices; ui32Dev++)
+    {
+        if(!g_psDevices[ui32Dev].ui32Inputs)
+        {
+            continue;
+        }
+
+        pui64P99[ui32Timed] = LoadDevicePercentile(&g_psDevices[ui32Dev], 990);
+
+        if(pui64P99[ui32Timed] > ui64Worst)
+        {
+            ui64Worst = pui64P99[ui32Timed];
+            ui32Worst = ui32Dev;
+        }
+
+        ui32Timed++;
+    }
+
+    if(ui32Timed)
+    {
+        qsort(pui64P99, ui32Timed, sizeof(uint64_t), CompareU64);
+        printf("per gamepad p99 to %lluus: best %lluus median %lluus worst "
+               "%lluus (gamepad %u)\n",
+               (unsigned long long)(LOAD_DEV_BUCKET_NS / SIM_US),
+               (unsigned long long)(pui64P99[0] / SIM_US),
+               (unsigned long long)(pui64P99[ui32Timed / 2] / SIM_US),
+               (unsigned long long)(ui64Worst / SIM_US), ui32Worst);
+    }
+
+    free(pui64P99);
+}
+
+static bool WriteDevices(const char *pcPath)
+{
+    const tLoadDevice *psDev;
+    uint32_t ui32Dev;
+    FILE *pfOut;
+
+    pfOut = fopen(pcPath, "w");
+
+    if(!pfOut)
+    {
+        fprintf(stderr, "%s: cannot create\n", pcPath);
+        return(false);
+    }
+
+    fprintf(pfOut, "gamepad,reports,changed,inputs,lost,min_us,mean_us,"
+            "p50_us,p99_us,max_us\n");
+
+    for(ui32Dev = 0; ui32Dev < g_ui32Devices; ui32Dev++)
+    {
+        psDev = &g_psDevices[ui32Dev];
+
+        fprintf(pfOut, "%u,%llu,%llu,%u,%u,%.1f,%.1f,%llu,%llu,%.1f\n",
+                ui32Dev, (unsigned long long)psDev->ui64Reports,
+                (unsigned long long)psDev->ui64Changed, psDev->ui32Inputs,
+                psDev->ui32Lost, psDev->ui64MinNs / 1e3,
+                psDev->ui32Inputs ? (psDev->dSum / psDev->ui32Inputs / 1e3) : 0,
+                (unsigned long long)(LoadDevicePercentile(psDev, 500) / SIM_US),
+                (unsigned long long)(LoadDevicePercentile(psDev, 990) / SIM_US),
+                psDev->ui64MaxNs / 1e3);
+    }
+
+    fclose(pfOut);
+
+    return(true);
+}
+
+static void Stop(int iSignal)
+{
+    (void)iSignal;
+
+    g_bStop = true;
+}
+
+static int Usage(void)
+{
+    fprintf(stderr, "usage: gamepad_load [-n count] [-t threads] [-a] [-d s] "
+            "[-P us] [-p passes]\n"
+            "                    [-f] [-i script | -R log] [-g us] [-s seed] "
+            "[-u | -m ring] [-o file]\n");
+
+    return(2);
+}
+
+int main(int argc, char *argv[])
+{
+    const char *pcScript = 0, *pcRecording = 0, *pcOut = 0, *pcRing = 0;
+    tSimLatency *psTotal;
+    tLoadWorker *psWorker;
+    uint64_t ui64Reports = 0, ui64Changed = 0, ui64Ticks = 0, ui64Overruns = 0;
+    uint64_t ui64LateMaxNs = 0, ui64WallNs;
+    uint32_t ui32Dev, ui32Worker, ui32Next, ui32SinkErrors = 0;
+    double dLateSum = 0;
+    int iArg;
+
+    g_ui32Workers = (uint32_t)sysconf(_SC_NPROCESSORS_ONLN);
+
+    for(iArg = 1; iArg < argc; iArg++)
+    {
+        if(!strcmp(argv[iArg], "-a"))
+        {
+            g_bAffinity = true;
+        }
+        else if(!strcmp(argv[iArg], "-f"))
+        {
+            g_bFlat = true;
+        }
+        else if(!strcmp(argv[iArg], "-u"))
+        {
+            g_bUHID = true;
+        }
+        else if((iArg + 1) >= argc)
+        {
+            return(Usage());
+        }
+        else if(!strcmp(argv[iArg], "-n"))
+        {
+            g_ui32Devices = (uint32_t)strtoul(argv[++iArg], 0, 0);
+        }
+        else if(!strcmp(argv[iArg], "-t"))
+        {
+            g_ui32Workers = (uint32_t)strtoul(argv[++iArg], 0, 0);
+        }
+        else if(!strcmp(argv[iArg], "-d"))
+        {
+            g_ui64RunNs = (uint64_t)(strtod(argv[++iArg], 0) * SIM_S);
+        }
+        else if(!strcmp(argv[iArg], "-P"))
+        {
+            g_ui64PollNs = strtoull(argv[++iArg], 0, 0) * SIM_US;
+        }
+        else if(!strcmp(argv[iArg], "-p"))
+        {
+            g_ui32Passes = (uint32_t)strtoul(argv[++iArg], 0, 0);
+        }
+        else if(!strcmp(argv[iArg], "-i"))
+        {
+            pcScript = argv[++iArg];
+        }
+        else if(!strcmp(argv[iArg], "-R"))
+        {
+            pcRecording = argv[++iArg];
+        }
+        else if(!strcmp(argv[iArg], "-g"))
+        {
+            g_ui64GapNs = strtoull(argv[++iArg], 0, 0) * SIM_US;
+        }
+        else if(!strcmp(argv[iArg], "-s"))
+        {
+            g_ui64Seed = strtoull(argv[++iArg], 0, 0);
+        }
+        else if(!strcmp(argv[iArg], "-o"))
+        {
+            pcOut = argv[++iArg];
+        }
+        else if(!strcmp(argv[iArg], "-m"))
+        {
+            pcRing = argv[++iArg];
+        }
+        else
+        {
+            return(Usage());
+        }
+    }
+
+    if(!g_ui32Devices || (g_ui32Devices > LOAD_MAX_DEVICES) ||
+       !g_ui32Workers || !g_ui64PollNs || !g_ui32Passes ||
+       (g_ui32Passes > LOAD_MAX_PASSES) || (pcScript && pcRecording) ||
+       (g_bUHID && pcRing))
+    {
+        return(Usage());
+    }
+
+    if(g_ui32Workers > LOAD_MAX_THREADS)
+    {
+        g_ui32Workers = LOAD_MAX_THREADS;
+    }
+
+    if(g_ui32Workers > g_ui32Devices)
+    {
+        g_ui32Workers = g_ui32Devices;
+    }
+
+    g_pfnSink = g_bUHID ? LoadSinkUHID : (pcRing ? LoadSinkRing : LoadSinkLocal);
+
+    if(pcRing &&
+       !ReportRingCreate(&g_sRing, pcRing, g_ui32Workers, LOAD_RING_SLOTS,
+                         g_sGamepadDevice.pui8ReportDescriptor,
+                         g_sGamepadDevice.ui32DescriptorSize))
+    {
+        return(1);
+    }
+
+    if((pcScript && !LoadScript(pcScript)) ||
+       (pcRecording && !LoadRecording(pcRecording)))
+    {
+        return(1);
+    }
+
+    g_psDevices = calloc(g_ui32Devices, sizeof(tLoadDevice));
+    g_psWorkers = calloc(g_ui32Workers, sizeof(tLoadWorker));
+    psTotal = calloc(1, sizeof(tSimLatency));
+
+    if(!g_psDevices || !g_psWorkers || !psTotal)
+    {
+        fprintf(stderr, "out of memory\n");
+        return(1);
+    }
+
+    for(ui32Dev = 0; ui32Dev < g_ui32Devices; ui32Dev++)
+    {
+        LoadDeviceInit(&g_psDevices[ui32Dev], ui32Dev);
+
+        if(g_bUHID && !LoadCreateUHID(&g_psDevices[ui32Dev]))
+        {
+            return(1);
+        }
+    }
+
+    signal(SIGINT, Stop);
+    signal(SIGTERM, Stop);
+
+    // split the gamepads into contiguous shards, the first few one larger
+    g_ui64RealStart = MonotonicNs();
+
+    for(ui32Worker = 0, ui32Next = 0; ui32Worker < g_ui32Workers; ui32Worker++)
+    {
+        psWorker = &g_psWorkers[ui32Worker];
+        psWorker->ui32Worker = ui32Worker;
+        psWorker->ui32First = ui32Next;
+        psWorker->ui32Count = (g_ui32Devices / g_ui32Workers) +
+                              (ui32Worker < (g_ui32Devices % g_ui32Workers));
+        ui32Next += psWorker->ui32Count;
+
+        if(pthread_create(&psWorker->sThread, 0, LoadWorker, psWorker))
+        {
+            fprintf(stderr, "pthread_create failed\n");
+            return(1);
+        }
+    }
+
+    for(ui32Worker = 0; ui32Worker < g_ui32Workers; ui32Worker++)
+    {
+        psWorker = &g_psWorkers[ui32Worker];
+        pthread_join(psWorker->sThread, 0);
+
+        SimLatencyMerge(psTotal, &psWorker->sLatency);
+        ui64Ticks += psWorker->ui64Ticks;
+        ui64Overruns += psWorker->ui64Overruns;
+        dLateSum += psWorker->dLateSum;
+        ui32SinkErrors += psWorker->ui32SinkErrors;
+
+        if(psWorker->ui64LateMaxNs > ui64LateMaxNs)
+        {
+            ui64LateMaxNs = psWorker->ui64LateMaxNs;
+        }
+    }
+
+    ui64WallNs = MonotonicNs() - g_ui64RealStart;
+
+    if(pcRing)
+    {
+        ReportRingClose(&g_sRing);
+    }
+
+    for(ui32Dev = 0; ui32Dev < g_ui32Devices; ui32Dev++)
+    {
+        ui64Reports += g_psDevices[ui32Dev].ui64Reports;
+        ui64Changed += g_psDevices[ui32Dev].ui64Changed;
+
+        // lost inputs are counted per gamepad only
+        psTotal->ui32Lost += g_psDevices[ui32Dev].ui32Lost;
+
+        if(g_psDevices[ui32Dev].iUHID >= 0)
+        {
+            close(g_psDevices[ui32Dev].iUHID);
+        }
+    }
+
+    printf("%u gamepads on %u threads, %lluus polling, %u passes, %s, %s "
+           "input\n", g_ui32Devices, g_ui32Workers,
+           (unsigned long long)(g_ui64PollNs / SIM_US), g_ui32Passes,
+           g_bFlat ? "flat out" : "paced",
+           pcScript ? "scripted" : (pcRecording ? "recorded" : "random"));
+    printf("reports %llu (%llu changed) in %.3fs: %.0f/s, %.2fx real time, "
+           "%u sink errors\n",
+           (unsigned long long)ui64Reports, (unsigned long long)ui64Changed,
+           ui64WallNs / 1e9, ui64Reports / (ui64WallNs / 1e9),
+           ((double)ui64Reports / g_ui32Devices) * g_ui64PollNs / ui64WallNs,
+           ui32SinkErrors);
+
+    if(!g_bFlat && ui64Ticks)
+    {
+        printf("workers woke %.1fus late on average, %.1fus at worst, and "
+               "overran %llu of %llu intervals\n",
+               dLateSum / ui64Ticks / 1e3, ui64LateMaxNs / 1e3,
+               (unsigned long long)ui64Overruns, (unsigned long long)ui64Ticks);
+    }
+
+    PrintLatency(psTotal);
+    PrintDevices();
+
+    if(pcOut && !WriteDevices(pcOut))
+    {
+        return(1);
+    }
+
+    return(0);
+}
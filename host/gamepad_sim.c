@@ -0,0 +1,540 @@
+//*****************************************************************************
+//
+// gamepad_sim.c - Runs the gamepad firmware on the host against a script.
+//
+// Copyright (c) Aditya Challamarad.  All rights reserved.
+//
+// usage: gamepad_sim [options] [script]
+//
+//   -o file    write every report the host received as CSV:
+//              time_us,frame,x,y,lt,rt,buttons
+//   -q         drop the firmware's console output, which goes to stderr
+//              otherwise
+//   -m name    publish every report the host received to the shared memory
+//              ring name (see report_ring.h), one lane per job
+//   -F file    write the input recorder's trace region (see recorder.h) to
+//              file at the end, for gamepad_trace
+//   -f file    load a trace region image into flash before the run, for
+//              the replay engine (see replay.h) to play with key p
+//
+// Latency measurement (see sim_latency.c):
+//
+//   -n count   time count inputs from the pin to the host, then stop
+//   -k kind    button, stick or mixed inputs (button)
+//   -g us      random gap of up to this long between inputs (2000)
+//   -s seed    random seed (1)
+//   -j jobs    split the inputs over this many processes, each with its own
+//              copy of the firmware and its own seed
+//   -H file    write the latency histogram as CSV: latency_us,count
+//
+// The script is optional with -n.  The run summary goes to stdout.  The
+// exit status is 0 if the run reached its end, 1 if the firmware stopped it
+// some other way, such as a watchdog reset.
+//
+//*****************************************************************************
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "usblib/usblib.h"
+#include "usblib/device/usbdhidgamepad.h"
+#include "gamepad_feature.h"
+#include "recorder.h"
+#include "usb_gamepad_structs.h"
+#include "report_ring.h"
+#include "sim.h"
+
+#define MAX_JOBS                256
+
+// Records each lane of a -m ring holds.
+#define RING_SLOTS              65536
+
+//
+// What one run, or one worker process of a split run, reports back.
+//
+typedef struct
+{
+    tSimStats sStats;
+    uint32_t ui32ReportsSent;
+    uint32_t ui32ReportsDropped;
+    uint32_t ui32MaxLoopCycles;
+    uint64_t ui64EndNs;
+    bool bCompleted;
+    char pcStopped[64];
+    tSimLatency sLatency;
+} tRunResult;
+
+typedef struct
+{
+    const char *pcScript;
+    const char *pcCSV;
+    const char *pcHist;
+    const char *pcRing;
+    const char *pcFlash;
+    const char *pcTrace;
+    bool bQuiet;
+    uint32_t ui32Inputs;
+    tSimInput iInput;
+    uint64_t ui64GapNs;
+    uint64_t ui64Seed;
+    uint32_t ui32Jobs;
+} tOptions;
+
+static FILE *g_pfCSV;
+
+// The -m ring, and the lane and gamepad number this run publishes as.
+static tReportRing g_sRing;
+static uint32_t g_ui32RingLane;
+
+// Every report the host receives goes to the latency meter, the CSV and the
+// ring.
+static void ReportSink(const tSimReport *psReport, void *pvData)
+{
+    const uint8_t *pui8Data = psReport->pui8Data;
+
+    (void)pvData;
+
+    SimLatencyObserve(psReport);
+
+    if(g_pfCSV)
+    {
+        fprintf(g_pfCSV, "%llu,%llu,%d,%d,%u,%u,0x%02x\n",
+                (unsigned long long)(psReport->ui64Time / SIM_US),
+                (unsigned long long)(psReport->ui64Time / SIM_MS),
+                (int8_t)pui8Data[0], (int8_t)pui8Data[1], pui8Data[2],
+                pui8Data[3], pui8Data[4]);
+    }
+
+    if(g_sRing.psHeader)
+    {
+        ReportRingPush(&g_sRing, g_ui32RingLane, psReport->ui64Time,
+                       (uint16_t)g_ui32RingLane, pui8Data, SIM_REPORT_SIZE);
+    }
+}
+
+// Run the firmware once with ui32Inputs latency inputs.  Returns false if
+// the run could not be set up.
+static bool Run(const tOptions *psOpt, uint32_t ui32Inputs, uint64_t ui64Seed,
+                bool bQuiet, tRunResult *psResult)
+{
+    const char *pcStopped;
+
+    SimInit();
+    g_pfSimConsole = bQuiet ? 0 : stderr;
+
+    // a latency run ends after its last input
+    if(psOpt->ui32Inputs)
+    {
+        g_sSimConfig.ui64EndNs = ~0ULL;
+    }
+
+    if(psOpt->pcScript && !SimScriptLoad(psOpt->pcScript))
+    {
+        return(false);
+    }
+
+    if(psOpt->pcTrace &&
+       !SimFlashLoad(RECORDER_FLASH_BASE, RECORDER_FLASH_SIZE, psOpt->pcTrace))
+    {
+        return(false);
+    }
+
+    if(psOpt->pcCSV)
+    {
+        g_pfCSV = fopen(psOpt->pcCSV, "w");
+
+        if(!g_pfCSV)
+        {
+            fprintf(stderr, "%s: cannot create\n", psOpt->pcCSV);
+            return(false);
+        }
+
+        fprintf(g_pfCSV, "time_us,frame,x,y,lt,rt,buttons\n");
+    }
+
+    SimUSBSinkSet(ReportSink, 0);
+    SimLatencyStart(ui32Inputs, psOpt->iInput, psOpt->ui64GapNs, ui64Seed);
+
+    pcStopped = SimRun();
+
+    if(g_pfCSV)
+    {
+        fclose(g_pfCSV);
+        g_pfCSV = 0;
+    }
+
+    if(psOpt->pcFlash &&
+       !SimFlashSave(RECORDER_FLASH_BASE, RECORDER_FLASH_SIZE, psOpt->pcFlash))
+    {
+        return(false);
+    }
+
+    memset(psResult, 0, sizeof(*psResult));
+    psResult->sStats = g_sSimStats;
+    psResult->ui32ReportsSent = g_sGamepadStats.ui32ReportsSent;
+    psResult->ui32ReportsDropped = g_sGamepadStats.ui32ReportsDropped;
+    psResult->ui32MaxLoopCycles = g_sGamepadStats.ui32MaxLoopCycles;
+    psResult->ui64EndNs = g_ui64SimNow;
+    psResult->bCompleted = !strcmp(pcStopped, "end of run") ||
+                           !strcmp(pcStopped, "end of script");
+    snprintf(psResult->pcStopped, sizeof(psResult->pcStopped), "%s",
+             pcStopped);
+    psResult->sLatency = g_sSimLatency;
+
+    return(true);
+}
+
+// Add a worker's result to the total.  The first one that did not complete
+// gives the reason the whole run stopped.
+static void Merge(tRunResult *psTo, const tRunResult *psFrom)
+{
+    psTo->sStats.ui64LoopPasses += psFrom->sStats.ui64LoopPasses;
+    psTo->sStats.ui64Interrupts += psFrom->sStats.ui64Interrupts;
+    psTo->sStats.ui32Sent += psFrom->sStats.ui32Sent;
+    psTo->sStats.ui32Refused += psFrom->sStats.ui32Refused;
+    psTo->sStats.ui32Received += psFrom->sStats.ui32Received;
+    psTo->ui32ReportsSent += psFrom->ui32ReportsSent;
+    psTo->ui32ReportsDropped += psFrom->ui32ReportsDropped;
+    psTo->ui64EndNs += psFrom->ui64EndNs;
+
+    if(psFrom->ui32MaxLoopCycles > psTo->ui32MaxLoopCycles)
+    {
+        psTo->ui32MaxLoopCycles = psFrom->ui32MaxLoopCycles;
+    }
+
+    if(psTo->bCompleted && !psFrom->bCompleted)
+    {
+        psTo->bCompleted = false;
+        memcpy(psTo->pcStopped, psFrom->pcStopped, sizeof(psTo->pcStopped));
+    }
+
+    SimLatencyMerge(&psTo->sLatency, &psFrom->sLatency);
+}
+
+// Run the inputs split over several processes.  The firmware's state is all
+// globals, so each worker is a fork with its own copy.
+static bool RunSplit(const tOptions *psOpt, tRunResult *psTotal)
+{
+    static tRunResult sResult;
+    int ppiPipe[MAX_JOBS][2];
+    pid_t piPid[MAX_JOBS];
+    uint32_t ui32Job, ui32Inputs;
+    size_t szGot;
+    ssize_t szRead;
+    bool bOk = true;
+
+    memset(psTotal, 0, sizeof(*psTotal));
+    psTotal->bCompleted = true;
+    snprintf(psTotal->pcStopped, sizeof(psTotal->pcStopped), "end of run");
+    fflush(0);
+
+    for(ui32Job = 0; ui32Job < psOpt->ui32Jobs; ui32Job++)
+    {
+        ui32Inputs = psOpt->ui32Inputs / psOpt->ui32Jobs;
+
+        if(ui32Job < (psOpt->ui32Inputs % psOpt->ui32Jobs))
+        {
+            ui32Inputs++;
+        }
+
+        if(pipe(ppiPipe[ui32Job]) < 0)
+        {
+            perror("pipe");
+            exit(1);
+        }
+
+        piPid[ui32Job] = fork();
+
+        if(piPid[ui32Job] < 0)
+        {
+            perror("fork");
+            exit(1);
+        }
+
+        if(piPid[ui32Job] == 0)
+        {
+            close(ppiPipe[ui32Job][0]);
+            g_ui32RingLane = ui32Job;
+
+            if(!Run(psOpt, ui32Inputs, psOpt->ui64Seed + ui32Job, true,
+                    &sResult) ||
+               (write(ppiPipe[ui32Job][1], &sResult, sizeof(sResult)) !=
+                (ssize_t)sizeof(sResult)))
+            {
+                _exit(1);
+            }
+
+            _exit(0);
+        }
+
+        close(ppiPipe[ui32Job][1]);
+    }
+
+    for(ui32Job = 0; ui32Job < psOpt->ui32Jobs; ui32Job++)
+    {
+        for(szGot = 0; szGot < sizeof(sResult); szGot += (size_t)szRead)
+        {
+            szRead = read(ppiPipe[ui32Job][0], (char *)&sResult + szGot,
+                          sizeof(sResult) - szGot);
+
+            if(szRead <= 0)
+            {
+                break;
+            }
+        }
+
+        close(ppiPipe[ui32Job][0]);
+        waitpid(piPid[ui32Job], 0, 0);
+
+        if(szGot != sizeof(sResult))
+        {
+            bOk = false;
+            continue;
+        }
+
+        Merge(psTotal, &sResult);
+    }
+
+    return(bOk);
+}
+
+static void PrintLatency(const tSimLatency *psLat)
+{
+    double dMean, dVar;
+
+    printf("latency over %u inputs, %u lost", psLat->ui32Inputs,
+           psLat->ui32Lost);
+
+    if(!psLat->ui32Inputs)
+    {
+        printf("\n");
+        return;
+    }
+
+    dMean = psLat->dSum / psLat->ui32Inputs;
+    dVar = (psLat->dSumSq / psLat->ui32Inputs) - (dMean * dMean);
+
+    printf("\n  min %.1fus mean %.1fus max %.1fus jitter (stddev) %.1fus\n",
+           psLat->ui64MinNs / 1e3, dMean / 1e3, psLat->ui64MaxNs / 1e3,
+           sqrt((dVar > 0) ? dVar : 0) / 1e3);
+    printf("  p50 %lluus p90 %lluus p99 %lluus p99.9 %lluus\n",
+           (unsigned long long)(SimLatencyPercentile(psLat, 500) / SIM_US),
+           (unsigned long long)(SimLatencyPercentile(psLat, 900) / SIM_US),
+           (unsigned long long)(SimLatencyPercentile(psLat, 990) / SIM_US),
+           (unsigned long long)(SimLatencyPercentile(psLat, 999) / SIM_US));
+
+    if(psLat->ui32Over)
+    {
+        printf("  %u inputs over %ums\n", psLat->ui32Over,
+               SIM_LAT_BUCKETS / 1000);
+    }
+}
+
+static bool WriteHistogram(const char *pcFile, const tSimLatency *psLat)
+{
+    uint32_t ui32Bucket;
+    FILE *pfHist;
+
+    pfHist = fopen(pcFile, "w");
+
+    if(!pfHist)
+    {
+        fprintf(stderr, "%s: cannot create\n", pcFile);
+        return(false);
+    }
+
+    fprintf(pfHist, "latency_us,count\n");
+
+    for(ui32Bucket = 0; ui32Bucket < SIM_LAT_BUCKETS; ui32Bucket++)
+    {
+        if(psLat->pui32Hist[ui32Bucket])
+        {
+            fprintf(pfHist, "%u,%u\n", ui32Bucket, psLat->pui32Hist[ui32Bucket]);
+        }
+    }
+
+    fclose(pfHist);
+
+    return(true);
+}
+
+// What the ring took, and what it had to drop for want of a consumer.
+static void PrintRing(const tReportRing *psRing)
+{
+    uint64_t ui64Published = 0, ui64Dropped = 0;
+    uint32_t ui32Lane;
+
+    for(ui32Lane = 0; ui32Lane < psRing->psHeader->ui32Lanes; ui32Lane++)
+    {
+        ui64Published += __atomic_load_n(&psRing->psLanes[ui32Lane].ui64Head,
+                                         __ATOMIC_ACQUIRE);
+        ui64Dropped += __atomic_load_n(&psRing->psLanes[ui32Lane].ui64Dropped,
+                                       __ATOMIC_ACQUIRE);
+    }
+
+    printf("ring %s: published %llu dropped %llu\n", psRing->pcName,
+           (unsigned long long)ui64Published, (unsigned long long)ui64Dropped);
+}
+
+static int Usage(void)
+{
+    fprintf(stderr,
+            "usage: gamepad_sim [-o reports.csv] [-q] [-m ring] [-f trace.bin] "
+            "[-F trace.bin]\n"
+            "                   [-n inputs [-k button|stick|mixed] "
+            "[-g gap_us] [-s seed] [-j jobs]\n"
+            "                   [-H histogram.csv]] [script]\n");
+    return(2);
+}
+
+int main(int argc, char *argv[])
+{
+    static tRunResult sResult;
+    tOptions sOpt;
+    const char *pcValue;
+    int iArg;
+
+    memset(&sOpt, 0, sizeof(sOpt));
+    sOpt.iInput = eSimInputButton;
+    sOpt.ui64GapNs = 2000 * SIM_US;
+    sOpt.ui64Seed = 1;
+    sOpt.ui32Jobs = 1;
+
+    for(iArg = 1; iArg < argc; iArg++)
+    {
+        if(!strcmp(argv[iArg], "-q"))
+        {
+            sOpt.bQuiet = true;
+            continue;
+        }
+
+        if(argv[iArg][0] != '-')
+        {
+            if(sOpt.pcScript)
+            {
+                return(Usage());
+            }
+
+            sOpt.pcScript = argv[iArg];
+            continue;
+        }
+
+        if(((iArg + 1) >= argc) || (argv[iArg][2] != 0))
+        {
+            return(Usage());
+        }
+
+        pcValue = argv[++iArg];
+
+        switch(argv[iArg - 1][1])
+        {
+            case 'o': sOpt.pcCSV = pcValue; break;
+            case 'H': sOpt.pcHist = pcValue; break;
+            case 'm': sOpt.pcRing = pcValue; break;
+            case 'F': sOpt.pcFlash = pcValue; break;
+            case 'f': sOpt.pcTrace = pcValue; break;
+            case 'n': sOpt.ui32Inputs = (uint32_t)strtoul(pcValue, 0, 0); break;
+            case 'g': sOpt.ui64GapNs = strtoull(pcValue, 0, 0) * SIM_US; break;
+            case 's': sOpt.ui64Seed = strtoull(pcValue, 0, 0); break;
+            case 'j': sOpt.ui32Jobs = (uint32_t)strtoul(pcValue, 0, 0); break;
+            case 'k':
+            {
+                if(!strcmp(pcValue, "button"))
+                {
+                    sOpt.iInput = eSimInputButton;
+                }
+                else if(!strcmp(pcValue, "stick"))
+                {
+                    sOpt.iInput = eSimInputStick;
+                }
+                else if(!strcmp(pcValue, "mixed"))
+                {
+                    sOpt.iInput = eSimInputMixed;
+                }
+                else
+                {
+                    return(Usage());
+                }
+                break;
+            }
+            default:
+            {
+                return(Usage());
+            }
+        }
+    }
+
+    if((!sOpt.pcScript && !sOpt.ui32Inputs) || !sOpt.ui32Jobs ||
+       (sOpt.ui32Jobs > MAX_JOBS) ||
+       ((sOpt.ui32Jobs > 1) && (sOpt.pcCSV || sOpt.pcFlash)))
+    {
+        return(Usage());
+    }
+
+    // made before the jobs fork, so they all share it
+    if(sOpt.pcRing &&
+       !ReportRingCreate(&g_sRing, sOpt.pcRing, sOpt.ui32Jobs, RING_SLOTS,
+                         g_sGamepadDevice.pui8ReportDescriptor,
+                         g_sGamepadDevice.ui32DescriptorSize))
+    {
+        return(1);
+    }
+
+    if(sOpt.ui32Jobs > 1)
+    {
+        if(!RunSplit(&sOpt, &sResult))
+        {
+            fprintf(stderr, "a worker failed\n");
+            return(1);
+        }
+
+        printf("stopped: %s, %llu.%03llums simulated over %u jobs\n",
+               sResult.pcStopped,
+               (unsigned long long)(sResult.ui64EndNs / SIM_MS),
+               (unsigned long long)((sResult.ui64EndNs % SIM_MS) / SIM_US),
+               sOpt.ui32Jobs);
+    }
+    else
+    {
+        if(!Run(&sOpt, sOpt.ui32Inputs, sOpt.ui64Seed, sOpt.bQuiet, &sResult))
+        {
+            return(1);
+        }
+
+        printf("stopped: %s at %llu.%03llums\n", sResult.pcStopped,
+               (unsigned long long)(sResult.ui64EndNs / SIM_MS),
+               (unsigned long long)((sResult.ui64EndNs % SIM_MS) / SIM_US));
+    }
+
+    printf("loop passes %llu, interrupts %llu\n",
+           (unsigned long long)sResult.sStats.ui64LoopPasses,
+           (unsigned long long)sResult.sStats.ui64Interrupts);
+    printf("reports sent %u refused %u received %u\n", sResult.sStats.ui32Sent,
+           sResult.sStats.ui32Refused, sResult.sStats.ui32Received);
+    printf("firmware: sent %u dropped %u max loop %u cycles\n",
+           sResult.ui32ReportsSent, sResult.ui32ReportsDropped,
+           sResult.ui32MaxLoopCycles);
+
+    if(g_sRing.psHeader)
+    {
+        PrintRing(&g_sRing);
+        ReportRingClose(&g_sRing);
+    }
+
+    if(sOpt.ui32Inputs)
+    {
+        PrintLatency(&sResult.sLatency);
+
+        if(sOpt.pcHist && !WriteHistogram(sOpt.pcHist, &sResult.sLatency))
+        {
+            return(1);
+        }
+    }
+
+    return(sResult.bCompleted ? 0 : 1);
+}
@@ -0,0 +1,403 @@
+//*****************************************************************************
+//
+// gamepad_trace.c - Reads input traces recorded by the gamepad.
+//
+// Copyright (c) Aditya Challamarad.  All rights reserved.
+//
+// usage: gamepad_trace [options] trace.bin|/dev/hidrawN
+//
+//   -o file    write the decoded reports as CSV:
+//              time_us,x,y,lt,rt,buttons
+//              with the time from the start of the recording
+//   -b file    save the trace region read from a device, to read again later
+//   -s         start a new recording on the device and exit
+//   -p         play the trace on the device once through the report path
+//              (see replay.h) and exit, -P to play it until stopped
+//   -x         stop recording or playing on the device and exit
+//
+// The trace comes from an image of the trace region, as gamepad_sim -F or
+// -b here write it, or straight from the board's hidraw node through the
+// trace feature page (gamepad_feature.h), 16 bytes a request.  Only the
+// chunks holding the trace are read, the rest of the region is left alone.
+//
+// The summary gives the records, their sizes and kinds, and the length of
+// the recording.  A trace still being recorded, or cut short by a reset,
+// has no length in its header and is read up to the first erased byte.
+// The CSV is in the form gamepad_load -R and the analysis scripts take.
+//
+//*****************************************************************************
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <linux/hidraw.h>
+#include "gamepad_feature.h"
+#include "recorder.h"
+#include "replay.h"
+#include "trace.h"
+
+// Feature report as hidraw passes it, the report ID first.  The gamepad
+// has no report IDs, so it is always 0.
+#define TRACE_HIDRAW_SIZE       (1 + GAMEPAD_FEATURE_SIZE)
+
+static uint8_t g_pui8Region[RECORDER_FLASH_SIZE];
+
+// Select a page and read it back, or with bWrite apply ui32Arg to it.
+static bool HidrawFeature(int iFD, bool bWrite, uint32_t ui32Arg,
+                          uint8_t *pui8Page)
+{
+    uint8_t pui8Buf[TRACE_HIDRAW_SIZE];
+
+    memset(pui8Buf, 0, sizeof(pui8Buf));
+    pui8Buf[1 + GAMEPAD_FEATURE_PAGE] = GAMEPAD_PAGE_TRACE;
+    pui8Buf[1 + GAMEPAD_FEATURE_VER] = GAMEPAD_FEATURE_VERSION |
+                                       (bWrite ? GAMEPAD_FEATURE_WRITE : 0);
+    pui8Buf[1 + GAMEPAD_FEATURE_DATA] = (uint8_t)ui32Arg;
+    pui8Buf[2 + GAMEPAD_FEATURE_DATA] = (uint8_t)(ui32Arg >> 8);
+
+    if(ioctl(iFD, HIDIOCSFEATURE(sizeof(pui8Buf)), pui8Buf) < 0)
+    {
+        fprintf(stderr, "set feature: %s\n", strerror(errno));
+        return(false);
+    }
+
+    if(bWrite)
+    {
+        return(true);
+    }
+
+    memset(pui8Buf, 0, sizeof(pui8Buf));
+
+    if(ioctl(iFD, HIDIOCGFEATURE(sizeof(pui8Buf)), pui8Buf) < 0)
+    {
+        fprintf(stderr, "get feature: %s\n", strerror(errno));
+        return(false);
+    }
+
+    if((pui8Buf[1 + GAMEPAD_FEATURE_PAGE] != GAMEPAD_PAGE_TRACE) ||
+       (pui8Buf[3 + GAMEPAD_FEATURE_DATA] != (uint8_t)ui32Arg) ||
+       (pui8Buf[4 + GAMEPAD_FEATURE_DATA] != (uint8_t)(ui32Arg >> 8)))
+    {
+        fprintf(stderr, "no trace page, firmware too old?\n");
+        return(false);
+    }
+
+    memcpy(pui8Page, &pui8Buf[1], GAMEPAD_FEATURE_SIZE);
+    return(true);
+}
+
+// Read the chunks of the region that hold the trace into g_pui8Region, the
+// rest stays erased.  Returns the bytes read, 0 on failure.
+static uint32_t ReadDevice(int iFD)
+{
+    uint8_t pui8Page[GAMEPAD_FEATURE_SIZE];
+    uint32_t ui32Chunk, ui32Size;
+
+    memset(g_pui8Region, TRACE_TAG_ERASED, sizeof(g_pui8Region));
+
+    if(!HidrawFeature(iFD, false, 0, pui8Page))
+    {
+        return(0);
+    }
+
+    // the recorder's own count, the header has none while recording; one
+    // word more for the end tag and padding
+    ui32Size = TRACE_HEADER_SIZE + TraceGetU32(&pui8Page[6]) + 4;
+
+    if(ui32Size > RECORDER_FLASH_SIZE)
+    {
+        ui32Size = RECORDER_FLASH_SIZE;
+    }
+
+    memcpy(g_pui8Region, &pui8Page[16], GAMEPAD_TRACE_CHUNK);
+
+    for(ui32Chunk = 1; (ui32Chunk * GAMEPAD_TRACE_CHUNK) < ui32Size;
+        ui32Chunk++)
+    {
+        if(!HidrawFeature(iFD, false, ui32Chunk, pui8Page))
+        {
+            return(0);
+        }
+
+        memcpy(&g_pui8Region[ui32Chunk * GAMEPAD_TRACE_CHUNK], &pui8Page[16],
+               GAMEPAD_TRACE_CHUNK);
+    }
+
+    printf("read %u bytes, recorder %s, replay %s\n",
+           ui32Chunk * GAMEPAD_TRACE_CHUNK,
+           (pui8Page[4] == RECORDER_RECORDING) ? "recording" :
+           (pui8Page[4] == RECORDER_ERASING) ? "erasing" : "idle",
+           (pui8Page[5] == REPLAY_PLAYING) ? "playing" : "idle");
+
+    return(ui32Chunk * GAMEPAD_TRACE_CHUNK);
+}
+
+// Read an image of the region.  Returns the bytes read, 0 on failure.
+static uint32_t ReadImage(int iFD, const char *pcPath)
+{
+    ssize_t iRead;
+    uint32_t ui32Size = 0;
+
+    memset(g_pui8Region, TRACE_TAG_ERASED, sizeof(g_pui8Region));
+
+    while(ui32Size < sizeof(g_pui8Region))
+    {
+        iRead = read(iFD, &g_pui8Region[ui32Size],
+                     sizeof(g_pui8Region) - ui32Size);
+
+        if(iRead < 0)
+        {
+            fprintf(stderr, "%s: %s\n", pcPath, strerror(errno));
+            return(0);
+        }
+
+        if(!iRead)
+        {
+            break;
+        }
+
+        ui32Size += (uint32_t)iRead;
+    }
+
+    if(ui32Size < TRACE_HEADER_SIZE)
+    {
+        fprintf(stderr, "%s: too short for a trace\n", pcPath);
+        return(0);
+    }
+
+    return(ui32Size);
+}
+
+// Decode the trace in g_pui8Region, writing the reports to pfCSV if there
+// is one, and print what it holds.
+static bool Decode(uint32_t ui32Size, FILE *pfCSV)
+{
+    tTraceState sState;
+    uint32_t ui32Bytes, ui32Records, ui32Offset = TRACE_HEADER_SIZE;
+    uint32_t pui32Kinds[3] = { 0, 0, 0 }, ui32Decoded = 0;
+    uint64_t ui64First = 0;
+    int32_t i32Len = TRACE_END;
+    uint8_t ui8Tag;
+
+    if(!TraceHeaderValid(g_pui8Region))
+    {
+        fprintf(stderr, "no trace, the region is %s\n",
+                (TraceGetU32(g_pui8Region) == TRACE_OPEN) ? "erased" :
+                "not a trace of this version");
+        return(false);
+    }
+
+    ui32Bytes = TraceGetU32(&g_pui8Region[8]);
+    ui32Records = TraceGetU32(&g_pui8Region[12]);
+
+    // an open trace ends at the first erased byte
+    if((ui32Bytes != TRACE_OPEN) &&
+       ((TRACE_HEADER_SIZE + ui32Bytes) < ui32Size))
+    {
+        ui32Size = TRACE_HEADER_SIZE + ui32Bytes;
+    }
+
+    TraceStart(&sState);
+
+    while(ui32Offset < ui32Size)
+    {
+        ui8Tag = g_pui8Region[ui32Offset];
+        i32Len = TraceDecode(&sState, &g_pui8Region[ui32Offset],
+                             ui32Size - ui32Offset);
+
+        if(i32Len <= 0)
+        {
+            break;
+        }
+
+        pui32Kinds[(ui8Tag < TRACE_TAG_AXIS) ? 0 :
+                   (ui8Tag < TRACE_TAG_BUTTONS) ? 1 : 2]++;
+
+        if(!ui32Decoded)
+        {
+            ui64First = sState.ui64TimeUs;
+        }
+
+        if(pfCSV)
+        {
+            fprintf(pfCSV, "%llu,%d,%d,%u,%u,0x%02x\n",
+                    (unsigned long long)sState.ui64TimeUs,
+                    (int8_t)sState.pui8Report[0], (int8_t)sState.pui8Report[1],
+                    sState.pui8Report[2], sState.pui8Report[3],
+                    sState.pui8Report[4]);
+        }
+
+        ui32Decoded++;
+        ui32Offset += (uint32_t)i32Len;
+    }
+
+    if(i32Len == TRACE_BAD)
+    {
+        fprintf(stderr, "bad record at offset %u, stopped there\n",
+                ui32Offset);
+    }
+    else if(i32Len == TRACE_TRUNCATED)
+    {
+        fprintf(stderr, "last record cut short at offset %u\n", ui32Offset);
+    }
+
+    printf("trace %s, %u records in %u bytes, %.2f bytes a record\n",
+           (ui32Bytes == TRACE_OPEN) ? "open" : "closed", ui32Decoded,
+           ui32Offset - TRACE_HEADER_SIZE,
+           ui32Decoded ? ((double)(ui32Offset - TRACE_HEADER_SIZE) /
+                          ui32Decoded) : 0.0);
+    printf("%u full, %u axis step, %u buttons only\n", pui32Kinds[0],
+           pui32Kinds[1], pui32Kinds[2]);
+    printf("%.3f s from the first record to the last, %.3f s recorded\n",
+           (double)(sState.ui64TimeUs - ui64First) / 1e6,
+           (double)sState.ui64TimeUs / 1e6);
+
+    if((ui32Records != TRACE_OPEN) && (ui32Records != ui32Decoded))
+    {
+        fprintf(stderr, "the header says %u records\n", ui32Records);
+        return(false);
+    }
+
+    return(i32Len >= 0);
+}
+
+int main(int argc, char *argv[])
+{
+    const char *pcPath = 0, *pcCSV = 0, *pcImage = 0;
+    struct stat sStat;
+    uint32_t ui32Size;
+    int iArg, iFD, iCommand = -1, iKB = 0;
+    FILE *pfCSV = 0, *pfImage;
+    bool bDevice, bOk;
+
+    for(iArg = 1; iArg < argc; iArg++)
+    {
+        if(!strcmp(argv[iArg], "-o") && ((iArg + 1) < argc))
+        {
+            pcCSV = argv[++iArg];
+        }
+        else if(!strcmp(argv[iArg], "-b") && ((iArg + 1) < argc))
+        {
+            pcImage = argv[++iArg];
+        }
+        else if(!strcmp(argv[iArg], "-s"))
+        {
+            iCommand = GAMEPAD_TRACE_RECORD;
+        }
+        else if(!strcmp(argv[iArg], "-k") && ((iArg + 1) < argc))
+        {
+            iKB = atoi(argv[++iArg]);
+            iCommand = GAMEPAD_TRACE_RECORD;
+        }
+        else if(!strcmp(argv[iArg], "-p"))
+        {
+            iCommand = GAMEPAD_TRACE_PLAY;
+        }
+        else if(!strcmp(argv[iArg], "-P"))
+        {
+            iCommand = GAMEPAD_TRACE_LOOP;
+        }
+        else if(!strcmp(argv[iArg], "-x"))
+        {
+            iCommand = GAMEPAD_TRACE_STOP;
+        }
+        else if((argv[iArg][0] != '-') && !pcPath)
+        {
+            pcPath = argv[iArg];
+        }
+        else
+        {
+            pcPath = 0;
+            break;
+        }
+    }
+
+    if(!pcPath)
+    {
+        fprintf(stderr, "usage: gamepad_trace [-o reports.csv] [-b trace.bin] "
+                "[-s|-k KB|-p|-P|-x] trace.bin|/dev/hidrawN\n");
+        return(2);
+    }
+
+    iFD = open(pcPath, (iCommand >= 0) ? O_RDWR : O_RDONLY);
+
+    if((iFD < 0) && (errno == EACCES) && (iCommand < 0))
+    {
+        // hidraw feature requests need write access too
+        iFD = open(pcPath, O_RDWR);
+    }
+
+    if((iFD < 0) || (fstat(iFD, &sStat) < 0))
+    {
+        fprintf(stderr, "%s: %s\n", pcPath, strerror(errno));
+        return(1);
+    }
+
+    bDevice = S_ISCHR(sStat.st_mode);
+
+    if(iCommand >= 0)
+    {
+        if(!bDevice)
+        {
+            fprintf(stderr, "%s: -s, -p, -P and -x need a hidraw node\n",
+                    pcPath);
+            return(2);
+        }
+
+        bOk = HidrawFeature(iFD, true, (uint32_t)iCommand |
+                            ((uint32_t)(iKB & 0xff) << 8), 0);
+        close(iFD);
+        return(bOk ? 0 : 1);
+    }
+
+    ui32Size = bDevice ? ReadDevice(iFD) : ReadImage(iFD, pcPath);
+    close(iFD);
+
+    if(!ui32Size)
+    {
+        return(1);
+    }
+
+    if(pcImage)
+    {
+        pfImage = fopen(pcImage, "wb");
+
+        if(!pfImage ||
+           (fwrite(g_pui8Region, 1, sizeof(g_pui8Region), pfImage) !=
+            sizeof(g_pui8Region)) || fclose(pfImage))
+        {
+            fprintf(stderr, "%s: write failed\n", pcImage);
+            return(1);
+        }
+    }
+
+    if(pcCSV)
+    {
+        pfCSV = fopen(pcCSV, "w");
+
+        if(!pfCSV)
+        {
+            fprintf(stderr, "%s: cannot create\n", pcCSV);
+            return(1);
+        }
+
+        fprintf(pfCSV, "time_us,x,y,lt,rt,buttons\n");
+    }
+
+    bOk = Decode(ui32Size, pfCSV);
+
+    if(pfCSV && fclose(pfCSV))
+    {
+        fprintf(stderr, "%s: write failed\n", pcCSV);
+        bOk = false;
+    }
+
+    return(bOk ? 0 : 1);
+}
@@ -0,0 +1,498 @@
+//*****************************************************************************
+//
+// gamepad_uhid.c - Runs the gamepad firmware as a Linux virtual HID device.
+//
+// Copyright (c) Aditya Challamarad.  All rights reserved.
+//
+// usage: gamepad_uhid [-o writes.csv] [-q] [-f trace.bin] [script]
+//
+//   -o  log every report handed to the kernel as CSV:
+//       time_us,x,y,lt,rt,buttons
+//       with CLOCK_MONOTONIC time, the clock hidraw readers stamp with
+//   -q  drop the firmware's console output
+//   -f  load a trace region image into flash, for the replay engine to play
+//       with key p in the script or the trace feature page
+//
+// The firmware runs in the simulator as gamepad_sim does.  Simulated time is
+// held back to real time, and every report the simulated host receives is
+// passed to the kernel through /dev/uhid.  The device is created with the
+// firmware's own report descriptor, VID, PID and strings, so hid-generic,
+// hidraw, evdev, SDL and games see what they would see from the board.
+// Feature report reads and writes from the kernel go to the firmware as
+// GET_REPORT and SET_REPORT control requests.
+//
+// The device's phys is "gamepad-sim/<pid>" and its hidraw node is printed
+// once the kernel has bound it.  The run ends at the script's end, or on
+// SIGINT or SIGTERM.  /dev/uhid normally needs root.
+//
+//*****************************************************************************
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <linux/uhid.h>
+#include "usblib/usblib.h"
+#include "usblib/usbhid.h"
+#include "usblib/device/usbdhidgamepad.h"
+#include "usb_gamepad_structs.h"
+#include "recorder.h"
+#include "sim.h"
+
+// How often the kernel side is serviced, in simulated time.
+#define UHID_SERVICE_NS         (1 * SIM_MS)
+
+// Give the kernel this long to bind hidraw before giving up on finding it.
+#define UHID_FIND_NS            (2 * SIM_S)
+
+#define BUS_USB                 0x03
+
+static int g_iUHID = -1;
+static FILE *g_pfLog;
+static volatile sig_atomic_t g_bStop;
+
+// Real time the run started at, simulated time 0.
+static uint64_t g_ui64RealStart;
+
+static char g_pcPhys[64];
+static bool g_bFound;
+
+static uint64_t MonotonicNs(void)
+{
+    struct timespec sNow;
+
+    clock_gettime(CLOCK_MONOTONIC, &sNow);
+
+    return(((uint64_t)sNow.tv_sec * SIM_S) + (uint64_t)sNow.tv_nsec);
+}
+
+// Hold simulated time back to real time.
+static void Pace(void)
+{
+    uint64_t ui64Due = g_ui64RealStart + g_ui64SimNow;
+    uint64_t ui64Now = MonotonicNs();
+    struct timespec sDue;
+
+    if(ui64Now >= ui64Due)
+    {
+        return;
+    }
+
+    sDue.tv_sec = (time_t)(ui64Due / SIM_S);
+    sDue.tv_nsec = (long)(ui64Due % SIM_S);
+
+    while(clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &sDue, 0) == EINTR)
+    {
+        if(g_bStop)
+        {
+            break;
+        }
+    }
+}
+
+static bool UHIDWrite(const struct uhid_event *psEvent)
+{
+    ssize_t iWritten;
+
+    iWritten = write(g_iUHID, psEvent, sizeof(*psEvent));
+
+    if(iWritten != (ssize_t)sizeof(*psEvent))
+    {
+        fprintf(stderr, "uhid write: %s\n",
+                (iWritten < 0) ? strerror(errno) : "short write");
+        return(false);
+    }
+
+    return(true);
+}
+
+// Copy a USB string descriptor into pcOut as ASCII.
+static void StringDescriptor(uint32_t ui32Index, char *pcOut, size_t szOut)
+{
+    const uint8_t *pui8Desc;
+    size_t szChar = 0;
+    uint32_t ui32Byte;
+
+    if(ui32Index < g_sGamepadDevice.ui32NumStringDescriptors)
+    {
+        pui8Desc = g_sGamepadDevice.ppui8StringDescriptors[ui32Index];
+
+        for(ui32Byte = 2; ((ui32Byte + 1) < pui8Desc[0]) &&
+                          ((szChar + 1) < szOut); ui32Byte += 2)
+        {
+            pcOut[szChar++] = (char)pui8Desc[ui32Byte];
+        }
+    }
+
+    pcOut[szChar] = 0;
+}
+
+// Create the device from the firmware's descriptors.
+static bool UHIDCreate(void)
+{
+    struct uhid_event sEvent;
+    char pcManufacturer[64], pcProduct[64];
+
+    memset(&sEvent, 0, sizeof(sEvent));
+    sEvent.type = UHID_CREATE2;
+
+    StringDescriptor(1, pcManufacturer, sizeof(pcManufacturer));
+    StringDescriptor(2, pcProduct, sizeof(pcProduct));
+    snprintf((char *)sEvent.u.create2.name, sizeof(sEvent.u.create2.name),
+             "%s %s", pcManufacturer, pcProduct);
+    StringDescriptor(3, (char *)sEvent.u.create2.uniq,
+                     sizeof(sEvent.u.create2.uniq));
+    snprintf((char *)sEvent.u.create2.phys, sizeof(sEvent.u.create2.phys),
+             "%s", g_pcPhys);
+
+    sEvent.u.create2.rd_size = (uint16_t)g_sGamepadDevice.ui32DescriptorSize;
+    memcpy(sEvent.u.create2.rd_data, g_sGamepadDevice.pui8ReportDescriptor,
+           g_sGamepadDevice.ui32DescriptorSize);
+    sEvent.u.create2.bus = BUS_USB;
+    sEvent.u.create2.vendor = g_sGamepadDevice.ui16VID;
+    sEvent.u.create2.product = g_sGamepadDevice.ui16PID;
+
+    return(UHIDWrite(&sEvent));
+}
+
+// Find the hidraw node the kernel gave the device, by its phys.
+static void HidrawFind(void)
+{
+    char pcPath[300], pcLine[128];
+    struct dirent *psEntry;
+    DIR *psDir;
+    FILE *pfUevent;
+
+    psDir = opendir("/sys/class/hidraw");
+
+    if(!psDir)
+    {
+        return;
+    }
+
+    while(!g_bFound && ((psEntry = readdir(psDir)) != 0))
+    {
+        if(strncmp(psEntry->d_name, "hidraw", 6))
+        {
+            continue;
+        }
+
+        snprintf(pcPath, sizeof(pcPath), "/sys/class/hidraw/%s/device/uevent",
+                 psEntry->d_name);
+        pfUevent = fopen(pcPath, "r");
+
+        if(!pfUevent)
+        {
+            continue;
+        }
+
+        while(fgets(pcLine, sizeof(pcLine), pfUevent))
+        {
+            pcLine[strcspn(pcLine, "\n")] = 0;
+
+            if(!strncmp(pcLine, "HID_PHYS=", 9) &&
+               !strcmp(pcLine + 9, g_pcPhys))
+            {
+                printf("hidraw node /dev/%s\n", psEntry->d_name);
+                fflush(stdout);
+                g_bFound = true;
+                break;
+            }
+        }
+
+        fclose(pfUevent);
+    }
+
+    closedir(psDir);
+}
+
+// A report reached the simulated host, hand it to the kernel.
+static void ReportSink(const tSimReport *psReport, void *pvData)
+{
+    struct uhid_event sEvent;
+    const uint8_t *pui8Data = psReport->pui8Data;
+
+    (void)pvData;
+
+    Pace();
+
+    memset(&sEvent, 0, sizeof(sEvent));
+    sEvent.type = UHID_INPUT2;
+    sEvent.u.input2.size = SIM_REPORT_SIZE;
+    memcpy(sEvent.u.input2.data, pui8Data, SIM_REPORT_SIZE);
+
+    if(!UHIDWrite(&sEvent))
+    {
+        SimStop("uhid write failed");
+    }
+
+    if(g_pfLog)
+    {
+        fprintf(g_pfLog, "%llu,%d,%d,%u,%u,0x%02x\n",
+                (unsigned long long)(MonotonicNs() / SIM_US),
+                (int8_t)pui8Data[0], (int8_t)pui8Data[1], pui8Data[2],
+                pui8Data[3], pui8Data[4]);
+    }
+}
+
+// The firmware answered a GET_REPORT.  Reports go to the kernel with the
+// report ID in front, 0 as the descriptor has none.
+static void GetReportDone(const uint8_t *pui8Data, uint32_t ui32Size,
+                          void *pvData)
+{
+    struct uhid_event sEvent;
+
+    memset(&sEvent, 0, sizeof(sEvent));
+    sEvent.type = UHID_GET_REPORT_REPLY;
+    sEvent.u.get_report_reply.id = (uint32_t)(uintptr_t)pvData;
+
+    if(pui8Data)
+    {
+        sEvent.u.get_report_reply.size = (uint16_t)(ui32Size + 1);
+        memcpy(&sEvent.u.get_report_reply.data[1], pui8Data, ui32Size);
+    }
+    else
+    {
+        sEvent.u.get_report_reply.err = EIO;
+    }
+
+    UHIDWrite(&sEvent);
+}
+
+static void SetReportDone(const uint8_t *pui8Data, uint32_t ui32Size,
+                          void *pvData)
+{
+    struct uhid_event sEvent;
+
+    (void)ui32Size;
+
+    memset(&sEvent, 0, sizeof(sEvent));
+    sEvent.type = UHID_SET_REPORT_REPLY;
+    sEvent.u.set_report_reply.id = (uint32_t)(uintptr_t)pvData;
+    sEvent.u.set_report_reply.err = pui8Data ? 0 : EIO;
+
+    UHIDWrite(&sEvent);
+}
+
+static uint32_t ReportType(uint8_t ui8Type)
+{
+    return((ui8Type == UHID_FEATURE_REPORT) ? USB_HID_REPORT_FEATURE :
+           (ui8Type == UHID_OUTPUT_REPORT) ? USB_HID_REPORT_OUTPUT :
+                                             USB_HID_REPORT_INPUT);
+}
+
+// Answer a GET_REPORT or SET_REPORT from the kernel.  Both wait for the
+// firmware, which serves them from its USB interrupt.
+static void UHIDRequest(const struct uhid_event *psEvent)
+{
+    struct uhid_event sReply;
+    const uint8_t *pui8Data;
+    uint32_t ui32Size;
+    bool bQueued;
+
+    if(psEvent->type == UHID_GET_REPORT)
+    {
+        bQueued = SimUSBControl(ReportType(psEvent->u.get_report.rtype), 0, 0,
+                                GetReportDone,
+                                (void *)(uintptr_t)psEvent->u.get_report.id);
+    }
+    else
+    {
+        // drop the report ID in front
+        pui8Data = psEvent->u.set_report.data;
+        ui32Size = psEvent->u.set_report.size;
+
+        if(ui32Size && !psEvent->u.set_report.rnum)
+        {
+            pui8Data++;
+            ui32Size--;
+        }
+
+        bQueued = SimUSBControl(ReportType(psEvent->u.set_report.rtype),
+                                pui8Data, ui32Size, SetReportDone,
+                                (void *)(uintptr_t)psEvent->u.set_report.id);
+    }
+
+    if(bQueued)
+    {
+        return;
+    }
+
+    // one request at a time, as on the control endpoint
+    memset(&sReply, 0, sizeof(sReply));
+
+    if(psEvent->type == UHID_GET_REPORT)
+    {
+        sReply.type = UHID_GET_REPORT_REPLY;
+        sReply.u.get_report_reply.id = psEvent->u.get_report.id;
+        sReply.u.get_report_reply.err = EBUSY;
+    }
+    else
+    {
+        sReply.type = UHID_SET_REPORT_REPLY;
+        sReply.u.set_report_reply.id = psEvent->u.set_report.id;
+        sReply.u.set_report_reply.err = EBUSY;
+    }
+
+    UHIDWrite(&sReply);
+}
+
+// Keep up with real time and take whatever the kernel sent.
+static void UHIDService(uint32_t ui32Arg)
+{
+    struct pollfd sPoll;
+    struct uhid_event sEvent;
+
+    (void)ui32Arg;
+
+    Pace();
+
+    if(g_bStop)
+    {
+        SimStop("end of run");
+    }
+
+    if(!g_bFound && (g_ui64SimNow < UHID_FIND_NS))
+    {
+        HidrawFind();
+    }
+
+    sPoll.fd = g_iUHID;
+    sPoll.events = POLLIN;
+
+    while((poll(&sPoll, 1, 0) > 0) && (sPoll.revents & POLLIN))
+    {
+        if(read(g_iUHID, &sEvent, sizeof(sEvent)) <= 0)
+        {
+            break;
+        }
+
+        if((sEvent.type == UHID_GET_REPORT) || (sEvent.type == UHID_SET_REPORT))
+        {
+            UHIDRequest(&sEvent);
+        }
+    }
+
+    SimSchedule(g_ui64SimNow + UHID_SERVICE_NS, UHIDService, 0);
+}
+
+static void Stop(int iSignal)
+{
+    (void)iSignal;
+
+    g_bStop = true;
+}
+
+int main(int argc, char *argv[])
+{
+    const char *pcScript = 0, *pcLog = 0, *pcTrace = 0, *pcStopped;
+    struct uhid_event sEvent;
+    bool bQuiet = false;
+    int iArg;
+
+    for(iArg = 1; iArg < argc; iArg++)
+    {
+        if(!strcmp(argv[iArg], "-o") && ((iArg + 1) < argc))
+        {
+            pcLog = argv[++iArg];
+        }
+        else if(!strcmp(argv[iArg], "-f") && ((iArg + 1) < argc))
+        {
+            pcTrace = argv[++iArg];
+        }
+        else if(!strcmp(argv[iArg], "-q"))
+        {
+            bQuiet = true;
+        }
+        else if((argv[iArg][0] != '-') && !pcScript)
+        {
+            pcScript = argv[iArg];
+        }
+        else
+        {
+            fprintf(stderr, "usage: gamepad_uhid [-o writes.csv] [-q] "
+                    "[-f trace.bin] [script]\n");
+            return(2);
+        }
+    }
+
+    SimInit();
+    g_pfSimConsole = bQuiet ? 0 : stderr;
+
+    // runs until stopped unless the script says otherwise
+    g_sSimConfig.ui64EndNs = ~0ULL;
+
+    if(pcScript && !SimScriptLoad(pcScript))
+    {
+        return(1);
+    }
+
+    if(pcTrace &&
+       !SimFlashLoad(RECORDER_FLASH_BASE, RECORDER_FLASH_SIZE, pcTrace))
+    {
+        return(1);
+    }
+
+    g_iUHID = open("/dev/uhid", O_RDWR | O_CLOEXEC);
+
+    if(g_iUHID < 0)
+    {
+        fprintf(stderr, "/dev/uhid: %s\n", strerror(errno));
+        return(1);
+    }
+
+    if(pcLog)
+    {
+        g_pfLog = fopen(pcLog, "w");
+
+        if(!g_pfLog)
+        {
+            fprintf(stderr, "%s: cannot create\n", pcLog);
+            return(1);
+        }
+
+        fprintf(g_pfLog, "time_us,x,y,lt,rt,buttons\n");
+    }
+
+    snprintf(g_pcPhys, sizeof(g_pcPhys), "gamepad-sim/%d", (int)getpid());
+
+    if(!UHIDCreate())
+    {
+        return(1);
+    }
+
+    signal(SIGINT, Stop);
+    signal(SIGTERM, Stop);
+
+    SimUSBSinkSet(ReportSink, 0);
+    SimSchedule(0, UHIDService, 0);
+
+    g_ui64RealStart = MonotonicNs();
+    pcStopped = SimRun();
+
+    memset(&sEvent, 0, sizeof(sEvent));
+    sEvent.type = UHID_DESTROY;
+    UHIDWrite(&sEvent);
+    close(g_iUHID);
+
+    if(g_pfLog)
+    {
+        fclose(g_pfLog);
+    }
+
+    printf("stopped: %s at %llu.%03llums, %u reports to the kernel\n",
+           pcStopped, (unsigned long long)(g_ui64SimNow / SIM_MS),
+           (unsigned long long)((g_ui64SimNow % SIM_MS) / SIM_US),
+           g_sSimStats.ui32Received);
+
+    return((!strcmp(pcStopped, "end of run") ||
+            !strcmp(pcStopped, "end of script")) ? 0 : 1);
+}
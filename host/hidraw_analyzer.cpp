@@ -0,0 +1,1279 @@
+//*****************************************************************************
+//
+// hidraw_analyzer.cpp - Report rate, jitter and drop analyzer for a HID
+//                       device on Linux.
+//
+// Copyright (c) Aditya Challamarad.  All rights reserved.
+//
+// usage: hidraw_analyzer [options] /dev/hidrawN
+//        hidraw_analyzer [options] --replay raw.log --rdesc descriptor.bin
+//        hidraw_analyzer [options] --ring NAME [--gamepad N]
+//
+//   --count N          stop after N reports
+//   --seconds S        stop after S seconds (default: run until Ctrl-C)
+//   --seq FIELD        treat input field FIELD as a sequence counter and
+//                      count gaps in it
+//   --csv FILE         one row per report: time_us,interval_us,report_id,
+//                      status,<decoded fields>
+//   --json FILE        the summary and interval histogram as JSON
+//   --raw FILE         the reports as time_us,hex bytes, for --replay
+//   --replay FILE      analyze a --raw log instead of a device
+//   --rdesc FILE       report descriptor for --replay, the binary the
+//                      kernel shows in /sys/class/hidraw/*/device/
+//                      report_descriptor
+//   --ring NAME        read the reports from the shared memory ring
+//                      gamepad_sim -m or gamepad_load -m publish to, in
+//                      place, with the producer's time stamps
+//   --gamepad N        the gamepad to analyze from a ring (0)
+//   --layout           print the decoded input report layout and exit
+//
+// Reports are decoded with the device's own report descriptor, read with
+// HIDIOCGRDESC.  Each one is stamped with CLOCK_MONOTONIC as read() returns
+// it, which is also the clock gamepad_uhid -o logs writes with.
+//
+// A report that is byte for byte the same as the previous one with the same
+// report ID is a duplicate.  One that differs only in constant (padding)
+// bits is redundant.  Both carry no new input.
+//
+// Works the same against the board and against the virtual device
+// gamepad_uhid creates.  A ring carries its own descriptor, and the records
+// of other gamepads in it are skipped.
+//
+//*****************************************************************************
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <time.h>
+#include <unistd.h>
+#include <linux/hidraw.h>
+
+#include "report_ring.h"
+
+namespace
+{
+
+//*****************************************************************************
+//
+// Report descriptor parsing.  Only what is needed to find the input report
+// fields: their position, size, usage and logical range.
+//
+//*****************************************************************************
+
+// Item tags with the size bits masked off.
+const uint8_t ITEM_INPUT = 0x80;
+const uint8_t ITEM_COLLECTION = 0xa0;
+const uint8_t ITEM_END_COLLECTION = 0xc0;
+const uint8_t ITEM_OUTPUT = 0x90;
+const uint8_t ITEM_FEATURE = 0xb0;
+const uint8_t ITEM_USAGE_PAGE = 0x04;
+const uint8_t ITEM_LOGICAL_MIN = 0x14;
+const uint8_t ITEM_LOGICAL_MAX = 0x24;
+const uint8_t ITEM_REPORT_SIZE = 0x74;
+const uint8_t ITEM_REPORT_ID = 0x84;
+const uint8_t ITEM_REPORT_COUNT = 0x94;
+const uint8_t ITEM_PUSH = 0xa4;
+const uint8_t ITEM_POP = 0xb4;
+const uint8_t ITEM_USAGE = 0x08;
+const uint8_t ITEM_USAGE_MIN = 0x18;
+const uint8_t ITEM_USAGE_MAX = 0x28;
+const uint8_t ITEM_LONG = 0xfe;
+
+// Main item flag bits.
+const uint32_t MAIN_CONSTANT = 0x01;
+const uint32_t MAIN_VARIABLE = 0x02;
+
+// One value in an input report.
+struct tField
+{
+    uint8_t ui8ReportID;
+    uint32_t ui32BitOffset;
+    uint32_t ui32BitSize;
+    uint32_t ui32UsagePage;
+    uint32_t ui32Usage;
+    int32_t i32LogicalMin;
+    int32_t i32LogicalMax;
+    bool bConstant;
+    std::string sName;
+};
+
+struct tGlobals
+{
+    uint32_t ui32UsagePage = 0;
+    int32_t i32LogicalMin = 0;
+    int32_t i32LogicalMax = 0;
+    uint32_t ui32ReportSize = 0;
+    uint32_t ui32ReportCount = 0;
+    uint8_t ui8ReportID = 0;
+};
+
+class tLayout
+{
+public:
+    std::vector<tField> vFields;
+
+    // Input report sizes in bytes by report ID, without the ID byte.
+    std::map<uint8_t, uint32_t> mReportBytes;
+
+    bool bReportIDs = false;
+
+    bool Parse(const std::vector<uint8_t> &vDesc, std::string &sError);
+    void Print(void) const;
+    int FindField(const std::string &sName) const;
+};
+
+static int32_t SignExtend(uint32_t ui32Value, uint32_t ui32Bytes)
+{
+    if(ui32Bytes == 1)
+    {
+        return((int8_t)ui32Value);
+    }
+
+    if(ui32Bytes == 2)
+    {
+        return((int16_t)ui32Value);
+    }
+
+    return((int32_t)ui32Value);
+}
+
+static std::string UsageName(uint32_t ui32Page, uint32_t ui32Usage)
+{
+    static const char * const ppcDesktop[] =
+    {
+        "x", "y", "z", "rx", "ry", "rz", "slider", "dial", "wheel", "hat"
+    };
+    char pcName[32];
+
+    if((ui32Page == 0x01) && (ui32Usage >= 0x30) && (ui32Usage <= 0x39))
+    {
+        return(ppcDesktop[ui32Usage - 0x30]);
+    }
+
+    if(ui32Page == 0x09)
+    {
+        snprintf(pcName, sizeof(pcName), "button%u", ui32Usage);
+        return(pcName);
+    }
+
+    snprintf(pcName, sizeof(pcName), "%04x:%04x", ui32Page, ui32Usage);
+    return(pcName);
+}
+
+bool tLayout::Parse(const std::vector<uint8_t> &vDesc, std::string &sError)
+{
+    std::vector<tGlobals> vStack;
+    std::vector<uint32_t> vUsages;
+    std::map<uint8_t, uint32_t> mBits;
+    tGlobals sGlobals;
+    uint32_t ui32UsageMin = 0, ui32Pos = 0;
+    bool bUsageMin = false;
+
+    while(ui32Pos < vDesc.size())
+    {
+        uint8_t ui8Prefix = vDesc[ui32Pos];
+        uint32_t ui32Bytes = ui8Prefix & 3, ui32Value = 0, ui32Byte;
+
+        if(ui8Prefix == ITEM_LONG)
+        {
+            if((ui32Pos + 1) >= vDesc.size())
+            {
+                break;
+            }
+
+            ui32Pos += 3 + vDesc[ui32Pos + 1];
+            continue;
+        }
+
+        if(ui32Bytes == 3)
+        {
+            ui32Bytes = 4;
+        }
+
+        if((ui32Pos + 1 + ui32Bytes) > vDesc.size())
+        {
+            sError = "report descriptor is truncated";
+            return(false);
+        }
+
+        for(ui32Byte = 0; ui32Byte < ui32Bytes; ui32Byte++)
+        {
+            ui32Value |= (uint32_t)vDesc[ui32Pos + 1 + ui32Byte] << (8 * ui32Byte);
+        }
+
+        ui32Pos += 1 + ui32Bytes;
+
+        switch(ui8Prefix & 0xfc)
+        {
+            case ITEM_USAGE_PAGE: sGlobals.ui32UsagePage = ui32Value; break;
+            case ITEM_LOGICAL_MIN:
+                sGlobals.i32LogicalMin = SignExtend(ui32Value, ui32Bytes);
+                break;
+            // unsigned unless the minimum is negative, as the kernel reads
+            // it, so a one byte 0xff maximum after a 0 minimum is 255
+            case ITEM_LOGICAL_MAX:
+                sGlobals.i32LogicalMax = (sGlobals.i32LogicalMin < 0) ?
+                                         SignExtend(ui32Value, ui32Bytes) :
+                                         (int32_t)ui32Value;
+                break;
+            case ITEM_REPORT_SIZE: sGlobals.ui32ReportSize = ui32Value; break;
+            case ITEM_REPORT_COUNT: sGlobals.ui32ReportCount = ui32Value; break;
+            case ITEM_REPORT_ID:
+                sGlobals.ui8ReportID = (uint8_t)ui32Value;
+                bReportIDs = true;
+                break;
+            case ITEM_PUSH: vStack.push_back(sGlobals); break;
+            case ITEM_POP:
+                if(!vStack.empty())
+                {
+                    sGlobals = vStack.back();
+                    vStack.pop_back();
+                }
+                break;
+            case ITEM_USAGE: vUsages.push_back(ui32Value); break;
+            case ITEM_USAGE_MIN:
+                ui32UsageMin = ui32Value;
+                bUsageMin = true;
+                break;
+            case ITEM_USAGE_MAX:
+                for(uint32_t ui32Usage = ui32UsageMin;
+                    bUsageMin && (ui32Usage <= ui32Value) &&
+                    (vUsages.size() < 1024); ui32Usage++)
+                {
+                    vUsages.push_back(ui32Usage);
+                }
+                bUsageMin = false;
+                break;
+            case ITEM_INPUT:
+            {
+                uint32_t &ui32Bits = mBits[sGlobals.ui8ReportID];
+
+                for(uint32_t ui32Idx = 0; ui32Idx < sGlobals.ui32ReportCount;
+                    ui32Idx++)
+                {
+                    tField sField;
+                    uint32_t ui32Usage = 0;
+
+                    if(!vUsages.empty())
+                    {
+                        ui32Usage = vUsages[std::min<size_t>(ui32Idx,
+                                                             vUsages.size() - 1)];
+                    }
+
+                    sField.ui8ReportID = sGlobals.ui8ReportID;
+                    sField.ui32BitOffset = ui32Bits;
+                    sField.ui32BitSize = sGlobals.ui32ReportSize;
+                    sField.ui32UsagePage = sGlobals.ui32UsagePage;
+                    sField.ui32Usage = ui32Usage;
+                    sField.i32LogicalMin = sGlobals.i32LogicalMin;
+                    sField.i32LogicalMax = sGlobals.i32LogicalMax;
+                    sField.bConstant = (ui32Value & MAIN_CONSTANT) != 0;
+                    sField.sName = sField.bConstant ? "pad" :
+                                   UsageName(sField.ui32UsagePage, ui32Usage);
+
+                    if(!(ui32Value & MAIN_VARIABLE) && !sField.bConstant)
+                    {
+                        sField.sName += "[]";
+                    }
+
+                    ui32Bits += sGlobals.ui32ReportSize;
+                    vFields.push_back(sField);
+                }
+
+                vUsages.clear();
+                break;
+            }
+            case ITEM_OUTPUT:
+            case ITEM_FEATURE:
+            case ITEM_COLLECTION:
+            case ITEM_END_COLLECTION:
+                vUsages.clear();
+                break;
+            default:
+                break;
+        }
+    }
+
+    for(const auto &sEntry : mBits)
+    {
+        mReportBytes[sEntry.first] = (sEntry.second + 7) / 8;
+    }
+
+    // name clashes get the report ID and an index added
+    std::map<std::string, uint32_t> mSeen;
+
+    for(auto &sField : vFields)
+    {
+        if(!sField.bConstant && (mSeen[sField.sName]++ != 0))
+        {
+            sField.sName += "_" + std::to_string(mSeen[sField.sName] - 1);
+        }
+    }
+
+    if(mReportBytes.empty())
+    {
+        sError = "no input reports in the report descriptor";
+        return(false);
+    }
+
+    return(true);
+}
+
+void tLayout::Print(void) const
+{
+    for(const auto &sField : vFields)
+    {
+        printf("  id %u  bit %3u  size %2u  %-12s range %d..%d%s\n",
+               sField.ui8ReportID, sField.ui32BitOffset, sField.ui32BitSize,
+               sField.sName.c_str(), sField.i32LogicalMin,
+               sField.i32LogicalMax, sField.bConstant ? "  constant" : "");
+    }
+
+    for(const auto &sEntry : mReportBytes)
+    {
+        printf("  report id %u: %u bytes\n", sEntry.first, sEntry.second);
+    }
+}
+
+int tLayout::FindField(const std::string &sName) const
+{
+    for(size_t szIdx = 0; szIdx < vFields.size(); szIdx++)
+    {
+        if(!vFields[szIdx].bConstant && (vFields[szIdx].sName == sName))
+        {
+            return((int)szIdx);
+        }
+    }
+
+    return(-1);
+}
+
+// Pull a field out of a report, pui8Data without the report ID byte.
+static int64_t FieldValue(const tField &sField, const uint8_t *pui8Data,
+                          size_t szData)
+{
+    uint64_t ui64Raw = 0;
+    uint32_t ui32Bit;
+
+    for(ui32Bit = 0; (ui32Bit < sField.ui32BitSize) && (ui32Bit < 64);
+        ui32Bit++)
+    {
+        uint32_t ui32At = sField.ui32BitOffset + ui32Bit;
+
+        if((ui32At / 8) >= szData)
+        {
+            break;
+        }
+
+        if(pui8Data[ui32At / 8] & (1 << (ui32At % 8)))
+        {
+            ui64Raw |= 1ULL << ui32Bit;
+        }
+    }
+
+    // signed if the logical range goes negative
+    if((sField.i32LogicalMin < 0) && (sField.ui32BitSize < 64) &&
+       (ui64Raw & (1ULL << (sField.ui32BitSize - 1))))
+    {
+        ui64Raw |= ~0ULL << sField.ui32BitSize;
+    }
+
+    return((int64_t)ui64Raw);
+}
+
+//*****************************************************************************
+//
+// Statistics.
+//
+//*****************************************************************************
+
+// Intervals are binned per microsecond up to this, longer ones are counted.
+const uint32_t HIST_BUCKETS = 100000;
+
+enum tStatus
+{
+    eStatusNew,
+    eStatusDuplicate,
+    eStatusRedundant
+};
+
+static const char * const g_ppcStatus[] = { "new", "duplicate", "redundant" };
+
+class tAnalysis
+{
+public:
+    explicit tAnalysis(const tLayout &sLayout) :
+        m_sLayout(sLayout), m_vHist(HIST_BUCKETS, 0)
+    {
+    }
+
+    // Add one report.  Returns its status.
+    tStatus Add(uint64_t ui64TimeUs, const uint8_t *pui8Report, size_t szSize);
+
+    void SeqFieldSet(int iField) { m_iSeqField = iField; }
+    void Print(void) const;
+    bool WriteJSON(const std::string &sFile) const;
+
+    uint64_t ui64Reports = 0;
+
+private:
+    uint64_t Percentile(double dFraction) const;
+
+    const tLayout &m_sLayout;
+
+    // Last report by report ID.
+    std::map<uint8_t, std::vector<uint8_t>> m_mLast;
+
+    uint64_t m_ui64FirstUs = 0;
+    uint64_t m_ui64LastUs = 0;
+    uint64_t m_ui64Intervals = 0;
+    uint64_t m_ui64MinUs = ~0ULL;
+    uint64_t m_ui64MaxUs = 0;
+    double m_dSum = 0;
+    double m_dSumSq = 0;
+    std::vector<uint64_t> m_vHist;
+    uint64_t m_ui64Over = 0;
+
+    uint64_t m_ui64Duplicates = 0;
+    uint64_t m_ui64Redundant = 0;
+    uint64_t m_ui64BadSize = 0;
+
+    // Sequence counter checks.
+    int m_iSeqField = -1;
+    bool m_bSeqValid = false;
+    uint64_t m_ui64Seq = 0;
+    uint64_t m_ui64SeqMissing = 0;
+    uint64_t m_ui64SeqGaps = 0;
+    uint64_t m_ui64SeqRepeats = 0;
+    uint64_t m_ui64SeqBackwards = 0;
+};
+
+tStatus tAnalysis::Add(uint64_t ui64TimeUs, const uint8_t *pui8Report,
+                       size_t szSize)
+{
+    uint8_t ui8ID = 0;
+    tStatus iStatus = eStatusNew;
+
+    if(m_sLayout.bReportIDs && szSize)
+    {
+        ui8ID = pui8Report[0];
+        pui8Report++;
+        szSize--;
+    }
+
+    auto sExpected = m_sLayout.mReportBytes.find(ui8ID);
+
+    if((sExpected == m_sLayout.mReportBytes.end()) ||
+       (sExpected->second != szSize))
+    {
+        m_ui64BadSize++;
+    }
+
+    if(ui64Reports++)
+    {
+        uint64_t ui64Gap = ui64TimeUs - m_ui64LastUs;
+
+        m_ui64Intervals++;
+        m_ui64MinUs = std::min(m_ui64MinUs, ui64Gap);
+        m_ui64MaxUs = std::max(m_ui64MaxUs, ui64Gap);
+        m_dSum += (double)ui64Gap;
+        m_dSumSq += (double)ui64Gap * (double)ui64Gap;
+
+        if(ui64Gap < HIST_BUCKETS)
+        {
+            m_vHist[ui64Gap]++;
+        }
+        else
+        {
+            m_ui64Over++;
+        }
+    }
+    else
+    {
+        m_ui64FirstUs = ui64TimeUs;
+    }
+
+    m_ui64LastUs = ui64TimeUs;
+
+    std::vector<uint8_t> &vLast = m_mLast[ui8ID];
+
+    if((vLast.size() == szSize) && !memcmp(vLast.data(), pui8Report, szSize))
+    {
+        iStatus = eStatusDuplicate;
+        m_ui64Duplicates++;
+    }
+    else if(vLast.size() == szSize)
+    {
+        iStatus = eStatusRedundant;
+
+        for(const auto &sField : m_sLayout.vFields)
+        {
+            if(!sField.bConstant && (sField.ui8ReportID == ui8ID) &&
+               (FieldValue(sField, pui8Report, szSize) !=
+                FieldValue(sField, vLast.data(), szSize)))
+            {
+                iStatus = eStatusNew;
+                break;
+            }
+        }
+
+        if(iStatus == eStatusRedundant)
+        {
+            m_ui64Redundant++;
+        }
+    }
+
+    vLast.assign(pui8Report, pui8Report + szSize);
+
+    if((m_iSeqField >= 0) &&
+       (m_sLayout.vFields[m_iSeqField].ui8ReportID == ui8ID))
+    {
+        const tField &sField = m_sLayout.vFields[m_iSeqField];
+        uint64_t ui64Mask = (sField.ui32BitSize >= 64) ? ~0ULL :
+                            ((1ULL << sField.ui32BitSize) - 1);
+        uint64_t ui64Seq = (uint64_t)FieldValue(sField, pui8Report, szSize) &
+                           ui64Mask;
+        uint64_t ui64Step = (ui64Seq - m_ui64Seq) & ui64Mask;
+
+        if(m_bSeqValid)
+        {
+            if(ui64Step == 0)
+            {
+                m_ui64SeqRepeats++;
+            }
+            else if(ui64Step > (ui64Mask / 2))
+            {
+                m_ui64SeqBackwards++;
+            }
+            else if(ui64Step > 1)
+            {
+                m_ui64SeqGaps++;
+                m_ui64SeqMissing += ui64Step - 1;
+            }
+        }
+
+        m_bSeqValid = true;
+        m_ui64Seq = ui64Seq;
+    }
+
+    return(iStatus);
+}
+
+uint64_t tAnalysis::Percentile(double dFraction) const
+{
+    uint64_t ui64Want, ui64Seen = 0;
+
+    ui64Want = (uint64_t)std::ceil(dFraction * (double)m_ui64Intervals);
+
+    for(uint32_t ui32Bucket = 0; ui32Bucket < HIST_BUCKETS; ui32Bucket++)
+    {
+        ui64Seen += m_vHist[ui32Bucket];
+
+        if(ui64Seen && (ui64Seen >= ui64Want))
+        {
+            return(ui32Bucket);
+        }
+    }
+
+    return(m_ui64MaxUs);
+}
+
+void tAnalysis::Print(void) const
+{
+    double dSpan = (double)(m_ui64LastUs - m_ui64FirstUs) / 1e6;
+
+    printf("%llu reports over %.3fs", (unsigned long long)ui64Reports, dSpan);
+
+    if(dSpan > 0)
+    {
+        printf(", %.1f reports/s", (double)m_ui64Intervals / dSpan);
+    }
+
+    printf("\n%llu duplicate, %llu redundant, %llu with new input",
+           (unsigned long long)m_ui64Duplicates,
+           (unsigned long long)m_ui64Redundant,
+           (unsigned long long)(ui64Reports - m_ui64Duplicates -
+                                m_ui64Redundant));
+
+    if(m_ui64BadSize)
+    {
+        printf(", %llu not the size the descriptor gives",
+               (unsigned long long)m_ui64BadSize);
+    }
+
+    printf("\n");
+
+    if(m_ui64Intervals)
+    {
+        double dMean = m_dSum / (double)m_ui64Intervals;
+        double dVar = (m_dSumSq / (double)m_ui64Intervals) - (dMean * dMean);
+
+        printf("interval min %lluus mean %.1fus max %lluus jitter (stddev) "
+               "%.1fus\n", (unsigned long long)m_ui64MinUs, dMean,
+               (unsigned long long)m_ui64MaxUs, std::sqrt(std::max(dVar, 0.0)));
+        printf("  p50 %lluus p90 %lluus p99 %lluus p99.9 %lluus\n",
+               (unsigned long long)Percentile(0.5),
+               (unsigned long long)Percentile(0.9),
+               (unsigned long long)Percentile(0.99),
+               (unsigned long long)Percentile(0.999));
+    }
+
+    if(m_iSeqField >= 0)
+    {
+        printf("sequence %s: %llu gaps, %llu missing, %llu repeated, "
+               "%llu backwards\n",
+               m_sLayout.vFields[m_iSeqField].sName.c_str(),
+               (unsigned long long)m_ui64SeqGaps,
+               (unsigned long long)m_ui64SeqMissing,
+               (unsigned long long)m_ui64SeqRepeats,
+               (unsigned long long)m_ui64SeqBackwards);
+    }
+}
+
+bool tAnalysis::WriteJSON(const std::string &sFile) const
+{
+    FILE *pfJSON = fopen(sFile.c_str(), "w");
+    double dSpan = (double)(m_ui64LastUs - m_ui64FirstUs) / 1e6;
+    double dMean = 0, dVar = 0;
+    bool bFirst = true;
+
+    if(!pfJSON)
+    {
+        fprintf(stderr, "%s: %s\n", sFile.c_str(), strerror(errno));
+        return(false);
+    }
+
+    if(m_ui64Intervals)
+    {
+        dMean = m_dSum / (double)m_ui64Intervals;
+        dVar = std::max((m_dSumSq / (double)m_ui64Intervals) - (dMean * dMean),
+                        0.0);
+    }
+
+    fprintf(pfJSON, "{\n");
+    fprintf(pfJSON, " \"reports\": %llu,\n", (unsigned long long)ui64Reports);
+    fprintf(pfJSON, " \"seconds\": %.6f,\n", dSpan);
+    fprintf(pfJSON, " \"rate_hz\": %.3f,\n",
+            (dSpan > 0) ? ((double)m_ui64Intervals / dSpan) : 0.0);
+    fprintf(pfJSON, " \"duplicate\": %llu,\n",
+            (unsigned long long)m_ui64Duplicates);
+    fprintf(pfJSON, " \"redundant\": %llu,\n",
+            (unsigned long long)m_ui64Redundant);
+    fprintf(pfJSON, " \"bad_size\": %llu,\n", (unsigned long long)m_ui64BadSize);
+    fprintf(pfJSON, " \"interval_us\": {\"min\": %llu, \"mean\": %.3f, "
+            "\"max\": %llu, \"stddev\": %.3f, \"p50\": %llu, \"p90\": %llu, "
+            "\"p99\": %llu, \"p999\": %llu},\n",
+            (unsigned long long)(m_ui64Intervals ? m_ui64MinUs : 0), dMean,
+            (unsigned long long)m_ui64MaxUs, std::sqrt(dVar),
+            (unsigned long long)Percentile(0.5),
+            (unsigned long long)Percentile(0.9),
+            (unsigned long long)Percentile(0.99),
+            (unsigned long long)Percentile(0.999));
+
+    if(m_iSeqField >= 0)
+    {
+        fprintf(pfJSON, " \"sequence\": {\"field\": \"%s\", \"gaps\": %llu, "
+                "\"missing\": %llu, \"repeated\": %llu, \"backwards\": %llu},\n",
+                m_sLayout.vFields[m_iSeqField].sName.c_str(),
+                (unsigned long long)m_ui64SeqGaps,
+                (unsigned long long)m_ui64SeqMissing,
+                (unsigned long long)m_ui64SeqRepeats,
+                (unsigned long long)m_ui64SeqBackwards);
+    }
+
+    // sparse, interval in us to count
+    fprintf(pfJSON, " \"histogram_us\": {");
+
+    for(uint32_t ui32Bucket = 0; ui32Bucket < HIST_BUCKETS; ui32Bucket++)
+    {
+        if(m_vHist[ui32Bucket])
+        {
+            fprintf(pfJSON, "%s\"%u\": %llu", bFirst ? "" : ", ", ui32Bucket,
+                    (unsigned long long)m_vHist[ui32Bucket]);
+            bFirst = false;
+        }
+    }
+
+    fprintf(pfJSON, "},\n \"over_%u_us\": %llu\n}\n", HIST_BUCKETS,
+            (unsigned long long)m_ui64Over);
+    fclose(pfJSON);
+
+    return(true);
+}
+
+//*****************************************************************************
+//
+// Sources: a hidraw node, a --raw log or a report ring.
+//
+//*****************************************************************************
+volatile sig_atomic_t g_bStop;
+
+void Stop(int)
+{
+    g_bStop = 1;
+}
+
+uint64_t MonotonicUs(void)
+{
+    struct timespec sNow;
+
+    clock_gettime(CLOCK_MONOTONIC, &sNow);
+
+    return(((uint64_t)sNow.tv_sec * 1000000) + ((uint64_t)sNow.tv_nsec / 1000));
+}
+
+bool ReadFile(const std::string &sFile, std::vector<uint8_t> &vData)
+{
+    std::ifstream sIn(sFile, std::ios::binary);
+
+    if(!sIn)
+    {
+        fprintf(stderr, "%s: cannot open\n", sFile.c_str());
+        return(false);
+    }
+
+    vData.assign(std::istreambuf_iterator<char>(sIn),
+                 std::istreambuf_iterator<char>());
+
+    return(true);
+}
+
+bool DeviceDescriptor(int iFd, std::vector<uint8_t> &vDesc)
+{
+    struct hidraw_report_descriptor sDesc;
+    int iSize = 0;
+
+    if(ioctl(iFd, HIDIOCGRDESCSIZE, &iSize) < 0)
+    {
+        perror("HIDIOCGRDESCSIZE");
+        return(false);
+    }
+
+    memset(&sDesc, 0, sizeof(sDesc));
+    sDesc.size = (uint32_t)iSize;
+
+    if(ioctl(iFd, HIDIOCGRDESC, &sDesc) < 0)
+    {
+        perror("HIDIOCGRDESC");
+        return(false);
+    }
+
+    vDesc.assign(sDesc.value, sDesc.value + sDesc.size);
+
+    return(true);
+}
+
+// Parse one "time_us,hexbytes" line of a --raw log.
+bool RawLine(const std::string &sLine, uint64_t &ui64TimeUs,
+             std::vector<uint8_t> &vReport)
+{
+    size_t szComma = sLine.find(',');
+    char *pcEnd;
+
+    if(szComma == std::string::npos)
+    {
+        return(false);
+    }
+
+    ui64TimeUs = strtoull(sLine.c_str(), &pcEnd, 10);
+
+    if(pcEnd != (sLine.c_str() + szComma))
+    {
+        return(false);
+    }
+
+    vReport.clear();
+
+    for(size_t szPos = szComma + 1; (szPos + 1) < sLine.size(); szPos += 2)
+    {
+        vReport.push_back((uint8_t)strtoul(sLine.substr(szPos, 2).c_str(), 0,
+                                           16));
+    }
+
+    return(true);
+}
+
+//
+// Reads one gamepad's records from a report ring, taking the lanes in turn.
+// Each record is handed back to the producer as soon as it is read.
+//
+class tRingSource
+{
+public:
+    tRingSource() { memset(&m_sRing, 0, sizeof(m_sRing)); }
+    ~tRingSource() { ReportRingClose(&m_sRing); }
+
+    // Wait for the producer to make the ring.  Gives up at once if another
+    // consumer already has it.
+    bool Open(const std::string &sName)
+    {
+        while(!g_bStop)
+        {
+            if(ReportRingOpen(&m_sRing, sName.c_str()))
+            {
+                return(true);
+            }
+
+            if(errno == EBUSY)
+            {
+                fprintf(stderr, "%s: another consumer has the ring\n",
+                        sName.c_str());
+                return(false);
+            }
+
+            usleep(10000);
+        }
+
+        return(false);
+    }
+
+    void Descriptor(std::vector<uint8_t> &vDesc) const
+    {
+        vDesc.assign(m_sRing.psHeader->pui8Desc,
+                     m_sRing.psHeader->pui8Desc +
+                     m_sRing.psHeader->ui32DescSize);
+    }
+
+    // The next record of gamepad ui16Gamepad.  Returns false once the
+    // producer has closed the ring and it is empty, or on Ctrl-C.
+    bool Next(uint16_t ui16Gamepad, uint64_t &ui64TimeUs, uint8_t *pui8Report,
+              size_t &szSize)
+    {
+        const tReportRecord *psRecord;
+        uint32_t ui32Lanes = m_sRing.psHeader->ui32Lanes, ui32Empty = 0;
+        bool bDone = false;
+
+        while(!g_bStop)
+        {
+            m_ui32Lane = (m_ui32Lane + 1) % ui32Lanes;
+
+            if(ReportRingPeek(&m_sRing, m_ui32Lane, &psRecord))
+            {
+                bool bMine = (psRecord->ui16Gamepad == ui16Gamepad);
+
+                if(bMine)
+                {
+                    ui64TimeUs = psRecord->ui64TimeNs / 1000;
+                    szSize = psRecord->ui8Size;
+                    memcpy(pui8Report, psRecord->pui8Report, szSize);
+                }
+
+                ReportRingRelease(&m_sRing, m_ui32Lane, 1);
+                ui32Empty = 0;
+
+                if(bMine)
+                {
+                    return(true);
+                }
+
+                continue;
+            }
+
+            if(++ui32Empty < ui32Lanes)
+            {
+                continue;
+            }
+
+            // every lane was empty after the producer closed, so it is over
+            if(bDone)
+            {
+                return(false);
+            }
+
+            bDone = ReportRingDone(&m_sRing);
+            ui32Empty = 0;
+
+            if(!bDone)
+            {
+                usleep(100);
+            }
+        }
+
+        return(false);
+    }
+
+private:
+    tReportRing m_sRing;
+    uint32_t m_ui32Lane = 0;
+};
+
+struct tOptions
+{
+    std::string sDevice;
+    std::string sReplay;
+    std::string sRing;
+    std::string sDescriptor;
+    std::string sCSV;
+    std::string sJSON;
+    std::string sRaw;
+    std::string sSeq;
+    uint64_t ui64Count = 0;
+    uint16_t ui16Gamepad = 0;
+    double dSeconds = 0;
+    bool bLayout = false;
+};
+
+int Usage(void)
+{
+    fprintf(stderr,
+            "usage: hidraw_analyzer [--count N] [--seconds S] [--seq FIELD]\n"
+            "                       [--csv FILE] [--json FILE] [--raw FILE]\n"
+            "                       [--layout] /dev/hidrawN\n"
+            "       hidraw_analyzer [options] --replay raw.log "
+            "--rdesc descriptor.bin\n"
+            "       hidraw_analyzer [options] --ring NAME [--gamepad N]\n");
+    return(2);
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    tOptions sOpt;
+    std::vector<uint8_t> vDesc, vReport(HID_MAX_DESCRIPTOR_SIZE);
+    std::string sError;
+    tLayout sLayout;
+    FILE *pfCSV = 0, *pfRaw = 0;
+    std::ifstream sReplay;
+    tRingSource sRing;
+    int iFd = -1, iArg;
+
+    for(iArg = 1; iArg < argc; iArg++)
+    {
+        std::string sArg = argv[iArg];
+
+        if(sArg == "--layout")
+        {
+            sOpt.bLayout = true;
+            continue;
+        }
+
+        if(sArg[0] != '-')
+        {
+            if(!sOpt.sDevice.empty())
+            {
+                return(Usage());
+            }
+
+            sOpt.sDevice = sArg;
+            continue;
+        }
+
+        if((iArg + 1) >= argc)
+        {
+            return(Usage());
+        }
+
+        std::string sValue = argv[++iArg];
+
+        if(sArg == "--count") sOpt.ui64Count = strtoull(sValue.c_str(), 0, 0);
+        else if(sArg == "--seconds") sOpt.dSeconds = atof(sValue.c_str());
+        else if(sArg == "--seq") sOpt.sSeq = sValue;
+        else if(sArg == "--csv") sOpt.sCSV = sValue;
+        else if(sArg == "--json") sOpt.sJSON = sValue;
+        else if(sArg == "--raw") sOpt.sRaw = sValue;
+        else if(sArg == "--replay") sOpt.sReplay = sValue;
+        else if(sArg == "--rdesc") sOpt.sDescriptor = sValue;
+        else if(sArg == "--ring") sOpt.sRing = sValue;
+        else if(sArg == "--gamepad")
+            sOpt.ui16Gamepad = (uint16_t)strtoul(sValue.c_str(), 0, 0);
+        else return(Usage());
+    }
+
+    if((sOpt.sDevice.empty() + sOpt.sReplay.empty() + sOpt.sRing.empty()) !=
+       2)
+    {
+        return(Usage());
+    }
+
+    signal(SIGINT, Stop);
+    signal(SIGTERM, Stop);
+
+    //
+    // The descriptor comes from the device unless one is given.
+    //
+    if(!sOpt.sDevice.empty())
+    {
+        iFd = open(sOpt.sDevice.c_str(), O_RDONLY | O_CLOEXEC);
+
+        if(iFd < 0)
+        {
+            fprintf(stderr, "%s: %s\n", sOpt.sDevice.c_str(), strerror(errno));
+            return(1);
+        }
+    }
+
+    if(!sOpt.sRing.empty() && !sRing.Open(sOpt.sRing))
+    {
+        return(1);
+    }
+
+    if(!sOpt.sDescriptor.empty())
+    {
+        if(!ReadFile(sOpt.sDescriptor, vDesc))
+        {
+            return(1);
+        }
+    }
+    else if(!sOpt.sRing.empty())
+    {
+        sRing.Descriptor(vDesc);
+    }
+    else if(iFd < 0)
+    {
+        fprintf(stderr, "--replay needs --rdesc\n");
+        return(1);
+    }
+    else if(!DeviceDescriptor(iFd, vDesc))
+    {
+        return(1);
+    }
+
+    if(!sLayout.Parse(vDesc, sError))
+    {
+        fprintf(stderr, "%s\n", sError.c_str());
+        return(1);
+    }
+
+    if(sOpt.bLayout)
+    {
+        sLayout.Print();
+        return(0);
+    }
+
+    tAnalysis sAnalysis(sLayout);
+
+    if(!sOpt.sSeq.empty())
+    {
+        int iField = sLayout.FindField(sOpt.sSeq);
+
+        if(iField < 0)
+        {
+            fprintf(stderr, "no input field %s, see --layout\n",
+                    sOpt.sSeq.c_str());
+            return(1);
+        }
+
+        sAnalysis.SeqFieldSet(iField);
+    }
+
+    if(!sOpt.sCSV.empty())
+    {
+        if(!(pfCSV = fopen(sOpt.sCSV.c_str(), "w")))
+        {
+            fprintf(stderr, "%s: %s\n", sOpt.sCSV.c_str(), strerror(errno));
+            return(1);
+        }
+
+        fprintf(pfCSV, "time_us,interval_us,report_id,status");
+
+        for(const auto &sField : sLayout.vFields)
+        {
+            if(!sField.bConstant)
+            {
+                fprintf(pfCSV, ",%s", sField.sName.c_str());
+            }
+        }
+
+        fprintf(pfCSV, "\n");
+    }
+
+    if(!sOpt.sRaw.empty() && !(pfRaw = fopen(sOpt.sRaw.c_str(), "w")))
+    {
+        fprintf(stderr, "%s: %s\n", sOpt.sRaw.c_str(), strerror(errno));
+        return(1);
+    }
+
+    if(!sOpt.sReplay.empty())
+    {
+        sReplay.open(sOpt.sReplay);
+
+        if(!sReplay)
+        {
+            fprintf(stderr, "%s: cannot open\n", sOpt.sReplay.c_str());
+            return(1);
+        }
+    }
+
+    uint64_t ui64StartUs = MonotonicUs(), ui64PrevUs = 0;
+
+    while(!g_bStop &&
+          (!sOpt.ui64Count || (sAnalysis.ui64Reports < sOpt.ui64Count)))
+    {
+        uint64_t ui64TimeUs;
+        size_t szSize;
+
+        if(iFd >= 0)
+        {
+            struct pollfd sPoll = { iFd, POLLIN, 0 };
+            ssize_t iRead;
+
+            if((sOpt.dSeconds > 0) &&
+               ((MonotonicUs() - ui64StartUs) >= (sOpt.dSeconds * 1e6)))
+            {
+                break;
+            }
+
+            if(poll(&sPoll, 1, 100) <= 0)
+            {
+                continue;
+            }
+
+            iRead = read(iFd, vReport.data(), vReport.size());
+            ui64TimeUs = MonotonicUs();
+
+            if(iRead < 0)
+            {
+                if(errno != EINTR)
+                {
+                    perror("read");
+                    break;
+                }
+
+                continue;
+            }
+
+            szSize = (size_t)iRead;
+        }
+        else if(!sOpt.sRing.empty())
+        {
+            if(!sRing.Next(sOpt.ui16Gamepad, ui64TimeUs, vReport.data(),
+                           szSize))
+            {
+                break;
+            }
+
+            if(!sAnalysis.ui64Reports)
+            {
+                ui64StartUs = ui64TimeUs;
+            }
+
+            if((sOpt.dSeconds > 0) &&
+               ((ui64TimeUs - ui64StartUs) >= (sOpt.dSeconds * 1e6)))
+            {
+                break;
+            }
+        }
+        else
+        {
+            std::string sLine;
+            std::vector<uint8_t> vLine;
+
+            if(!std::getline(sReplay, sLine))
+            {
+                break;
+            }
+
+            if(!RawLine(sLine, ui64TimeUs, vLine))
+            {
+                continue;
+            }
+
+            if(!sAnalysis.ui64Reports)
+            {
+                ui64StartUs = ui64TimeUs;
+            }
+
+            if((sOpt.dSeconds > 0) &&
+               ((ui64TimeUs - ui64StartUs) >= (sOpt.dSeconds * 1e6)))
+            {
+                break;
+            }
+
+            szSize = std::min(vLine.size(), vReport.size());
+            std::copy(vLine.begin(), vLine.begin() + szSize, vReport.begin());
+        }
+
+        tStatus iStatus = sAnalysis.Add(ui64TimeUs, vReport.data(), szSize);
+
+        if(pfRaw)
+        {
+            fprintf(pfRaw, "%llu,", (unsigned long long)ui64TimeUs);
+
+            for(size_t szByte = 0; szByte < szSize; szByte++)
+            {
+                fprintf(pfRaw, "%02x", vReport[szByte]);
+            }
+
+            fprintf(pfRaw, "\n");
+        }
+
+        if(pfCSV)
+        {
+            const uint8_t *pui8Data = vReport.data();
+            size_t szData = szSize;
+            uint8_t ui8ID = 0;
+
+            if(sLayout.bReportIDs && szData)
+            {
+                ui8ID = *pui8Data++;
+                szData--;
+            }
+
+            fprintf(pfCSV, "%llu,%llu,%u,%s", (unsigned long long)ui64TimeUs,
+                    (unsigned long long)(ui64PrevUs ? (ui64TimeUs - ui64PrevUs) :
+                                                      0),
+                    ui8ID, g_ppcStatus[iStatus]);
+
+            for(const auto &sField : sLayout.vFields)
+            {
+                if(sField.bConstant)
+                {
+                    continue;
+                }
+
+                if(sField.ui8ReportID == ui8ID)
+                {
+                    fprintf(pfCSV, ",%lld",
+                            (long long)FieldValue(sField, pui8Data, szData));
+                }
+                else
+                {
+                    fprintf(pfCSV, ",");
+                }
+            }
+
+            fprintf(pfCSV, "\n");
+        }
+
+        ui64PrevUs = ui64TimeUs;
+    }
+
+    if(iFd >= 0)
+    {
+        close(iFd);
+    }
+
+    if(pfCSV)
+    {
+        fclose(pfCSV);
+    }
+
+    if(pfRaw)
+    {
+        fclose(pfRaw);
+    }
+
+    sAnalysis.Print();
+
+    if(!sOpt.sJSON.empty() && !sAnalysis.WriteJSON(sOpt.sJSON))
+    {
+        return(1);
+    }
+
+    return(0);
+}
@@ -0,0 +1,389 @@
+//*****************************************************************************
+//
+// report_ring.c - Shared memory ring of gamepad reports for local consumers.
+//
+// Copyright (c) Aditya Challamarad.  All rights reserved.
+//
+// See report_ring.h for the layout.  The producer publishes a record by
+// storing the head with release order after filling the slot, and the
+// consumer frees it by storing the tail with release order after reading
+// it.  The loads of the other side's index are acquire, so a record is never
+// seen half written or overwritten while it is being read.
+//
+//*****************************************************************************
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <signal.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "report_ring.h"
+
+_Static_assert(sizeof(tReportRecord) == 16, "record layout");
+_Static_assert(sizeof(tReportLane) == 128, "lane layout");
+_Static_assert((sizeof(tReportRingHeader) % 64) == 0, "header layout");
+
+#define LOAD_ACQUIRE(pui64)     __atomic_load_n(pui64, __ATOMIC_ACQUIRE)
+#define STORE_RELEASE(pui64, v) __atomic_store_n(pui64, v, __ATOMIC_RELEASE)
+
+// Shared memory object names start with a slash.
+static void RingName(tReportRing *psRing, const char *pcName)
+{
+    snprintf(psRing->pcName, sizeof(psRing->pcName), "%s%s",
+             (pcName[0] == '/') ? "" : "/", pcName);
+}
+
+static size_t RingSize(uint32_t ui32Lanes, uint32_t ui32Slots)
+{
+    return(sizeof(tReportRingHeader) + (ui32Lanes * sizeof(tReportLane)) +
+           ((size_t)ui32Lanes * ui32Slots * sizeof(tReportRecord)));
+}
+
+// Find the lanes and records in a mapping, and make the local index cache.
+static bool RingMap(tReportRing *psRing, void *pvMap, size_t szMap)
+{
+    tReportRingHeader *psHeader = (tReportRingHeader *)pvMap;
+
+    psRing->psHeader = psHeader;
+    psRing->szMap = szMap;
+    psRing->psLanes = (tReportLane *)(psHeader + 1);
+    psRing->psRecords = (tReportRecord *)(psRing->psLanes +
+                                          psHeader->ui32Lanes);
+    psRing->pui64Seen = calloc(psHeader->ui32Lanes, sizeof(uint64_t));
+
+    return(psRing->pui64Seen != 0);
+}
+
+// Create the ring pcName with ui32Lanes lanes of ui32Slots records each, a
+// power of two.  An old ring of the same name is replaced.
+bool ReportRingCreate(tReportRing *psRing, const char *pcName,
+                      uint32_t ui32Lanes, uint32_t ui32Slots,
+                      const uint8_t *pui8Desc, uint32_t ui32DescSize)
+{
+    tReportRingHeader *psHeader;
+    size_t szMap;
+    void *pvMap;
+    int iFd;
+
+    memset(psRing, 0, sizeof(*psRing));
+
+    if(!ui32Lanes || (ui32Lanes > REPORT_RING_LANES_MAX) || !ui32Slots ||
+       (ui32Slots & (ui32Slots - 1)) || (ui32DescSize > REPORT_RING_DESC_MAX))
+    {
+        fprintf(stderr, "%s: bad ring size\n", pcName);
+        return(false);
+    }
+
+    RingName(psRing, pcName);
+    shm_unlink(psRing->pcName);
+
+    iFd = shm_open(psRing->pcName, O_RDWR | O_CREAT | O_EXCL, 0644);
+
+    if(iFd < 0)
+    {
+        fprintf(stderr, "%s: %s\n", psRing->pcName, strerror(errno));
+        return(false);
+    }
+
+    szMap = RingSize(ui32Lanes, ui32Slots);
+
+    if(ftruncate(iFd, (off_t)szMap) < 0)
+    {
+        fprintf(stderr, "%s: %s\n", psRing->pcName, strerror(errno));
+        close(iFd);
+        shm_unlink(psRing->pcName);
+        return(false);
+    }
+
+    pvMap = mmap(0, szMap, PROT_READ | PROT_WRITE, MAP_SHARED, iFd, 0);
+    close(iFd);
+
+    if(pvMap == MAP_FAILED)
+    {
+        fprintf(stderr, "%s: %s\n", psRing->pcName, strerror(errno));
+        shm_unlink(psRing->pcName);
+        return(false);
+    }
+
+    // the object starts zeroed, so every lane starts empty
+    psHeader = (tReportRingHeader *)pvMap;
+    psHeader->ui32Version = REPORT_RING_VERSION;
+    psHeader->ui32Lanes = ui32Lanes;
+    psHeader->ui32Slots = ui32Slots;
+    psHeader->ui32RecordSize = sizeof(tReportRecord);
+    psHeader->ui32DescSize = ui32DescSize;
+    memcpy(psHeader->pui8Desc, pui8Desc, ui32DescSize);
+
+    psRing->bProducer = true;
+
+    if(!RingMap(psRing, pvMap, szMap))
+    {
+        ReportRingClose(psRing);
+        return(false);
+    }
+
+    // the magic last, a consumer that sees it sees the rest
+    __atomic_store_n(&psHeader->ui32Magic, REPORT_RING_MAGIC, __ATOMIC_RELEASE);
+
+    return(true);
+}
+
+// Take every lane for this process.  A lane held by a process that has
+// gone is taken over.  Returns false, with none taken, if another consumer
+// has any of them.
+static bool RingClaim(tReportRing *psRing)
+{
+    uint32_t ui32Lanes = psRing->psHeader->ui32Lanes, ui32Lane, ui32Owner;
+    uint32_t ui32Self = (uint32_t)getpid();
+
+    for(ui32Lane = 0; ui32Lane < ui32Lanes; ui32Lane++)
+    {
+        ui32Owner = 0;
+
+        while(!__atomic_compare_exchange_n(
+                   &psRing->psLanes[ui32Lane].ui32Consumer, &ui32Owner,
+                   ui32Self, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+        {
+            // ui32Owner now holds the current consumer, try again over it if
+            // it has gone
+            if((kill((pid_t)ui32Owner, 0) < 0) && (errno == ESRCH))
+            {
+                continue;
+            }
+
+            while(ui32Lane--)
+            {
+                __atomic_store_n(&psRing->psLanes[ui32Lane].ui32Consumer, 0,
+                                 __ATOMIC_RELEASE);
+            }
+
+            return(false);
+        }
+
+        // a consumer before this one may have moved the tail, start from it
+        psRing->pui64Seen[ui32Lane] =
+            __atomic_load_n(&psRing->psLanes[ui32Lane].ui64Tail,
+                            __ATOMIC_ACQUIRE);
+    }
+
+    return(true);
+}
+
+// Give back the lanes this process took.
+static void RingUnclaim(tReportRing *psRing)
+{
+    uint32_t ui32Lanes = psRing->psHeader->ui32Lanes, ui32Lane, ui32Owner;
+
+    for(ui32Lane = 0; ui32Lane < ui32Lanes; ui32Lane++)
+    {
+        ui32Owner = (uint32_t)getpid();
+
+        __atomic_compare_exchange_n(&psRing->psLanes[ui32Lane].ui32Consumer,
+                                    &ui32Owner, 0, false, __ATOMIC_RELEASE,
+                                    __ATOMIC_RELAXED);
+    }
+}
+
+// Map an existing ring to consume it.  Fails quietly, with errno ENOENT, if
+// there is no such ring yet, so callers can wait for the producer.  Fails
+// with errno EBUSY if another process is consuming it.
+bool ReportRingOpen(tReportRing *psRing, const char *pcName)
+{
+    tReportRingHeader *psHeader;
+    struct stat sStat;
+    void *pvMap;
+    int iFd;
+
+    memset(psRing, 0, sizeof(*psRing));
+    RingName(psRing, pcName);
+
+    iFd = shm_open(psRing->pcName, O_RDWR, 0);
+
+    if(iFd < 0)
+    {
+        return(false);
+    }
+
+    if((fstat(iFd, &sStat) < 0) ||
+       ((size_t)sStat.st_size < sizeof(tReportRingHeader)))
+    {
+        close(iFd);
+        errno = ENOENT;
+        return(false);
+    }
+
+    pvMap = mmap(0, (size_t)sStat.st_size, PROT_READ | PROT_WRITE, MAP_SHARED,
+                 iFd, 0);
+    close(iFd);
+
+    if(pvMap == MAP_FAILED)
+    {
+        errno = ENOENT;
+        return(false);
+    }
+
+    psHeader = (tReportRingHeader *)pvMap;
+
+    if((__atomic_load_n(&psHeader->ui32Magic, __ATOMIC_ACQUIRE) !=
+        REPORT_RING_MAGIC) ||
+       (psHeader->ui32Version != REPORT_RING_VERSION) ||
+       (psHeader->ui32RecordSize != sizeof(tReportRecord)) ||
+       !psHeader->ui32Lanes || (psHeader->ui32Lanes > REPORT_RING_LANES_MAX) ||
+       !psHeader->ui32Slots ||
+       (psHeader->ui32Slots & (psHeader->ui32Slots - 1)) ||
+       (psHeader->ui32DescSize > REPORT_RING_DESC_MAX) ||
+       (RingSize(psHeader->ui32Lanes, psHeader->ui32Slots) >
+        (size_t)sStat.st_size))
+    {
+        munmap(pvMap, (size_t)sStat.st_size);
+        errno = ENOENT;
+        return(false);
+    }
+
+    if(!RingMap(psRing, pvMap, (size_t)sStat.st_size))
+    {
+        munmap(pvMap, (size_t)sStat.st_size);
+        errno = ENOMEM;
+        return(false);
+    }
+
+    if(!RingClaim(psRing))
+    {
+        munmap(pvMap, (size_t)sStat.st_size);
+        free(psRing->pui64Seen);
+        memset(psRing, 0, sizeof(*psRing));
+        errno = EBUSY;
+        return(false);
+    }
+
+    return(true);
+}
+
+// Unmap the ring.  The producer marks it closed first and removes the name,
+// consumers already attached keep reading what is left.
+void ReportRingClose(tReportRing *psRing)
+{
+    if(!psRing->psHeader)
+    {
+        return;
+    }
+
+    if(psRing->bProducer)
+    {
+        __atomic_or_fetch(&psRing->psHeader->ui32Flags, REPORT_RING_CLOSED,
+                          __ATOMIC_RELEASE);
+        shm_unlink(psRing->pcName);
+    }
+    else
+    {
+        RingUnclaim(psRing);
+    }
+
+    munmap(psRing->psHeader, psRing->szMap);
+    free(psRing->pui64Seen);
+    psRing->psHeader = 0;
+    psRing->pui64Seen = 0;
+}
+
+// Publish one report to a lane.  Returns false, and counts the report as
+// dropped, if the lane is full.
+bool ReportRingPush(tReportRing *psRing, uint32_t ui32Lane,
+                    uint64_t ui64TimeNs, uint16_t ui16Gamepad,
+                    const uint8_t *pui8Report, uint32_t ui32Size)
+{
+    tReportLane *psLane = &psRing->psLanes[ui32Lane];
+    uint32_t ui32Slots = psRing->psHeader->ui32Slots;
+    tReportRecord *psRecord;
+    uint64_t ui64Head;
+
+    // only this side writes the head
+    ui64Head = psLane->ui64Head;
+
+    if((ui64Head - psRing->pui64Seen[ui32Lane]) >= ui32Slots)
+    {
+        psRing->pui64Seen[ui32Lane] = LOAD_ACQUIRE(&psLane->ui64Tail);
+
+        if((ui64Head - psRing->pui64Seen[ui32Lane]) >= ui32Slots)
+        {
+            STORE_RELEASE(&psLane->ui64Dropped, psLane->ui64Dropped + 1);
+            return(false);
+        }
+    }
+
+    if(ui32Size > REPORT_RING_REPORT_MAX)
+    {
+        ui32Size = REPORT_RING_REPORT_MAX;
+    }
+
+    psRecord = &psRing->psRecords[((size_t)ui32Lane * ui32Slots) +
+                                  (ui64Head & (ui32Slots - 1))];
+    psRecord->ui64TimeNs = ui64TimeNs;
+    psRecord->ui16Gamepad = ui16Gamepad;
+    psRecord->ui8Size = (uint8_t)ui32Size;
+    memcpy(psRecord->pui8Report, pui8Report, ui32Size);
+
+    STORE_RELEASE(&psLane->ui64Head, ui64Head + 1);
+
+    return(true);
+}
+
+// Point *ppsRecords at the oldest unread records of a lane, in place.
+// Returns how many there are in a row, up to the end of the lane's storage;
+// the rest come from the next call.
+uint32_t ReportRingPeek(tReportRing *psRing, uint32_t ui32Lane,
+                        const tReportRecord **ppsRecords)
+{
+    tReportLane *psLane = &psRing->psLanes[ui32Lane];
+    uint32_t ui32Slots = psRing->psHeader->ui32Slots;
+    uint64_t ui64Tail, ui64Ready;
+    uint32_t ui32Slot;
+
+    // only this side writes the tail
+    ui64Tail = psLane->ui64Tail;
+
+    if(psRing->pui64Seen[ui32Lane] == ui64Tail)
+    {
+        psRing->pui64Seen[ui32Lane] = LOAD_ACQUIRE(&psLane->ui64Head);
+
+        if(psRing->pui64Seen[ui32Lane] == ui64Tail)
+        {
+            return(0);
+        }
+    }
+
+    ui32Slot = (uint32_t)(ui64Tail & (ui32Slots - 1));
+    ui64Ready = psRing->pui64Seen[ui32Lane] - ui64Tail;
+
+    if(ui64Ready > (ui32Slots - ui32Slot))
+    {
+        ui64Ready = ui32Slots - ui32Slot;
+    }
+
+    *ppsRecords = &psRing->psRecords[((size_t)ui32Lane * ui32Slots) +
+                                     ui32Slot];
+
+    return((uint32_t)ui64Ready);
+}
+
+// Hand ui32Count records read with ReportRingPeek() back to the producer.
+void ReportRingRelease(tReportRing *psRing, uint32_t ui32Lane,
+                       uint32_t ui32Count)
+{
+    tReportLane *psLane = &psRing->psLanes[ui32Lane];
+
+    STORE_RELEASE(&psLane->ui64Tail, psLane->ui64Tail + ui32Count);
+}
+
+// True once the producer has closed the ring.  Records it published before
+// closing can still be read.
+bool ReportRingDone(const tReportRing *psRing)
+{
+    return((__atomic_load_n(&psRing->psHeader->ui32Flags, __ATOMIC_ACQUIRE) &
+            REPORT_RING_CLOSED) != 0);
+}
@@ -0,0 +1,130 @@
+//*****************************************************************************
+//
+// report_ring.h - Shared memory ring of gamepad reports for local consumers.
+//
+// Copyright (c) Aditya Challamarad.  All rights reserved.
+//
+// A producer, the simulator or the load generator, publishes every report
+// the host receives into a POSIX shared memory object, where analyzers and
+// test harnesses on the same machine read them in place.  Nothing on either
+// side makes a system call or copies a report once the ring is mapped.
+//
+// The ring is split into lanes, one per producing thread or process, and
+// each lane has exactly one producer and one consumer.  The producer only
+// writes the head and the consumer only writes the tail, so a lane needs no
+// locks, just ordered loads and stores.  A full lane drops the new report
+// and counts it, a producer never waits for a consumer.
+//
+// A consumer claims every lane when it opens the ring, by swapping its
+// process ID into each one, and gives them back when it closes it.  A second
+// consumer is refused while the first is alive, rather than both moving the
+// tails.  The claim of a process that died is taken over.
+//
+// The header carries the report descriptor, so a consumer can decode the
+// reports without asking the device.
+//
+//*****************************************************************************
+
+#ifndef __REPORT_RING_H__
+#define __REPORT_RING_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define REPORT_RING_MAGIC       0x52475052  // "RPGR"
+#define REPORT_RING_VERSION     2
+
+#define REPORT_RING_LANES_MAX   256
+#define REPORT_RING_DESC_MAX    1024
+#define REPORT_RING_REPORT_MAX  5
+
+// The producer has finished, nothing more will be published.
+#define REPORT_RING_CLOSED      0x00000001
+
+//
+// One report.  pui8Report holds the tGamepadReport bytes as they went on the
+// wire: x, y, LT, RT and the buttons.  ui64TimeNs is the producer's time the
+// host received it, simulated time from the start of the run.
+//
+typedef struct
+{
+    uint64_t ui64TimeNs;
+    uint16_t ui16Gamepad;
+    uint8_t ui8Size;
+    uint8_t pui8Report[REPORT_RING_REPORT_MAX];
+} __attribute__((packed)) tReportRecord;
+
+//
+// The indexes of one lane.  Both count records from the start and never
+// wrap, the slot is the index modulo the lane size.  Each sits on its own
+// cache line so the two sides do not share one.  ui32Consumer is the process
+// ID of the consumer that has the lane, 0 for none.
+//
+typedef struct
+{
+    uint64_t ui64Head;
+    uint64_t ui64Dropped;
+    uint8_t pui8Pad0[48];
+    uint64_t ui64Tail;
+    uint32_t ui32Consumer;
+    uint8_t pui8Pad1[52];
+} tReportLane;
+
+//
+// The start of the shared memory object.  The lanes follow, then the
+// records of each lane in turn.
+//
+typedef struct
+{
+    uint32_t ui32Magic;
+    uint32_t ui32Version;
+    uint32_t ui32Lanes;
+    uint32_t ui32Slots;
+    uint32_t ui32RecordSize;
+    uint32_t ui32Flags;
+    uint32_t ui32DescSize;
+    uint8_t pui8Pad[36];
+    uint8_t pui8Desc[REPORT_RING_DESC_MAX];
+} tReportRingHeader;
+
+//
+// One process's mapping of a ring.  pui64Seen caches the other side's index
+// of each lane, so the shared one is only read when the cached one says the
+// lane is full, or empty.
+//
+typedef struct
+{
+    tReportRingHeader *psHeader;
+    tReportLane *psLanes;
+    tReportRecord *psRecords;
+    uint64_t *pui64Seen;
+    size_t szMap;
+    bool bProducer;
+    char pcName[64];
+} tReportRing;
+
+extern bool ReportRingCreate(tReportRing *psRing, const char *pcName,
+                             uint32_t ui32Lanes, uint32_t ui32Slots,
+                             const uint8_t *pui8Desc, uint32_t ui32DescSize);
+extern bool ReportRingOpen(tReportRing *psRing, const char *pcName);
+extern void ReportRingClose(tReportRing *psRing);
+extern bool ReportRingPush(tReportRing *psRing, uint32_t ui32Lane,
+                           uint64_t ui64TimeNs, uint16_t ui16Gamepad,
+                           const uint8_t *pui8Report, uint32_t ui32Size);
+extern uint32_t ReportRingPeek(tReportRing *psRing, uint32_t ui32Lane,
+                               const tReportRecord **ppsRecords);
+extern void ReportRingRelease(tReportRing *psRing, uint32_t ui32Lane,
+                              uint32_t ui32Count);
+extern bool ReportRingDone(const tReportRing *psRing);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __REPORT_RING_H__
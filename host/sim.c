@@ -0,0 +1,580 @@
+//*****************************************************************************
+//
+// sim.c - Simulated time, interrupts, pins and ADC for the host build.
+//
+// Copyright (c) Aditya Challamarad.  All rights reserved.
+//
+//*****************************************************************************
+
+#include <setjmp.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "inc/hw_ints.h"
+#include "inc/hw_memmap.h"
+#include "inc/hw_types.h"
+#include "driverlib/gpio.h"
+#include "driverlib/pin_map.h"
+#include "drivers/cycles.h"
+#include "board.h"
+#include "hal.h"
+#include "sim.h"
+
+HAL_HOST_STATE;
+
+tSimConfig g_sSimConfig;
+tSimStats g_sSimStats;
+uint64_t g_ui64SimNow;
+
+//*****************************************************************************
+//
+// Event queue, a binary heap ordered by time and then by the order events
+// were scheduled in, so equal times always fire the same way round.
+//
+//*****************************************************************************
+#define SIM_MAX_EVENTS          1024
+
+typedef struct
+{
+    uint64_t ui64Time;
+    uint64_t ui64Seq;
+    tSimEvent pfnEvent;
+    uint32_t ui32Arg;
+} tSimQueued;
+
+static tSimQueued g_psSimQueue[SIM_MAX_EVENTS];
+static uint32_t g_ui32SimQueued;
+static uint64_t g_ui64SimSeq;
+
+static bool SimBefore(const tSimQueued *psA, const tSimQueued *psB)
+{
+    if(psA->ui64Time != psB->ui64Time)
+    {
+        return(psA->ui64Time < psB->ui64Time);
+    }
+
+    return(psA->ui64Seq < psB->ui64Seq);
+}
+
+void SimSchedule(uint64_t ui64Time, tSimEvent pfnEvent, uint32_t ui32Arg)
+{
+    tSimQueued sEvent, *psQueue = g_psSimQueue;
+    uint32_t ui32Idx;
+
+    if(g_ui32SimQueued == SIM_MAX_EVENTS)
+    {
+        SimStop("event queue full");
+    }
+
+    sEvent.ui64Time = (ui64Time < g_ui64SimNow) ? g_ui64SimNow : ui64Time;
+    sEvent.ui64Seq = g_ui64SimSeq++;
+    sEvent.pfnEvent = pfnEvent;
+    sEvent.ui32Arg = ui32Arg;
+
+    // sift up
+    for(ui32Idx = g_ui32SimQueued++; ui32Idx; ui32Idx = (ui32Idx - 1) / 2)
+    {
+        if(!SimBefore(&sEvent, &psQueue[(ui32Idx - 1) / 2]))
+        {
+            break;
+        }
+
+        psQueue[ui32Idx] = psQueue[(ui32Idx - 1) / 2];
+    }
+
+    psQueue[ui32Idx] = sEvent;
+}
+
+static void SimPop(tSimQueued *psEvent)
+{
+    tSimQueued *psQueue = g_psSimQueue;
+    uint32_t ui32Idx, ui32Child;
+
+    *psEvent = psQueue[0];
+
+    // sift the last entry down from the top
+    g_ui32SimQueued--;
+
+    for(ui32Idx = 0; ; ui32Idx = ui32Child)
+    {
+        ui32Child = (2 * ui32Idx) + 1;
+
+        if(ui32Child >= g_ui32SimQueued)
+        {
+            break;
+        }
+
+        if(((ui32Child + 1) < g_ui32SimQueued) &&
+           SimBefore(&psQueue[ui32Child + 1], &psQueue[ui32Child]))
+        {
+            ui32Child++;
+        }
+
+        if(!SimBefore(&psQueue[ui32Child], &psQueue[g_ui32SimQueued]))
+        {
+            break;
+        }
+
+        psQueue[ui32Idx] = psQueue[ui32Child];
+    }
+
+    psQueue[ui32Idx] = psQueue[g_ui32SimQueued];
+}
+
+//*****************************************************************************
+//
+// Running and stopping.  SimStop() unwinds straight out of the firmware,
+// which otherwise never returns from main().
+//
+//*****************************************************************************
+static jmp_buf g_sSimExit;
+static const char *g_pcSimStopped;
+
+void SimStop(const char *pcReason)
+{
+    g_pcSimStopped = pcReason;
+    longjmp(g_sSimExit, 1);
+}
+
+// Fire every event due by ui64Until, then settle on it.
+static void SimRunTo(uint64_t ui64Until)
+{
+    tSimQueued sEvent;
+
+    if(ui64Until > g_sSimConfig.ui64EndNs)
+    {
+        ui64Until = g_sSimConfig.ui64EndNs;
+    }
+
+    while(g_ui32SimQueued && (g_psSimQueue[0].ui64Time <= ui64Until))
+    {
+        SimPop(&sEvent);
+        g_ui64SimNow = sEvent.ui64Time;
+        g_sHALHost.ui32USBFrame = (uint32_t)(g_ui64SimNow / SIM_MS);
+        sEvent.pfnEvent(sEvent.ui32Arg);
+        SimIntDispatch();
+    }
+
+    g_ui64SimNow = ui64Until;
+    g_sHALHost.ui32USBFrame = (uint32_t)(g_ui64SimNow / SIM_MS);
+
+    if(g_ui64SimNow >= g_sSimConfig.ui64EndNs)
+    {
+        SimStop("end of run");
+    }
+}
+
+void SimAdvance(uint64_t ui64Ns)
+{
+    SimRunTo(g_ui64SimNow + ui64Ns);
+}
+
+// Wait for interrupt.  Moves time on to the next event until an interrupt
+// is pending, masked or not.
+void SimIdle(void)
+{
+    while(!SimIntPending())
+    {
+        if(!g_ui32SimQueued)
+        {
+            SimStop("asleep with nothing left to wake it");
+        }
+
+        SimRunTo(g_psSimQueue[0].ui64Time);
+    }
+}
+
+static void SimLoop(void)
+{
+    g_sSimStats.ui64LoopPasses++;
+    SimAdvance(g_sSimConfig.ui64LoopNs);
+}
+
+static void SimPoll(void)
+{
+    SimAdvance(SIM_POLL_NS);
+}
+
+//*****************************************************************************
+//
+// Interrupt controller.  Every vector the firmware uses has the same
+// priority, so pending interrupts are taken in vector order and none
+// preempts another.
+//
+//*****************************************************************************
+extern void SuspendGPIOIntHandler(void);
+extern void SuspendTimerIntHandler(void);
+extern void SupervisorIntHandler(void);
+extern void RGBBlinkIntHandler(void);
+extern void ReplayTimerIntHandler(void);
+extern void MacroTimerIntHandler(void);
+
+bool g_bSimMasked = true;
+
+static void (*g_ppfnSimVectors[NUM_INTERRUPTS])(void);
+static bool g_pbSimEnabled[NUM_INTERRUPTS];
+static bool g_pbSimPending[NUM_INTERRUPTS];
+static bool g_bSimInHandler;
+
+void SimIntRaise(uint32_t ui32Int)
+{
+    g_pbSimPending[ui32Int] = true;
+}
+
+bool SimIntPending(void)
+{
+    uint32_t ui32Int;
+
+    for(ui32Int = 0; ui32Int < NUM_INTERRUPTS; ui32Int++)
+    {
+        if(g_pbSimPending[ui32Int] && g_pbSimEnabled[ui32Int])
+        {
+            return(true);
+        }
+    }
+
+    return(false);
+}
+
+void SimIntDispatch(void)
+{
+    uint32_t ui32Int;
+
+    if(g_bSimMasked || g_bSimInHandler)
+    {
+        return;
+    }
+
+    for(ui32Int = 0; ui32Int < NUM_INTERRUPTS; ui32Int++)
+    {
+        if(!g_pbSimPending[ui32Int] || !g_pbSimEnabled[ui32Int])
+        {
+            continue;
+        }
+
+        g_pbSimPending[ui32Int] = false;
+        g_sSimStats.ui64Interrupts++;
+
+        if(g_ppfnSimVectors[ui32Int])
+        {
+            g_bSimInHandler = true;
+            g_ppfnSimVectors[ui32Int]();
+            g_bSimInHandler = false;
+        }
+
+        // the handler may have raised or unmasked more, start over
+        ui32Int = (uint32_t)-1;
+
+        if(g_bSimMasked)
+        {
+            break;
+        }
+    }
+}
+
+void SimIntEnable(uint32_t ui32Int, bool bEnable)
+{
+    g_pbSimEnabled[ui32Int] = bEnable;
+}
+
+bool SimIntEnabled(uint32_t ui32Int)
+{
+    return(g_pbSimEnabled[ui32Int]);
+}
+
+void SimIntRegister(uint32_t ui32Int, void (*pfnHandler)(void))
+{
+    g_ppfnSimVectors[ui32Int] = pfnHandler;
+}
+
+//*****************************************************************************
+//
+// System clock.  The cycle counter keeps counting across clock changes, so
+// the cycles so far are banked whenever the clock changes.
+//
+//*****************************************************************************
+static uint32_t g_ui32SimClock;
+static uint64_t g_ui64SimCycleBase;
+static uint64_t g_ui64SimClockSince;
+
+uint32_t SimClockGet(void)
+{
+    return(g_ui32SimClock);
+}
+
+uint64_t SimCycles(void)
+{
+    return(g_ui64SimCycleBase +
+           (((g_ui64SimNow - g_ui64SimClockSince) * g_ui32SimClock) / SIM_S));
+}
+
+void SimClockSet(uint32_t ui32Hz)
+{
+    g_ui64SimCycleBase = SimCycles();
+    g_ui64SimClockSince = g_ui64SimNow;
+    g_ui32SimClock = ui32Hz;
+}
+
+//*****************************************************************************
+//
+// Register file.  Every HWREG() lands here, registers nothing models just
+// keep what was written.
+//
+//*****************************************************************************
+#define SIM_REGS                512
+
+static uint32_t g_pui32SimRegAddr[SIM_REGS];
+static uint32_t g_pui32SimRegValue[SIM_REGS];
+
+// The cycle counter is read twice per main loop pass, so it skips the
+// lookup.
+static uint32_t g_ui32SimCycleReg;
+
+volatile uint32_t *SimReg(uint32_t ui32Addr)
+{
+    uint32_t ui32Slot;
+
+    if(ui32Addr == CYCLES_DWT_CYCCNT)
+    {
+        g_ui32SimCycleReg = (uint32_t)SimCycles();
+        return(&g_ui32SimCycleReg);
+    }
+
+    ui32Slot = ((ui32Addr >> 2) * 2654435761u) % SIM_REGS;
+
+    while(g_pui32SimRegAddr[ui32Slot] &&
+          (g_pui32SimRegAddr[ui32Slot] != ui32Addr))
+    {
+        ui32Slot = (ui32Slot + 1) % SIM_REGS;
+    }
+
+    g_pui32SimRegAddr[ui32Slot] = ui32Addr;
+
+    return(&g_pui32SimRegValue[ui32Slot]);
+}
+
+//*****************************************************************************
+//
+// GPIO.  Levels live in the HAL state, an edge on a pin with its interrupt
+// enabled raises the port's interrupt.
+//
+//*****************************************************************************
+static const uint32_t g_pui32SimPortInt[HAL_HOST_PORTS] =
+{
+    INT_GPIOA, INT_GPIOB, INT_GPIOC, INT_GPIOD, INT_GPIOE, INT_GPIOF
+};
+
+static uint8_t g_pui8SimPinInt[HAL_HOST_PORTS];
+
+void SimPinSet(uint32_t ui32Port, uint8_t ui8Pins, bool bHigh)
+{
+    uint32_t ui32Idx = HALHostPort(ui32Port);
+    uint8_t ui8Old = g_sHALHost.pui8GPIO[ui32Idx];
+
+    g_sHALHost.pui8GPIO[ui32Idx] = bHigh ? (ui8Old | ui8Pins) :
+                                           (ui8Old & ~ui8Pins);
+
+    if((ui8Old ^ g_sHALHost.pui8GPIO[ui32Idx]) & g_pui8SimPinInt[ui32Idx])
+    {
+        SimIntRaise(g_pui32SimPortInt[ui32Idx]);
+    }
+}
+
+void SimPinIntEnable(uint32_t ui32Port, uint8_t ui8Pins, bool bEnable)
+{
+    uint32_t ui32Idx = HALHostPort(ui32Port);
+
+    if(bEnable)
+    {
+        g_pui8SimPinInt[ui32Idx] |= ui8Pins;
+    }
+    else
+    {
+        g_pui8SimPinInt[ui32Idx] &= ~ui8Pins;
+    }
+}
+
+//*****************************************************************************
+//
+// ADC sequencer 0.  A trigger converts every configured step after the
+// conversion time, from the analog levels at the end of it.
+//
+//*****************************************************************************
+#define SIM_ADC_CHANNELS        12
+
+static uint32_t g_pui32SimAnalog[SIM_ADC_CHANNELS];
+static uint32_t g_pui32SimADCStep[HAL_HOST_ADC_STEPS];
+static uint32_t g_ui32SimADCSteps;
+static bool g_bSimADCBusy;
+
+void SimAnalogSet(uint32_t ui32Channel, uint32_t ui32Value)
+{
+    g_pui32SimAnalog[ui32Channel] = (ui32Value > 4095) ? 4095 : ui32Value;
+}
+
+void SimADCStepSet(uint32_t ui32Step, uint32_t ui32Channel, bool bEnd)
+{
+    g_pui32SimADCStep[ui32Step] = ui32Channel % SIM_ADC_CHANNELS;
+
+    if(bEnd)
+    {
+        g_ui32SimADCSteps = ui32Step + 1;
+    }
+}
+
+static void SimADCDone(uint32_t ui32Arg)
+{
+    uint32_t ui32Step;
+
+    (void)ui32Arg;
+
+    for(ui32Step = 0; ui32Step < g_ui32SimADCSteps; ui32Step++)
+    {
+        g_sHALHost.pui32ADC[ui32Step] =
+            g_pui32SimAnalog[g_pui32SimADCStep[ui32Step]];
+    }
+
+    g_sHALHost.ui32ADCSteps = g_ui32SimADCSteps;
+    g_sHALHost.bADCDone = true;
+    g_bSimADCBusy = false;
+}
+
+// A trigger while a conversion is running is ignored, as on the target.
+static void SimADCTrigger(void)
+{
+    if(g_bSimADCBusy)
+    {
+        return;
+    }
+
+    g_bSimADCBusy = true;
+    SimSchedule(g_ui64SimNow + g_sSimConfig.ui64ADCNs, SimADCDone, 0);
+}
+
+//*****************************************************************************
+//
+// The board pins by their name in board.h, with the ADC channel of analog
+// pins.
+//
+//*****************************************************************************
+typedef struct
+{
+    const char *pcName;
+    uint32_t ui32Port;
+    uint8_t ui8Pin;
+    uint8_t ui8Port;
+} tSimPin;
+
+#define SIM_PIN_ENTRY(x, y, name, port, pin, fn, mux)                         \
+    { #name, GPIO_PORT##port##_BASE, 1 << (pin), BOARD_PORT_##port },
+
+static const tSimPin g_psSimPins[] =
+{
+    BOARD_PINS(SIM_PIN_ENTRY, 0, 0)
+};
+
+#define SIM_NUM_PINS            (sizeof(g_psSimPins) / sizeof(g_psSimPins[0]))
+
+// AIN0 to AIN11 by port and pin.
+static const uint8_t g_pui8SimAIN[SIM_ADC_CHANNELS][2] =
+{
+    { BOARD_PORT_E, 3 }, { BOARD_PORT_E, 2 }, { BOARD_PORT_E, 1 },
+    { BOARD_PORT_E, 0 }, { BOARD_PORT_D, 3 }, { BOARD_PORT_D, 2 },
+    { BOARD_PORT_D, 1 }, { BOARD_PORT_D, 0 }, { BOARD_PORT_E, 5 },
+    { BOARD_PORT_E, 4 }, { BOARD_PORT_B, 4 }, { BOARD_PORT_B, 5 }
+};
+
+// Look a pin up by name.  pi32Channel is its ADC channel, -1 if it has none.
+bool SimBoardPin(const char *pcName, uint32_t *pui32Port, uint8_t *pui8Pin,
+                 int32_t *pi32Channel)
+{
+    uint32_t ui32Idx, ui32Chan;
+
+    for(ui32Idx = 0; ui32Idx < SIM_NUM_PINS; ui32Idx++)
+    {
+        if(strcmp(pcName, g_psSimPins[ui32Idx].pcName))
+        {
+            continue;
+        }
+
+        *pui32Port = g_psSimPins[ui32Idx].ui32Port;
+        *pui8Pin = g_psSimPins[ui32Idx].ui8Pin;
+        *pi32Channel = -1;
+
+        for(ui32Chan = 0; ui32Chan < SIM_ADC_CHANNELS; ui32Chan++)
+        {
+            if((g_pui8SimAIN[ui32Chan][0] == g_psSimPins[ui32Idx].ui8Port) &&
+               ((1 << g_pui8SimAIN[ui32Chan][1]) == *pui8Pin))
+            {
+                *pi32Channel = (int32_t)ui32Chan;
+            }
+        }
+
+        return(true);
+    }
+
+    return(false);
+}
+
+//*****************************************************************************
+//
+// Reset state and the run itself.
+//
+//*****************************************************************************
+void SimInit(void)
+{
+    uint32_t ui32Chan;
+
+    g_sSimConfig.ui64LoopNs = 2 * SIM_US;
+    g_sSimConfig.ui64PollNs = 1 * SIM_MS;
+    g_sSimConfig.ui64EnumerateNs = 50 * SIM_MS;
+    g_sSimConfig.ui64ADCNs = 3 * SIM_US;
+    g_sSimConfig.ui64ResumeNs = 20 * SIM_MS;
+    g_sSimConfig.bRemoteWake = true;
+    g_sSimConfig.ui64EndNs = 1 * SIM_S;
+
+    g_sHALHost.pfnADCTrigger = SimADCTrigger;
+    g_sHALHost.pfnLoop = SimLoop;
+    g_sHALHost.pfnPoll = SimPoll;
+
+    // Buttons released, which is low except for the joystick switch, and
+    // the sticks and trigger centered.
+    SimPinSet(GPIO_PORTA_BASE, BOARD_PIN_JOYSTICK_SW, true);
+
+    for(ui32Chan = 0; ui32Chan < SIM_ADC_CHANNELS; ui32Chan++)
+    {
+        g_pui32SimAnalog[ui32Chan] = 2048;
+    }
+
+    SimIntRegister(INT_GPIOA, SuspendGPIOIntHandler);
+    SimIntRegister(INT_GPIOB, SuspendGPIOIntHandler);
+    SimIntRegister(INT_GPIOC, SuspendGPIOIntHandler);
+    SimIntRegister(INT_GPIOF, SuspendGPIOIntHandler);
+    SimIntRegister(INT_WATCHDOG, SupervisorIntHandler);
+    SimIntRegister(INT_TIMER2A, SuspendTimerIntHandler);
+    SimIntRegister(INT_USB0, SimUSBIntHandler);
+    SimIntRegister(INT_WTIMER5B, RGBBlinkIntHandler);
+    SimIntRegister(INT_TIMER3A, ReplayTimerIntHandler);
+    SimIntRegister(INT_TIMER4A, MacroTimerIntHandler);
+
+    // flash starts erased
+    memset(g_sHALHost.pui8Flash, 0xff, sizeof(g_sHALHost.pui8Flash));
+
+    SimTimerReset();
+}
+
+// Run the firmware until the end of the run or until it stops.  Returns why
+// it stopped.
+const char *SimRun(void)
+{
+    if(setjmp(g_sSimExit) == 0)
+    {
+        FirmwareMain();
+        g_pcSimStopped = "main returned";
+    }
+
+    g_bSimInHandler = false;
+
+    return(g_pcSimStopped);
+}
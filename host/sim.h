@@ -0,0 +1,209 @@
+//*****************************************************************************
+//
+// sim.h - Host simulator of the gamepad board.
+//
+// Copyright (c) Aditya Challamarad.  All rights reserved.
+//
+//*****************************************************************************
+
+#ifndef _SIM_H_
+#define _SIM_H_
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+//
+// The firmware runs unmodified against the stand-in driverlib and usblib in
+// host/stubs.  Time is simulated: it only moves when the firmware finishes a
+// main loop pass, polls the ADC, or sleeps, and events such as timer
+// interrupts, ADC conversions and host IN polls fire as it passes them.  A
+// run is fully deterministic.
+//
+// Interrupts are taken between loop passes and while polling or sleeping,
+// never in the middle of other firmware code.  All vectors have the same
+// priority, so as on the target a handler is never preempted.
+//
+
+// Nanoseconds.
+#define SIM_US                  1000ULL
+#define SIM_MS                  1000000ULL
+#define SIM_S                   1000000000ULL
+
+// Simulated time it takes to go round a busy-wait loop once.
+#define SIM_POLL_NS             250
+
+// The report as it goes over the wire.
+#define SIM_REPORT_SIZE         5
+
+//
+// Board and host timing, set before SimRun().
+//
+typedef struct
+{
+    // One pass of the main loop.
+    uint64_t ui64LoopNs;
+
+    // Host IN polling interval of the HID endpoint.
+    uint64_t ui64PollNs;
+
+    // USB init to the host setting the configuration.
+    uint64_t ui64EnumerateNs;
+
+    // One conversion of the whole ADC sequence.
+    uint64_t ui64ADCNs;
+
+    // Remote wakeup request to the host resuming the bus.
+    uint64_t ui64ResumeNs;
+
+    // The host allows remote wakeup.
+    bool bRemoteWake;
+
+    // End of the run.
+    uint64_t ui64EndNs;
+} tSimConfig;
+
+//
+// One report as the host received it.
+//
+typedef struct
+{
+    uint64_t ui64Time;
+    uint8_t pui8Data[SIM_REPORT_SIZE];
+} tSimReport;
+
+typedef struct
+{
+    uint64_t ui64LoopPasses;
+    uint64_t ui64Interrupts;
+
+    // Reports accepted by the endpoint, refused by it, and received by the
+    // host.
+    uint32_t ui32Sent;
+    uint32_t ui32Refused;
+    uint32_t ui32Received;
+} tSimStats;
+
+// Called for every report the host receives.
+typedef void (*tSimReportSink)(const tSimReport *psReport, void *pvData);
+
+extern tSimConfig g_sSimConfig;
+extern tSimStats g_sSimStats;
+
+// Current simulated time.
+extern uint64_t g_ui64SimNow;
+
+// The firmware's main(), renamed by the host build.
+extern int FirmwareMain(void);
+
+// Run loop, sim.c.
+extern void SimInit(void);
+extern const char *SimRun(void);
+extern void SimStop(const char *pcReason);
+extern void SimAdvance(uint64_t ui64Ns);
+extern void SimIdle(void);
+
+// Events, handlers run at their time as time passes it.
+typedef void (*tSimEvent)(uint32_t ui32Arg);
+extern void SimSchedule(uint64_t ui64Time, tSimEvent pfnEvent,
+                        uint32_t ui32Arg);
+
+// Interrupt controller.
+extern bool g_bSimMasked;
+extern void SimIntRaise(uint32_t ui32Int);
+extern void SimIntDispatch(void);
+extern bool SimIntPending(void);
+extern void SimIntEnable(uint32_t ui32Int, bool bEnable);
+extern bool SimIntEnabled(uint32_t ui32Int);
+extern void SimIntRegister(uint32_t ui32Int, void (*pfnHandler)(void));
+
+// System clock and cycle counter.
+extern uint32_t SimClockGet(void);
+extern void SimClockSet(uint32_t ui32Hz);
+extern uint64_t SimCycles(void);
+
+// Pins and analog inputs.  Pins are set by port base address, analog
+// inputs by ADC channel.
+extern void SimPinSet(uint32_t ui32Port, uint8_t ui8Pins, bool bHigh);
+extern void SimPinIntEnable(uint32_t ui32Port, uint8_t ui8Pins, bool bEnable);
+extern void SimAnalogSet(uint32_t ui32Channel, uint32_t ui32Value);
+extern void SimADCStepSet(uint32_t ui32Step, uint32_t ui32Channel, bool bEnd);
+extern bool SimBoardPin(const char *pcName, uint32_t *pui32Port,
+                        uint8_t *pui8Pin, int32_t *pi32Channel);
+
+// Peripheral timers and the watchdog, sim_tiva.c.
+extern void SimTimerReset(void);
+
+// Flash contents from and to a file, sim_tiva.c.
+extern bool SimFlashLoad(uint32_t ui32Address, uint32_t ui32Size,
+                         const char *pcFile);
+extern bool SimFlashSave(uint32_t ui32Address, uint32_t ui32Size,
+                         const char *pcFile);
+
+// UART console, sim_tiva.c.
+extern FILE *g_pfSimConsole;
+extern void SimKey(char cKey);
+
+// USB device and host, sim_usb.c.
+extern void SimUSBConnect(void);
+extern void SimUSBDisconnect(void);
+extern void SimUSBSuspend(void);
+extern void SimUSBResume(void);
+extern void SimUSBIdle(bool bIdle);
+extern void SimUSBDropTx(bool bForever);
+extern void SimUSBSinkSet(tSimReportSink pfnSink, void *pvData);
+extern void SimUSBIntHandler(void);
+
+// Control requests on endpoint 0.  SIM_CONTROL_SIZE is the largest report
+// they carry.
+#define SIM_CONTROL_SIZE        64
+
+typedef void (*tSimControlDone)(const uint8_t *pui8Data, uint32_t ui32Size,
+                                void *pvData);
+extern bool SimUSBControl(uint32_t ui32Type, const uint8_t *pui8Data,
+                          uint32_t ui32Size, tSimControlDone pfnDone,
+                          void *pvData);
+
+// Scripted stimuli, sim_script.c.
+extern bool SimScriptLoad(const char *pcFile);
+
+//
+// Input to host latency, sim_latency.c.  Latencies are binned per
+// microsecond up to SIM_LAT_BUCKETS, longer ones are only counted.
+//
+#define SIM_LAT_BUCKETS         65536
+
+typedef enum
+{
+    eSimInputButton,            // BUTTON1 edges
+    eSimInputStick,             // STICK_X between center and full travel
+    eSimInputMixed              // either, picked at random
+} tSimInput;
+
+typedef struct
+{
+    uint32_t ui32Inputs;
+    uint32_t ui32Lost;
+    uint32_t ui32Over;
+    uint64_t ui64MinNs;
+    uint64_t ui64MaxNs;
+    double dSum;
+    double dSumSq;
+    uint32_t pui32Hist[SIM_LAT_BUCKETS];
+} tSimLatency;
+
+extern tSimLatency g_sSimLatency;
+extern void SimLatencyStart(uint32_t ui32Inputs, tSimInput iInput,
+                            uint64_t ui64GapNs, uint64_t ui64Seed);
+extern void SimLatencyObserve(const tSimReport *psReport);
+extern void SimLatencyAdd(tSimLatency *psLat, uint64_t ui64Ns);
+extern void SimLatencyMerge(tSimLatency *psTo, const tSimLatency *psFrom);
+extern uint64_t SimLatencyPercentile(const tSimLatency *psLat,
+                                     uint32_t ui32PerMille);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,45 @@
+#
+# sim_check.cmake - Runs one stimulus script through gamepad_sim and
+# compares the reports and the console with the expected output.
+#
+# cmake -DSIM=gamepad_sim -DSCRIPT=host/scripts/x.txt
+#       -DEXPECTED=host/scripts/expected/x -DOUT=x [-DSTATUS=1] [-DUPDATE=1]
+#       -P sim_check.cmake
+#
+# EXPECTED and OUT are paths without the extension, .csv is the reports and
+# .out the console.  STATUS is the exit status the run should end with, 0
+# unless given.  UPDATE saves the run as the new expected output.
+#
+
+if(NOT DEFINED STATUS)
+    set(STATUS 0)
+endif()
+
+execute_process(
+    COMMAND ${SIM} -o ${OUT}.csv ${SCRIPT}
+    OUTPUT_FILE ${OUT}.out
+    ERROR_FILE ${OUT}.out
+    RESULT_VARIABLE RESULT)
+
+if(NOT RESULT EQUAL STATUS)
+    message(FATAL_ERROR "${SCRIPT}: gamepad_sim exited with ${RESULT}, "
+                        "expected ${STATUS}")
+endif()
+
+if(UPDATE)
+    configure_file(${OUT}.csv ${EXPECTED}.csv COPYONLY)
+    configure_file(${OUT}.out ${EXPECTED}.out COPYONLY)
+    return()
+endif()
+
+foreach(EXT csv out)
+    execute_process(
+        COMMAND ${CMAKE_COMMAND} -E compare_files
+                ${OUT}.${EXT} ${EXPECTED}.${EXT}
+        RESULT_VARIABLE RESULT)
+
+    if(NOT RESULT EQUAL 0)
+        message(FATAL_ERROR "${SCRIPT}: ${OUT}.${EXT} differs from "
+                            "${EXPECTED}.${EXT}")
+    endif()
+endforeach()
@@ -0,0 +1,249 @@
+//*****************************************************************************
+//
+// sim_latency.c - Input to host latency measurement in the simulator.
+//
+// Copyright (c) Aditya Challamarad.  All rights reserved.
+//
+// Drives one input at a time, a button edge or a full stick deflection, and
+// times it to the first report the host receives that shows it.  The next
+// input follows a random gap after that, so inputs land at every phase of
+// the main loop, the ADC conversion and the host polling interval.
+//
+// An input that no report shows within SIM_LAT_TIMEOUT is counted as lost.
+//
+//*****************************************************************************
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "inc/hw_memmap.h"
+#include "board.h"
+#include "sim.h"
+
+// Give up on an input after this long.
+#define SIM_LAT_TIMEOUT         (100 * SIM_MS)
+
+// First input, well after enumeration and stick calibration.
+#define SIM_LAT_SETTLE          (100 * SIM_MS)
+
+// Byte and bits in the report each kind of input changes.
+#define SIM_LAT_BUTTON_BYTE     4
+#define SIM_LAT_BUTTON_BITS     0x01
+#define SIM_LAT_STICK_BYTE      0
+#define SIM_LAT_STICK_BITS      0xff
+
+// The stick's ADC channel, AIN8.
+#define SIM_LAT_STICK_CHANNEL   8
+
+tSimLatency g_sSimLatency;
+
+static tSimInput g_iSimLatInput;
+static uint32_t g_ui32SimLatLeft;
+static uint64_t g_ui64SimLatGapNs;
+static uint64_t g_ui64SimLatRandom;
+
+// The input being timed: when it happened, which report bits show it and
+// what they held before it.  ui32Gen drops the timeout of an input that has
+// already been seen.
+static bool g_bSimLatWaiting;
+static uint64_t g_ui64SimLatStart;
+static uint32_t g_ui32SimLatByte;
+static uint8_t g_ui8SimLatBits;
+static uint8_t g_ui8SimLatBefore;
+static uint32_t g_ui32SimLatGen;
+
+// Last report the host received, and the level of each input.
+static uint8_t g_pui8SimLatLast[SIM_REPORT_SIZE];
+static bool g_bSimLatButton;
+static bool g_bSimLatStick;
+
+static void SimLatencyInput(uint32_t ui32Arg);
+
+// xorshift64*, seeded per run so runs repeat exactly.
+static uint64_t SimLatencyRandom(void)
+{
+    g_ui64SimLatRandom ^= g_ui64SimLatRandom >> 12;
+    g_ui64SimLatRandom ^= g_ui64SimLatRandom << 25;
+    g_ui64SimLatRandom ^= g_ui64SimLatRandom >> 27;
+
+    return(g_ui64SimLatRandom * 2685821657736338717ULL);
+}
+
+// Record one latency.
+void SimLatencyAdd(tSimLatency *psLat, uint64_t ui64Ns)
+{
+    uint64_t ui64Bucket = ui64Ns / SIM_US;
+
+    if(!psLat->ui32Inputs || (ui64Ns < psLat->ui64MinNs))
+    {
+        psLat->ui64MinNs = ui64Ns;
+    }
+
+    if(ui64Ns > psLat->ui64MaxNs)
+    {
+        psLat->ui64MaxNs = ui64Ns;
+    }
+
+    psLat->ui32Inputs++;
+    psLat->dSum += (double)ui64Ns;
+    psLat->dSumSq += (double)ui64Ns * (double)ui64Ns;
+
+    if(ui64Bucket < SIM_LAT_BUCKETS)
+    {
+        psLat->pui32Hist[ui64Bucket]++;
+    }
+    else
+    {
+        psLat->ui32Over++;
+    }
+}
+
+// Move on to the next input, or end the run after the last one.
+static void SimLatencyNext(void)
+{
+    uint64_t ui64Gap;
+
+    g_bSimLatWaiting = false;
+    g_ui32SimLatGen++;
+
+    if(!g_ui32SimLatLeft)
+    {
+        SimStop("end of run");
+    }
+
+    ui64Gap = g_ui64SimLatGapNs ? (SimLatencyRandom() % g_ui64SimLatGapNs) : 0;
+    SimSchedule(g_ui64SimNow + ui64Gap, SimLatencyInput, 0);
+}
+
+static void SimLatencyTimeout(uint32_t ui32Gen)
+{
+    if(g_bSimLatWaiting && (ui32Gen == g_ui32SimLatGen))
+    {
+        g_sSimLatency.ui32Lost++;
+        SimLatencyNext();
+    }
+}
+
+static void SimLatencyInput(uint32_t ui32Arg)
+{
+    bool bButton;
+
+    (void)ui32Arg;
+
+    bButton = (g_iSimLatInput == eSimInputButton) ||
+              ((g_iSimLatInput == eSimInputMixed) &&
+               (SimLatencyRandom() & 0x100));
+
+    g_ui32SimLatLeft--;
+
+    if(bButton)
+    {
+        g_bSimLatButton = !g_bSimLatButton;
+        SimPinSet(GPIO_PORTF_BASE, BOARD_PIN_BUTTON1, g_bSimLatButton);
+        g_ui32SimLatByte = SIM_LAT_BUTTON_BYTE;
+        g_ui8SimLatBits = SIM_LAT_BUTTON_BITS;
+    }
+    else
+    {
+        g_bSimLatStick = !g_bSimLatStick;
+        SimAnalogSet(SIM_LAT_STICK_CHANNEL, g_bSimLatStick ? 4095 : 2048);
+        g_ui32SimLatByte = SIM_LAT_STICK_BYTE;
+        g_ui8SimLatBits = SIM_LAT_STICK_BITS;
+    }
+
+    g_ui8SimLatBefore = g_pui8SimLatLast[g_ui32SimLatByte] & g_ui8SimLatBits;
+    g_ui64SimLatStart = g_ui64SimNow;
+    g_bSimLatWaiting = true;
+
+    SimSchedule(g_ui64SimNow + SIM_LAT_TIMEOUT, SimLatencyTimeout,
+                g_ui32SimLatGen);
+}
+
+// Start timing ui32Inputs inputs, each a random 0 to ui64GapNs after the
+// previous one was seen.  The run ends after the last.
+void SimLatencyStart(uint32_t ui32Inputs, tSimInput iInput, uint64_t ui64GapNs,
+                     uint64_t ui64Seed)
+{
+    memset(&g_sSimLatency, 0, sizeof(g_sSimLatency));
+
+    g_iSimLatInput = iInput;
+    g_ui32SimLatLeft = ui32Inputs;
+    g_ui64SimLatGapNs = ui64GapNs;
+    g_ui64SimLatRandom = ui64Seed ? ui64Seed : 1;
+
+    if(ui32Inputs)
+    {
+        SimSchedule(g_sSimConfig.ui64EnumerateNs + SIM_LAT_SETTLE,
+                    SimLatencyInput, 0);
+    }
+}
+
+// Called for every report the host receives.
+void SimLatencyObserve(const tSimReport *psReport)
+{
+    memcpy(g_pui8SimLatLast, psReport->pui8Data, SIM_REPORT_SIZE);
+
+    if(g_bSimLatWaiting &&
+       ((psReport->pui8Data[g_ui32SimLatByte] & g_ui8SimLatBits) !=
+        g_ui8SimLatBefore))
+    {
+        SimLatencyAdd(&g_sSimLatency, psReport->ui64Time - g_ui64SimLatStart);
+        SimLatencyNext();
+    }
+}
+
+// Add the results of another run.
+void SimLatencyMerge(tSimLatency *psTo, const tSimLatency *psFrom)
+{
+    uint32_t ui32Bucket;
+
+    if(!psFrom->ui32Inputs)
+    {
+        psTo->ui32Lost += psFrom->ui32Lost;
+        return;
+    }
+
+    if(!psTo->ui32Inputs || (psFrom->ui64MinNs < psTo->ui64MinNs))
+    {
+        psTo->ui64MinNs = psFrom->ui64MinNs;
+    }
+
+    if(psFrom->ui64MaxNs > psTo->ui64MaxNs)
+    {
+        psTo->ui64MaxNs = psFrom->ui64MaxNs;
+    }
+
+    psTo->ui32Inputs += psFrom->ui32Inputs;
+    psTo->ui32Lost += psFrom->ui32Lost;
+    psTo->ui32Over += psFrom->ui32Over;
+    psTo->dSum += psFrom->dSum;
+    psTo->dSumSq += psFrom->dSumSq;
+
+    for(ui32Bucket = 0; ui32Bucket < SIM_LAT_BUCKETS; ui32Bucket++)
+    {
+        psTo->pui32Hist[ui32Bucket] += psFrom->pui32Hist[ui32Bucket];
+    }
+}
+
+// Latency below which ui32PerMille thousandths of the inputs fall, to the
+// microsecond.  Inputs past the histogram count as the maximum.
+uint64_t SimLatencyPercentile(const tSimLatency *psLat, uint32_t ui32PerMille)
+{
+    uint64_t ui64Want, ui64Seen = 0;
+    uint32_t ui32Bucket;
+
+    ui64Want = (((uint64_t)psLat->ui32Inputs * ui32PerMille) + 999) / 1000;
+
+    for(ui32Bucket = 0; ui32Bucket < SIM_LAT_BUCKETS; ui32Bucket++)
+    {
+        ui64Seen += psLat->pui32Hist[ui32Bucket];
+
+        if(ui64Seen && (ui64Seen >= ui64Want))
+        {
+            return((uint64_t)ui32Bucket * SIM_US);
+        }
+    }
+
+    return(psLat->ui64MaxNs);
+}
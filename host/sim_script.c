@@ -0,0 +1,420 @@
+//*****************************************************************************
+//
+// sim_script.c - Scripted stimuli for the host simulator.
+//
+// Copyright (c) Aditya Challamarad.  All rights reserved.
+//
+// A script is a text file with one stimulus per line, prefixed by the time
+// it happens at in milliseconds (fractions allowed):
+//
+//     100     pin BUTTON1 1       drive a board pin high or low
+//     120.5   adc STICK_X 4095    set an analog pin, 0 to 4095
+//     200     usb suspend         also connect, disconnect, resume
+//     210     usb idle            the host stops polling, "usb poll" resumes
+//     220     usb droptx          lose the TX complete of the next report
+//     230     usb deadtx          lose every TX complete from now on
+//     300     key s               type a character on the console
+//     400     feature 08 80 02    SET_REPORT a feature report, hex bytes
+//     500     end                 end the run
+//
+// Lines starting with "set" change the board and host timing before the run
+// and take no time.  Durations are in microseconds:
+//
+//     set poll 1000       host IN polling interval
+//     set loop 2          one main loop pass
+//     set enumerate 50000 USB init to the host configuring the device
+//     set adc 3           one ADC sequence conversion
+//     set resume 20000    remote wakeup request to bus resume
+//     set remotewake 0    the host refuses remote wakeup
+//     set end 1000000     run length
+//
+// Everything after a # is a comment.  Pin names are the ones in board.h.
+//
+//*****************************************************************************
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "usblib/usbhid.h"
+#include "sim.h"
+
+#define SIM_SCRIPT_LINE         256
+
+typedef enum
+{
+    eSimActPin,
+    eSimActADC,
+    eSimActConnect,
+    eSimActDisconnect,
+    eSimActSuspend,
+    eSimActResume,
+    eSimActIdle,
+    eSimActPoll,
+    eSimActDropTx,
+    eSimActDeadTx,
+    eSimActKey,
+    eSimActFeature,
+    eSimActEnd
+} tSimAction;
+
+typedef struct
+{
+    tSimAction iAction;
+    uint32_t ui32Port;
+    uint8_t ui8Pin;
+    uint32_t ui32Value;
+    uint8_t pui8Data[SIM_CONTROL_SIZE];
+} tSimStep;
+
+static tSimStep *g_psSimSteps;
+static uint32_t g_ui32SimSteps;
+
+static void SimScriptFeatureDone(const uint8_t *pui8Data, uint32_t ui32Size,
+                                 void *pvData)
+{
+    (void)ui32Size;
+
+    if(!pui8Data)
+    {
+        fprintf(stderr, "script step %u: feature report not taken\n",
+                (uint32_t)(uintptr_t)pvData);
+    }
+}
+
+static void SimScriptStep(uint32_t ui32Step)
+{
+    tSimStep *psStep = &g_psSimSteps[ui32Step];
+
+    switch(psStep->iAction)
+    {
+        case eSimActPin:
+        {
+            SimPinSet(psStep->ui32Port, psStep->ui8Pin, psStep->ui32Value != 0);
+            break;
+        }
+
+        case eSimActADC:
+        {
+            SimAnalogSet(psStep->ui32Port, psStep->ui32Value);
+            break;
+        }
+
+        case eSimActConnect:
+        {
+            SimUSBConnect();
+            break;
+        }
+
+        case eSimActDisconnect:
+        {
+            SimUSBDisconnect();
+            break;
+        }
+
+        case eSimActSuspend:
+        {
+            SimUSBSuspend();
+            break;
+        }
+
+        case eSimActResume:
+        {
+            SimUSBResume();
+            break;
+        }
+
+        case eSimActIdle:
+        {
+            SimUSBIdle(true);
+            break;
+        }
+
+        case eSimActPoll:
+        {
+            SimUSBIdle(false);
+            break;
+        }
+
+        case eSimActDropTx:
+        {
+            SimUSBDropTx(false);
+            break;
+        }
+
+        case eSimActDeadTx:
+        {
+            SimUSBDropTx(true);
+            break;
+        }
+
+        case eSimActKey:
+        {
+            SimKey((char)psStep->ui32Value);
+            break;
+        }
+
+        case eSimActFeature:
+        {
+            if(!SimUSBControl(USB_HID_REPORT_FEATURE, psStep->pui8Data,
+                              psStep->ui32Value, SimScriptFeatureDone,
+                              (void *)(uintptr_t)ui32Step))
+            {
+                fprintf(stderr, "script step %u: control request busy\n",
+                        ui32Step);
+            }
+            break;
+        }
+
+        case eSimActEnd:
+        {
+            SimStop("end of script");
+            break;
+        }
+    }
+}
+
+// Apply one "set" line.
+static bool SimScriptSet(const char *pcName, unsigned long long ullValue)
+{
+    static const struct
+    {
+        const char *pcName;
+        uint64_t *pui64Value;
+    }
+    psDurations[] =
+    {
+        { "poll", &g_sSimConfig.ui64PollNs },
+        { "loop", &g_sSimConfig.ui64LoopNs },
+        { "enumerate", &g_sSimConfig.ui64EnumerateNs },
+        { "adc", &g_sSimConfig.ui64ADCNs },
+        { "resume", &g_sSimConfig.ui64ResumeNs },
+        { "end", &g_sSimConfig.ui64EndNs },
+    };
+    uint32_t ui32Idx;
+
+    if(!strcmp(pcName, "remotewake"))
+    {
+        g_sSimConfig.bRemoteWake = (ullValue != 0);
+        return(true);
+    }
+
+    for(ui32Idx = 0; ui32Idx < (sizeof(psDurations) / sizeof(psDurations[0]));
+        ui32Idx++)
+    {
+        if(!strcmp(pcName, psDurations[ui32Idx].pcName))
+        {
+            // a zero polling interval or loop pass would stop time
+            if(!ullValue && (ui32Idx < 2))
+            {
+                return(false);
+            }
+
+            *psDurations[ui32Idx].pui64Value = ullValue * SIM_US;
+            return(true);
+        }
+    }
+
+    return(false);
+}
+
+// Parse the command part of a timed line into psStep.
+static bool SimScriptParse(char *pcCmd, tSimStep *psStep)
+{
+    char *pcArg1, *pcArg2;
+    int32_t i32Channel;
+
+    pcCmd = strtok(pcCmd, " \t");
+    pcArg1 = strtok(0, " \t");
+    pcArg2 = strtok(0, " \t");
+
+    if(!pcCmd)
+    {
+        return(false);
+    }
+
+    if(!strcmp(pcCmd, "pin") || !strcmp(pcCmd, "adc"))
+    {
+        if(!pcArg1 || !pcArg2 ||
+           !SimBoardPin(pcArg1, &psStep->ui32Port, &psStep->ui8Pin,
+                        &i32Channel))
+        {
+            return(false);
+        }
+
+        psStep->ui32Value = (uint32_t)strtoul(pcArg2, 0, 0);
+
+        if(!strcmp(pcCmd, "pin"))
+        {
+            psStep->iAction = eSimActPin;
+            return(true);
+        }
+
+        if(i32Channel < 0)
+        {
+            return(false);
+        }
+
+        psStep->iAction = eSimActADC;
+        psStep->ui32Port = (uint32_t)i32Channel;
+        return(true);
+    }
+
+    if(!strcmp(pcCmd, "usb") && pcArg1)
+    {
+        if(!strcmp(pcArg1, "connect"))
+        {
+            psStep->iAction = eSimActConnect;
+        }
+        else if(!strcmp(pcArg1, "disconnect"))
+        {
+            psStep->iAction = eSimActDisconnect;
+        }
+        else if(!strcmp(pcArg1, "suspend"))
+        {
+            psStep->iAction = eSimActSuspend;
+        }
+        else if(!strcmp(pcArg1, "resume"))
+        {
+            psStep->iAction = eSimActResume;
+        }
+        else if(!strcmp(pcArg1, "idle"))
+        {
+            psStep->iAction = eSimActIdle;
+        }
+        else if(!strcmp(pcArg1, "poll"))
+        {
+            psStep->iAction = eSimActPoll;
+        }
+        else if(!strcmp(pcArg1, "droptx"))
+        {
+            psStep->iAction = eSimActDropTx;
+        }
+        else if(!strcmp(pcArg1, "deadtx"))
+        {
+            psStep->iAction = eSimActDeadTx;
+        }
+        else
+        {
+            return(false);
+        }
+
+        return(true);
+    }
+
+    if(!strcmp(pcCmd, "key") && pcArg1)
+    {
+        psStep->iAction = eSimActKey;
+        psStep->ui32Value = (uint8_t)pcArg1[0];
+        return(true);
+    }
+
+    if(!strcmp(pcCmd, "feature") && pcArg1)
+    {
+        psStep->iAction = eSimActFeature;
+        psStep->ui32Value = 0;
+
+        // the first two bytes were split off with the command
+        while(pcArg1)
+        {
+            if(psStep->ui32Value == SIM_CONTROL_SIZE)
+            {
+                return(false);
+            }
+
+            psStep->pui8Data[psStep->ui32Value++] =
+                (uint8_t)strtoul(pcArg1, 0, 16);
+            pcArg1 = pcArg2 ? pcArg2 : strtok(0, " \t");
+            pcArg2 = 0;
+        }
+
+        return(true);
+    }
+
+    if(!strcmp(pcCmd, "end"))
+    {
+        psStep->iAction = eSimActEnd;
+        return(true);
+    }
+
+    return(false);
+}
+
+// Load a script and schedule everything in it.  Reports the first bad line
+// on stderr and returns false.
+bool SimScriptLoad(const char *pcFile)
+{
+    char pcLine[SIM_SCRIPT_LINE], *pcText, *pcEnd, *pcName;
+    uint32_t ui32Line = 0;
+    double dMs;
+    tSimStep sStep, *psSteps;
+    FILE *pfScript;
+    bool bOk = true;
+
+    pfScript = fopen(pcFile, "r");
+
+    if(!pfScript)
+    {
+        fprintf(stderr, "%s: cannot open\n", pcFile);
+        return(false);
+    }
+
+    while(bOk && fgets(pcLine, sizeof(pcLine), pfScript))
+    {
+        ui32Line++;
+
+        if((pcText = strchr(pcLine, '#')) != 0)
+        {
+            *pcText = 0;
+        }
+
+        pcLine[strcspn(pcLine, "\r\n")] = 0;
+        pcText = pcLine + strspn(pcLine, " \t");
+
+        if(!*pcText)
+        {
+            continue;
+        }
+
+        if(!strncmp(pcText, "set", 3) && ((pcText[3] == ' ') ||
+                                          (pcText[3] == '\t')))
+        {
+            pcName = strtok(pcText + 4, " \t");
+            pcText = strtok(0, " \t");
+            bOk = pcName && pcText &&
+                  SimScriptSet(pcName, strtoull(pcText, 0, 0));
+            continue;
+        }
+
+        dMs = strtod(pcText, &pcEnd);
+
+        if((pcEnd == pcText) || (dMs < 0) || !SimScriptParse(pcEnd, &sStep))
+        {
+            bOk = false;
+            continue;
+        }
+
+        psSteps = realloc(g_psSimSteps, (g_ui32SimSteps + 1) * sizeof(tSimStep));
+
+        if(!psSteps)
+        {
+            bOk = false;
+            continue;
+        }
+
+        g_psSimSteps = psSteps;
+        g_psSimSteps[g_ui32SimSteps] = sStep;
+        SimSchedule((uint64_t)(dMs * SIM_MS), SimScriptStep, g_ui32SimSteps);
+        g_ui32SimSteps++;
+    }
+
+    fclose(pfScript);
+
+    if(!bOk)
+    {
+        fprintf(stderr, "%s:%u: bad line\n", pcFile, ui32Line);
+    }
+
+    return(bOk);
+}
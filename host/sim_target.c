@@ -0,0 +1,86 @@
+//*****************************************************************************
+//
+// sim_target.c - Host versions of the fault recorder and stack monitor.
+//
+// Copyright (c) Aditya Challamarad.  All rights reserved.
+//
+// fault.c and stackmon.c are built from Cortex-M assembly and linker
+// symbols, so the host build uses these instead.  There is no reset to
+// survive, a fault reset ends the run, and the stack figures are zero.
+//
+//*****************************************************************************
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "utils/uartstdio.h"
+#include "fault.h"
+#include "stackmon.h"
+#include "sim.h"
+
+tFaultRecord g_sFaultRecord;
+
+void FaultInit(void)
+{
+}
+
+bool FaultValid(void)
+{
+    return(false);
+}
+
+void FaultClear(void)
+{
+}
+
+void FaultReset(uint32_t ui32Type)
+{
+    static const char * const ppcReason[] =
+    {
+        "fault reset", "fault reset (nmi)", "fault reset (hard fault)",
+        "fault reset (unexpected interrupt)", "fault reset (supervisor)",
+        "fault reset (setup)"
+    };
+
+    g_sFaultRecord.ui32Type = ui32Type;
+    g_sFaultRecord.ui32Count++;
+
+    SimStop(ppcReason[(ui32Type <= FAULT_TYPE_SETUP) ? ui32Type : 0]);
+}
+
+void FaultReport(void)
+{
+}
+
+void FaultPrint(void)
+{
+    UARTprintf("\nno fault record\n");
+}
+
+void StackMonInit(void)
+{
+}
+
+uint32_t StackHighWater(void)
+{
+    return(0);
+}
+
+void RAMBudgetGet(tRAMBudget *psBudget)
+{
+    psBudget->ui32SRAM = 0;
+    psBudget->ui32Vtable = 0;
+    psBudget->ui32Data = 0;
+    psBudget->ui32Bss = 0;
+    psBudget->ui32RamFunc = 0;
+    psBudget->ui32NoInit = 0;
+    psBudget->ui32Heap = 0;
+    psBudget->ui32Stack = 0;
+    psBudget->ui32StackUsed = 0;
+    psBudget->ui32Free = 0;
+}
+
+void RAMBudgetPrint(void)
+{
+    UARTprintf("\nram budget not available on the host\n");
+}
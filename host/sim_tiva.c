@@ -0,0 +1,853 @@
+//*****************************************************************************
+//
+// sim_tiva.c - Stand-ins for the driverlib and uartstdio calls the firmware
+//              makes, on top of the simulated board in sim.c.
+//
+// Copyright (c) Aditya Challamarad.  All rights reserved.
+//
+// Calls that only configure hardware the simulation does not model do
+// nothing.  Clocks, interrupts, GPIO interrupts, the ADC sequencer, the
+// periodic timers, the flash and the watchdog are modelled well enough for
+// the firmware to behave as it does on the board.
+//
+//*****************************************************************************
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "inc/hw_ints.h"
+#include "inc/hw_memmap.h"
+#include "inc/hw_types.h"
+#include "driverlib/adc.h"
+#include "driverlib/flash.h"
+#include "driverlib/gpio.h"
+#include "driverlib/interrupt.h"
+#include "driverlib/sysctl.h"
+#include "driverlib/timer.h"
+#include "driverlib/uart.h"
+#include "driverlib/watchdog.h"
+#include "utils/uartstdio.h"
+#include "hal.h"
+#include "sim.h"
+
+// PLL output, PIOSC, and the deep sleep clock the firmware selects.
+#define SIM_PLL_HZ              400000000
+#define SIM_PIOSC_HZ            16000000
+#define SIM_DEEP_SLEEP_HZ       30000
+
+//*****************************************************************************
+//
+// System control
+//
+//*****************************************************************************
+
+// Deep sleep, and the peripherals that keep their clock in it.
+static bool g_bSimDeepSleep;
+static bool g_bSimWatchdogSleeps = true;
+static bool g_bSimTimer2Sleeps = true;
+
+void SysCtlClockSet(uint32_t ui32Config)
+{
+    uint32_t ui32Halves = ui32Config >> 24;
+
+    SimClockSet(ui32Halves ? (SIM_PLL_HZ / ui32Halves) : SIM_PIOSC_HZ);
+}
+
+uint32_t SysCtlClockGet(void)
+{
+    return(SimClockGet());
+}
+
+void SysCtlPeripheralEnable(uint32_t ui32Peripheral)
+{
+    (void)ui32Peripheral;
+}
+
+void SysCtlPeripheralDisable(uint32_t ui32Peripheral)
+{
+    (void)ui32Peripheral;
+}
+
+void SysCtlPeripheralReset(uint32_t ui32Peripheral)
+{
+    (void)ui32Peripheral;
+}
+
+bool SysCtlPeripheralReady(uint32_t ui32Peripheral)
+{
+    (void)ui32Peripheral;
+
+    return(true);
+}
+
+void SysCtlPeripheralDeepSleepEnable(uint32_t ui32Peripheral)
+{
+    if(ui32Peripheral == SYSCTL_PERIPH_TIMER2)
+    {
+        g_bSimTimer2Sleeps = false;
+    }
+    else if(ui32Peripheral == SYSCTL_PERIPH_WDOG0)
+    {
+        g_bSimWatchdogSleeps = false;
+    }
+}
+
+void SysCtlPeripheralClockGating(bool bEnable)
+{
+    (void)bEnable;
+}
+
+void SysCtlGPIOAHBEnable(uint32_t ui32GPIOPeripheral)
+{
+    (void)ui32GPIOPeripheral;
+}
+
+void SysCtlDeepSleepClockSet(uint32_t ui32Config)
+{
+    (void)ui32Config;
+}
+
+void SysCtlDeepSleepPowerSet(uint32_t ui32Config)
+{
+    (void)ui32Config;
+}
+
+// Sleep until an interrupt.  The core clock is the 30kHz oscillator in deep
+// sleep, which the cycle counter sees.
+void SysCtlDeepSleep(void)
+{
+    uint32_t ui32Clock = SimClockGet();
+
+    g_bSimDeepSleep = true;
+    SimClockSet(SIM_DEEP_SLEEP_HZ);
+
+    SimIdle();
+
+    SimClockSet(ui32Clock);
+    g_bSimDeepSleep = false;
+}
+
+void SysCtlSleep(void)
+{
+    SimIdle();
+}
+
+void SysCtlReset(void)
+{
+    SimStop("software reset");
+}
+
+uint32_t SysCtlResetCauseGet(void)
+{
+    return(0);
+}
+
+void SysCtlResetCauseClear(uint32_t ui32Causes)
+{
+    (void)ui32Causes;
+}
+
+//*****************************************************************************
+//
+// GPIO
+//
+//*****************************************************************************
+void GPIODirModeSet(uint32_t ui32Port, uint8_t ui8Pins, uint32_t ui32PinIO)
+{
+    (void)ui32Port;
+    (void)ui8Pins;
+    (void)ui32PinIO;
+}
+
+void GPIOPadConfigSet(uint32_t ui32Port, uint8_t ui8Pins,
+                      uint32_t ui32Strength, uint32_t ui32PadType)
+{
+    (void)ui32Port;
+    (void)ui8Pins;
+    (void)ui32Strength;
+    (void)ui32PadType;
+}
+
+void GPIOPinConfigure(uint32_t ui32PinConfig)
+{
+    (void)ui32PinConfig;
+}
+
+void GPIOPinTypeADC(uint32_t ui32Port, uint8_t ui8Pins)
+{
+    (void)ui32Port;
+    (void)ui8Pins;
+}
+
+void GPIOPinTypeGPIOInput(uint32_t ui32Port, uint8_t ui8Pins)
+{
+    (void)ui32Port;
+    (void)ui8Pins;
+}
+
+void GPIOPinTypeTimer(uint32_t ui32Port, uint8_t ui8Pins)
+{
+    (void)ui32Port;
+    (void)ui8Pins;
+}
+
+void GPIOPinTypeUART(uint32_t ui32Port, uint8_t ui8Pins)
+{
+    (void)ui32Port;
+    (void)ui8Pins;
+}
+
+void GPIOPinTypeUSBAnalog(uint32_t ui32Port, uint8_t ui8Pins)
+{
+    (void)ui32Port;
+    (void)ui8Pins;
+}
+
+int32_t GPIOPinRead(uint32_t ui32Port, uint8_t ui8Pins)
+{
+    return((int32_t)HALPinRead(ui32Port, ui8Pins));
+}
+
+void GPIOPinWrite(uint32_t ui32Port, uint8_t ui8Pins, uint8_t ui8Val)
+{
+    HALPinWrite(ui32Port, ui8Pins, ui8Val);
+}
+
+void GPIOIntTypeSet(uint32_t ui32Port, uint8_t ui8Pins, uint32_t ui32IntType)
+{
+    (void)ui32Port;
+    (void)ui8Pins;
+    (void)ui32IntType;
+}
+
+void GPIOIntEnable(uint32_t ui32Port, uint32_t ui32IntFlags)
+{
+    SimPinIntEnable(ui32Port, (uint8_t)ui32IntFlags, true);
+}
+
+void GPIOIntDisable(uint32_t ui32Port, uint32_t ui32IntFlags)
+{
+    SimPinIntEnable(ui32Port, (uint8_t)ui32IntFlags, false);
+}
+
+void GPIOIntClear(uint32_t ui32Port, uint32_t ui32IntFlags)
+{
+    (void)ui32Port;
+    (void)ui32IntFlags;
+}
+
+//*****************************************************************************
+//
+// ADC
+//
+//*****************************************************************************
+void ADCReferenceSet(uint32_t ui32Base, uint32_t ui32Ref)
+{
+    (void)ui32Base;
+    (void)ui32Ref;
+}
+
+void ADCSequenceStepConfigure(uint32_t ui32Base, uint32_t ui32SequenceNum,
+                              uint32_t ui32Step, uint32_t ui32Config)
+{
+    (void)ui32Base;
+
+    if(ui32SequenceNum == 0)
+    {
+        SimADCStepSet(ui32Step, ui32Config & 0xf,
+                      (ui32Config & ADC_CTL_END) != 0);
+    }
+}
+
+void ADCSequenceEnable(uint32_t ui32Base, uint32_t ui32SequenceNum)
+{
+    (void)ui32Base;
+    (void)ui32SequenceNum;
+}
+
+//*****************************************************************************
+//
+// Interrupt controller
+//
+//*****************************************************************************
+
+// Both return whether interrupts were masked before.
+bool IntMasterEnable(void)
+{
+    bool bMasked = g_bSimMasked;
+
+    g_bSimMasked = false;
+    SimIntDispatch();
+
+    return(bMasked);
+}
+
+bool IntMasterDisable(void)
+{
+    bool bMasked = g_bSimMasked;
+
+    g_bSimMasked = true;
+
+    return(bMasked);
+}
+
+void IntEnable(uint32_t ui32Interrupt)
+{
+    SimIntEnable(ui32Interrupt, true);
+    SimIntDispatch();
+}
+
+void IntDisable(uint32_t ui32Interrupt)
+{
+    SimIntEnable(ui32Interrupt, false);
+}
+
+bool IntIsEnabled(uint32_t ui32Interrupt)
+{
+    return(SimIntEnabled(ui32Interrupt));
+}
+
+void IntRegister(uint32_t ui32Interrupt, void (*pfnHandler)(void))
+{
+    SimIntRegister(ui32Interrupt, pfnHandler);
+}
+
+//*****************************************************************************
+//
+// Periodic timers.  Each half of a timer that has its timeout interrupt
+// enabled raises it once per load + 1 ticks.  A timer event carries a
+// generation count, so reloading or stopping a timer drops the event that
+// was already scheduled for it.  A half set to TIMER_UP_LOAD_TIMEOUT takes a
+// new load at its next timeout instead, and keeps its period running.
+//
+//*****************************************************************************
+typedef struct
+{
+    uint32_t ui32Base;
+    uint32_t pui32Int[2];
+    bool *pbSleeps;
+    bool bPIOSC;
+    uint32_t pui32Load[2];
+    bool pbEnabled[2];
+    bool pbIntEnabled[2];
+    bool pbLoadAtTimeout[2];
+    uint32_t pui32Gen[2];
+} tSimTimer;
+
+static bool g_bSimAlwaysSleeps = true;
+
+static tSimTimer g_psSimTimers[] =
+{
+    { .ui32Base = TIMER0_BASE, .pui32Int = { INT_TIMER0A, INT_TIMER0B },
+      .pbSleeps = &g_bSimAlwaysSleeps },
+    { .ui32Base = TIMER1_BASE, .pui32Int = { INT_TIMER1A, INT_TIMER1B },
+      .pbSleeps = &g_bSimAlwaysSleeps },
+    { .ui32Base = TIMER2_BASE, .pui32Int = { INT_TIMER2A, INT_TIMER2B },
+      .pbSleeps = &g_bSimTimer2Sleeps },
+    { .ui32Base = TIMER3_BASE, .pui32Int = { INT_TIMER3A, INT_TIMER3B },
+      .pbSleeps = &g_bSimAlwaysSleeps },
+    { .ui32Base = TIMER4_BASE, .pui32Int = { INT_TIMER4A, INT_TIMER4B },
+      .pbSleeps = &g_bSimAlwaysSleeps },
+    { .ui32Base = WTIMER5_BASE, .pui32Int = { INT_WTIMER5A, INT_WTIMER5B },
+      .pbSleeps = &g_bSimAlwaysSleeps },
+};
+
+#define SIM_NUM_TIMERS          (sizeof(g_psSimTimers) / sizeof(g_psSimTimers[0]))
+
+static void SimTimerSchedule(uint32_t ui32Timer, uint32_t ui32Half);
+
+static tSimTimer *SimTimerFind(uint32_t ui32Base)
+{
+    uint32_t ui32Idx;
+
+    for(ui32Idx = 0; ui32Idx < SIM_NUM_TIMERS; ui32Idx++)
+    {
+        if(g_psSimTimers[ui32Idx].ui32Base == ui32Base)
+        {
+            return(&g_psSimTimers[ui32Idx]);
+        }
+    }
+
+    return(0);
+}
+
+static void SimTimerEvent(uint32_t ui32Arg)
+{
+    tSimTimer *psTimer = &g_psSimTimers[(ui32Arg & 0xff) / 2];
+    uint32_t ui32Half = ui32Arg & 1;
+
+    if((ui32Arg >> 8) != (psTimer->pui32Gen[ui32Half] & 0xffffff))
+    {
+        return;
+    }
+
+    if(!(g_bSimDeepSleep && *psTimer->pbSleeps))
+    {
+        SimIntRaise(psTimer->pui32Int[ui32Half]);
+    }
+
+    SimTimerSchedule((ui32Arg & 0xff) / 2, ui32Half);
+}
+
+static void SimTimerSchedule(uint32_t ui32Timer, uint32_t ui32Half)
+{
+    tSimTimer *psTimer = &g_psSimTimers[ui32Timer];
+    uint64_t ui64Ticks;
+    uint32_t ui32Clock;
+
+    psTimer->pui32Gen[ui32Half]++;
+
+    if(!psTimer->pbEnabled[ui32Half] || !psTimer->pbIntEnabled[ui32Half] ||
+       !psTimer->pui32Load[ui32Half])
+    {
+        return;
+    }
+
+    ui32Clock = psTimer->bPIOSC ? SIM_PIOSC_HZ : SimClockGet();
+    ui64Ticks = (uint64_t)psTimer->pui32Load[ui32Half] + 1;
+
+    SimSchedule(g_ui64SimNow + ((ui64Ticks * SIM_S) / ui32Clock),
+                SimTimerEvent, (ui32Timer * 2) + ui32Half +
+                ((psTimer->pui32Gen[ui32Half] & 0xffffff) << 8));
+}
+
+// Loop over the halves selected by a TIMER_A/B/BOTH value.
+#define SIM_TIMER_HALVES(ui32Timer, ui32Half)                                 \
+    for(ui32Half = 0; ui32Half < 2; ui32Half++)                               \
+        if((ui32Timer) & (ui32Half ? TIMER_B : TIMER_A))
+
+void SimTimerReset(void)
+{
+    uint32_t ui32Idx;
+
+    for(ui32Idx = 0; ui32Idx < SIM_NUM_TIMERS; ui32Idx++)
+    {
+        g_psSimTimers[ui32Idx].bPIOSC = false;
+        g_psSimTimers[ui32Idx].pbEnabled[0] = false;
+        g_psSimTimers[ui32Idx].pbEnabled[1] = false;
+        g_psSimTimers[ui32Idx].pbIntEnabled[0] = false;
+        g_psSimTimers[ui32Idx].pbIntEnabled[1] = false;
+        g_psSimTimers[ui32Idx].pbLoadAtTimeout[0] = false;
+        g_psSimTimers[ui32Idx].pbLoadAtTimeout[1] = false;
+        g_psSimTimers[ui32Idx].pui32Load[0] = 0;
+        g_psSimTimers[ui32Idx].pui32Load[1] = 0;
+    }
+}
+
+void TimerConfigure(uint32_t ui32Base, uint32_t ui32Config)
+{
+    tSimTimer *psTimer = SimTimerFind(ui32Base);
+
+    (void)ui32Config;
+
+    if(psTimer)
+    {
+        psTimer->pbEnabled[0] = false;
+        psTimer->pbEnabled[1] = false;
+        psTimer->pbLoadAtTimeout[0] = false;
+        psTimer->pbLoadAtTimeout[1] = false;
+        SimTimerSchedule(psTimer - g_psSimTimers, 0);
+        SimTimerSchedule(psTimer - g_psSimTimers, 1);
+    }
+}
+
+void TimerClockSourceSet(uint32_t ui32Base, uint32_t ui32Source)
+{
+    tSimTimer *psTimer = SimTimerFind(ui32Base);
+
+    if(psTimer)
+    {
+        psTimer->bPIOSC = (ui32Source == TIMER_CLOCK_PIOSC);
+    }
+}
+
+void TimerLoadSet(uint32_t ui32Base, uint32_t ui32Timer, uint32_t ui32Value)
+{
+    tSimTimer *psTimer = SimTimerFind(ui32Base);
+    uint32_t ui32Half;
+
+    if(psTimer)
+    {
+        SIM_TIMER_HALVES(ui32Timer, ui32Half)
+        {
+            psTimer->pui32Load[ui32Half] = ui32Value;
+
+            // the next timeout is already scheduled with the old load
+            if(!psTimer->pbLoadAtTimeout[ui32Half] ||
+               !psTimer->pbEnabled[ui32Half])
+            {
+                SimTimerSchedule(psTimer - g_psSimTimers, ui32Half);
+            }
+        }
+    }
+}
+
+void TimerUpdateMode(uint32_t ui32Base, uint32_t ui32Timer,
+                     uint32_t ui32Config)
+{
+    tSimTimer *psTimer = SimTimerFind(ui32Base);
+    uint32_t ui32Half;
+
+    if(psTimer)
+    {
+        SIM_TIMER_HALVES(ui32Timer, ui32Half)
+        {
+            psTimer->pbLoadAtTimeout[ui32Half] =
+                (ui32Config == TIMER_UP_LOAD_TIMEOUT);
+        }
+    }
+}
+
+void TimerMatchSet(uint32_t ui32Base, uint32_t ui32Timer, uint32_t ui32Value)
+{
+    (void)ui32Base;
+    (void)ui32Timer;
+    (void)ui32Value;
+}
+
+static void SimTimerEnableSet(uint32_t ui32Base, uint32_t ui32Timer,
+                              bool bEnable)
+{
+    tSimTimer *psTimer = SimTimerFind(ui32Base);
+    uint32_t ui32Half;
+
+    if(psTimer)
+    {
+        SIM_TIMER_HALVES(ui32Timer, ui32Half)
+        {
+            psTimer->pbEnabled[ui32Half] = bEnable;
+            SimTimerSchedule(psTimer - g_psSimTimers, ui32Half);
+        }
+    }
+}
+
+void TimerEnable(uint32_t ui32Base, uint32_t ui32Timer)
+{
+    SimTimerEnableSet(ui32Base, ui32Timer, true);
+}
+
+void TimerDisable(uint32_t ui32Base, uint32_t ui32Timer)
+{
+    SimTimerEnableSet(ui32Base, ui32Timer, false);
+}
+
+void TimerIntEnable(uint32_t ui32Base, uint32_t ui32IntFlags)
+{
+    tSimTimer *psTimer = SimTimerFind(ui32Base);
+
+    if(psTimer)
+    {
+        psTimer->pbIntEnabled[0] |= (ui32IntFlags & TIMER_TIMA_TIMEOUT) != 0;
+        psTimer->pbIntEnabled[1] |= (ui32IntFlags & TIMER_TIMB_TIMEOUT) != 0;
+        SimTimerSchedule(psTimer - g_psSimTimers, 0);
+        SimTimerSchedule(psTimer - g_psSimTimers, 1);
+    }
+}
+
+void TimerIntClear(uint32_t ui32Base, uint32_t ui32IntFlags)
+{
+    (void)ui32Base;
+    (void)ui32IntFlags;
+}
+
+//*****************************************************************************
+//
+// Flash.  Erase sets a 1KB block to 0xff, programming can only clear bits,
+// as on the target.  The CPU stalls while the flash is busy, and so do the
+// interrupts, whose handlers are fetched from flash too.  The times are the
+// simulator's assumptions, not measurements.
+//
+//*****************************************************************************
+#define SIM_FLASH_BLOCK         1024
+#define SIM_FLASH_PROGRAM_NS    (50 * SIM_US)
+#define SIM_FLASH_ERASE_NS      (15 * SIM_MS)
+
+static void SimFlashBusy(uint64_t ui64Ns)
+{
+    bool bMasked = g_bSimMasked;
+
+    g_bSimMasked = true;
+    SimAdvance(ui64Ns);
+    g_bSimMasked = bMasked;
+
+    SimIntDispatch();
+}
+
+int32_t FlashErase(uint32_t ui32Address)
+{
+    if((ui32Address & (SIM_FLASH_BLOCK - 1)) ||
+       (ui32Address >= HAL_HOST_FLASH_SIZE))
+    {
+        return(-1);
+    }
+
+    memset(&g_sHALHost.pui8Flash[ui32Address], 0xff, SIM_FLASH_BLOCK);
+    SimFlashBusy(SIM_FLASH_ERASE_NS);
+
+    return(0);
+}
+
+int32_t FlashProgram(uint32_t *pui32Data, uint32_t ui32Address,
+                     uint32_t ui32Count)
+{
+    const uint8_t *pui8Data = (const uint8_t *)pui32Data;
+    uint32_t ui32Idx;
+
+    if((ui32Address & 3) || (ui32Count & 3) ||
+       (ui32Address + ui32Count > HAL_HOST_FLASH_SIZE))
+    {
+        return(-1);
+    }
+
+    for(ui32Idx = 0; ui32Idx < ui32Count; ui32Idx++)
+    {
+        g_sHALHost.pui8Flash[ui32Address + ui32Idx] &= pui8Data[ui32Idx];
+    }
+
+    SimFlashBusy((ui32Count / 4) * SIM_FLASH_PROGRAM_NS);
+
+    return(0);
+}
+
+// Load ui32Size bytes of flash at ui32Address from a file, before the run.
+// A short file leaves the rest erased.
+bool SimFlashLoad(uint32_t ui32Address, uint32_t ui32Size, const char *pcFile)
+{
+    FILE *pfFlash;
+    size_t iRead;
+
+    if(ui32Address + ui32Size > HAL_HOST_FLASH_SIZE)
+    {
+        return(false);
+    }
+
+    pfFlash = fopen(pcFile, "rb");
+
+    if(!pfFlash)
+    {
+        fprintf(stderr, "%s: cannot open\n", pcFile);
+        return(false);
+    }
+
+    memset(&g_sHALHost.pui8Flash[ui32Address], 0xff, ui32Size);
+    iRead = fread(&g_sHALHost.pui8Flash[ui32Address], 1, ui32Size, pfFlash);
+    fclose(pfFlash);
+
+    if(!iRead)
+    {
+        fprintf(stderr, "%s: empty\n", pcFile);
+        return(false);
+    }
+
+    return(true);
+}
+
+// Save ui32Size bytes of flash at ui32Address to a file, after the run.
+bool SimFlashSave(uint32_t ui32Address, uint32_t ui32Size, const char *pcFile)
+{
+    FILE *pfFlash;
+    bool bOk;
+
+    if(ui32Address + ui32Size > HAL_HOST_FLASH_SIZE)
+    {
+        return(false);
+    }
+
+    pfFlash = fopen(pcFile, "wb");
+
+    if(!pfFlash)
+    {
+        fprintf(stderr, "%s: cannot create\n", pcFile);
+        return(false);
+    }
+
+    bOk = fwrite(&g_sHALHost.pui8Flash[ui32Address], 1, ui32Size,
+                 pfFlash) == ui32Size;
+    bOk = (fclose(pfFlash) == 0) && bOk;
+
+    if(!bOk)
+    {
+        fprintf(stderr, "%s: write failed\n", pcFile);
+    }
+
+    return(bOk);
+}
+
+//*****************************************************************************
+//
+// Watchdog.  The first timeout sets the interrupt status and raises the
+// interrupt, a second one before the status is cleared resets the system.
+// Writing the load restarts the count, as on the target.
+//
+//*****************************************************************************
+static uint32_t g_ui32SimWatchdogLoad;
+static uint32_t g_ui32SimWatchdogGen;
+static bool g_bSimWatchdogEnabled;
+static bool g_bSimWatchdogReset;
+static bool g_bSimWatchdogStatus;
+
+static void SimWatchdogSchedule(void);
+
+static void SimWatchdogEvent(uint32_t ui32Gen)
+{
+    if(ui32Gen != g_ui32SimWatchdogGen)
+    {
+        return;
+    }
+
+    if(!(g_bSimDeepSleep && g_bSimWatchdogSleeps))
+    {
+        if(g_bSimWatchdogStatus && g_bSimWatchdogReset)
+        {
+            SimStop("watchdog reset");
+        }
+
+        g_bSimWatchdogStatus = true;
+        SimIntRaise(INT_WATCHDOG);
+    }
+
+    SimWatchdogSchedule();
+}
+
+static void SimWatchdogSchedule(void)
+{
+    g_ui32SimWatchdogGen++;
+
+    if(g_bSimWatchdogEnabled && g_ui32SimWatchdogLoad)
+    {
+        SimSchedule(g_ui64SimNow + (((uint64_t)g_ui32SimWatchdogLoad * SIM_S) /
+                                    SimClockGet()),
+                    SimWatchdogEvent, g_ui32SimWatchdogGen);
+    }
+}
+
+bool WatchdogLockState(uint32_t ui32Base)
+{
+    (void)ui32Base;
+
+    return(false);
+}
+
+void WatchdogUnlock(uint32_t ui32Base)
+{
+    (void)ui32Base;
+}
+
+void WatchdogReloadSet(uint32_t ui32Base, uint32_t ui32LoadVal)
+{
+    (void)ui32Base;
+
+    g_ui32SimWatchdogLoad = ui32LoadVal;
+    SimWatchdogSchedule();
+}
+
+void WatchdogStallEnable(uint32_t ui32Base)
+{
+    (void)ui32Base;
+}
+
+void WatchdogResetEnable(uint32_t ui32Base)
+{
+    (void)ui32Base;
+
+    g_bSimWatchdogReset = true;
+}
+
+void WatchdogIntEnable(uint32_t ui32Base)
+{
+    (void)ui32Base;
+}
+
+void WatchdogIntClear(uint32_t ui32Base)
+{
+    (void)ui32Base;
+
+    g_bSimWatchdogStatus = false;
+}
+
+void WatchdogEnable(uint32_t ui32Base)
+{
+    (void)ui32Base;
+
+    g_bSimWatchdogEnabled = true;
+    SimWatchdogSchedule();
+}
+
+//*****************************************************************************
+//
+// UART console.  Output goes to g_pfSimConsole, or nowhere if that is NULL,
+// and input comes from SimKey().
+//
+//*****************************************************************************
+#define SIM_KEYS                64
+
+FILE *g_pfSimConsole;
+
+static char g_pcSimKeys[SIM_KEYS];
+static uint32_t g_ui32SimKeyRead;
+static uint32_t g_ui32SimKeyWrite;
+
+void SimKey(char cKey)
+{
+    if((g_ui32SimKeyWrite - g_ui32SimKeyRead) < SIM_KEYS)
+    {
+        g_pcSimKeys[g_ui32SimKeyWrite++ % SIM_KEYS] = cKey;
+    }
+}
+
+void UARTClockSourceSet(uint32_t ui32Base, uint32_t ui32Source)
+{
+    (void)ui32Base;
+    (void)ui32Source;
+}
+
+void UARTStdioConfig(uint32_t ui32Port, uint32_t ui32Baud,
+                     uint32_t ui32SrcClock)
+{
+    (void)ui32Port;
+    (void)ui32Baud;
+    (void)ui32SrcClock;
+}
+
+void UARTprintf(const char *pcString, ...)
+{
+    va_list vaArgP;
+
+    if(g_pfSimConsole)
+    {
+        va_start(vaArgP, pcString);
+        vfprintf(g_pfSimConsole, pcString, vaArgP);
+        va_end(vaArgP);
+    }
+}
+
+unsigned char UARTgetc(void)
+{
+    while(g_ui32SimKeyRead == g_ui32SimKeyWrite)
+    {
+        SimIdle();
+    }
+
+    return((unsigned char)g_pcSimKeys[g_ui32SimKeyRead++ % SIM_KEYS]);
+}
+
+int UARTRxBytesAvail(void)
+{
+    return((int)(g_ui32SimKeyWrite - g_ui32SimKeyRead));
+}
+
+void UARTFlushTx(bool bDiscard)
+{
+    (void)bDiscard;
+
+    if(g_pfSimConsole)
+    {
+        fflush(g_pfSimConsole);
+    }
+}
+
+void UARTStdioIntHandler(void)
+{
+}
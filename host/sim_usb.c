@@ -0,0 +1,441 @@
+//*****************************************************************************
+//
+// sim_usb.c - Stand-in for the usblib HID gamepad device class, and the USB
+//             host at the other end of the cable.
+//
+// Copyright (c) Aditya Challamarad.  All rights reserved.
+//
+// The host enumerates the device some time after USBDHIDGamepadInit() and
+// then polls the interrupt IN endpoint once per polling interval, on frame
+// boundaries.  A report handed to USBDHIDGamepadSendReport() goes out at
+// the next poll, which is when TX complete comes back.  Bus events reach the
+// firmware's callback from the USB0 interrupt, as they do with usblib.
+//
+// A script can make the host stop polling while it stays configured, as a
+// host does when nothing has the device open, and drop a TX complete, so
+// the endpoint is stuck with the report gone.
+//
+// The host can also make one GET_REPORT or SET_REPORT control request at a
+// time.  It is served from the USB0 interrupt too, and its completion is
+// passed back to whoever made it.
+//
+//*****************************************************************************
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "inc/hw_ints.h"
+#include "driverlib/usb.h"
+#include "usblib/usblib.h"
+#include "usblib/device/usbdevice.h"
+#include "usblib/device/usbdhid.h"
+#include "usblib/device/usbdhidgamepad.h"
+#include "hal.h"
+#include "sim.h"
+
+#define SIM_USB_EVENTS          16
+
+static tUSBDHIDGamepadDevice *g_psSimGamepad;
+static bool g_bSimConfigured;
+static bool g_bSimSuspended;
+static bool g_bSimBusy;
+static bool g_bSimResuming;
+static bool g_bSimIdle;         // the host is not polling
+static bool g_bSimDropTx;       // drop the next TX complete
+static bool g_bSimDeadTx;       // drop every TX complete from now on
+static bool g_bSimTxLost;       // the report went but TX complete never came
+static uint8_t g_pui8SimReport[SIM_REPORT_SIZE];
+
+// Bus events waiting for the USB0 interrupt.
+static uint32_t g_pui32SimEvents[SIM_USB_EVENTS];
+static uint32_t g_ui32SimEventRead;
+static uint32_t g_ui32SimEventWrite;
+
+// Where received reports go.
+static tSimReportSink g_pfnSimSink;
+static void *g_pvSimSinkData;
+
+// Bumped when the device detaches, so polls scheduled before it are dropped.
+static uint32_t g_ui32SimAttach;
+
+// The control request waiting for the USB0 interrupt.  The data stage of a
+// SET_REPORT is kept here until then.
+static bool g_bSimControl;
+static bool g_bSimControlSet;
+static uint32_t g_ui32SimControlType;
+static uint8_t g_pui8SimControlData[SIM_CONTROL_SIZE];
+static uint32_t g_ui32SimControlSize;
+static tSimControlDone g_pfnSimControlDone;
+static void *g_pvSimControlData;
+
+static void SimUSBEvent(uint32_t ui32Event)
+{
+    if((g_ui32SimEventWrite - g_ui32SimEventRead) < SIM_USB_EVENTS)
+    {
+        g_pui32SimEvents[g_ui32SimEventWrite++ % SIM_USB_EVENTS] = ui32Event;
+        SimIntRaise(INT_USB0);
+    }
+}
+
+// Serve the pending control request through the firmware's callback.
+static void SimUSBControlServe(void)
+{
+    tSimControlDone pfnDone = g_pfnSimControlDone;
+    void *pvReport = 0;
+    uint32_t ui32Size;
+
+    g_bSimControl = false;
+
+    if(!g_psSimGamepad || !g_bSimConfigured)
+    {
+        pfnDone(0, 0, g_pvSimControlData);
+        return;
+    }
+
+    if(g_bSimControlSet)
+    {
+        g_psSimGamepad->pfnCallback(g_psSimGamepad->pvCBData,
+                                    USBD_HID_EVENT_SET_REPORT,
+                                    g_ui32SimControlSize,
+                                    g_pui8SimControlData);
+        pfnDone(g_pui8SimControlData, g_ui32SimControlSize,
+                g_pvSimControlData);
+        return;
+    }
+
+    ui32Size = g_psSimGamepad->pfnCallback(g_psSimGamepad->pvCBData,
+                                           USBD_HID_EVENT_GET_REPORT,
+                                           g_ui32SimControlType << 8,
+                                           &pvReport);
+
+    // the input report comes back without a size
+    if(!ui32Size)
+    {
+        ui32Size = SIM_REPORT_SIZE;
+    }
+
+    if(ui32Size > SIM_CONTROL_SIZE)
+    {
+        ui32Size = SIM_CONTROL_SIZE;
+    }
+
+    if(pvReport)
+    {
+        memcpy(g_pui8SimControlData, pvReport, ui32Size);
+    }
+
+    pfnDone(pvReport ? g_pui8SimControlData : 0, pvReport ? ui32Size : 0,
+            g_pvSimControlData);
+}
+
+void SimUSBIntHandler(void)
+{
+    uint32_t ui32Event;
+
+    while(g_ui32SimEventRead != g_ui32SimEventWrite)
+    {
+        ui32Event = g_pui32SimEvents[g_ui32SimEventRead++ % SIM_USB_EVENTS];
+
+        if(g_psSimGamepad && g_psSimGamepad->pfnCallback)
+        {
+            g_psSimGamepad->pfnCallback(g_psSimGamepad->pvCBData, ui32Event,
+                                        0, 0);
+        }
+    }
+
+    if(g_bSimControl)
+    {
+        SimUSBControlServe();
+    }
+}
+
+// Queue a GET_REPORT (pui8Data 0) or SET_REPORT request of ui32Type,
+// USB_HID_REPORT_*.  pfnDone gets the report read, or what was written, or
+// no data if the device could not take the request.  Returns false if
+// another request is still pending.
+bool SimUSBControl(uint32_t ui32Type, const uint8_t *pui8Data,
+                   uint32_t ui32Size, tSimControlDone pfnDone, void *pvData)
+{
+    if(g_bSimControl)
+    {
+        return(false);
+    }
+
+    if(ui32Size > SIM_CONTROL_SIZE)
+    {
+        ui32Size = SIM_CONTROL_SIZE;
+    }
+
+    g_bSimControl = true;
+    g_bSimControlSet = (pui8Data != 0);
+    g_ui32SimControlType = ui32Type;
+    g_ui32SimControlSize = pui8Data ? ui32Size : 0;
+    g_pfnSimControlDone = pfnDone;
+    g_pvSimControlData = pvData;
+
+    if(pui8Data)
+    {
+        memcpy(g_pui8SimControlData, pui8Data, ui32Size);
+    }
+
+    SimIntRaise(INT_USB0);
+
+    return(true);
+}
+
+void SimUSBSinkSet(tSimReportSink pfnSink, void *pvData)
+{
+    g_pfnSimSink = pfnSink;
+    g_pvSimSinkData = pvData;
+}
+
+//*****************************************************************************
+//
+// The host side.
+//
+//*****************************************************************************
+
+// The host's IN poll.  Takes the pending report, if the device is still the
+// one the poll was scheduled for.
+static void SimUSBPoll(uint32_t ui32Attach)
+{
+    tSimReport sReport;
+
+    if((ui32Attach != g_ui32SimAttach) || !g_bSimBusy || g_bSimSuspended ||
+       !g_bSimConfigured || g_bSimIdle || g_bSimTxLost)
+    {
+        return;
+    }
+
+    sReport.ui64Time = g_ui64SimNow;
+    memcpy(sReport.pui8Data, g_pui8SimReport, SIM_REPORT_SIZE);
+    g_sSimStats.ui32Received++;
+
+    if(g_pfnSimSink)
+    {
+        g_pfnSimSink(&sReport, g_pvSimSinkData);
+    }
+
+    if(g_bSimDropTx || g_bSimDeadTx)
+    {
+        g_bSimDropTx = false;
+        g_bSimTxLost = true;
+        return;
+    }
+
+    g_bSimBusy = false;
+    SimUSBEvent(USB_EVENT_TX_COMPLETE);
+}
+
+// Schedule the poll for the pending report on the next polling boundary.
+static void SimUSBPollNext(void)
+{
+    uint64_t ui64Poll = g_sSimConfig.ui64PollNs;
+
+    SimSchedule(((g_ui64SimNow / ui64Poll) + 1) * ui64Poll, SimUSBPoll,
+                g_ui32SimAttach);
+}
+
+void SimUSBConnect(void)
+{
+    if(!g_psSimGamepad || g_bSimConfigured)
+    {
+        return;
+    }
+
+    g_bSimConfigured = true;
+    g_bSimSuspended = false;
+    SimUSBEvent(USB_EVENT_CONNECTED);
+}
+
+void SimUSBDisconnect(void)
+{
+    if(!g_bSimConfigured)
+    {
+        return;
+    }
+
+    g_ui32SimAttach++;
+    g_bSimConfigured = false;
+    g_bSimSuspended = false;
+    g_bSimBusy = false;
+    g_bSimTxLost = false;
+    SimUSBEvent(USB_EVENT_DISCONNECTED);
+}
+
+void SimUSBSuspend(void)
+{
+    if(!g_bSimConfigured || g_bSimSuspended)
+    {
+        return;
+    }
+
+    g_bSimSuspended = true;
+    SimUSBEvent(USB_EVENT_SUSPEND);
+}
+
+void SimUSBResume(void)
+{
+    g_bSimResuming = false;
+
+    if(!g_bSimSuspended)
+    {
+        return;
+    }
+
+    g_bSimSuspended = false;
+    SimUSBEvent(USB_EVENT_RESUME);
+
+    // a report queued before the suspend goes out now
+    if(g_bSimBusy)
+    {
+        SimUSBPollNext();
+    }
+}
+
+// The host stops or starts polling the IN endpoint.
+void SimUSBIdle(bool bIdle)
+{
+    g_bSimIdle = bIdle;
+
+    // a report queued meanwhile goes out now
+    if(!bIdle && g_bSimBusy && !g_bSimSuspended)
+    {
+        SimUSBPollNext();
+    }
+}
+
+// The next report reaches the host but its TX complete is lost, or with
+// bForever every report from now on, across re-enumeration.
+void SimUSBDropTx(bool bForever)
+{
+    g_bSimDropTx = true;
+    g_bSimDeadTx = g_bSimDeadTx || bForever;
+}
+
+static void SimUSBConnectEvent(uint32_t ui32Attach)
+{
+    if(ui32Attach == g_ui32SimAttach)
+    {
+        SimUSBConnect();
+    }
+}
+
+static void SimUSBResumeEvent(uint32_t ui32Arg)
+{
+    (void)ui32Arg;
+
+    SimUSBResume();
+}
+
+//*****************************************************************************
+//
+// The device class.
+//
+//*****************************************************************************
+void USBStackModeSet(uint32_t ui32Index, tUSBMode iUSBMode,
+                     tUSBModeCallback pfnCallback)
+{
+    (void)ui32Index;
+    (void)iUSBMode;
+    (void)pfnCallback;
+}
+
+tUSBDHIDGamepadDevice *USBDHIDGamepadInit(uint32_t ui32Index,
+                                          tUSBDHIDGamepadDevice *psGamepad)
+{
+    (void)ui32Index;
+
+    g_psSimGamepad = psGamepad;
+    g_bSimConfigured = false;
+    g_bSimSuspended = false;
+    g_bSimBusy = false;
+    g_bSimTxLost = false;
+
+    SimIntEnable(INT_USB0, true);
+    SimSchedule(g_ui64SimNow + g_sSimConfig.ui64EnumerateNs,
+                SimUSBConnectEvent, g_ui32SimAttach);
+
+    return(psGamepad);
+}
+
+// The device drops off the bus.  The host notices, but the firmware hears
+// nothing more about it.
+void USBDHIDGamepadTerm(tUSBDHIDGamepadDevice *psGamepad)
+{
+    (void)psGamepad;
+
+    g_ui32SimAttach++;
+    g_bSimConfigured = false;
+    g_bSimSuspended = false;
+    g_bSimBusy = false;
+    g_bSimTxLost = false;
+    g_ui32SimEventRead = g_ui32SimEventWrite;
+    g_psSimGamepad = 0;
+}
+
+uint32_t USBDHIDGamepadSendReport(tUSBDHIDGamepadDevice *psGamepad,
+                                  void *pvReport, uint32_t ui32Size)
+{
+    (void)psGamepad;
+
+    if(!g_bSimConfigured)
+    {
+        g_sSimStats.ui32Refused++;
+        return(USBDGAMEPAD_NOT_CONFIGURED);
+    }
+
+    if(g_bSimBusy)
+    {
+        g_sSimStats.ui32Refused++;
+        return(USBDGAMEPAD_TX_ERROR);
+    }
+
+    memset(g_pui8SimReport, 0, SIM_REPORT_SIZE);
+    memcpy(g_pui8SimReport, pvReport,
+           (ui32Size < SIM_REPORT_SIZE) ? ui32Size : SIM_REPORT_SIZE);
+    g_bSimBusy = true;
+    g_sSimStats.ui32Sent++;
+
+    if(!g_bSimSuspended)
+    {
+        SimUSBPollNext();
+    }
+
+    return(USBDGAMEPAD_SUCCESS);
+}
+
+// EP1 IN as the controller shows it: TXPKTRDY while a report waits for the
+// host to poll, clear once it has gone, whether or not TX complete came.
+uint32_t USBEndpointStatus(uint32_t ui32Base, uint32_t ui32Endpoint)
+{
+    (void)ui32Base;
+
+    if((ui32Endpoint == USB_EP_1) && g_bSimBusy && !g_bSimTxLost)
+    {
+        return(USB_DEV_TX_TXPKTRDY);
+    }
+
+    return(0);
+}
+
+// Remote wakeup, granted if the bus is suspended and the host allows it.
+bool USBDCDRemoteWakeupRequest(uint32_t ui32Index)
+{
+    (void)ui32Index;
+
+    if(!g_bSimSuspended || !g_sSimConfig.bRemoteWake)
+    {
+        return(false);
+    }
+
+    if(!g_bSimResuming)
+    {
+        g_bSimResuming = true;
+        SimSchedule(g_ui64SimNow + g_sSimConfig.ui64ResumeNs,
+                    SimUSBResumeEvent, 0);
+    }
+
+    return(true);
+}
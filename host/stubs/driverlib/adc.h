@@ -0,0 +1,38 @@
+//*****************************************************************************
+//
+// adc.h - Host stand-in for the TivaWare ADC API.
+//
+// Copyright (c) Aditya Challamarad.  All rights reserved.
+//
+//*****************************************************************************
+
+#ifndef __DRIVERLIB_ADC_H__
+#define __DRIVERLIB_ADC_H__
+
+#define ADC_CTL_TS              0x00000080
+#define ADC_CTL_IE              0x00000040
+#define ADC_CTL_END             0x00000020
+#define ADC_CTL_D               0x00000010
+#define ADC_CTL_CH0             0x00000000
+#define ADC_CTL_CH1             0x00000001
+#define ADC_CTL_CH2             0x00000002
+#define ADC_CTL_CH3             0x00000003
+#define ADC_CTL_CH4             0x00000004
+#define ADC_CTL_CH5             0x00000005
+#define ADC_CTL_CH6             0x00000006
+#define ADC_CTL_CH7             0x00000007
+#define ADC_CTL_CH8             0x00000008
+#define ADC_CTL_CH9             0x00000009
+#define ADC_CTL_CH10            0x0000000A
+#define ADC_CTL_CH11            0x0000000B
+
+#define ADC_REF_INT             0x00000000
+#define ADC_REF_EXT_3V          0x00000001
+
+extern void ADCReferenceSet(uint32_t ui32Base, uint32_t ui32Ref);
+extern void ADCSequenceStepConfigure(uint32_t ui32Base,
+                                     uint32_t ui32SequenceNum,
+                                     uint32_t ui32Step, uint32_t ui32Config);
+extern void ADCSequenceEnable(uint32_t ui32Base, uint32_t ui32SequenceNum);
+
+#endif
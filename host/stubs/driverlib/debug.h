@@ -0,0 +1,14 @@
+//*****************************************************************************
+//
+// debug.h - Host stand-in for the TivaWare ASSERT macro.
+//
+// Copyright (c) Aditya Challamarad.  All rights reserved.
+//
+//*****************************************************************************
+
+#ifndef __DRIVERLIB_DEBUG_H__
+#define __DRIVERLIB_DEBUG_H__
+
+#define ASSERT(expr)
+
+#endif
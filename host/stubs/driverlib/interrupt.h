@@ -0,0 +1,19 @@
+//*****************************************************************************
+//
+// interrupt.h - Host stand-in for the TivaWare interrupt controller API.
+//
+// Copyright (c) Aditya Challamarad.  All rights reserved.
+//
+//*****************************************************************************
+
+#ifndef __DRIVERLIB_INTERRUPT_H__
+#define __DRIVERLIB_INTERRUPT_H__
+
+extern bool IntMasterEnable(void);
+extern bool IntMasterDisable(void);
+extern void IntEnable(uint32_t ui32Interrupt);
+extern void IntDisable(uint32_t ui32Interrupt);
+extern bool IntIsEnabled(uint32_t ui32Interrupt);
+extern void IntRegister(uint32_t ui32Interrupt, void (*pfnHandler)(void));
+
+#endif
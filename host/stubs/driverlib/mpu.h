@@ -0,0 +1,12 @@
+//*****************************************************************************
+//
+// mpu.h - Host stand-in, the host build has no MPU.
+//
+// Copyright (c) Aditya Challamarad.  All rights reserved.
+//
+//*****************************************************************************
+
+#ifndef __DRIVERLIB_MPU_H__
+#define __DRIVERLIB_MPU_H__
+
+#endif
@@ -0,0 +1,18 @@
+//*****************************************************************************
+//
+// pin_map.h - TM4C123GH6PM pin mux values for the host build.
+//
+// Copyright (c) Aditya Challamarad.  All rights reserved.
+//
+//*****************************************************************************
+
+#ifndef __DRIVERLIB_PIN_MAP_H__
+#define __DRIVERLIB_PIN_MAP_H__
+
+#define GPIO_PA0_U0RX           0x00000001
+#define GPIO_PA1_U0TX           0x00000401
+#define GPIO_PF1_T0CCP1         0x00050407
+#define GPIO_PF2_T1CCP0         0x00050807
+#define GPIO_PF3_T1CCP1         0x00050C07
+
+#endif
@@ -0,0 +1,12 @@
+//*****************************************************************************
+//
+// rom.h - Host stand-in, the host build has no ROM.
+//
+// Copyright (c) Aditya Challamarad.  All rights reserved.
+//
+//*****************************************************************************
+
+#ifndef __DRIVERLIB_ROM_H__
+#define __DRIVERLIB_ROM_H__
+
+#endif
@@ -0,0 +1,64 @@
+//*****************************************************************************
+//
+// rom_map.h - Host stand-in for the TivaWare ROM/flash call mapping.
+//
+// Copyright (c) Aditya Challamarad.  All rights reserved.
+//
+//*****************************************************************************
+
+#ifndef __DRIVERLIB_ROM_MAP_H__
+#define __DRIVERLIB_ROM_MAP_H__
+
+//
+// There is no ROM on the host, every MAP_ call goes to the stand-in.
+//
+#define MAP_SysCtlClockSet                  SysCtlClockSet
+#define MAP_SysCtlPeripheralEnable          SysCtlPeripheralEnable
+#define MAP_SysCtlPeripheralDisable         SysCtlPeripheralDisable
+#define MAP_SysCtlPeripheralReset           SysCtlPeripheralReset
+#define MAP_SysCtlPeripheralReady           SysCtlPeripheralReady
+#define MAP_SysCtlPeripheralDeepSleepEnable SysCtlPeripheralDeepSleepEnable
+#define MAP_SysCtlPeripheralClockGating     SysCtlPeripheralClockGating
+#define MAP_SysCtlReset                     SysCtlReset
+#define MAP_SysCtlResetCauseGet             SysCtlResetCauseGet
+#define MAP_SysCtlResetCauseClear           SysCtlResetCauseClear
+#define MAP_GPIODirModeSet                  GPIODirModeSet
+#define MAP_GPIOPadConfigSet                GPIOPadConfigSet
+#define MAP_GPIOPinConfigure                GPIOPinConfigure
+#define MAP_GPIOPinTypeADC                  GPIOPinTypeADC
+#define MAP_GPIOPinTypeGPIOInput            GPIOPinTypeGPIOInput
+#define MAP_GPIOPinTypeTimer                GPIOPinTypeTimer
+#define MAP_GPIOPinTypeUART                 GPIOPinTypeUART
+#define MAP_GPIOPinTypeUSBAnalog            GPIOPinTypeUSBAnalog
+#define MAP_GPIOPinRead                     GPIOPinRead
+#define MAP_GPIOPinWrite                    GPIOPinWrite
+#define MAP_GPIOIntTypeSet                  GPIOIntTypeSet
+#define MAP_GPIOIntEnable                   GPIOIntEnable
+#define MAP_GPIOIntDisable                  GPIOIntDisable
+#define MAP_GPIOIntClear                    GPIOIntClear
+#define MAP_FlashErase                      FlashErase
+#define MAP_FlashProgram                    FlashProgram
+#define MAP_ADCReferenceSet                 ADCReferenceSet
+#define MAP_ADCSequenceStepConfigure        ADCSequenceStepConfigure
+#define MAP_ADCSequenceEnable               ADCSequenceEnable
+#define MAP_IntEnable                       IntEnable
+#define MAP_IntDisable                      IntDisable
+#define MAP_IntIsEnabled                    IntIsEnabled
+#define MAP_TimerConfigure                  TimerConfigure
+#define MAP_TimerLoadSet                    TimerLoadSet
+#define MAP_TimerMatchSet                   TimerMatchSet
+#define MAP_TimerEnable                     TimerEnable
+#define MAP_TimerDisable                    TimerDisable
+#define MAP_TimerIntEnable                  TimerIntEnable
+#define MAP_TimerIntClear                   TimerIntClear
+#define MAP_WatchdogLockState               WatchdogLockState
+#define MAP_WatchdogUnlock                  WatchdogUnlock
+#define MAP_WatchdogReloadSet               WatchdogReloadSet
+#define MAP_WatchdogStallEnable             WatchdogStallEnable
+#define MAP_WatchdogResetEnable             WatchdogResetEnable
+#define MAP_WatchdogIntEnable               WatchdogIntEnable
+#define MAP_WatchdogIntClear                WatchdogIntClear
+#define MAP_WatchdogEnable                  WatchdogEnable
+#define MAP_USBEndpointStatus               USBEndpointStatus
+
+#endif
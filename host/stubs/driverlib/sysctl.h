@@ -0,0 +1,67 @@
+//*****************************************************************************
+//
+// sysctl.h - Host stand-in for the TivaWare system control API.
+//
+// Copyright (c) Aditya Challamarad.  All rights reserved.
+//
+//*****************************************************************************
+
+#ifndef __DRIVERLIB_SYSCTL_H__
+#define __DRIVERLIB_SYSCTL_H__
+
+#define SYSCTL_PERIPH_WDOG0     0xf0000000
+#define SYSCTL_PERIPH_TIMER0    0xf0000400
+#define SYSCTL_PERIPH_TIMER1    0xf0000401
+#define SYSCTL_PERIPH_TIMER2    0xf0000402
+#define SYSCTL_PERIPH_TIMER3    0xf0000403
+#define SYSCTL_PERIPH_TIMER4    0xf0000404
+#define SYSCTL_PERIPH_GPIOA     0xf0000800
+#define SYSCTL_PERIPH_GPIOB     0xf0000801
+#define SYSCTL_PERIPH_GPIOC     0xf0000802
+#define SYSCTL_PERIPH_GPIOD     0xf0000803
+#define SYSCTL_PERIPH_GPIOE     0xf0000804
+#define SYSCTL_PERIPH_GPIOF     0xf0000805
+#define SYSCTL_PERIPH_UART0     0xf0001800
+#define SYSCTL_PERIPH_USB0      0xf0002800
+#define SYSCTL_PERIPH_ADC0      0xf0003800
+#define SYSCTL_PERIPH_WTIMER5   0xf0005c05
+
+//
+// The host encodes the PLL divider as the number of half steps from the
+// 400MHz PLL in the top byte, so SysCtlClockGet() can work the clock out.
+// The oscillator flags below are left clear of it.
+//
+#define SYSCTL_SYSDIV_2_5       0x05000000
+#define SYSCTL_SYSDIV_4         0x08000000
+#define SYSCTL_SYSDIV_5         0x0A000000
+#define SYSCTL_SYSDIV_10        0x14000000
+#define SYSCTL_USE_PLL          0x00000000
+#define SYSCTL_OSC_MAIN         0x00000000
+#define SYSCTL_XTAL_16MHZ       0x00000540
+
+#define SYSCTL_DSLP_DIV_1       0x00000000
+#define SYSCTL_DSLP_OSC_INT30   0x00000030
+#define SYSCTL_FLASH_LOW_POWER  0x00000003
+#define SYSCTL_SRAM_LOW_POWER   0x00000001
+
+#define SYSCTL_CAUSE_WDOG0      0x00000008
+#define SYSCTL_CAUSE_SW         0x00000010
+
+extern void SysCtlClockSet(uint32_t ui32Config);
+extern uint32_t SysCtlClockGet(void);
+extern void SysCtlPeripheralEnable(uint32_t ui32Peripheral);
+extern void SysCtlPeripheralDisable(uint32_t ui32Peripheral);
+extern void SysCtlPeripheralReset(uint32_t ui32Peripheral);
+extern bool SysCtlPeripheralReady(uint32_t ui32Peripheral);
+extern void SysCtlPeripheralDeepSleepEnable(uint32_t ui32Peripheral);
+extern void SysCtlPeripheralClockGating(bool bEnable);
+extern void SysCtlGPIOAHBEnable(uint32_t ui32GPIOPeripheral);
+extern void SysCtlDeepSleepClockSet(uint32_t ui32Config);
+extern void SysCtlDeepSleepPowerSet(uint32_t ui32Config);
+extern void SysCtlDeepSleep(void);
+extern void SysCtlSleep(void);
+extern void SysCtlReset(void);
+extern uint32_t SysCtlResetCauseGet(void);
+extern void SysCtlResetCauseClear(uint32_t ui32Causes);
+
+#endif
@@ -0,0 +1,46 @@
+//*****************************************************************************
+//
+// timer.h - Host stand-in for the TivaWare timer API.
+//
+// Copyright (c) Aditya Challamarad.  All rights reserved.
+//
+//*****************************************************************************
+
+#ifndef __DRIVERLIB_TIMER_H__
+#define __DRIVERLIB_TIMER_H__
+
+#define TIMER_CFG_ONE_SHOT      0x00000021
+#define TIMER_CFG_PERIODIC      0x00000022
+#define TIMER_CFG_SPLIT_PAIR    0x04000000
+#define TIMER_CFG_A_PERIODIC    0x00000002
+#define TIMER_CFG_A_PWM         0x0000000A
+#define TIMER_CFG_B_PERIODIC    0x00000200
+#define TIMER_CFG_B_PWM         0x00000A00
+
+#define TIMER_TIMA_TIMEOUT      0x00000001
+#define TIMER_TIMB_TIMEOUT      0x00000100
+
+#define TIMER_A                 0x000000ff
+#define TIMER_B                 0x0000ff00
+#define TIMER_BOTH              0x0000ffff
+
+#define TIMER_CLOCK_SYSTEM      0x00000000
+#define TIMER_CLOCK_PIOSC       0x00000001
+
+#define TIMER_UP_LOAD_IMMEDIATE 0x00000000
+#define TIMER_UP_LOAD_TIMEOUT   0x00000100
+
+extern void TimerConfigure(uint32_t ui32Base, uint32_t ui32Config);
+extern void TimerClockSourceSet(uint32_t ui32Base, uint32_t ui32Source);
+extern void TimerLoadSet(uint32_t ui32Base, uint32_t ui32Timer,
+                         uint32_t ui32Value);
+extern void TimerMatchSet(uint32_t ui32Base, uint32_t ui32Timer,
+                          uint32_t ui32Value);
+extern void TimerEnable(uint32_t ui32Base, uint32_t ui32Timer);
+extern void TimerDisable(uint32_t ui32Base, uint32_t ui32Timer);
+extern void TimerIntEnable(uint32_t ui32Base, uint32_t ui32IntFlags);
+extern void TimerIntClear(uint32_t ui32Base, uint32_t ui32IntFlags);
+extern void TimerUpdateMode(uint32_t ui32Base, uint32_t ui32Timer,
+                            uint32_t ui32Config);
+
+#endif
@@ -0,0 +1,17 @@
+//*****************************************************************************
+//
+// uart.h - Host stand-in for the TivaWare UART API.
+//
+// Copyright (c) Aditya Challamarad.  All rights reserved.
+//
+//*****************************************************************************
+
+#ifndef __DRIVERLIB_UART_H__
+#define __DRIVERLIB_UART_H__
+
+#define UART_CLOCK_SYSTEM       0x00000000
+#define UART_CLOCK_PIOSC        0x00000005
+
+extern void UARTClockSourceSet(uint32_t ui32Base, uint32_t ui32Source);
+
+#endif
@@ -0,0 +1,21 @@
+//*****************************************************************************
+//
+// usb.h - Host stand-in for the TivaWare USB controller API.
+//
+// Copyright (c) Aditya Challamarad.  All rights reserved.
+//
+//*****************************************************************************
+
+#ifndef __DRIVERLIB_USB_H__
+#define __DRIVERLIB_USB_H__
+
+#define USB_EP_1                0x00000010
+
+#define USB_DEV_TX_TXPKTRDY     0x00000001
+#define USB_DEV_TX_FIFO_NE      0x00000002
+#define USB_DEV_TX_UNDERRUN     0x00000004
+#define USB_DEV_TX_SENT_STALL   0x00000020
+
+extern uint32_t USBEndpointStatus(uint32_t ui32Base, uint32_t ui32Endpoint);
+
+#endif
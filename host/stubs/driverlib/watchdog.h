@@ -0,0 +1,21 @@
+//*****************************************************************************
+//
+// watchdog.h - Host stand-in for the TivaWare watchdog API.
+//
+// Copyright (c) Aditya Challamarad.  All rights reserved.
+//
+//*****************************************************************************
+
+#ifndef __DRIVERLIB_WATCHDOG_H__
+#define __DRIVERLIB_WATCHDOG_H__
+
+extern bool WatchdogLockState(uint32_t ui32Base);
+extern void WatchdogUnlock(uint32_t ui32Base);
+extern void WatchdogReloadSet(uint32_t ui32Base, uint32_t ui32LoadVal);
+extern void WatchdogStallEnable(uint32_t ui32Base);
+extern void WatchdogResetEnable(uint32_t ui32Base);
+extern void WatchdogIntEnable(uint32_t ui32Base);
+extern void WatchdogIntClear(uint32_t ui32Base);
+extern void WatchdogEnable(uint32_t ui32Base);
+
+#endif
@@ -0,0 +1,24 @@
+//*****************************************************************************
+//
+// hw_adc.h - TM4C123 ADC register offsets for the host build.
+//
+// Copyright (c) Aditya Challamarad.  All rights reserved.
+//
+//*****************************************************************************
+
+#ifndef _HW_ADC_H_
+#define _HW_ADC_H_
+
+#define ADC_O_RIS               0x00000004  // ADC Raw Interrupt Status
+#define ADC_O_ISC               0x0000000C  // ADC Interrupt Status and Clear
+#define ADC_O_PSSI              0x00000028  // ADC Processor Sample Sequence
+                                            // Initiate
+#define ADC_O_SSMUX0            0x00000040  // ADC Sample Sequence Input
+                                            // Multiplexer Select 0
+#define ADC_O_SSFIFO0           0x00000048  // ADC Sample Sequence Result FIFO 0
+#define ADC_O_SSFSTAT0          0x0000004C  // ADC Sample Sequence FIFO 0 Status
+#define ADC_O_SSMUX1            0x00000060  // ADC Sample Sequence Input
+                                            // Multiplexer Select 1
+#define ADC_SSFSTAT0_EMPTY      0x00000100  // FIFO Empty
+
+#endif
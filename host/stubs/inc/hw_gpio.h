@@ -0,0 +1,14 @@
+//*****************************************************************************
+//
+// hw_gpio.h - TM4C123 GPIO register offsets for the host build.
+//
+// Copyright (c) Aditya Challamarad.  All rights reserved.
+//
+//*****************************************************************************
+
+#ifndef _HW_GPIO_H_
+#define _HW_GPIO_H_
+
+#define GPIO_O_DATA             0x00000000   // GPIO Data
+
+#endif
@@ -0,0 +1,36 @@
+//*****************************************************************************
+//
+// hw_ints.h - TM4C123 interrupt numbers for the host build.
+//
+// Copyright (c) Aditya Challamarad.  All rights reserved.
+//
+//*****************************************************************************
+
+#ifndef _HW_INTS_H_
+#define _HW_INTS_H_
+
+#define INT_GPIOA               16
+#define INT_GPIOB               17
+#define INT_GPIOC               18
+#define INT_GPIOD               19
+#define INT_GPIOE               20
+#define INT_UART0               21
+#define INT_WATCHDOG            34
+#define INT_TIMER0A             35
+#define INT_TIMER0B             36
+#define INT_TIMER1A             37
+#define INT_TIMER1B             38
+#define INT_TIMER2A             39
+#define INT_TIMER2B             40
+#define INT_GPIOF               46
+#define INT_TIMER3A             51
+#define INT_TIMER3B             52
+#define INT_USB0                60
+#define INT_TIMER4A             86
+#define INT_TIMER4B             87
+#define INT_WTIMER5A            120
+#define INT_WTIMER5B            121
+
+#define NUM_INTERRUPTS          155
+
+#endif
@@ -0,0 +1,35 @@
+//*****************************************************************************
+//
+// hw_memmap.h - TM4C123 peripheral base addresses for the host build.
+//
+// Copyright (c) Aditya Challamarad.  All rights reserved.
+//
+//*****************************************************************************
+
+#ifndef _HW_MEMMAP_H_
+#define _HW_MEMMAP_H_
+
+#define WATCHDOG0_BASE          0x40000000
+#define GPIO_PORTA_BASE         0x40004000
+#define GPIO_PORTB_BASE         0x40005000
+#define GPIO_PORTC_BASE         0x40006000
+#define GPIO_PORTD_BASE         0x40007000
+#define UART0_BASE              0x4000C000
+#define GPIO_PORTE_BASE         0x40024000
+#define GPIO_PORTF_BASE         0x40025000
+#define TIMER0_BASE             0x40030000
+#define TIMER1_BASE             0x40031000
+#define TIMER2_BASE             0x40032000
+#define TIMER3_BASE             0x40033000
+#define TIMER4_BASE             0x40034000
+#define ADC0_BASE               0x40038000
+#define WTIMER5_BASE            0x4004F000
+#define USB0_BASE               0x40050000
+#define GPIO_PORTA_AHB_BASE     0x40058000
+#define GPIO_PORTB_AHB_BASE     0x40059000
+#define GPIO_PORTC_AHB_BASE     0x4005A000
+#define GPIO_PORTD_AHB_BASE     0x4005B000
+#define GPIO_PORTE_AHB_BASE     0x4005C000
+#define GPIO_PORTF_AHB_BASE     0x4005D000
+
+#endif
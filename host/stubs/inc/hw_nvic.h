@@ -0,0 +1,12 @@
+//*****************************************************************************
+//
+// hw_nvic.h - Host stand-in, nothing here is used off target.
+//
+// Copyright (c) Aditya Challamarad.  All rights reserved.
+//
+//*****************************************************************************
+
+#ifndef _HW_NVIC_H_
+#define _HW_NVIC_H_
+
+#endif
@@ -0,0 +1,12 @@
+//*****************************************************************************
+//
+// hw_sysctl.h - Host stand-in, nothing here is used off target.
+//
+// Copyright (c) Aditya Challamarad.  All rights reserved.
+//
+//*****************************************************************************
+
+#ifndef _HW_SYSCTL_H_
+#define _HW_SYSCTL_H_
+
+#endif
@@ -0,0 +1,24 @@
+//*****************************************************************************
+//
+// hw_types.h - Host stand-in for the TivaWare register access macros.
+//
+// Copyright (c) Aditya Challamarad.  All rights reserved.
+//
+//*****************************************************************************
+
+#ifndef _HW_TYPES_H_
+#define _HW_TYPES_H_
+
+//
+// On the host every register access goes through SimReg(), which returns the
+// word for that address in a simulated register file.  Registers nothing
+// models just hold what was last written.  The DWT cycle counter reads back
+// the simulated cycle count.
+//
+extern volatile uint32_t *SimReg(uint32_t ui32Addr);
+
+#define HWREG(x)                (*SimReg((uint32_t)(x)))
+#define HWREGH(x)               (*(volatile uint16_t *)SimReg((uint32_t)(x)))
+#define HWREGB(x)               (*(volatile uint8_t *)SimReg((uint32_t)(x)))
+
+#endif
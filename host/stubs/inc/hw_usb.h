@@ -0,0 +1,14 @@
+//*****************************************************************************
+//
+// hw_usb.h - TM4C123 USB register offsets for the host build.
+//
+// Copyright (c) Aditya Challamarad.  All rights reserved.
+//
+//*****************************************************************************
+
+#ifndef _HW_USB_H_
+#define _HW_USB_H_
+
+#define USB_O_FRAME             0x0000000C  // USB Frame Value
+
+#endif
@@ -0,0 +1,12 @@
+//*****************************************************************************
+//
+// usbdcomp.h - Host stand-in, the gamepad is not a composite device.
+//
+// Copyright (c) Aditya Challamarad.  All rights reserved.
+//
+//*****************************************************************************
+
+#ifndef __USBDCOMP_H__
+#define __USBDCOMP_H__
+
+#endif
@@ -0,0 +1,14 @@
+//*****************************************************************************
+//
+// usbdevice.h - Host stand-in for the usblib device controller API.
+//
+// Copyright (c) Aditya Challamarad.  All rights reserved.
+//
+//*****************************************************************************
+
+#ifndef __USBDEVICE_H__
+#define __USBDEVICE_H__
+
+extern bool USBDCDRemoteWakeupRequest(uint32_t ui32Index);
+
+#endif
@@ -0,0 +1,22 @@
+//*****************************************************************************
+//
+// usbdhid.h - Host stand-in for the usblib HID device class events.
+//
+// Copyright (c) Aditya Challamarad.  All rights reserved.
+//
+//*****************************************************************************
+
+#ifndef __USBDHID_H__
+#define __USBDHID_H__
+
+#define USBD_HID_EVENT_BASE     (USB_CLASS_EVENT_BASE + 0x1000)
+#define USBD_HID_EVENT_IDLE_TIMEOUT                                           \
+                                (USBD_HID_EVENT_BASE + 0)
+#define USBD_HID_EVENT_GET_REPORT_BUFFER                                      \
+                                (USBD_HID_EVENT_BASE + 1)
+#define USBD_HID_EVENT_GET_REPORT                                             \
+                                (USBD_HID_EVENT_BASE + 2)
+#define USBD_HID_EVENT_SET_REPORT                                             \
+                                (USBD_HID_EVENT_BASE + 3)
+
+#endif
@@ -0,0 +1,50 @@
+//*****************************************************************************
+//
+// usbdhidgamepad.h - Host stand-in for the usblib HID gamepad class.
+//
+// Copyright (c) Aditya Challamarad.  All rights reserved.
+//
+//*****************************************************************************
+
+#ifndef __USBDHIDGAMEPAD_H__
+#define __USBDHIDGAMEPAD_H__
+
+//
+// The gamepad's input report, laid out as g_pui8MyCustomReportDescriptor in
+// usb_gamepad_structs.c describes it.
+//
+typedef struct
+{
+    int8_t i8XPos;
+    int8_t i8YPos;
+    int8_t i8LT;
+    int8_t i8RT;
+    uint8_t ui8Buttons;
+} __attribute__((packed)) tGamepadReport;
+
+typedef struct
+{
+    const uint16_t ui16VID;
+    const uint16_t ui16PID;
+    const uint16_t ui16MaxPowermA;
+    const uint8_t ui8PwrAttributes;
+    const tUSBCallback pfnCallback;
+    void *pvCBData;
+    const uint8_t * const *ppui8StringDescriptors;
+    const uint32_t ui32NumStringDescriptors;
+    const uint8_t *pui8ReportDescriptor;
+    const uint32_t ui32DescriptorSize;
+} tUSBDHIDGamepadDevice;
+
+#define USBDGAMEPAD_SUCCESS     0
+#define USBDGAMEPAD_TX_ERROR    1
+#define USBDGAMEPAD_NOT_CONFIGURED                                            \
+                                2
+
+extern tUSBDHIDGamepadDevice *USBDHIDGamepadInit(uint32_t ui32Index,
+                                        tUSBDHIDGamepadDevice *psGamepad);
+extern void USBDHIDGamepadTerm(tUSBDHIDGamepadDevice *psGamepad);
+extern uint32_t USBDHIDGamepadSendReport(tUSBDHIDGamepadDevice *psGamepad,
+                                         void *pvReport, uint32_t ui32Size);
+
+#endif
@@ -0,0 +1,15 @@
+//*****************************************************************************
+//
+// usb-ids.h - USB vendor and product IDs used with usblib.
+//
+// Copyright (c) Aditya Challamarad.  All rights reserved.
+//
+//*****************************************************************************
+
+#ifndef __USB_IDS_H__
+#define __USB_IDS_H__
+
+#define USB_VID_TI_1CBE         0x1cbe
+#define USB_PID_GAMEPAD         0x000F
+
+#endif
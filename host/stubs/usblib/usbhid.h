@@ -0,0 +1,58 @@
+//*****************************************************************************
+//
+// usbhid.h - Host stand-in for the HID class definitions in usbhid.h.
+//
+// Copyright (c) Aditya Challamarad.  All rights reserved.
+//
+//*****************************************************************************
+
+#ifndef __USBHID_H__
+#define __USBHID_H__
+
+#define USB_HID_REPORT_INPUT    1
+#define USB_HID_REPORT_OUTPUT   2
+#define USB_HID_REPORT_FEATURE  3
+
+// Usage pages and usages.
+#define USB_HID_GENERIC_DESKTOP 0x01
+#define USB_HID_BUTTONS         0x09
+#define USB_HID_GAME_PAD        0x05
+#define USB_HID_X               0x30
+#define USB_HID_Y               0x31
+#define USB_HID_Z               0x32
+#define USB_HID_RX              0x33
+#define USB_HID_RY              0x34
+#define USB_HID_RZ              0x35
+
+// Collection types.
+#define USB_HID_PHYSICAL        0x00
+#define USB_HID_APPLICATION     0x01
+
+// Main item flags.
+#define USB_HID_INPUT_DATA      0x00
+#define USB_HID_INPUT_CONSTANT  0x01
+#define USB_HID_INPUT_ARRAY     0x00
+#define USB_HID_INPUT_VARIABLE  0x02
+#define USB_HID_INPUT_ABS       0x00
+#define USB_HID_INPUT_RELATIVE  0x04
+#define USB_HID_FEATURE_DATA    0x00
+#define USB_HID_FEATURE_CONSTANT 0x01
+#define USB_HID_FEATURE_ARRAY   0x00
+#define USB_HID_FEATURE_VARIABLE 0x02
+#define USB_HID_FEATURE_ABS     0x00
+
+// Report descriptor items, one byte of data each like usblib's.
+#define UsagePage(ui8Value)     0x05, ((ui8Value) & 0xff)
+#define Usage(ui8Value)         0x09, ((ui8Value) & 0xff)
+#define UsageMinimum(ui8Value)  0x19, ((ui8Value) & 0xff)
+#define UsageMaximum(ui8Value)  0x29, ((ui8Value) & 0xff)
+#define LogicalMinimum(i8Value) 0x15, ((i8Value) & 0xff)
+#define LogicalMaximum(i8Value) 0x25, ((i8Value) & 0xff)
+#define ReportSize(ui8Value)    0x75, ((ui8Value) & 0xff)
+#define ReportCount(ui8Value)   0x95, ((ui8Value) & 0xff)
+#define Collection(ui8Value)    0xa1, ((ui8Value) & 0xff)
+#define EndCollection           0xc0
+#define Input(ui8Value)         0x81, ((ui8Value) & 0xff)
+#define Feature(ui8Value)       0xb1, ((ui8Value) & 0xff)
+
+#endif
@@ -0,0 +1,53 @@
+//*****************************************************************************
+//
+// usblib.h - Host stand-in for the parts of usblib.h the firmware uses.
+//
+// Copyright (c) Aditya Challamarad.  All rights reserved.
+//
+//*****************************************************************************
+
+#ifndef __USBLIB_H__
+#define __USBLIB_H__
+
+#define USBShort(ui16Value)     ((ui16Value) & 0xff), ((ui16Value) >> 8)
+
+#define USB_DTYPE_DEVICE        1
+#define USB_DTYPE_CONFIGURATION 2
+#define USB_DTYPE_STRING        3
+
+#define USB_LANG_EN_US          0x0409
+
+#define USB_CONF_ATTR_BUS_PWR   0x80
+#define USB_CONF_ATTR_SELF_PWR  0xC0
+#define USB_CONF_ATTR_RWAKE     0xA0
+
+#define USB_EVENT_BASE          0x0000
+#define USB_EVENT_CONNECTED     (USB_EVENT_BASE + 0)
+#define USB_EVENT_DISCONNECTED  (USB_EVENT_BASE + 1)
+#define USB_EVENT_RX_AVAILABLE  (USB_EVENT_BASE + 2)
+#define USB_EVENT_TX_COMPLETE   (USB_EVENT_BASE + 5)
+#define USB_EVENT_ERROR         (USB_EVENT_BASE + 6)
+#define USB_EVENT_SUSPEND       (USB_EVENT_BASE + 7)
+#define USB_EVENT_RESUME        (USB_EVENT_BASE + 8)
+
+#define USB_CLASS_EVENT_BASE    0x8000
+
+typedef uint32_t (*tUSBCallback)(void *pvCBData, uint32_t ui32Event,
+                                 uint32_t ui32MsgParam, void *pvMsgData);
+
+typedef enum
+{
+    eUSBModeHost = 0,
+    eUSBModeDevice,
+    eUSBModeOTG,
+    eUSBModeNone,
+    eUSBModeForceHost,
+    eUSBModeForceDevice
+} tUSBMode;
+
+typedef void (*tUSBModeCallback)(uint32_t ui32Index, tUSBMode iMode);
+
+extern void USBStackModeSet(uint32_t ui32Index, tUSBMode iUSBMode,
+                            tUSBModeCallback pfnCallback);
+
+#endif
@@ -0,0 +1,20 @@
+//*****************************************************************************
+//
+// uartstdio.h - Host stand-in for the TivaWare UART console.
+//
+// Copyright (c) Aditya Challamarad.  All rights reserved.
+//
+//*****************************************************************************
+
+#ifndef __UARTSTDIO_H__
+#define __UARTSTDIO_H__
+
+extern void UARTStdioConfig(uint32_t ui32Port, uint32_t ui32Baud,
+                            uint32_t ui32SrcClock);
+extern void UARTprintf(const char *pcString, ...);
+extern unsigned char UARTgetc(void);
+extern int UARTRxBytesAvail(void);
+extern void UARTFlushTx(bool bDiscard);
+extern void UARTStdioIntHandler(void);
+
+#endif
@@ -0,0 +1,340 @@
+//*****************************************************************************
+//
+// test_remap.c - Checks the compiled remap tables against the layout.
+//
+// Copyright (c) Aditya Challamarad.  All rights reserved.
+//
+// RemapApply() never reads the layout, only the tables RemapCompile() built
+// from it.  This runs a table of hand-checked cases, then compiles random
+// valid layouts and compares RemapApply() on random inputs with Expected(),
+// which reads the layout field by field the slow way.  Also checks that
+// RemapConfigValid() turns away fields out of range.  Exits non-zero on the
+// first difference.
+//
+//*****************************************************************************
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "remap.h"
+
+#define TEST_LAYOUTS            2000
+#define TEST_INPUTS             500
+
+static uint32_t g_ui32Seed = 1;
+
+static uint32_t Random(void)
+{
+    g_ui32Seed = (g_ui32Seed * 1103515245) + 12345;
+
+    return(g_ui32Seed >> 16);
+}
+
+static bool Signed(uint32_t ui32Axis)
+{
+    return(ui32Axis <= REMAP_AXIS_Y);
+}
+
+// The report psConfig makes of pui8Input, worked out per report.
+static void Expected(const tRemapConfig *psConfig, const uint8_t *pui8Input,
+                     uint8_t *pui8Report)
+{
+    uint32_t ui32Buttons, ui32Layer, ui32Idx, ui32Source, ui32Press;
+    uint32_t ui32Drive;
+    int32_t i32Value, i32Threshold;
+    bool bPressed;
+
+    ui32Buttons = pui8Input[REMAP_FIELD_BUTTONS];
+    ui32Layer = (ui32Buttons & psConfig->ui8Shift) ? 1 : 0;
+    pui8Report[REMAP_FIELD_BUTTONS] = 0;
+
+    for(ui32Idx = 0; ui32Idx < REMAP_BUTTONS; ui32Idx++)
+    {
+        if(ui32Buttons & (1 << ui32Idx))
+        {
+            pui8Report[REMAP_FIELD_BUTTONS] |=
+                psConfig->ppui8Buttons[ui32Layer][ui32Idx];
+        }
+    }
+
+    for(ui32Idx = 0; ui32Idx < REMAP_AXES; ui32Idx++)
+    {
+        ui32Source = psConfig->pui8Axis[ui32Idx] & REMAP_AXIS_SOURCE_M;
+
+        // the value in the range of the output axis
+        if(Signed(ui32Source))
+        {
+            i32Value = (int8_t)pui8Input[ui32Source];
+            i32Value += Signed(ui32Idx) ? 0 : 128;
+        }
+        else
+        {
+            i32Value = pui8Input[ui32Source];
+            i32Value -= Signed(ui32Idx) ? 128 : 0;
+        }
+
+        if(psConfig->pui8Axis[ui32Idx] & REMAP_AXIS_INVERT)
+        {
+            if(Signed(ui32Idx))
+            {
+                i32Value = (i32Value == -128) ? 127 : -i32Value;
+            }
+            else
+            {
+                i32Value = 255 - i32Value;
+            }
+        }
+
+        i32Threshold = Signed(ui32Idx) ?
+                       (int8_t)psConfig->pui8Threshold[ui32Idx] :
+                       psConfig->pui8Threshold[ui32Idx];
+
+        if(!i32Threshold)
+        {
+            bPressed = false;
+        }
+        else if(i32Threshold > 0)
+        {
+            bPressed = (i32Value >= i32Threshold);
+        }
+        else
+        {
+            bPressed = (i32Value <= i32Threshold);
+        }
+
+        ui32Press = (psConfig->pui8Axis[ui32Idx] & REMAP_AXIS_PRESS_M) >>
+                    REMAP_AXIS_PRESS_S;
+
+        if(bPressed && ui32Press)
+        {
+            pui8Report[REMAP_FIELD_BUTTONS] |= 1 << (ui32Press - 1);
+        }
+
+        ui32Drive = psConfig->pui8Drive[ui32Idx];
+
+        if(ui32Drive &&
+           ((ui32Buttons & (ui32Drive | psConfig->ui8Shift)) == ui32Drive))
+        {
+            pui8Report[ui32Idx] = psConfig->pui8DriveValue[ui32Idx];
+        }
+        else
+        {
+            pui8Report[ui32Idx] = (uint8_t)i32Value;
+        }
+    }
+}
+
+// A hand-checked case: a change to the identity, an input and the report.
+typedef struct
+{
+    const char *pcName;
+    uint32_t ui32Field;
+    uint8_t pui8Value[REMAP_AXES];
+    uint8_t pui8Input[REMAP_REPORT_SIZE];
+    uint8_t pui8Report[REMAP_REPORT_SIZE];
+} tRemapCase;
+
+#define CASE_NONE               0
+#define CASE_AXIS               1
+
+static const tRemapCase g_psRemapCases[] =
+{
+    { "identity", CASE_NONE, { 0 },
+      { 0x80, 0x7f, 0x00, 0xff, 0x1f }, { 0x80, 0x7f, 0x00, 0xff, 0x1f } },
+    { "sticks inverted", CASE_AXIS, { 0x80, 0x81, 2, 3 },
+      { 0x80, 0x05, 0x00, 0xff, 0x00 }, { 0x7f, 0xfb, 0x00, 0xff, 0x00 } },
+    { "triggers inverted", CASE_AXIS, { 0, 1, 0x82, 0x83 },
+      { 0x00, 0x00, 0x00, 0x40, 0x00 }, { 0x00, 0x00, 0xff, 0xbf, 0x00 } },
+    { "sticks from triggers", CASE_AXIS, { 2, 3, 2, 3 },
+      { 0x00, 0x00, 0x00, 0xff, 0x00 }, { 0x80, 0x7f, 0x00, 0xff, 0x00 } },
+    { "triggers from sticks", CASE_AXIS, { 0, 1, 0, 0x81 },
+      { 0x00, 0x80, 0x00, 0x00, 0x00 }, { 0x00, 0x80, 0x80, 0xff, 0x00 } },
+    { "stick presses below", CASE_AXIS, { 0x10, 1, 2, 3 },
+      { 0xc0, 0x00, 0x00, 0x00, 0x00 }, { 0xc0, 0x00, 0x00, 0x00, 0x01 } },
+    { "trigger presses at", CASE_AXIS, { 0, 1, 0x52, 3 },
+      { 0x00, 0x00, 0x80, 0x00, 0x00 }, { 0x00, 0x00, 0x80, 0x00, 0x10 } },
+};
+
+static bool Fail(const char *pcWhat, const uint8_t *pui8Input,
+                 const uint8_t *pui8Got, const uint8_t *pui8Want)
+{
+    fprintf(stderr, "test_remap: %s, input %02x %02x %02x %02x %02x, got "
+            "%02x %02x %02x %02x %02x, want %02x %02x %02x %02x %02x\n",
+            pcWhat, pui8Input[0], pui8Input[1], pui8Input[2], pui8Input[3],
+            pui8Input[4], pui8Got[0], pui8Got[1], pui8Got[2], pui8Got[3],
+            pui8Got[4], pui8Want[0], pui8Want[1], pui8Want[2], pui8Want[3],
+            pui8Want[4]);
+
+    return(false);
+}
+
+static bool Cases(void)
+{
+    tRemapConfig sConfig;
+    uint8_t pui8Report[REMAP_REPORT_SIZE];
+    uint32_t ui32Case, ui32Idx;
+    const tRemapCase *psCase;
+
+    for(ui32Case = 0;
+        ui32Case < (sizeof(g_psRemapCases) / sizeof(g_psRemapCases[0]));
+        ui32Case++)
+    {
+        psCase = &g_psRemapCases[ui32Case];
+        RemapConfigDefaults(&sConfig);
+
+        if(psCase->ui32Field == CASE_AXIS)
+        {
+            memcpy(sConfig.pui8Axis, psCase->pui8Value, REMAP_AXES);
+        }
+
+        // the press cases press at -64 on X and 128 on LT
+        for(ui32Idx = 0; ui32Idx < REMAP_AXES; ui32Idx++)
+        {
+            sConfig.pui8Threshold[ui32Idx] = Signed(ui32Idx) ? 0xc0 : 0x80;
+        }
+
+        RemapCompile(&sConfig);
+        RemapApply(psCase->pui8Input, pui8Report);
+
+        if(memcmp(pui8Report, psCase->pui8Report, REMAP_REPORT_SIZE))
+        {
+            return(Fail(psCase->pcName, psCase->pui8Input, pui8Report,
+                        psCase->pui8Report));
+        }
+    }
+
+    return(true);
+}
+
+// A layout with every field random but in range.
+static void RandomLayout(tRemapConfig *psConfig)
+{
+    uint32_t ui32Idx;
+
+    psConfig->ui8Shift = (Random() & 1) ?
+                         (1 << (Random() % REMAP_BUTTONS)) : 0;
+
+    for(ui32Idx = 0; ui32Idx < REMAP_BUTTONS; ui32Idx++)
+    {
+        psConfig->ppui8Buttons[0][ui32Idx] = Random() % REMAP_BUTTON_STATES;
+        psConfig->ppui8Buttons[1][ui32Idx] = Random() % REMAP_BUTTON_STATES;
+    }
+
+    for(ui32Idx = 0; ui32Idx < REMAP_AXES; ui32Idx++)
+    {
+        psConfig->pui8Axis[ui32Idx] =
+            (Random() & (REMAP_AXIS_SOURCE_M | REMAP_AXIS_INVERT)) |
+            ((Random() % (REMAP_BUTTONS + 1)) << REMAP_AXIS_PRESS_S);
+        psConfig->pui8Threshold[ui32Idx] = (Random() & 3) ? Random() : 0;
+        psConfig->pui8Drive[ui32Idx] =
+            (Random() & 1) ? (Random() % REMAP_BUTTON_STATES) : 0;
+        psConfig->pui8DriveValue[ui32Idx] = Random();
+    }
+}
+
+static bool Layouts(void)
+{
+    tRemapConfig sConfig;
+    uint8_t pui8Input[REMAP_REPORT_SIZE], pui8Report[REMAP_REPORT_SIZE];
+    uint8_t pui8Want[REMAP_REPORT_SIZE];
+    uint32_t ui32Layout, ui32Input, ui32Idx;
+
+    for(ui32Layout = 0; ui32Layout < TEST_LAYOUTS; ui32Layout++)
+    {
+        RandomLayout(&sConfig);
+
+        if(!RemapConfigValid(&sConfig))
+        {
+            fprintf(stderr, "test_remap: layout %u refused\n", ui32Layout);
+            return(false);
+        }
+
+        RemapCompile(&sConfig);
+
+        for(ui32Input = 0; ui32Input < TEST_INPUTS; ui32Input++)
+        {
+            for(ui32Idx = 0; ui32Idx < REMAP_AXES; ui32Idx++)
+            {
+                // the ends and the centre more often than the rest
+                pui8Input[ui32Idx] = (Random() & 3) ? Random() :
+                                     ((Random() & 1) ? 0x80 : 0x7f);
+            }
+
+            pui8Input[REMAP_FIELD_BUTTONS] = Random() % REMAP_BUTTON_STATES;
+
+            RemapApply(pui8Input, pui8Report);
+            Expected(&sConfig, pui8Input, pui8Want);
+
+            if(memcmp(pui8Report, pui8Want, REMAP_REPORT_SIZE))
+            {
+                fprintf(stderr, "test_remap: layout %u\n", ui32Layout);
+                return(Fail("random layout", pui8Input, pui8Report,
+                            pui8Want));
+            }
+        }
+    }
+
+    printf("%u layouts, %u inputs each\n", TEST_LAYOUTS, TEST_INPUTS);
+
+    return(true);
+}
+
+// One field out of range at a time.
+static bool Invalid(void)
+{
+    tRemapConfig sConfig;
+    uint32_t ui32Field;
+
+    for(ui32Field = 0; ui32Field < 5; ui32Field++)
+    {
+        RemapConfigDefaults(&sConfig);
+
+        switch(ui32Field)
+        {
+            case 0:
+            {
+                sConfig.ui8Shift = 0x03;
+                break;
+            }
+
+            case 1:
+            {
+                sConfig.ui8Shift = REMAP_BUTTON_STATES;
+                break;
+            }
+
+            case 2:
+            {
+                sConfig.ppui8Buttons[1][2] = REMAP_BUTTON_STATES;
+                break;
+            }
+
+            case 3:
+            {
+                sConfig.pui8Axis[3] =
+                    (REMAP_BUTTONS + 1) << REMAP_AXIS_PRESS_S;
+                break;
+            }
+
+            default:
+            {
+                sConfig.pui8Drive[0] = REMAP_BUTTON_STATES;
+                break;
+            }
+        }
+
+        if(RemapConfigValid(&sConfig))
+        {
+            fprintf(stderr, "test_remap: bad field %u accepted\n", ui32Field);
+            return(false);
+        }
+    }
+
+    return(true);
+}
+
+int main(void)
+{
+    return((Cases() && Layouts() && Invalid()) ? 0 : 1);
+}
@@ -0,0 +1,274 @@
+//*****************************************************************************
+//
+// test_trace.c - Round trips reports through the trace encoder and decoder.
+//
+// Copyright (c) Aditya Challamarad.  All rights reserved.
+//
+// Encodes a run of reports covering every record form, from a repeat that
+// is not recorded to a full record after a gap of hours, decodes the result
+// and checks each record comes back with its report and time.  Then checks
+// a trace cut anywhere inside a record is seen as truncated, reserved tags
+// as bad, and the header.  Exits non-zero on the first difference.
+//
+//*****************************************************************************
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "trace.h"
+
+#define TEST_REPORTS            4096
+
+static uint8_t g_pui8Trace[TEST_REPORTS * TRACE_RECORD_MAX + 1];
+static uint8_t g_ppui8Reports[TEST_REPORTS][TRACE_REPORT_SIZE];
+static uint64_t g_pui64Times[TEST_REPORTS];
+
+static uint32_t g_ui32Seed = 1;
+
+static uint32_t Random(void)
+{
+    g_ui32Seed = (g_ui32Seed * 1103515245) + 12345;
+
+    return(g_ui32Seed >> 16);
+}
+
+// The next report from the last, changed in one of the ways a trace sees.
+static void NextReport(const uint8_t *pui8Last, uint8_t *pui8Report,
+                       uint64_t *pui64Time)
+{
+    uint32_t ui32Kind = Random() % 8;
+
+    memcpy(pui8Report, pui8Last, TRACE_REPORT_SIZE);
+    *pui64Time += 1 + (Random() % 2000);
+
+    switch(ui32Kind)
+    {
+        case 0:
+        {
+            // unchanged, not recorded
+            break;
+        }
+
+        case 1:
+        {
+            pui8Report[TRACE_FIELD_BUTTONS] = Random() & TRACE_TAG_FULL_MASK;
+            break;
+        }
+
+        case 2:
+        {
+            // a button byte only the full form can carry
+            pui8Report[TRACE_FIELD_BUTTONS] = 0x20 | (Random() & 0xff);
+            break;
+        }
+
+        case 3:
+        {
+            // a step from -8 to 7, including the wrap past -128 and 127
+            pui8Report[Random() % 4] += (uint8_t)((Random() % 16) - 8);
+            break;
+        }
+
+        case 4:
+        {
+            // just outside the short form
+            pui8Report[Random() % 4] += (Random() & 1) ? 8 : (uint8_t)-9;
+            break;
+        }
+
+        case 5:
+        {
+            pui8Report[Random() % TRACE_REPORT_SIZE] = (uint8_t)Random();
+            pui8Report[Random() % TRACE_REPORT_SIZE] = (uint8_t)Random();
+            break;
+        }
+
+        case 6:
+        {
+            // a long pause, past what 32 bits of microseconds hold
+            *pui64Time += (uint64_t)Random() << 20;
+            pui8Report[0] = (uint8_t)Random();
+            break;
+        }
+
+        default:
+        {
+            pui8Report[3] = (uint8_t)Random();
+            break;
+        }
+    }
+}
+
+static bool Fail(const char *pcWhat, uint32_t ui32Record)
+{
+    fprintf(stderr, "test_trace: %s at record %u\n", pcWhat, ui32Record);
+
+    return(false);
+}
+
+// Encode the reports, then decode them back.
+static bool RoundTrip(void)
+{
+    tTraceState sEncode, sDecode;
+    uint8_t pui8Last[TRACE_REPORT_SIZE] = { 0 }, pui8Report[TRACE_REPORT_SIZE];
+    uint32_t ui32Idx, ui32Len, ui32Size = 0, ui32Records = 0;
+    uint64_t ui64Time = 0;
+    int32_t i32Len;
+
+    TraceStart(&sEncode);
+
+    for(ui32Idx = 0; ui32Idx < TEST_REPORTS; ui32Idx++)
+    {
+        NextReport(pui8Last, pui8Report, &ui64Time);
+        memcpy(pui8Last, pui8Report, TRACE_REPORT_SIZE);
+
+        // the first report is recorded whatever it is
+        ui32Len = TraceEncode(&sEncode, ui64Time, pui8Report,
+                              &g_pui8Trace[ui32Size]);
+
+        if(ui32Len > TRACE_RECORD_MAX)
+        {
+            return(Fail("record too long", ui32Idx));
+        }
+
+        if(!ui32Len)
+        {
+            continue;
+        }
+
+        memcpy(g_ppui8Reports[ui32Records], pui8Report, TRACE_REPORT_SIZE);
+        g_pui64Times[ui32Records++] = ui64Time;
+        ui32Size += ui32Len;
+    }
+
+    g_pui8Trace[ui32Size++] = TRACE_TAG_END;
+
+    TraceStart(&sDecode);
+
+    for(ui32Idx = 0, ui32Len = 0; ui32Idx < ui32Records; ui32Idx++)
+    {
+        i32Len = TraceDecode(&sDecode, &g_pui8Trace[ui32Len],
+                             ui32Size - ui32Len);
+
+        if(i32Len <= 0)
+        {
+            return(Fail("trace ended early", ui32Idx));
+        }
+
+        if(memcmp(sDecode.pui8Report, g_ppui8Reports[ui32Idx],
+                  TRACE_REPORT_SIZE))
+        {
+            return(Fail("wrong report", ui32Idx));
+        }
+
+        if(sDecode.ui64TimeUs != g_pui64Times[ui32Idx])
+        {
+            return(Fail("wrong time", ui32Idx));
+        }
+
+        ui32Len += (uint32_t)i32Len;
+    }
+
+    if(TraceDecode(&sDecode, &g_pui8Trace[ui32Len], ui32Size - ui32Len) !=
+       TRACE_END)
+    {
+        return(Fail("no end tag", ui32Idx));
+    }
+
+    printf("%u reports, %u records in %u bytes\n", TEST_REPORTS, ui32Records,
+           ui32Size);
+
+    return(true);
+}
+
+// Every record cut short is truncated, never bad or a record.
+static bool Truncated(void)
+{
+    tTraceState sState;
+    uint8_t pui8Report[TRACE_REPORT_SIZE] = { 1, 2, 3, 4, 0x25 };
+    uint32_t ui32Len, ui32Cut;
+
+    TraceStart(&sState);
+    ui32Len = TraceEncode(&sState, 0x123456789ull, pui8Report, g_pui8Trace);
+
+    for(ui32Cut = 0; ui32Cut < ui32Len; ui32Cut++)
+    {
+        TraceStart(&sState);
+
+        if(TraceDecode(&sState, g_pui8Trace, ui32Cut) != TRACE_TRUNCATED)
+        {
+            return(Fail("cut record not truncated", ui32Cut));
+        }
+    }
+
+    return(true);
+}
+
+// Reserved tags are bad, erased flash ends the trace.
+static bool Tags(void)
+{
+    tTraceState sState;
+    uint8_t pui8Record[2] = { 0, 0 };
+    uint32_t ui32Tag;
+    int32_t i32Expect, i32Len;
+
+    for(ui32Tag = 0; ui32Tag < 256; ui32Tag++)
+    {
+        if((ui32Tag == TRACE_TAG_END) || (ui32Tag == TRACE_TAG_ERASED))
+        {
+            i32Expect = TRACE_END;
+        }
+        else if(((ui32Tag > TRACE_TAG_FULL_MASK) &&
+                 (ui32Tag < TRACE_TAG_AXIS)) ||
+                (ui32Tag > (TRACE_TAG_BUTTONS | TRACE_TAG_FULL_MASK)))
+        {
+            i32Expect = TRACE_BAD;
+        }
+        else
+        {
+            // a tag and a zero time, or a full tag short of its fields
+            i32Expect = 2;
+        }
+
+        pui8Record[0] = (uint8_t)ui32Tag;
+        TraceStart(&sState);
+        i32Len = TraceDecode(&sState, pui8Record, sizeof(pui8Record));
+
+        if((i32Len != i32Expect) &&
+           ((i32Expect != 2) || (i32Len != TRACE_TRUNCATED)))
+        {
+            return(Fail("wrong result for tag", ui32Tag));
+        }
+    }
+
+    return(true);
+}
+
+static bool Header(void)
+{
+    uint8_t pui8Header[TRACE_HEADER_SIZE];
+
+    TraceHeader(pui8Header, 1234, TRACE_OPEN);
+
+    if(!TraceHeaderValid(pui8Header) ||
+       (TraceGetU32(&pui8Header[8]) != 1234) ||
+       (TraceGetU32(&pui8Header[12]) != TRACE_OPEN))
+    {
+        return(Fail("bad header", 0));
+    }
+
+    pui8Header[4]++;
+
+    if(TraceHeaderValid(pui8Header))
+    {
+        return(Fail("wrong version accepted", 0));
+    }
+
+    return(true);
+}
+
+int main(void)
+{
+    return((RoundTrip() && Truncated() && Tags() && Header()) ? 0 : 1);
+}
@@ -0,0 +1,52 @@
+//*****************************************************************************
+//
+// hotpath.h - Clock and code placement for the performance build profile.
+//
+// Copyright (c) Aditya Challamarad.  All rights reserved.
+//
+//*****************************************************************************
+
+#ifndef _HOTPATH_H_
+#define _HOTPATH_H_
+
+//
+// The performance profile is opt-in.  Build with PERF_PROFILE defined, for
+// both the compiler and the linker, to run the core at 80MHz and execute the
+// input to report path from SRAM.  Above 40MHz every flash access that
+// misses the prefetch buffer stalls, SRAM runs at the core clock with no
+// wait states.
+//
+// Without it the clock stays at 50MHz and everything runs from flash.
+//
+
+#ifdef PERF_PROFILE
+// 400MHz PLL / 2 / 2.5
+#define HOTPATH_SYSDIV          SYSCTL_SYSDIV_2_5
+#define HOTPATH_CLOCK_MHZ       80
+#else
+// 400MHz PLL / 2 / 4
+#define HOTPATH_SYSDIV          SYSCTL_SYSDIV_4
+#define HOTPATH_CLOCK_MHZ       50
+#endif
+
+//
+// Mark a function as part of the hot path.  In the performance profile the
+// linker puts it in .TI.ramfunc, which the boot code copies from flash to
+// SRAM before main.  Library functions on the same path are pulled into
+// .TI.ramfunc by name in usb_dev_gamepad_ccs.cmd.
+//
+#if defined(PERF_PROFILE) && defined(__TI_COMPILER_VERSION__)
+#define HOT_FUNC                __attribute__((ramfunc))
+#else
+#define HOT_FUNC
+#endif
+
+// True if the function at pfn runs from SRAM.  Never on the host, where the
+// address is wherever the loader put it.
+#ifdef HAL_HOST
+#define HotPathInSRAM(pfn)      ((void)(pfn), false)
+#else
+#define HotPathInSRAM(pfn)      (((uint32_t)(pfn) & 0xf0000000) == 0x20000000)
+#endif
+
+#endif
@@ -0,0 +1,197 @@
+//*****************************************************************************
+//
+// isrprof.c - Interrupt execution time profiler and CPU load meter.
+//
+// Copyright (c) Aditya Challamarad.  All rights reserved.
+//
+// With ISR_PROFILE defined the vector table points at the ISRProf* wrappers
+// below instead of the real handlers.  Each wrapper times its handler with
+// the DWT cycle counter, so the figures cover the handler body but not the
+// 12 cycle exception entry/exit.
+//
+// CPU load comes from the main loop.  Every cycle is spent in some pass of
+// the loop, so the sum of the pass lengths is the elapsed time.  Passes that
+// did no work count as idle, minus any interrupt time that landed in them.
+//
+//*****************************************************************************
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "inc/hw_types.h"
+#include "driverlib/interrupt.h"
+#include "drivers/cycles.h"
+#include "utils/uartstdio.h"
+#include "isrprof.h"
+#include "hotpath.h"
+
+tISRProfile g_psISRProfile[ISR_PROF_NUM];
+
+// Cycles spent in all profiled handlers, in the main loop, and in main
+// loop passes that found nothing to do.
+static volatile uint64_t g_ui64ISRCycles;
+static uint64_t g_ui64LoopCycles;
+static uint64_t g_ui64IdleCycles;
+
+// Start of the current loop pass and the handler total at that point.
+static uint32_t g_ui32LoopStart;
+static uint64_t g_ui64LoopISRStart;
+
+#ifdef ISR_PROFILE
+static const char * const g_ppcISRProfName[ISR_PROF_NUM] =
+{
+    "uart0", "usb0"
+};
+
+extern void UARTStdioIntHandler(void);
+extern void USB0DeviceIntHandler(void);
+
+// Add one handler run to its slot.
+HOT_FUNC static void ISRProfRecord(uint32_t ui32Slot, uint32_t ui32Cycles)
+{
+    tISRProfile *psProf = &g_psISRProfile[ui32Slot];
+
+    psProf->ui32Count++;
+    psProf->ui64Total += ui32Cycles;
+
+    if(ui32Cycles < psProf->ui32Min)
+    {
+        psProf->ui32Min = ui32Cycles;
+    }
+
+    if(ui32Cycles > psProf->ui32Max)
+    {
+        psProf->ui32Max = ui32Cycles;
+    }
+
+    g_ui64ISRCycles += ui32Cycles;
+}
+
+// Generate ISRProf<handler>() which times <handler> into slot ui32Slot.
+#define ISR_PROF_WRAPPER(pfnHandler, ui32Slot)                                \
+HOT_FUNC void ISRProf##pfnHandler(void)                                       \
+{                                                                             \
+    uint32_t ui32Start = CyclesGet();                                         \
+    pfnHandler();                                                             \
+    ISRProfRecord((ui32Slot), CyclesSince(ui32Start));                        \
+}
+
+ISR_PROF_WRAPPER(UARTStdioIntHandler, ISR_PROF_UART0)
+ISR_PROF_WRAPPER(USB0DeviceIntHandler, ISR_PROF_USB0)
+#endif
+
+// Clear all handler statistics and restart the load measurement.
+void ISRProfReset(void)
+{
+    uint32_t ui32Slot;
+    bool bMasked;
+
+    bMasked = IntMasterDisable();
+
+    for(ui32Slot = 0; ui32Slot < ISR_PROF_NUM; ui32Slot++)
+    {
+        g_psISRProfile[ui32Slot].ui32Count = 0;
+        g_psISRProfile[ui32Slot].ui32Min = 0xffffffff;
+        g_psISRProfile[ui32Slot].ui32Max = 0;
+        g_psISRProfile[ui32Slot].ui64Total = 0;
+    }
+
+    g_ui64ISRCycles = 0;
+    g_ui64LoopCycles = 0;
+    g_ui64IdleCycles = 0;
+    g_ui64LoopISRStart = 0;
+
+    if(!bMasked)
+    {
+        IntMasterEnable();
+    }
+}
+
+void ISRProfLoopBeginFn(void)
+{
+    g_ui32LoopStart = CyclesGet();
+    g_ui64LoopISRStart = g_ui64ISRCycles;
+}
+
+void ISRProfLoopEndFn(bool bBusy)
+{
+    uint32_t ui32Pass, ui32ISR;
+
+    ui32Pass = CyclesSince(g_ui32LoopStart);
+    ui32ISR = (uint32_t)(g_ui64ISRCycles - g_ui64LoopISRStart);
+
+    g_ui64LoopCycles += ui32Pass;
+
+    if(!bBusy && (ui32Pass > ui32ISR))
+    {
+        g_ui64IdleCycles += ui32Pass - ui32ISR;
+    }
+}
+
+// Mean cycles per run of one handler.
+uint32_t ISRProfMean(uint32_t ui32Slot)
+{
+    tISRProfile *psProf = &g_psISRProfile[ui32Slot];
+
+    if(psProf->ui32Count == 0)
+    {
+        return(0);
+    }
+
+    return((uint32_t)(psProf->ui64Total / psProf->ui32Count));
+}
+
+// Busy (non idle) share of the CPU in tenths of a percent.
+uint32_t ISRProfCPULoad(void)
+{
+    if(g_ui64LoopCycles == 0)
+    {
+        return(0);
+    }
+
+    return((uint32_t)(((g_ui64LoopCycles - g_ui64IdleCycles) * 1000) /
+                      g_ui64LoopCycles));
+}
+
+// Share of the CPU spent in the profiled handlers in tenths of a percent.
+uint32_t ISRProfISRLoad(void)
+{
+    if(g_ui64LoopCycles == 0)
+    {
+        return(0);
+    }
+
+    return((uint32_t)((g_ui64ISRCycles * 1000) / g_ui64LoopCycles));
+}
+
+// Dump the handler statistics and CPU load to the UART console.
+void ISRProfPrint(void)
+{
+#ifdef ISR_PROFILE
+    tISRProfile *psProf;
+    uint32_t ui32Slot, ui32Load;
+
+    UARTprintf("\nisr cycles\n");
+
+    for(ui32Slot = 0; ui32Slot < ISR_PROF_NUM; ui32Slot++)
+    {
+        psProf = &g_psISRProfile[ui32Slot];
+
+        if(psProf->ui32Count == 0)
+        {
+            UARTprintf("%s: no calls\n", g_ppcISRProfName[ui32Slot]);
+            continue;
+        }
+
+        UARTprintf("%s: n=%u min=%u max=%u mean=%u\n",
+                   g_ppcISRProfName[ui32Slot], psProf->ui32Count,
+                   psProf->ui32Min, psProf->ui32Max, ISRProfMean(ui32Slot));
+    }
+
+    ui32Load = ISRProfCPULoad();
+    UARTprintf("cpu busy %u.%u%%", ui32Load / 10, ui32Load % 10);
+    ui32Load = ISRProfISRLoad();
+    UARTprintf(" (isr %u.%u%%)\n", ui32Load / 10, ui32Load % 10);
+#else
+    UARTprintf("\nisr profiling not built in (define ISR_PROFILE)\n");
+#endif
+}
@@ -0,0 +1,61 @@
+//*****************************************************************************
+//
+// isrprof.h - Interrupt execution time profiler and CPU load meter.
+//
+// Copyright (c) Aditya Challamarad.  All rights reserved.
+//
+//*****************************************************************************
+
+#ifndef _ISRPROF_H_
+#define _ISRPROF_H_
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+//
+// Profiling is opt-in.  Build with ISR_PROFILE defined to route the
+// profiled vector table entries in startup_ccs.c through the wrappers in
+// isrprof.c.  Without it the loop hooks below compile to nothing and the
+// counters stay at zero.
+//
+
+// Handlers that can be profiled, one slot each.
+#define ISR_PROF_UART0          0   // UARTStdioIntHandler
+#define ISR_PROF_USB0           1   // USB0DeviceIntHandler
+#define ISR_PROF_NUM            2
+
+typedef struct
+{
+    uint32_t ui32Count;
+    uint32_t ui32Min;
+    uint32_t ui32Max;
+    uint64_t ui64Total;
+} tISRProfile;
+
+extern tISRProfile g_psISRProfile[ISR_PROF_NUM];
+
+#ifdef ISR_PROFILE
+// Bracket each pass of the main loop.  bBusy says whether the pass did any
+// work, passes that only polled count as idle time.
+#define ISRProfLoopBegin()      ISRProfLoopBeginFn()
+#define ISRProfLoopEnd(bBusy)   ISRProfLoopEndFn(bBusy)
+#else
+#define ISRProfLoopBegin()
+#define ISRProfLoopEnd(bBusy)
+#endif
+
+extern void ISRProfReset(void);
+extern void ISRProfLoopBeginFn(void);
+extern void ISRProfLoopEndFn(bool bBusy);
+extern uint32_t ISRProfMean(uint32_t ui32Slot);
+extern uint32_t ISRProfCPULoad(void);
+extern uint32_t ISRProfISRLoad(void);
+extern void ISRProfPrint(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,172 @@
+//*****************************************************************************
+//
+// latency.c - Input to USB latency instrumentation for the gamepad.
+//
+// Copyright (c) Aditya Challamarad.  All rights reserved.
+//
+// The main loop timestamps each step of building a report with the DWT
+// cycle counter and the TX complete callback closes the trace.  Each stage
+// goes into a log2 bucketed histogram so the distribution, not just the
+// average, can be read back over the UART console or the latency feature
+// page.  This is always on; a stamp is one register read and a store.
+//
+//*****************************************************************************
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "inc/hw_types.h"
+#include "driverlib/interrupt.h"
+#include "driverlib/sysctl.h"
+#include "drivers/cycles.h"
+#include "utils/uartstdio.h"
+#include "latency.h"
+#include "hotpath.h"
+
+volatile uint32_t g_pui32LatencyStamp[LATENCY_NUM_POINTS];
+
+tLatencyHistogram g_psLatency[LATENCY_NUM_STAGES];
+
+// Set once a report is handed to the driver, so TX complete knows the
+// stamps belong to it.
+static volatile bool g_bLatencyArmed;
+
+static const char * const g_ppcLatencyStage[LATENCY_NUM_STAGES] =
+{
+    "adc", "debounce", "pack", "send", "tx", "total"
+};
+
+// Count leading zeros, the TI compiler spells the intrinsic differently.
+#if defined(ccs)
+#define LatencyCLZ(ui32Value)   _norm(ui32Value)
+#else
+#define LatencyCLZ(ui32Value)   __builtin_clz(ui32Value)
+#endif
+
+// Clear all histograms.
+void LatencyReset(void)
+{
+    uint32_t ui32Stage, ui32Bucket;
+    bool bMasked;
+
+    bMasked = IntMasterDisable();
+
+    for(ui32Stage = 0; ui32Stage < LATENCY_NUM_STAGES; ui32Stage++)
+    {
+        g_psLatency[ui32Stage].ui32Count = 0;
+        g_psLatency[ui32Stage].ui32Min = 0xffffffff;
+        g_psLatency[ui32Stage].ui32Max = 0;
+
+        for(ui32Bucket = 0; ui32Bucket < LATENCY_NUM_BUCKETS; ui32Bucket++)
+        {
+            g_psLatency[ui32Stage].pui32Buckets[ui32Bucket] = 0;
+        }
+    }
+
+    if(!bMasked)
+    {
+        IntMasterEnable();
+    }
+}
+
+// Add one sample to a stage histogram.
+HOT_FUNC void LatencyRecord(uint32_t ui32Stage, uint32_t ui32Cycles)
+{
+    tLatencyHistogram *psHist = &g_psLatency[ui32Stage];
+    uint32_t ui32Bucket;
+
+    ui32Bucket = ui32Cycles ? (32 - LatencyCLZ(ui32Cycles)) : 0;
+    if(ui32Bucket >= LATENCY_NUM_BUCKETS)
+    {
+        ui32Bucket = LATENCY_NUM_BUCKETS - 1;
+    }
+
+    psHist->pui32Buckets[ui32Bucket]++;
+    psHist->ui32Count++;
+
+    if(ui32Cycles < psHist->ui32Min)
+    {
+        psHist->ui32Min = ui32Cycles;
+    }
+
+    if(ui32Cycles > psHist->ui32Max)
+    {
+        psHist->ui32Max = ui32Cycles;
+    }
+}
+
+// The report built on this pass is about to go to the driver.  This is done
+// before the send since TX complete can beat USBDHIDGamepadSendReport back.
+void LatencyArm(void)
+{
+    g_bLatencyArmed = true;
+}
+
+// Called from the TX complete event to close out the trace of the report
+// that was just sent.
+HOT_FUNC void LatencyCommit(void)
+{
+    volatile uint32_t *pui32Stamp = g_pui32LatencyStamp;
+
+    LatencyStamp(LATENCY_POINT_TXDONE);
+
+    if(!g_bLatencyArmed)
+    {
+        return;
+    }
+    g_bLatencyArmed = false;
+
+    // TX complete arrived before the SEND stamp was taken, so the stamp is
+    // still from the previous report.  Count the send as ending here.
+    if((pui32Stamp[LATENCY_POINT_SEND] - pui32Stamp[LATENCY_POINT_SAMPLE]) >
+       (pui32Stamp[LATENCY_POINT_TXDONE] - pui32Stamp[LATENCY_POINT_SAMPLE]))
+    {
+        pui32Stamp[LATENCY_POINT_SEND] = pui32Stamp[LATENCY_POINT_TXDONE];
+    }
+
+    LatencyRecord(LATENCY_STAGE_DEBOUNCE, pui32Stamp[LATENCY_POINT_DEBOUNCE] -
+                                          pui32Stamp[LATENCY_POINT_SAMPLE]);
+    LatencyRecord(LATENCY_STAGE_PACK, pui32Stamp[LATENCY_POINT_PACK] -
+                                      pui32Stamp[LATENCY_POINT_DEBOUNCE]);
+    LatencyRecord(LATENCY_STAGE_SEND, pui32Stamp[LATENCY_POINT_SEND] -
+                                      pui32Stamp[LATENCY_POINT_PACK]);
+    LatencyRecord(LATENCY_STAGE_TX, pui32Stamp[LATENCY_POINT_TXDONE] -
+                                    pui32Stamp[LATENCY_POINT_SEND]);
+    LatencyRecord(LATENCY_STAGE_TOTAL, pui32Stamp[LATENCY_POINT_TXDONE] -
+                                       pui32Stamp[LATENCY_POINT_SAMPLE]);
+}
+
+// Dump the histograms to the UART console.  Empty buckets are skipped.
+void LatencyPrint(void)
+{
+    tLatencyHistogram *psHist;
+    uint32_t ui32Stage, ui32Bucket, ui32PerUs;
+
+    ui32PerUs = SysCtlClockGet() / 1000000;
+
+    UARTprintf("\nlatency (cycles @ %d/us)\n", ui32PerUs);
+
+    for(ui32Stage = 0; ui32Stage < LATENCY_NUM_STAGES; ui32Stage++)
+    {
+        psHist = &g_psLatency[ui32Stage];
+
+        if(psHist->ui32Count == 0)
+        {
+            UARTprintf("%s: no samples\n", g_ppcLatencyStage[ui32Stage]);
+            continue;
+        }
+
+        UARTprintf("%s: n=%u min=%u max=%u (%uus)\n",
+                   g_ppcLatencyStage[ui32Stage], psHist->ui32Count,
+                   psHist->ui32Min, psHist->ui32Max,
+                   psHist->ui32Max / ui32PerUs);
+
+        for(ui32Bucket = 0; ui32Bucket < LATENCY_NUM_BUCKETS; ui32Bucket++)
+        {
+            if(psHist->pui32Buckets[ui32Bucket])
+            {
+                UARTprintf("  <%8u %u\n", 1 << ui32Bucket,
+                           psHist->pui32Buckets[ui32Bucket]);
+            }
+        }
+    }
+}
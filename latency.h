@@ -0,0 +1,73 @@
+//*****************************************************************************
+//
+// latency.h - Input to USB latency instrumentation for the gamepad.
+//
+// Copyright (c) Aditya Challamarad.  All rights reserved.
+//
+//*****************************************************************************
+
+#ifndef _LATENCY_H_
+#define _LATENCY_H_
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+//
+// Timestamps taken along the report pipeline, in the order they happen.
+// ADCTRIG is taken when a conversion is started and the rest are taken on
+// the main loop pass that builds a report, up to the TX complete callback.
+//
+#define LATENCY_POINT_ADCTRIG   0   // ADCProcessorTrigger
+#define LATENCY_POINT_SAMPLE    1   // start of the loop pass, inputs sampled
+#define LATENCY_POINT_DEBOUNCE  2   // ButtonsPoll returned
+#define LATENCY_POINT_PACK      3   // report filled in
+#define LATENCY_POINT_SEND      4   // USBDHIDGamepadSendReport returned
+#define LATENCY_POINT_TXDONE    5   // USB_EVENT_TX_COMPLETE
+#define LATENCY_NUM_POINTS      6
+
+//
+// Stages with a histogram each.  Every stage is the time between two points.
+//
+#define LATENCY_STAGE_ADC       0   // ADCTRIG -> conversion seen by the loop
+#define LATENCY_STAGE_DEBOUNCE  1   // SAMPLE -> DEBOUNCE
+#define LATENCY_STAGE_PACK      2   // DEBOUNCE -> PACK
+#define LATENCY_STAGE_SEND      3   // PACK -> SEND
+#define LATENCY_STAGE_TX        4   // SEND -> TXDONE
+#define LATENCY_STAGE_TOTAL     5   // SAMPLE -> TXDONE
+#define LATENCY_NUM_STAGES      6
+
+//
+// Histogram bucket n counts samples of 2^(n-1) to 2^n - 1 cycles, bucket 0
+// counts zero length samples and the last bucket also takes everything
+// longer.  At 50MHz the last bucket starts at ~168ms.
+//
+#define LATENCY_NUM_BUCKETS     24
+
+typedef struct
+{
+    uint32_t ui32Count;
+    uint32_t ui32Min;
+    uint32_t ui32Max;
+    uint32_t pui32Buckets[LATENCY_NUM_BUCKETS];
+} tLatencyHistogram;
+
+extern volatile uint32_t g_pui32LatencyStamp[LATENCY_NUM_POINTS];
+extern tLatencyHistogram g_psLatency[LATENCY_NUM_STAGES];
+
+// Take a timestamp for one of the LATENCY_POINT_* points.
+#define LatencyStamp(ui32Point)                                               \
+        (g_pui32LatencyStamp[(ui32Point)] = CyclesGet())
+
+extern void LatencyReset(void);
+extern void LatencyRecord(uint32_t ui32Stage, uint32_t ui32Cycles);
+extern void LatencyArm(void);
+extern void LatencyCommit(void);
+extern void LatencyPrint(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,461 @@
+//*****************************************************************************
+//
+// macro.c - Chord triggered button sequences and turbo buttons, timed in USB
+//           frames.
+//
+// Copyright (c) Aditya Challamarad.  All rights reserved.
+//
+// Sequences are tables of steps compiled to and/or masks over the report
+// (macro.h), so playing a step costs the same whatever it does.  A sequence
+// starts when the buttons held become exactly its chord.  Its first step
+// begins with the next USB frame and every step lasts a whole number of
+// frames, so each lands in a known frame.  The chord buttons are kept out
+// of the report from the moment the sequence starts until they are let go.
+//
+// A turbo button is pressed and released every g_pui8MacroTurbo frames for
+// as long as it is held, starting pressed in the frame it went down in.  A
+// running sequence owns the buttons, turbo included.
+//
+// The frames are followed by a PIOSC clocked timer that reads the USB frame
+// number MACRO_TICKS_PER_FRAME times a frame.  The timer runs only while a
+// sequence or a turbo button needs it, and keys everything to the frame
+// number, not to its own ticks, so a step never drifts from the frame it
+// was meant for.  A frame seen late, after the next one had begun, still
+// counts and is kept in the statistics.
+//
+// The interrupt posts the report masks for the main loop, which picks them
+// up on its next pass.  Button changes reach the engine from the main loop
+// only when there is one.  Neither adds to a pass that has nothing to do
+// beyond a load and a compare.
+//
+//*****************************************************************************
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "inc/hw_ints.h"
+#include "inc/hw_memmap.h"
+#include "inc/hw_types.h"
+#include "driverlib/interrupt.h"
+#include "driverlib/rom.h"
+#include "driverlib/rom_map.h"
+#include "driverlib/timer.h"
+#include "drivers/buttons.h"
+#include "utils/uartstdio.h"
+#include "hal.h"
+#include "hotpath.h"
+#include "macro.h"
+
+#define MACRO_SEQUENCE(pcName, ui8Chord, psSteps)                             \
+    { (pcName), (ui8Chord), sizeof(psSteps) / sizeof(psSteps[0]), (psSteps) }
+
+//
+// Two jumps with three frames between them.
+//
+static const tMacroStep g_psMacroDoubleJump[] =
+{
+    MACRO_HOLD(3, BUTTON1_MASK),
+    MACRO_HOLD(3, 0),
+    MACRO_HOLD(3, BUTTON1_MASK),
+};
+
+//
+// Half flip: jump, flip with the stick pulled back, then push it forward to
+// cancel the flip half way round.
+//
+static const tMacroStep g_psMacroHalfFlip[] =
+{
+    MACRO_HOLD(3, BUTTON1_MASK),
+    MACRO_HOLD(2, 0),
+    MACRO_HOLD_STICK(3, BUTTON1_MASK, 0, 127),
+    MACRO_HOLD_STICK(6, 0, 0, 127),
+    MACRO_HOLD_STICK(20, 0, 0, -128),
+};
+
+static const tMacro g_psMacros[] =
+{
+    MACRO_SEQUENCE("double jump", BUTTON3_MASK | BUTTON4_MASK,
+                   g_psMacroDoubleJump),
+    MACRO_SEQUENCE("half flip", JOYSTICK_MASK | BUTTON4_MASK,
+                   g_psMacroHalfFlip),
+};
+
+#define MACRO_NUM               (sizeof(g_psMacros) / sizeof(g_psMacros[0]))
+
+// The masks applied to the report, and whether they leave it as it is.
+typedef struct
+{
+    uint8_t pui8And[MACRO_REPORT_SIZE];
+    uint8_t pui8Or[MACRO_REPORT_SIZE];
+    bool bIdentity;
+} tMacroOverlay;
+
+tMacroStats g_sMacroStats;
+
+uint8_t g_pui8MacroTurbo[MACRO_NUM_BUTTONS];
+
+static bool g_bMacroEnabled = true;
+
+// Report buttons with a turbo rate.
+static uint8_t g_ui8MacroTurboMask;
+
+// Report buttons held after the remap, and the chord of the last sequence
+// while it is still held.
+static uint8_t g_ui8MacroHeld;
+static uint8_t g_ui8MacroSwallow;
+
+// The sequence running, steps started, and frames left of the last one
+// including the current frame.  No frames left before the first step.
+static const tMacro *g_psMacroRun;
+static uint32_t g_ui32MacroStep;
+static uint32_t g_ui32MacroLeft;
+
+// Frames each turbo button has been held for.
+static uint32_t g_pui32MacroTurboFrames[MACRO_NUM_BUTTONS];
+
+// The last frame the timer saw, and whether it is running.
+static uint32_t g_ui32MacroFrame;
+static bool g_bMacroTimer;
+
+// The masks last posted for the main loop, and the main loop's copy.  The
+// main loop applies its copy until it has picked up an identity.
+static tMacroOverlay g_sMacroDue;
+static volatile bool g_bMacroFresh;
+static volatile bool g_bMacroApplying;
+static tMacroOverlay g_sMacroOverlay;
+
+// Work out the masks for the current frame.
+static void MacroOverlayGet(tMacroOverlay *psOverlay)
+{
+    const tMacroStep *psStep;
+    uint32_t ui32Idx;
+    uint8_t ui8And = (uint8_t)~g_ui8MacroSwallow;
+
+    for(ui32Idx = 0; ui32Idx < MACRO_NUM_BUTTONS; ui32Idx++)
+    {
+        // the odd half periods are the released ones
+        if((g_ui8MacroHeld & g_ui8MacroTurboMask & (1 << ui32Idx)) &&
+           ((g_pui32MacroTurboFrames[ui32Idx] / g_pui8MacroTurbo[ui32Idx]) & 1))
+        {
+            ui8And &= ~(1 << ui32Idx);
+        }
+    }
+
+    for(ui32Idx = 0; ui32Idx < MACRO_REPORT_SIZE; ui32Idx++)
+    {
+        psOverlay->pui8And[ui32Idx] = 0xff;
+        psOverlay->pui8Or[ui32Idx] = 0;
+    }
+
+    psOverlay->pui8And[MACRO_FIELD_BUTTONS] = ui8And;
+
+    if(g_psMacroRun && g_ui32MacroLeft)
+    {
+        psStep = &g_psMacroRun->psSteps[g_ui32MacroStep - 1];
+
+        for(ui32Idx = 0; ui32Idx < MACRO_REPORT_SIZE; ui32Idx++)
+        {
+            psOverlay->pui8And[ui32Idx] = psStep->pui8And[ui32Idx];
+            psOverlay->pui8Or[ui32Idx] = psStep->pui8Or[ui32Idx];
+        }
+    }
+
+    psOverlay->bIdentity = true;
+
+    for(ui32Idx = 0; ui32Idx < MACRO_REPORT_SIZE; ui32Idx++)
+    {
+        if((psOverlay->pui8And[ui32Idx] != 0xff) || psOverlay->pui8Or[ui32Idx])
+        {
+            psOverlay->bIdentity = false;
+        }
+    }
+}
+
+// Post the masks for the main loop if they have changed.  Called from the
+// timer interrupt, or with interrupts off.
+static void MacroPost(void)
+{
+    tMacroOverlay sOverlay;
+    uint32_t ui32Idx;
+    bool bSame = true;
+
+    MacroOverlayGet(&sOverlay);
+
+    for(ui32Idx = 0; ui32Idx < MACRO_REPORT_SIZE; ui32Idx++)
+    {
+        if((sOverlay.pui8And[ui32Idx] != g_sMacroDue.pui8And[ui32Idx]) ||
+           (sOverlay.pui8Or[ui32Idx] != g_sMacroDue.pui8Or[ui32Idx]))
+        {
+            bSame = false;
+        }
+    }
+
+    if(bSame)
+    {
+        return;
+    }
+
+    g_sMacroDue = sOverlay;
+    g_bMacroFresh = true;
+    g_bMacroApplying = true;
+}
+
+// A new frame has begun.
+static void MacroFrame(void)
+{
+    uint32_t ui32Idx;
+
+    for(ui32Idx = 0; ui32Idx < MACRO_NUM_BUTTONS; ui32Idx++)
+    {
+        if(g_ui8MacroHeld & g_ui8MacroTurboMask & (1 << ui32Idx))
+        {
+            g_pui32MacroTurboFrames[ui32Idx]++;
+        }
+    }
+
+    if(!g_psMacroRun)
+    {
+        return;
+    }
+
+    if(g_ui32MacroLeft > 1)
+    {
+        g_ui32MacroLeft--;
+        return;
+    }
+
+    if(g_ui32MacroStep == g_psMacroRun->ui8Steps)
+    {
+        g_psMacroRun = 0;
+        g_ui32MacroLeft = 0;
+        return;
+    }
+
+    g_ui32MacroLeft = g_psMacroRun->psSteps[g_ui32MacroStep++].ui16Frames;
+}
+
+// Whether there is anything left for the timer to follow.
+static bool MacroTimed(void)
+{
+    return((g_psMacroRun != 0) ||
+           ((g_ui8MacroHeld & g_ui8MacroTurboMask) != 0));
+}
+
+// Runs MACRO_TICKS_PER_FRAME times a frame while the engine is timing
+// something.  Does nothing until the frame number changes.
+HOT_FUNC void MacroTimerIntHandler(void)
+{
+    uint32_t ui32Frame, ui32Elapsed;
+
+    MAP_TimerIntClear(MACRO_TIMER_BASE, TIMER_TIMA_TIMEOUT);
+
+    ui32Frame = HALUSBFrame(USB0_BASE);
+    ui32Elapsed = (ui32Frame - g_ui32MacroFrame) & 0x7ff;
+
+    if(!ui32Elapsed)
+    {
+        return;
+    }
+
+    g_ui32MacroFrame = ui32Frame;
+    g_sMacroStats.ui32Frames += ui32Elapsed;
+    g_sMacroStats.ui32LateFrames += ui32Elapsed - 1;
+
+    while(ui32Elapsed--)
+    {
+        MacroFrame();
+    }
+
+    MacroPost();
+
+    if(!MacroTimed())
+    {
+        MAP_TimerDisable(MACRO_TIMER_BASE, TIMER_A);
+        g_bMacroTimer = false;
+    }
+}
+
+void MacroInit(void)
+{
+    uint32_t ui32Idx;
+
+    for(ui32Idx = 0; ui32Idx < MACRO_REPORT_SIZE; ui32Idx++)
+    {
+        g_sMacroDue.pui8And[ui32Idx] = 0xff;
+        g_sMacroDue.pui8Or[ui32Idx] = 0;
+    }
+
+    g_sMacroDue.bIdentity = true;
+    g_sMacroOverlay = g_sMacroDue;
+
+    TimerClockSourceSet(MACRO_TIMER_BASE, TIMER_CLOCK_PIOSC);
+    MAP_TimerConfigure(MACRO_TIMER_BASE, TIMER_CFG_PERIODIC);
+    MAP_TimerLoadSet(MACRO_TIMER_BASE, TIMER_A,
+                     (MACRO_TIMER_CLOCK / (1000 * MACRO_TICKS_PER_FRAME)) - 1);
+    MAP_TimerIntEnable(MACRO_TIMER_BASE, TIMER_TIMA_TIMEOUT);
+    MAP_IntEnable(MACRO_TIMER_INT);
+}
+
+// Let chords start sequences, or not.  A sequence already running finishes.
+void MacroEnable(bool bEnable)
+{
+    g_bMacroEnabled = bEnable;
+}
+
+bool MacroEnabled(void)
+{
+    return(g_bMacroEnabled);
+}
+
+uint32_t MacroCount(void)
+{
+    return(MACRO_NUM);
+}
+
+// The sequence running, counting from 1, or 0 for none.
+uint32_t MacroRunning(void)
+{
+    const tMacro *psRun = g_psMacroRun;
+
+    return(psRun ? (uint32_t)(psRun - g_psMacros) + 1 : 0);
+}
+
+// Set the turbo half period of every report button, in frames.  Buttons
+// already held start over, pressed from the current frame.  Called from the
+// USB0 interrupt.
+void MacroTurboSet(const uint8_t *pui8Frames)
+{
+    uint32_t ui32Idx;
+
+    g_ui8MacroTurboMask = 0;
+
+    for(ui32Idx = 0; ui32Idx < MACRO_NUM_BUTTONS; ui32Idx++)
+    {
+        g_pui32MacroTurboFrames[ui32Idx] = 0;
+        g_pui8MacroTurbo[ui32Idx] = pui8Frames[ui32Idx];
+
+        if(pui8Frames[ui32Idx])
+        {
+            g_ui8MacroTurboMask |= 1 << ui32Idx;
+        }
+    }
+
+    if(MacroTimed() && !g_bMacroTimer)
+    {
+        g_ui32MacroFrame = HALUSBFrame(USB0_BASE);
+        g_bMacroTimer = true;
+        MAP_TimerEnable(MACRO_TIMER_BASE, TIMER_A);
+    }
+
+    MacroPost();
+}
+
+// The report buttons have changed, after the remap.  Starts the sequence of
+// a chord and the timing of turbo buttons just pressed.  Called from the
+// main loop.
+void MacroButtons(uint8_t ui8Buttons)
+{
+    uint8_t ui8Pressed = ui8Buttons & ~g_ui8MacroHeld;
+    uint32_t ui32Idx;
+
+    IntMasterDisable();
+
+    g_ui8MacroHeld = ui8Buttons;
+    g_ui8MacroSwallow &= ui8Buttons;
+
+    for(ui32Idx = 0; ui32Idx < MACRO_NUM_BUTTONS; ui32Idx++)
+    {
+        if(ui8Pressed & (1 << ui32Idx))
+        {
+            g_pui32MacroTurboFrames[ui32Idx] = 0;
+        }
+    }
+
+    for(ui32Idx = 0; ui8Pressed && g_bMacroEnabled && !g_psMacroRun &&
+                     (ui32Idx < MACRO_NUM); ui32Idx++)
+    {
+        if(ui8Buttons == g_psMacros[ui32Idx].ui8Chord)
+        {
+            g_psMacroRun = &g_psMacros[ui32Idx];
+            g_ui32MacroStep = 0;
+            g_ui32MacroLeft = 0;
+            g_ui8MacroSwallow = ui8Buttons;
+            g_sMacroStats.ui32Runs++;
+        }
+    }
+
+    // frames count from the one the change happened in
+    if(MacroTimed() && !g_bMacroTimer)
+    {
+        g_ui32MacroFrame = HALUSBFrame(USB0_BASE);
+        g_bMacroTimer = true;
+        MAP_TimerEnable(MACRO_TIMER_BASE, TIMER_A);
+    }
+
+    MacroPost();
+
+    IntMasterEnable();
+}
+
+// Apply the current step and turbo phases to pui8Report.  Returns true when
+// they have changed, so the report goes out even without a new ADC sample.
+// Costs a load and a compare when there is nothing to apply.
+HOT_FUNC bool MacroApply(uint8_t *pui8Report)
+{
+    uint32_t ui32Idx;
+    bool bNew;
+
+    if(!g_bMacroApplying)
+    {
+        return(false);
+    }
+
+    bNew = g_bMacroFresh;
+
+    if(bNew)
+    {
+        IntMasterDisable();
+
+        g_sMacroOverlay = g_sMacroDue;
+        g_bMacroFresh = false;
+
+        // the report is back to itself until something changes
+        if(g_sMacroOverlay.bIdentity)
+        {
+            g_bMacroApplying = false;
+        }
+
+        IntMasterEnable();
+    }
+
+    for(ui32Idx = 0; ui32Idx < MACRO_REPORT_SIZE; ui32Idx++)
+    {
+        pui8Report[ui32Idx] = (pui8Report[ui32Idx] &
+                               g_sMacroOverlay.pui8And[ui32Idx]) |
+                              g_sMacroOverlay.pui8Or[ui32Idx];
+    }
+
+    return(bNew);
+}
+
+// Print the sequences, the turbo rates and how well the frames were kept.
+void MacroPrint(void)
+{
+    uint32_t ui32Idx, ui32Running = MacroRunning();
+
+    UARTprintf("\nmacros %s, running %s, %u runs\n",
+               g_bMacroEnabled ? "on" : "off",
+               ui32Running ? g_psMacros[ui32Running - 1].pcName : "none",
+               g_sMacroStats.ui32Runs);
+
+    for(ui32Idx = 0; ui32Idx < MACRO_NUM; ui32Idx++)
+    {
+        UARTprintf("  %s: chord 0x%02x, %u steps\n", g_psMacros[ui32Idx].pcName,
+                   g_psMacros[ui32Idx].ui8Chord, g_psMacros[ui32Idx].ui8Steps);
+    }
+
+    UARTprintf("turbo frames %u %u %u %u %u\n", g_pui8MacroTurbo[0],
+               g_pui8MacroTurbo[1], g_pui8MacroTurbo[2], g_pui8MacroTurbo[3],
+               g_pui8MacroTurbo[4]);
+    UARTprintf("%u frames followed, %u late\n", g_sMacroStats.ui32Frames,
+               g_sMacroStats.ui32LateFrames);
+}
@@ -0,0 +1,99 @@
+//*****************************************************************************
+//
+// macro.h - Chord triggered button sequences and turbo buttons, timed in USB
+//           frames.
+//
+// Copyright (c) Aditya Challamarad.  All rights reserved.
+//
+//*****************************************************************************
+
+#ifndef _MACRO_H_
+#define _MACRO_H_
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+//
+// The timer that follows the USB frames, Timer 4 as one 32 bit periodic
+// timer clocked from PIOSC, so it keeps its rate at any system clock.  Its
+// timeout vector is MacroTimerIntHandler.
+//
+#define MACRO_TIMER_BASE        TIMER4_BASE
+#define MACRO_TIMER_INT         INT_TIMER4A
+#define MACRO_TIMER_CLOCK       16000000
+
+// Timer ticks per USB frame.  The frame number is read on every tick, so a
+// new frame is seen at most 1/MACRO_TICKS_PER_FRAME of a frame late.
+#define MACRO_TICKS_PER_FRAME   8
+
+// Report bytes, in tGamepadReport order: x, y, LT, RT, buttons.
+#define MACRO_REPORT_SIZE       5
+#define MACRO_FIELD_BUTTONS     4
+
+// Report buttons, one turbo rate each.
+#define MACRO_NUM_BUTTONS       5
+
+//
+// One step of a sequence, compiled to masks over the report: each byte
+// becomes (byte & and) | or for ui16Frames USB frames.  A step owns the
+// whole button byte, and the axes it sets.
+//
+typedef struct
+{
+    uint16_t ui16Frames;
+    uint8_t pui8And[MACRO_REPORT_SIZE];
+    uint8_t pui8Or[MACRO_REPORT_SIZE];
+} tMacroStep;
+
+// Hold exactly ui8Buttons, the sticks and triggers as they are.
+#define MACRO_HOLD(ui16Frames, ui8Buttons)                                    \
+    { (ui16Frames), { 0xff, 0xff, 0xff, 0xff, 0x00 },                         \
+      { 0, 0, 0, 0, (ui8Buttons) } }
+
+// Hold exactly ui8Buttons with the stick at i8X, i8Y.
+#define MACRO_HOLD_STICK(ui16Frames, ui8Buttons, i8X, i8Y)                   \
+    { (ui16Frames), { 0x00, 0x00, 0xff, 0xff, 0x00 },                         \
+      { (uint8_t)(i8X), (uint8_t)(i8Y), 0, 0, (ui8Buttons) } }
+
+//
+// A sequence and the chord that starts it, report button bits.  It starts
+// when the buttons held become exactly the chord.
+//
+typedef struct
+{
+    const char *pcName;
+    uint8_t ui8Chord;
+    uint8_t ui8Steps;
+    const tMacroStep *psSteps;
+} tMacro;
+
+typedef struct
+{
+    uint32_t ui32Runs;          // sequences started
+    uint32_t ui32Frames;        // frames the timer followed
+    uint32_t ui32LateFrames;    // frames only seen after the next had begun
+} tMacroStats;
+
+extern tMacroStats g_sMacroStats;
+
+// Turbo half period of each report button in frames, 0 for off.
+extern uint8_t g_pui8MacroTurbo[MACRO_NUM_BUTTONS];
+
+extern void MacroInit(void);
+extern void MacroEnable(bool bEnable);
+extern bool MacroEnabled(void);
+extern uint32_t MacroCount(void);
+extern uint32_t MacroRunning(void);
+extern void MacroTurboSet(const uint8_t *pui8Frames);
+extern void MacroButtons(uint8_t ui8Buttons);
+extern bool MacroApply(uint8_t *pui8Report);
+extern void MacroPrint(void);
+extern void MacroTimerIntHandler(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,366 @@
+//*****************************************************************************
+//
+// recorder.c - Records the reports sent to the host into flash.
+//
+// Copyright (c) Aditya Challamarad.  All rights reserved.
+//
+// Every report that differs from the last one recorded is encoded as a
+// trace record (trace.h) with the time it was sent, in microseconds from
+// the start of the recording.  Records go into a small SRAM stage, and the
+// main loop programs them into the trace region one word per pass, so no
+// pass stalls for longer than a single word program while recording.  The
+// region is filled front to back and every word is programmed once.
+//
+// All the erasing happens before the recording starts.  The start asks for
+// a length, RECORDER_DEFAULT_SIZE (32KB) unless the host gives one, and the
+// main loop erases all of it, one 1KB block per pass.  That is one long
+// stall at the start, about half a second for 32KB, during which reports
+// still go out but only every erase time.  Every recording wears its whole
+// requested length once, however little of it the records fill, so a
+// default recording always wears all 32KB.
+//
+// The time comes from the cycle counter, folded into microseconds on every
+// pass and at every clock governor change.  The counter stops in deep
+// sleep, so time spent suspended is not counted.
+//
+// A recording is started and stopped from the console or the trace feature
+// page.  Both only post a request, the main loop acts on it.  Stopping
+// writes an end tag and fills in the header's length and record count.  A
+// recording cut short by a reset has neither, and reads back up to where
+// the writes stopped.
+//
+//*****************************************************************************
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "inc/hw_types.h"
+#include "driverlib/flash.h"
+#include "driverlib/rom.h"
+#include "driverlib/rom_map.h"
+#include "driverlib/sysctl.h"
+#include "drivers/cycles.h"
+#include "utils/uartstdio.h"
+#include "clockgov.h"
+#include "fault.h"
+#include "hotpath.h"
+#include "trace.h"
+#include "recorder.h"
+
+#define RECORDER_REQ_NONE       0
+#define RECORDER_REQ_START      1
+#define RECORDER_REQ_STOP       2
+
+tRecorderStats g_sRecorderStats;
+
+static volatile uint32_t g_ui32RecorderState = RECORDER_IDLE;
+static volatile uint32_t g_ui32RecorderRequest;
+
+// Length of the region the next recording asked for, in bytes.
+static volatile uint32_t g_ui32RecorderSize;
+
+// Encoder state of the current trace.
+static tTraceState g_sRecorderTrace;
+
+// Encoded bytes not yet programmed.  Head and tail count bytes since the
+// start of the trace, the tail is always word aligned.
+static uint8_t g_pui8RecorderStage[RECORDER_STAGE_SIZE];
+static uint32_t g_ui32RecorderHead;
+static uint32_t g_ui32RecorderTail;
+
+// Offset into the region up to which blocks have been erased, and the
+// offset the recording's erase stops at.
+static uint32_t g_ui32RecorderErased;
+static uint32_t g_ui32RecorderEnd;
+
+// Record bytes that fit in the erased length, with room for the end tag and
+// the padding to a whole word.
+static uint32_t g_ui32RecorderDataMax;
+
+// Microseconds since the recording started, and the cycle count and
+// leftover cycles they were last brought up to date with.
+static uint64_t g_ui64RecorderUs;
+static uint32_t g_ui32RecorderCycles;
+static uint32_t g_ui32RecorderRem;
+static uint32_t g_ui32RecorderMHz;
+
+// Bring the time up to date at the current clock.  Called at least once a
+// pass, far more often than the cycle counter wraps.
+static uint64_t RecorderNow(void)
+{
+    uint32_t ui32Now = CyclesGet();
+    uint32_t ui32Cycles = (ui32Now - g_ui32RecorderCycles) + g_ui32RecorderRem;
+
+    g_ui32RecorderCycles = ui32Now;
+    g_ui64RecorderUs += ui32Cycles / g_ui32RecorderMHz;
+    g_ui32RecorderRem = ui32Cycles % g_ui32RecorderMHz;
+
+    return(g_ui64RecorderUs);
+}
+
+// Clock governor hook.  The cycles so far were at the old clock.
+static void RecorderClock(uint32_t ui32SysClock)
+{
+    if(g_ui32RecorderState == RECORDER_RECORDING)
+    {
+        RecorderNow();
+    }
+
+    g_ui32RecorderMHz = ui32SysClock / 1000000;
+}
+
+// Erase or program one word, and keep the longest stall.  Both return once
+// the flash is done, the CPU cannot fetch from flash meanwhile.
+static void RecorderErase(uint32_t ui32Offset)
+{
+    uint32_t ui32Start = CyclesGet(), ui32Cycles;
+
+    MAP_FlashErase(RECORDER_FLASH_BASE + ui32Offset);
+
+    ui32Cycles = CyclesSince(ui32Start);
+    if(ui32Cycles > g_sRecorderStats.ui32MaxStallCycles)
+    {
+        g_sRecorderStats.ui32MaxStallCycles = ui32Cycles;
+    }
+
+    g_sRecorderStats.ui32Erases++;
+}
+
+static void RecorderProgram(uint32_t ui32Offset, const uint8_t *pui8Data)
+{
+    uint32_t ui32Start = CyclesGet(), ui32Cycles, ui32Word;
+
+    ui32Word = TraceGetU32(pui8Data);
+    MAP_FlashProgram(&ui32Word, RECORDER_FLASH_BASE + ui32Offset, 4);
+
+    ui32Cycles = CyclesSince(ui32Start);
+    if(ui32Cycles > g_sRecorderStats.ui32MaxStallCycles)
+    {
+        g_sRecorderStats.ui32MaxStallCycles = ui32Cycles;
+    }
+}
+
+// Program the oldest staged word.
+static void RecorderFlushWord(void)
+{
+    uint8_t pui8Word[4];
+    uint32_t ui32Idx;
+
+    for(ui32Idx = 0; ui32Idx < 4; ui32Idx++)
+    {
+        pui8Word[ui32Idx] = g_pui8RecorderStage[(g_ui32RecorderTail + ui32Idx) &
+                                                (RECORDER_STAGE_SIZE - 1)];
+    }
+
+    RecorderProgram(TRACE_HEADER_SIZE + g_ui32RecorderTail, pui8Word);
+    g_ui32RecorderTail += 4;
+}
+
+static void RecorderStage(const uint8_t *pui8Data, uint32_t ui32Len)
+{
+    while(ui32Len--)
+    {
+        g_pui8RecorderStage[g_ui32RecorderHead++ & (RECORDER_STAGE_SIZE - 1)] =
+            *pui8Data++;
+    }
+}
+
+// Write the end tag and what is still staged, then complete the header.
+static void RecorderClose(void)
+{
+    uint8_t pui8Header[TRACE_HEADER_SIZE], ui8Pad = TRACE_TAG_END;
+
+    RecorderStage(&ui8Pad, 1);
+    g_sRecorderStats.ui32Bytes++;
+
+    // erased flash is 0xff already, the padding only completes the word
+    ui8Pad = TRACE_TAG_ERASED;
+    while(g_ui32RecorderHead & 3)
+    {
+        RecorderStage(&ui8Pad, 1);
+    }
+
+    while(g_ui32RecorderTail != g_ui32RecorderHead)
+    {
+        RecorderFlushWord();
+    }
+
+    TraceHeader(pui8Header, g_sRecorderStats.ui32Bytes,
+                g_sRecorderStats.ui32Records);
+    RecorderProgram(8, &pui8Header[8]);
+    RecorderProgram(12, &pui8Header[12]);
+
+    g_ui32RecorderState = RECORDER_IDLE;
+
+    UARTprintf("\ntrace closed\n");
+    RecorderPrint();
+}
+
+void RecorderInit(void)
+{
+    g_ui32RecorderMHz = SysCtlClockGet() / 1000000;
+
+    if(!ClockGovHookRegister(RecorderClock))
+    {
+        FaultReset(FAULT_TYPE_SETUP);
+    }
+}
+
+// Ask the main loop to start a new recording, replacing the last one, in the
+// first ui32Size bytes of the region, RECORDER_DEFAULT_SIZE if 0.  Safe from
+// an interrupt.
+void RecorderStart(uint32_t ui32Size)
+{
+    g_ui32RecorderSize = ui32Size ? ui32Size : RECORDER_DEFAULT_SIZE;
+    g_ui32RecorderRequest = RECORDER_REQ_START;
+}
+
+// Ask the main loop to close the recording.  Safe from an interrupt.
+void RecorderStop(void)
+{
+    g_ui32RecorderRequest = RECORDER_REQ_STOP;
+}
+
+uint32_t RecorderState(void)
+{
+    return(g_ui32RecorderState);
+}
+
+// Record a report that has just been handed to the driver.  Costs a load
+// and a compare when not recording.
+HOT_FUNC void RecorderReport(const uint8_t *pui8Report)
+{
+    uint8_t pui8Record[TRACE_RECORD_MAX];
+    uint32_t ui32Len;
+
+    if(g_ui32RecorderState != RECORDER_RECORDING)
+    {
+        return;
+    }
+
+    if((g_sRecorderStats.ui32Bytes + TRACE_RECORD_MAX) > g_ui32RecorderDataMax)
+    {
+        g_sRecorderStats.bFull = true;
+        g_ui32RecorderRequest = RECORDER_REQ_STOP;
+        return;
+    }
+
+    // keep room for the end tag and padding
+    if((g_ui32RecorderHead - g_ui32RecorderTail) >
+       (RECORDER_STAGE_SIZE - TRACE_RECORD_MAX - 4))
+    {
+        g_sRecorderStats.ui32Dropped++;
+        return;
+    }
+
+    ui32Len = TraceEncode(&g_sRecorderTrace, RecorderNow(), pui8Report,
+                          pui8Record);
+
+    if(ui32Len)
+    {
+        RecorderStage(pui8Record, ui32Len);
+        g_sRecorderStats.ui32Records++;
+        g_sRecorderStats.ui32Bytes += ui32Len;
+    }
+}
+
+// Once a pass from the main loop: act on requests, then erase one block
+// before a recording starts or program one word while it runs.
+void RecorderPoll(void)
+{
+    uint8_t pui8Header[TRACE_HEADER_SIZE];
+    uint32_t ui32Request = g_ui32RecorderRequest;
+
+    if((g_ui32RecorderState == RECORDER_IDLE) && !ui32Request)
+    {
+        return;
+    }
+
+    g_ui32RecorderRequest = RECORDER_REQ_NONE;
+
+    if(ui32Request == RECORDER_REQ_STOP)
+    {
+        if(g_ui32RecorderState == RECORDER_RECORDING)
+        {
+            RecorderClose();
+        }
+        else
+        {
+            g_ui32RecorderState = RECORDER_IDLE;
+        }
+
+        return;
+    }
+
+    if(ui32Request == RECORDER_REQ_START)
+    {
+        g_ui32RecorderHead = 0;
+        g_ui32RecorderTail = 0;
+        g_ui32RecorderErased = 0;
+        g_ui32RecorderEnd = (g_ui32RecorderSize + RECORDER_BLOCK_SIZE - 1) &
+                            ~(RECORDER_BLOCK_SIZE - 1);
+
+        if(g_ui32RecorderEnd > RECORDER_FLASH_SIZE)
+        {
+            g_ui32RecorderEnd = RECORDER_FLASH_SIZE;
+        }
+
+        g_ui32RecorderDataMax = g_ui32RecorderEnd - TRACE_HEADER_SIZE - 4;
+        g_sRecorderStats.ui32Records = 0;
+        g_sRecorderStats.ui32Bytes = 0;
+        g_sRecorderStats.ui32Dropped = 0;
+        g_sRecorderStats.bFull = false;
+        g_ui32RecorderState = RECORDER_ERASING;
+    }
+
+    if(g_ui32RecorderState == RECORDER_ERASING)
+    {
+        // erase all of it first, an erase stalls the loop for milliseconds
+        // and would show in the recorded timing
+        if(g_ui32RecorderErased < g_ui32RecorderEnd)
+        {
+            RecorderErase(g_ui32RecorderErased);
+            g_ui32RecorderErased += RECORDER_BLOCK_SIZE;
+            return;
+        }
+
+        // the header's length and count stay erased until the trace closes
+        TraceHeader(pui8Header, TRACE_OPEN, TRACE_OPEN);
+        RecorderProgram(0, &pui8Header[0]);
+        RecorderProgram(4, &pui8Header[4]);
+
+        TraceStart(&g_sRecorderTrace);
+        g_ui64RecorderUs = 0;
+        g_ui32RecorderRem = 0;
+        g_ui32RecorderCycles = CyclesGet();
+        g_ui32RecorderState = RECORDER_RECORDING;
+        return;
+    }
+
+    RecorderNow();
+
+    if((g_ui32RecorderHead - g_ui32RecorderTail) >= 4)
+    {
+        RecorderFlushWord();
+    }
+}
+
+// Print the recorder state and the size of the last or current trace.
+void RecorderPrint(void)
+{
+    static const char * const ppcState[] = { "idle", "erasing", "recording" };
+    uint32_t ui32PerRecord;
+
+    ui32PerRecord = g_sRecorderStats.ui32Records ?
+                    ((g_sRecorderStats.ui32Bytes * 10) /
+                     g_sRecorderStats.ui32Records) : 0;
+
+    UARTprintf("\nrecorder %s, %u records, %u of %u bytes, %u.%u a record\n",
+               ppcState[g_ui32RecorderState], g_sRecorderStats.ui32Records,
+               g_sRecorderStats.ui32Bytes, g_ui32RecorderDataMax,
+               ui32PerRecord / 10, ui32PerRecord % 10);
+    UARTprintf("%u dropped, %u blocks erased, longest flash stall %u "
+               "cycles%s\n",
+               g_sRecorderStats.ui32Dropped, g_sRecorderStats.ui32Erases,
+               g_sRecorderStats.ui32MaxStallCycles,
+               g_sRecorderStats.bFull ? ", stopped full" : "");
+}
@@ -0,0 +1,62 @@
+//*****************************************************************************
+//
+// recorder.h - Records the reports sent to the host into flash.
+//
+// Copyright (c) Aditya Challamarad.  All rights reserved.
+//
+//*****************************************************************************
+
+#ifndef _RECORDER_H_
+#define _RECORDER_H_
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+//
+// The trace region.  usb_dev_gamepad_ccs.cmd keeps it out of the FLASH
+// memory the linker places code in, the two must agree.  Erase blocks are
+// 1KB on the TM4C123.
+//
+#define RECORDER_FLASH_BASE     0x00020000
+#define RECORDER_FLASH_SIZE     0x00020000
+#define RECORDER_BLOCK_SIZE     1024
+
+// Encoded records waiting to be programmed.  A power of two.
+#define RECORDER_STAGE_SIZE     256
+
+// Length of the trace region erased for a recording when the start asks
+// for none.  The whole length is erased before the recording starts, so
+// nothing stalls the main loop once it is under way.
+#define RECORDER_DEFAULT_SIZE   0x00008000
+
+#define RECORDER_IDLE           0
+#define RECORDER_ERASING        1   // erasing the blocks it will use
+#define RECORDER_RECORDING      2
+
+typedef struct
+{
+    uint32_t ui32Records;       // records in the last or current trace
+    uint32_t ui32Bytes;         // bytes of records
+    uint32_t ui32Dropped;       // reports lost to a full stage buffer
+    uint32_t ui32Erases;        // blocks erased since power on
+    uint32_t ui32MaxStallCycles;// longest single erase or program
+    bool bFull;                 // the last trace filled its erased length
+} tRecorderStats;
+
+extern tRecorderStats g_sRecorderStats;
+
+extern void RecorderInit(void);
+extern void RecorderStart(uint32_t ui32Size);
+extern void RecorderStop(void);
+extern uint32_t RecorderState(void);
+extern void RecorderReport(const uint8_t *pui8Report);
+extern void RecorderPoll(void);
+extern void RecorderPrint(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
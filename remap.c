@@ -0,0 +1,329 @@
+//*****************************************************************************
+//
+// remap.c - Button and axis remapping with layers, compiled to lookup tables.
+//
+// Copyright (c) Aditya Challamarad.  All rights reserved.
+//
+// A layout (tRemapConfig) is never interpreted per report.  It is compiled
+// once into tables and RemapApply() only indexes them:
+//
+// - One entry per button state, 32 of them, holding the report buttons
+//   that state produces and the masks that let a button drive an axis.  The
+//   shift button is one of the five, so the layers are already in the index.
+// - Per output axis, the input axis it reads, how to move it between the
+//   stick and trigger ranges, how to invert it, and a 256 bit map of the
+//   values that press its button.
+//
+// Whatever the layout, a report costs one entry lookup and, per axis, one
+// load, a range xor, an invert, a bit test and two masks, with no branch on
+// the layout.
+// The default layout is the identity and leaves every report as it was.
+//
+// The host writes a layout through the remap feature page from the USB0
+// interrupt.  It only posts it, the main loop compiles it between two
+// reports, so a report never sees half a layout.
+//
+//*****************************************************************************
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "inc/hw_types.h"
+#include "driverlib/interrupt.h"
+#include "utils/uartstdio.h"
+#include "hotpath.h"
+#include "remap.h"
+
+#define REMAP_ALL_BUTTONS       (REMAP_BUTTON_STATES - 1)
+
+// The report buttons and axis masks of one button state.
+typedef struct
+{
+    uint8_t ui8Buttons;
+    uint8_t pui8AxisAnd[REMAP_AXES];
+    uint8_t pui8AxisOr[REMAP_AXES];
+} tRemapEntry;
+
+tRemapConfig g_sRemapConfig;
+
+// The compiled layout.
+static tRemapEntry g_psRemapEntries[REMAP_BUTTON_STATES];
+static uint8_t g_pui8RemapSource[REMAP_AXES];
+static uint8_t g_pui8RemapRange[REMAP_AXES];
+static uint8_t g_pui8RemapXor[REMAP_AXES];
+static uint8_t g_pui8RemapNegate[REMAP_AXES];
+static uint8_t g_pui8RemapPress[REMAP_AXES];
+static uint32_t g_ppui32RemapPressAt[REMAP_AXES][256 / 32];
+
+// A layout from the host, waiting for the main loop.
+static tRemapConfig g_sRemapPending;
+static volatile bool g_bRemapPending;
+
+// The sticks are signed, the triggers are not.
+static bool RemapSigned(uint32_t ui32Axis)
+{
+    return(ui32Axis <= REMAP_AXIS_Y);
+}
+
+// The identity: every button and axis as it is, no layers.
+void RemapConfigDefaults(tRemapConfig *psConfig)
+{
+    uint32_t ui32Idx;
+
+    psConfig->ui8Shift = 0;
+
+    for(ui32Idx = 0; ui32Idx < REMAP_BUTTONS; ui32Idx++)
+    {
+        psConfig->ppui8Buttons[0][ui32Idx] = 1 << ui32Idx;
+        psConfig->ppui8Buttons[1][ui32Idx] = 1 << ui32Idx;
+    }
+
+    for(ui32Idx = 0; ui32Idx < REMAP_AXES; ui32Idx++)
+    {
+        psConfig->pui8Axis[ui32Idx] = ui32Idx;
+        psConfig->pui8Threshold[ui32Idx] = 0;
+        psConfig->pui8Drive[ui32Idx] = 0;
+        psConfig->pui8DriveValue[ui32Idx] = 0;
+    }
+}
+
+// Returns true if every field of psConfig is in range.
+bool RemapConfigValid(const tRemapConfig *psConfig)
+{
+    uint32_t ui32Idx;
+
+    // one button or none
+    if((psConfig->ui8Shift & ~REMAP_ALL_BUTTONS) ||
+       (psConfig->ui8Shift & (psConfig->ui8Shift - 1)))
+    {
+        return(false);
+    }
+
+    for(ui32Idx = 0; ui32Idx < REMAP_BUTTONS; ui32Idx++)
+    {
+        if((psConfig->ppui8Buttons[0][ui32Idx] & ~REMAP_ALL_BUTTONS) ||
+           (psConfig->ppui8Buttons[1][ui32Idx] & ~REMAP_ALL_BUTTONS))
+        {
+            return(false);
+        }
+    }
+
+    for(ui32Idx = 0; ui32Idx < REMAP_AXES; ui32Idx++)
+    {
+        if((psConfig->pui8Axis[ui32Idx] &
+            ~(REMAP_AXIS_SOURCE_M | REMAP_AXIS_PRESS_M | REMAP_AXIS_INVERT)) ||
+           (((psConfig->pui8Axis[ui32Idx] & REMAP_AXIS_PRESS_M) >>
+             REMAP_AXIS_PRESS_S) > REMAP_BUTTONS) ||
+           (psConfig->pui8Drive[ui32Idx] & ~REMAP_ALL_BUTTONS))
+        {
+            return(false);
+        }
+    }
+
+    return(true);
+}
+
+// Whether an axis value presses the axis's button.
+static bool RemapPressed(uint32_t ui32Axis, uint8_t ui8Threshold,
+                         uint32_t ui32Value)
+{
+    if(!ui8Threshold)
+    {
+        return(false);
+    }
+
+    if(!RemapSigned(ui32Axis))
+    {
+        return(ui32Value >= ui8Threshold);
+    }
+
+    if((int8_t)ui8Threshold > 0)
+    {
+        return((int8_t)ui32Value >= (int8_t)ui8Threshold);
+    }
+
+    return((int8_t)ui32Value <= (int8_t)ui8Threshold);
+}
+
+// Build the tables RemapApply() uses from psConfig, which must be valid.
+// Only call this between reports, from the main loop.
+void RemapCompile(const tRemapConfig *psConfig)
+{
+    tRemapEntry *psEntry;
+    uint32_t ui32State, ui32Layer, ui32Idx, ui32Value, ui32Drive;
+
+    for(ui32State = 0; ui32State < REMAP_BUTTON_STATES; ui32State++)
+    {
+        psEntry = &g_psRemapEntries[ui32State];
+        ui32Layer = (ui32State & psConfig->ui8Shift) ? 1 : 0;
+
+        psEntry->ui8Buttons = 0;
+
+        for(ui32Idx = 0; ui32Idx < REMAP_BUTTONS; ui32Idx++)
+        {
+            if(ui32State & (1 << ui32Idx))
+            {
+                psEntry->ui8Buttons |= psConfig->ppui8Buttons[ui32Layer][ui32Idx];
+            }
+        }
+
+        // a drive without the shift button needs it let go
+        for(ui32Idx = 0; ui32Idx < REMAP_AXES; ui32Idx++)
+        {
+            ui32Drive = psConfig->pui8Drive[ui32Idx];
+
+            if(ui32Drive &&
+               ((ui32State & (ui32Drive | psConfig->ui8Shift)) == ui32Drive))
+            {
+                psEntry->pui8AxisAnd[ui32Idx] = 0;
+                psEntry->pui8AxisOr[ui32Idx] = psConfig->pui8DriveValue[ui32Idx];
+            }
+            else
+            {
+                psEntry->pui8AxisAnd[ui32Idx] = 0xff;
+                psEntry->pui8AxisOr[ui32Idx] = 0;
+            }
+        }
+    }
+
+    for(ui32Idx = 0; ui32Idx < REMAP_AXES; ui32Idx++)
+    {
+        g_pui8RemapSource[ui32Idx] =
+            psConfig->pui8Axis[ui32Idx] & REMAP_AXIS_SOURCE_M;
+
+        // a stick into a trigger or the reverse: flipping the top bit takes
+        // -128..127 to 0..255 and back, the centre to half
+        g_pui8RemapRange[ui32Idx] =
+            (RemapSigned(g_pui8RemapSource[ui32Idx]) != RemapSigned(ui32Idx)) ?
+            0x80 : 0;
+
+        // a trigger inverts to 255 - v, a stick to -v, limited to 127
+        g_pui8RemapXor[ui32Idx] =
+            (psConfig->pui8Axis[ui32Idx] & REMAP_AXIS_INVERT) ? 0xff : 0;
+        g_pui8RemapNegate[ui32Idx] =
+            (g_pui8RemapXor[ui32Idx] && RemapSigned(ui32Idx)) ? 1 : 0;
+
+        ui32Value = (psConfig->pui8Axis[ui32Idx] & REMAP_AXIS_PRESS_M) >>
+                    REMAP_AXIS_PRESS_S;
+        g_pui8RemapPress[ui32Idx] = ui32Value ? (1 << (ui32Value - 1)) : 0;
+
+        for(ui32Value = 0; ui32Value < 256; ui32Value += 32)
+        {
+            g_ppui32RemapPressAt[ui32Idx][ui32Value / 32] = 0;
+        }
+
+        for(ui32Value = 0; ui32Value < 256; ui32Value++)
+        {
+            if(RemapPressed(ui32Idx, psConfig->pui8Threshold[ui32Idx],
+                            ui32Value))
+            {
+                g_ppui32RemapPressAt[ui32Idx][ui32Value / 32] |=
+                    1 << (ui32Value % 32);
+            }
+        }
+    }
+}
+
+// Start with the identity.
+void RemapInit(void)
+{
+    RemapConfigDefaults(&g_sRemapConfig);
+    RemapCompile(&g_sRemapConfig);
+}
+
+// Post a layout for the main loop to compile.  psConfig must be valid.
+// Safe from an interrupt.
+void RemapSet(const tRemapConfig *psConfig)
+{
+    g_sRemapPending = *psConfig;
+    g_bRemapPending = true;
+}
+
+// Once a pass from the main loop: compile a layout the host has posted.
+void RemapPoll(void)
+{
+    if(!g_bRemapPending)
+    {
+        return;
+    }
+
+    // the remap page reads the layout in use from the USB0 interrupt
+    IntMasterDisable();
+    g_sRemapConfig = g_sRemapPending;
+    g_bRemapPending = false;
+    IntMasterEnable();
+
+    RemapCompile(&g_sRemapConfig);
+}
+
+// Build the report from the packed inputs through the compiled layout.  The
+// two must not overlap.  The same work whatever the layout.
+HOT_FUNC void RemapApply(const uint8_t *pui8Input, uint8_t *pui8Report)
+{
+    const tRemapEntry *psEntry;
+    uint32_t ui32Axis, ui32Value, ui32Buttons;
+
+    psEntry = &g_psRemapEntries[pui8Input[REMAP_FIELD_BUTTONS] &
+                                REMAP_ALL_BUTTONS];
+    ui32Buttons = psEntry->ui8Buttons;
+
+    for(ui32Axis = 0; ui32Axis < REMAP_AXES; ui32Axis++)
+    {
+        ui32Value = pui8Input[g_pui8RemapSource[ui32Axis]] ^
+                    g_pui8RemapRange[ui32Axis];
+
+        // ~v, plus one for a stick unless that would wrap -128 round
+        ui32Value = ((ui32Value ^ g_pui8RemapXor[ui32Axis]) +
+                     (g_pui8RemapNegate[ui32Axis] & (ui32Value != 0x80))) &
+                    0xff;
+
+        ui32Buttons |= g_pui8RemapPress[ui32Axis] &
+                       (0 - ((g_ppui32RemapPressAt[ui32Axis][ui32Value >> 5] >>
+                              (ui32Value & 31)) & 1));
+
+        pui8Report[ui32Axis] =
+            (uint8_t)((ui32Value & psEntry->pui8AxisAnd[ui32Axis]) |
+                      psEntry->pui8AxisOr[ui32Axis]);
+    }
+
+    pui8Report[REMAP_FIELD_BUTTONS] = (uint8_t)ui32Buttons;
+}
+
+// Print the layout in use.
+void RemapPrint(void)
+{
+    static const char * const ppcAxis[REMAP_AXES] = { "x", "y", "lt", "rt" };
+    const tRemapConfig *psConfig = &g_sRemapConfig;
+    uint32_t ui32Layer, ui32Idx, ui32Axis;
+
+    UARTprintf("\nremap shift 0x%02x\n", psConfig->ui8Shift);
+
+    for(ui32Layer = 0; ui32Layer < REMAP_LAYERS; ui32Layer++)
+    {
+        UARTprintf("layer %u:", ui32Layer);
+
+        for(ui32Idx = 0; ui32Idx < REMAP_BUTTONS; ui32Idx++)
+        {
+            UARTprintf(" 0x%02x", psConfig->ppui8Buttons[ui32Layer][ui32Idx]);
+        }
+
+        UARTprintf("\n");
+    }
+
+    for(ui32Idx = 0; ui32Idx < REMAP_AXES; ui32Idx++)
+    {
+        ui32Axis = psConfig->pui8Axis[ui32Idx];
+
+        UARTprintf("%s from %s%s, presses %u at %d, driven by 0x%02x to %d\n",
+                   ppcAxis[ui32Idx],
+                   (ui32Axis & REMAP_AXIS_INVERT) ? "-" : "",
+                   ppcAxis[ui32Axis & REMAP_AXIS_SOURCE_M],
+                   (ui32Axis & REMAP_AXIS_PRESS_M) >> REMAP_AXIS_PRESS_S,
+                   RemapSigned(ui32Idx) ?
+                   (int32_t)(int8_t)psConfig->pui8Threshold[ui32Idx] :
+                   (int32_t)psConfig->pui8Threshold[ui32Idx],
+                   psConfig->pui8Drive[ui32Idx],
+                   RemapSigned(ui32Idx) ?
+                   (int32_t)(int8_t)psConfig->pui8DriveValue[ui32Idx] :
+                   (int32_t)psConfig->pui8DriveValue[ui32Idx]);
+    }
+}
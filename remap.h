@@ -0,0 +1,90 @@
+//*****************************************************************************
+//
+// remap.h - Button and axis remapping with layers, compiled to lookup tables.
+//
+// Copyright (c) Aditya Challamarad.  All rights reserved.
+//
+//*****************************************************************************
+
+#ifndef _REMAP_H_
+#define _REMAP_H_
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+// Report fields, in tGamepadReport order: x, y, LT, RT, buttons.
+#define REMAP_AXIS_X            0
+#define REMAP_AXIS_Y            1
+#define REMAP_AXIS_LT           2
+#define REMAP_AXIS_RT           3
+#define REMAP_AXES              4
+#define REMAP_FIELD_BUTTONS     4
+#define REMAP_REPORT_SIZE       5
+
+// Report buttons, and the button states the tables are indexed by.
+#define REMAP_BUTTONS           5
+#define REMAP_BUTTON_STATES     (1 << REMAP_BUTTONS)
+
+// Layer 0, and layer 1 while the shift button is held.
+#define REMAP_LAYERS            2
+
+//
+// Each output axis byte of tRemapConfig: the axis it is taken from, whether
+// it is inverted, and the report button it presses past its threshold,
+// counting from 1, 0 for none.
+//
+#define REMAP_AXIS_SOURCE_M     0x03
+#define REMAP_AXIS_PRESS_M      0x70
+#define REMAP_AXIS_PRESS_S      4
+#define REMAP_AXIS_INVERT       0x80
+
+//
+// A layout.  Button bits are report buttons as GamepadButtonsPack() leaves
+// them, before the remap.
+//
+typedef struct
+{
+    // The button that selects layer 1 while held, one bit, 0 for no layers.
+    // It is mapped like any other button, usually to nothing.
+    uint8_t ui8Shift;
+
+    // The report buttons each button sets, per layer.
+    uint8_t ppui8Buttons[REMAP_LAYERS][REMAP_BUTTONS];
+
+    // Where each output axis comes from, REMAP_AXIS_*.  A stick read into a
+    // trigger, or a trigger into a stick, is moved to the output's range,
+    // so a centred stick gives a half pulled trigger and the reverse.
+    uint8_t pui8Axis[REMAP_AXES];
+
+    // Where an axis presses its button, after any swap or inversion.  The
+    // sticks are signed, a positive threshold presses at or above it and a
+    // negative one at or below it.  The triggers press at or above it.  0
+    // never presses.
+    uint8_t pui8Threshold[REMAP_AXES];
+
+    // The buttons that drive each axis to pui8DriveValue when all held, 0
+    // for none.  The layer is part of it: without the shift button they
+    // only drive the axis in layer 0, with it only in layer 1.
+    uint8_t pui8Drive[REMAP_AXES];
+    uint8_t pui8DriveValue[REMAP_AXES];
+} tRemapConfig;
+
+// The layout in use.
+extern tRemapConfig g_sRemapConfig;
+
+extern void RemapConfigDefaults(tRemapConfig *psConfig);
+extern bool RemapConfigValid(const tRemapConfig *psConfig);
+extern void RemapCompile(const tRemapConfig *psConfig);
+extern void RemapInit(void);
+extern void RemapSet(const tRemapConfig *psConfig);
+extern void RemapPoll(void);
+extern void RemapApply(const uint8_t *pui8Input, uint8_t *pui8Report);
+extern void RemapPrint(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,445 @@
+//*****************************************************************************
+//
+// replay.c - Plays a recorded input trace back through the report path.
+//
+// Copyright (c) Aditya Challamarad.  All rights reserved.
+//
+// The trace in the recorder's flash region (recorder.h, trace.h) is played
+// back in place of the sampled inputs.  Each record holds a whole report
+// after the maps and the button packing, so the replayed report replaces
+// sReport in the main loop and goes through everything after the input
+// stage unchanged: the report interval, the send, the latency trace, the
+// clock governor and the recorder.
+//
+// The records are timed by a hardware timer, not the loop.  The timer runs
+// periodic with its load taken at the timeout, so it reloads itself the
+// moment a record is due and the interrupt only has to queue the load for
+// the one after.  Interrupt latency never adds up, each record is due an
+// exact number of system clock ticks after the start.  The interrupt posts
+// the record's report and the main loop picks it up on its next pass.  How
+// long each record then waits to be handed to the driver is kept, that is
+// the replay's only timing error the host can see beyond its own polling.
+//
+// The timer counts system clock ticks, so the clock governor is held at
+// full speed while a trace plays.  The timer stops in deep sleep, a bus
+// suspend delays the rest of the trace by the time spent suspended, as the
+// recorder does not count that time either.  Gaps longer than one timer
+// period are split into several periods.
+//
+// Replay and recording share the flash region.  A replay does not start
+// while the recorder is busy, and stops if a recording starts.
+//
+//*****************************************************************************
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "inc/hw_ints.h"
+#include "inc/hw_memmap.h"
+#include "inc/hw_types.h"
+#include "driverlib/interrupt.h"
+#include "driverlib/rom.h"
+#include "driverlib/rom_map.h"
+#include "driverlib/sysctl.h"
+#include "driverlib/timer.h"
+#include "drivers/cycles.h"
+#include "utils/uartstdio.h"
+#include "clockgov.h"
+#include "hal.h"
+#include "hotpath.h"
+#include "trace.h"
+#include "recorder.h"
+#include "replay.h"
+
+#define REPLAY_REQ_NONE         0
+#define REPLAY_REQ_ONCE         1
+#define REPLAY_REQ_LOOP         2
+#define REPLAY_REQ_STOP         3
+
+// What a timer period ends with.  A wait is part of a gap too long for one
+// period.
+#define REPLAY_STEP_REPORT      0
+#define REPLAY_STEP_WAIT        1
+#define REPLAY_STEP_END         2
+
+// Shortest period, in microseconds.  The interrupt has to queue the next
+// load before the current period ends.  Recorded reports are at least a
+// USB frame apart, so this only ever applies to a damaged trace.
+#define REPLAY_MIN_US           10
+
+// Longest period, the timer is 32 bits.
+#define REPLAY_MAX_TICKS        0xffffffff
+
+typedef struct
+{
+    uint32_t ui32Ticks;         // timer ticks from the previous step
+    uint32_t ui32Kind;          // REPLAY_STEP_*
+    uint8_t pui8Report[TRACE_REPORT_SIZE];
+} tReplayStep;
+
+tReplayStats g_sReplayStats;
+
+static volatile uint32_t g_ui32ReplayState = REPLAY_IDLE;
+static volatile uint32_t g_ui32ReplayRequest;
+
+// Decoder state: where the next record is, and the ticks of a long gap not
+// yet covered by a step.
+static tTraceState g_sReplayTrace;
+static uint32_t g_ui32ReplayOffset;
+static uint64_t g_ui64ReplayGap;
+static uint32_t g_ui32ReplayMHz;
+static bool g_bReplayLoop;
+
+// The step the timer is counting down, and the one whose load is queued.
+static tReplayStep g_sReplayCur;
+static tReplayStep g_sReplayNext;
+
+// The last record due, posted by the interrupt for the main loop, and when
+// it was due.  The end of the trace sets g_bReplayDone.
+static uint8_t g_pui8ReplayDue[TRACE_REPORT_SIZE];
+static volatile bool g_bReplayFresh;
+static volatile bool g_bReplayDone;
+static uint32_t g_ui32ReplayDueCycles;
+
+// The main loop's copy of the report being played, and whether it has been
+// sent since it was due.
+static uint8_t g_pui8ReplayReport[TRACE_REPORT_SIZE];
+static uint32_t g_ui32ReplayAppliedCycles;
+static bool g_bReplayUnsent;
+
+// Work out the next timer period from the trace.
+static void ReplayStepNext(tReplayStep *psStep)
+{
+    const uint8_t *pui8Region = HALFlash(RECORDER_FLASH_BASE);
+    uint64_t ui64Prev;
+    uint32_t ui32Idx;
+    int32_t i32Len;
+
+    if(!g_ui64ReplayGap)
+    {
+        ui64Prev = g_sReplayTrace.ui64TimeUs;
+        i32Len = TraceDecode(&g_sReplayTrace, pui8Region + g_ui32ReplayOffset,
+                             RECORDER_FLASH_SIZE - g_ui32ReplayOffset);
+
+        // go round again, the first record's time is from the last one's
+        if((i32Len <= 0) && g_bReplayLoop &&
+           (g_ui32ReplayOffset > TRACE_HEADER_SIZE))
+        {
+            TraceStart(&g_sReplayTrace);
+            g_ui32ReplayOffset = TRACE_HEADER_SIZE;
+            g_sReplayStats.ui32Loops++;
+
+            ui64Prev = 0;
+            i32Len = TraceDecode(&g_sReplayTrace,
+                                 pui8Region + g_ui32ReplayOffset,
+                                 RECORDER_FLASH_SIZE - g_ui32ReplayOffset);
+        }
+
+        if(i32Len <= 0)
+        {
+            psStep->ui32Kind = REPLAY_STEP_END;
+            psStep->ui32Ticks = REPLAY_MIN_US * g_ui32ReplayMHz;
+            return;
+        }
+
+        g_ui32ReplayOffset += (uint32_t)i32Len;
+        g_ui64ReplayGap = (g_sReplayTrace.ui64TimeUs - ui64Prev) *
+                          g_ui32ReplayMHz;
+
+        if(g_ui64ReplayGap < (REPLAY_MIN_US * g_ui32ReplayMHz))
+        {
+            g_ui64ReplayGap = REPLAY_MIN_US * g_ui32ReplayMHz;
+        }
+    }
+
+    if(g_ui64ReplayGap > REPLAY_MAX_TICKS)
+    {
+        psStep->ui32Kind = REPLAY_STEP_WAIT;
+        psStep->ui32Ticks = REPLAY_MAX_TICKS;
+        g_ui64ReplayGap -= REPLAY_MAX_TICKS;
+
+        // keep the record's own period above the minimum too
+        if(g_ui64ReplayGap < (REPLAY_MIN_US * g_ui32ReplayMHz))
+        {
+            psStep->ui32Ticks -= REPLAY_MIN_US * g_ui32ReplayMHz;
+            g_ui64ReplayGap += REPLAY_MIN_US * g_ui32ReplayMHz;
+        }
+        return;
+    }
+
+    psStep->ui32Kind = REPLAY_STEP_REPORT;
+    psStep->ui32Ticks = (uint32_t)g_ui64ReplayGap;
+    g_ui64ReplayGap = 0;
+
+    for(ui32Idx = 0; ui32Idx < TRACE_REPORT_SIZE; ui32Idx++)
+    {
+        psStep->pui8Report[ui32Idx] = g_sReplayTrace.pui8Report[ui32Idx];
+    }
+}
+
+// The step the timer was counting down has ended, and the timer has
+// already started on the next one.  Post the report and queue the load for
+// the step after.
+HOT_FUNC void ReplayTimerIntHandler(void)
+{
+    uint32_t ui32Idx;
+
+    MAP_TimerIntClear(REPLAY_TIMER_BASE, TIMER_TIMA_TIMEOUT);
+
+    if(g_sReplayCur.ui32Kind == REPLAY_STEP_REPORT)
+    {
+        if(g_bReplayFresh)
+        {
+            g_sReplayStats.ui32Overrun++;
+        }
+
+        for(ui32Idx = 0; ui32Idx < TRACE_REPORT_SIZE; ui32Idx++)
+        {
+            g_pui8ReplayDue[ui32Idx] = g_sReplayCur.pui8Report[ui32Idx];
+        }
+
+        g_ui32ReplayDueCycles = CyclesGet();
+        g_bReplayFresh = true;
+        g_sReplayStats.ui32Records++;
+    }
+
+    g_sReplayCur = g_sReplayNext;
+
+    if(g_sReplayCur.ui32Kind == REPLAY_STEP_END)
+    {
+        MAP_TimerDisable(REPLAY_TIMER_BASE, TIMER_A);
+        g_bReplayDone = true;
+        return;
+    }
+
+    ReplayStepNext(&g_sReplayNext);
+    MAP_TimerLoadSet(REPLAY_TIMER_BASE, TIMER_A, g_sReplayNext.ui32Ticks - 1);
+}
+
+// Stop the timer and go back to the sampled inputs.
+static void ReplayHalt(void)
+{
+    MAP_TimerDisable(REPLAY_TIMER_BASE, TIMER_A);
+    MAP_TimerIntClear(REPLAY_TIMER_BASE, TIMER_TIMA_TIMEOUT);
+
+    g_bReplayFresh = false;
+    g_bReplayUnsent = false;
+    g_ui32ReplayState = REPLAY_IDLE;
+}
+
+// Start playing the trace in flash from its first record.
+static void ReplayBegin(bool bLoop)
+{
+    if(RecorderState() != RECORDER_IDLE)
+    {
+        UARTprintf("\nrecorder busy, no replay\n");
+        return;
+    }
+
+    if(!TraceHeaderValid(HALFlash(RECORDER_FLASH_BASE)))
+    {
+        UARTprintf("\nno trace to replay\n");
+        return;
+    }
+
+    // the timer counts at full speed from here on
+    ClockGovActivity();
+    g_ui32ReplayMHz = SysCtlClockGet() / 1000000;
+
+    g_sReplayStats.ui32Records = 0;
+    g_sReplayStats.ui32Loops = 0;
+    g_sReplayStats.ui32Overrun = 0;
+    g_sReplayStats.ui32Sent = 0;
+    g_sReplayStats.ui32MaxLateCycles = 0;
+    g_sReplayStats.ui64LateCycles = 0;
+
+    TraceStart(&g_sReplayTrace);
+    g_ui32ReplayOffset = TRACE_HEADER_SIZE;
+    g_ui64ReplayGap = 0;
+    g_bReplayLoop = bLoop;
+    g_bReplayFresh = false;
+    g_bReplayDone = false;
+    g_bReplayUnsent = false;
+
+    ReplayStepNext(&g_sReplayCur);
+
+    if(g_sReplayCur.ui32Kind == REPLAY_STEP_END)
+    {
+        UARTprintf("\ntrace is empty\n");
+        return;
+    }
+
+    ReplayStepNext(&g_sReplayNext);
+
+    // the first period starts now, the second is taken at its timeout
+    g_ui32ReplayState = REPLAY_PLAYING;
+    IntMasterDisable();
+    MAP_TimerLoadSet(REPLAY_TIMER_BASE, TIMER_A, g_sReplayCur.ui32Ticks - 1);
+    MAP_TimerEnable(REPLAY_TIMER_BASE, TIMER_A);
+    MAP_TimerLoadSet(REPLAY_TIMER_BASE, TIMER_A, g_sReplayNext.ui32Ticks - 1);
+    IntMasterEnable();
+
+    UARTprintf("\nreplaying%s\n", bLoop ? ", looped" : "");
+}
+
+void ReplayInit(void)
+{
+    MAP_TimerConfigure(REPLAY_TIMER_BASE, TIMER_CFG_PERIODIC);
+    TimerUpdateMode(REPLAY_TIMER_BASE, TIMER_A, TIMER_UP_LOAD_TIMEOUT);
+    MAP_TimerIntEnable(REPLAY_TIMER_BASE, TIMER_TIMA_TIMEOUT);
+    MAP_IntEnable(REPLAY_TIMER_INT);
+}
+
+// Ask the main loop to play the trace, once or round and round.  Safe from
+// an interrupt.
+void ReplayStart(bool bLoop)
+{
+    g_ui32ReplayRequest = bLoop ? REPLAY_REQ_LOOP : REPLAY_REQ_ONCE;
+}
+
+// Ask the main loop to stop playing.  Safe from an interrupt.
+void ReplayStop(void)
+{
+    g_ui32ReplayRequest = REPLAY_REQ_STOP;
+}
+
+uint32_t ReplayState(void)
+{
+    return(g_ui32ReplayState);
+}
+
+// Put the report being played into pui8Report, in place of the sampled
+// inputs.  Returns true when a new record has come due, so it goes out even
+// without a new ADC sample.  Costs a load and a compare when not playing.
+HOT_FUNC bool ReplayApply(uint8_t *pui8Report)
+{
+    uint32_t ui32Idx;
+    bool bNew;
+
+    if(g_ui32ReplayState != REPLAY_PLAYING)
+    {
+        return(false);
+    }
+
+    bNew = g_bReplayFresh;
+
+    if(bNew)
+    {
+        IntMasterDisable();
+
+        for(ui32Idx = 0; ui32Idx < TRACE_REPORT_SIZE; ui32Idx++)
+        {
+            g_pui8ReplayReport[ui32Idx] = g_pui8ReplayDue[ui32Idx];
+        }
+
+        g_ui32ReplayAppliedCycles = g_ui32ReplayDueCycles;
+        g_bReplayFresh = false;
+        IntMasterEnable();
+
+        // the last record never went out
+        if(g_bReplayUnsent)
+        {
+            g_sReplayStats.ui32Overrun++;
+        }
+
+        g_bReplayUnsent = true;
+    }
+
+    for(ui32Idx = 0; ui32Idx < TRACE_REPORT_SIZE; ui32Idx++)
+    {
+        pui8Report[ui32Idx] = g_pui8ReplayReport[ui32Idx];
+    }
+
+    return(bNew);
+}
+
+// A report has been handed to the driver.  The first one after a record
+// came due carries it.
+HOT_FUNC void ReplaySent(void)
+{
+    uint32_t ui32Cycles;
+
+    if(!g_bReplayUnsent)
+    {
+        return;
+    }
+
+    g_bReplayUnsent = false;
+    ui32Cycles = CyclesSince(g_ui32ReplayAppliedCycles);
+
+    g_sReplayStats.ui32Sent++;
+    g_sReplayStats.ui64LateCycles += ui32Cycles;
+
+    if(ui32Cycles > g_sReplayStats.ui32MaxLateCycles)
+    {
+        g_sReplayStats.ui32MaxLateCycles = ui32Cycles;
+    }
+}
+
+// Once a pass from the main loop: act on requests and notice the end of
+// the trace.
+void ReplayPoll(void)
+{
+    uint32_t ui32Request = g_ui32ReplayRequest;
+
+    if((g_ui32ReplayState == REPLAY_IDLE) && !ui32Request)
+    {
+        return;
+    }
+
+    g_ui32ReplayRequest = REPLAY_REQ_NONE;
+
+    if(ui32Request && (g_ui32ReplayState == REPLAY_PLAYING))
+    {
+        ReplayHalt();
+        UARTprintf("\nreplay stopped\n");
+        ReplayPrint();
+    }
+
+    if((ui32Request == REPLAY_REQ_ONCE) || (ui32Request == REPLAY_REQ_LOOP))
+    {
+        ReplayBegin(ui32Request == REPLAY_REQ_LOOP);
+    }
+
+    if(g_ui32ReplayState != REPLAY_PLAYING)
+    {
+        return;
+    }
+
+    // a recording is about to erase the trace
+    if(RecorderState() != RECORDER_IDLE)
+    {
+        ReplayHalt();
+        UARTprintf("\nreplay stopped by the recorder\n");
+        return;
+    }
+
+    // the last record has to be picked up before the end
+    if(g_bReplayDone && !g_bReplayFresh)
+    {
+        ReplayHalt();
+        UARTprintf("\nreplay done\n");
+        ReplayPrint();
+        return;
+    }
+
+    // hold the clock the timer counts at
+    ClockGovActivity();
+}
+
+// Print the replay state and how late the records went out.
+void ReplayPrint(void)
+{
+    uint32_t ui32Mean, ui32MHz = g_ui32ReplayMHz ? g_ui32ReplayMHz : 1;
+
+    ui32Mean = g_sReplayStats.ui32Sent ?
+               (uint32_t)((g_sReplayStats.ui64LateCycles * 10) /
+                          ((uint64_t)g_sReplayStats.ui32Sent * ui32MHz)) : 0;
+
+    UARTprintf("\nreplay %s, %u records, %u loops, %u overrun\n",
+               (g_ui32ReplayState == REPLAY_PLAYING) ? "playing" : "idle",
+               g_sReplayStats.ui32Records, g_sReplayStats.ui32Loops,
+               g_sReplayStats.ui32Overrun);
+    UARTprintf("due to sent over %u reports: mean %u.%uus, max %uus\n",
+               g_sReplayStats.ui32Sent, ui32Mean / 10, ui32Mean % 10,
+               g_sReplayStats.ui32MaxLateCycles / ui32MHz);
+}
@@ -0,0 +1,53 @@
+//*****************************************************************************
+//
+// replay.h - Plays a recorded input trace back through the report path.
+//
+// Copyright (c) Aditya Challamarad.  All rights reserved.
+//
+//*****************************************************************************
+
+#ifndef _REPLAY_H_
+#define _REPLAY_H_
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+//
+// The timer the records are due from, Timer 3 as one 32 bit periodic timer
+// clocked from the system clock.  Its timeout vector is ReplayTimerIntHandler.
+//
+#define REPLAY_TIMER_BASE       TIMER3_BASE
+#define REPLAY_TIMER_INT        INT_TIMER3A
+
+#define REPLAY_IDLE             0
+#define REPLAY_PLAYING          1
+
+typedef struct
+{
+    uint32_t ui32Records;       // records played since the start
+    uint32_t ui32Loops;         // times a looped replay went round
+    uint32_t ui32Overrun;       // records replaced before they were sent
+    uint32_t ui32Sent;          // records that went out in a report
+    uint32_t ui32MaxLateCycles; // longest from due to handed to the driver
+    uint64_t ui64LateCycles;    // sum of the same, for the mean
+} tReplayStats;
+
+extern tReplayStats g_sReplayStats;
+
+extern void ReplayInit(void);
+extern void ReplayStart(bool bLoop);
+extern void ReplayStop(void);
+extern uint32_t ReplayState(void);
+extern bool ReplayApply(uint8_t *pui8Report);
+extern void ReplaySent(void);
+extern void ReplayPoll(void);
+extern void ReplayPrint(void);
+extern void ReplayTimerIntHandler(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,100 @@
+//*****************************************************************************
+//
+// stackmon.c - Stack high water mark and RAM budget monitoring.
+//
+// Copyright (c) Aditya Challamarad.  All rights reserved.
+//
+// ResetISR paints the whole stack with STACK_PAINT before the C runtime
+// starts, so the deepest point the stack has reached is the lowest word that
+// no longer holds the pattern.  The bottom STACK_GUARD_SIZE bytes are made
+// inaccessible with the MPU, so an overflow faults right away instead of
+// silently running into .bss.
+//
+// The MemManage fault is left disabled on purpose.  A guard hit escalates to
+// a hard fault, and the MPU is off while the hard fault handler runs, so the
+// handler can still stack its frame.
+//
+//*****************************************************************************
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "inc/hw_types.h"
+#include "driverlib/mpu.h"
+#include "utils/uartstdio.h"
+#include "stackmon.h"
+
+// Total on-chip SRAM, see the MEMORY block in usb_dev_gamepad_ccs.cmd.
+#define SRAM_SIZE               0x00008000
+
+// Linker defined symbols, the address of each is its value.
+extern uint32_t __stack;
+extern uint32_t __STACK_TOP;
+extern uint32_t __vtable_size;
+extern uint32_t __data_size;
+extern uint32_t __bss_size;
+extern uint32_t __ramfunc_size;
+extern uint32_t __noinit_size;
+extern uint32_t __sysmem_size;
+
+// Put the guard region at the bottom of the stack.
+void StackMonInit(void)
+{
+    MPURegionSet(0, (uint32_t)&__stack,
+                 MPU_RGN_SIZE_32 | MPU_RGN_PERM_NOEXEC |
+                 MPU_RGN_PERM_PRV_NO_USR_NO | MPU_RGN_ENABLE);
+
+    // Everything else keeps the default memory map.
+    MPUEnable(MPU_CONFIG_PRIV_DEFAULT);
+}
+
+// Deepest stack use since reset in bytes.  Scans up from just above the guard
+// for the first word that is no longer painted.
+uint32_t StackHighWater(void)
+{
+    uint32_t *pui32Word = &__stack + (STACK_GUARD_SIZE / 4);
+
+    while((pui32Word < &__STACK_TOP) && (*pui32Word == STACK_PAINT))
+    {
+        pui32Word++;
+    }
+
+    return((uint32_t)&__STACK_TOP - (uint32_t)pui32Word);
+}
+
+// Fill in the SRAM usage by section.
+void RAMBudgetGet(tRAMBudget *psBudget)
+{
+    uint32_t ui32Used;
+
+    psBudget->ui32SRAM = SRAM_SIZE;
+    psBudget->ui32Vtable = (uint32_t)&__vtable_size;
+    psBudget->ui32Data = (uint32_t)&__data_size;
+    psBudget->ui32Bss = (uint32_t)&__bss_size;
+    psBudget->ui32RamFunc = (uint32_t)&__ramfunc_size;
+    psBudget->ui32NoInit = (uint32_t)&__noinit_size;
+    psBudget->ui32Heap = (uint32_t)&__sysmem_size;
+    psBudget->ui32Stack = (uint32_t)&__STACK_TOP - (uint32_t)&__stack;
+    psBudget->ui32StackUsed = StackHighWater();
+
+    ui32Used = psBudget->ui32Vtable + psBudget->ui32Data + psBudget->ui32Bss +
+               psBudget->ui32RamFunc + psBudget->ui32NoInit +
+               psBudget->ui32Heap + psBudget->ui32Stack;
+    psBudget->ui32Free = (ui32Used < SRAM_SIZE) ? (SRAM_SIZE - ui32Used) : 0;
+}
+
+// Dump the RAM budget to the UART console.
+void RAMBudgetPrint(void)
+{
+    tRAMBudget sBudget;
+
+    RAMBudgetGet(&sBudget);
+
+    UARTprintf("\nsram %u: vtable %u data %u bss %u ramfunc %u noinit %u "
+               "heap %u stack %u free %u\n",
+               sBudget.ui32SRAM, sBudget.ui32Vtable, sBudget.ui32Data,
+               sBudget.ui32Bss, sBudget.ui32RamFunc, sBudget.ui32NoInit,
+               sBudget.ui32Heap, sBudget.ui32Stack, sBudget.ui32Free);
+    UARTprintf("stack high water %u of %u (guard %u)\n",
+               sBudget.ui32StackUsed, sBudget.ui32Stack - STACK_GUARD_SIZE,
+               STACK_GUARD_SIZE);
+}
@@ -0,0 +1,51 @@
+//*****************************************************************************
+//
+// stackmon.h - Stack high water mark and RAM budget monitoring.
+//
+// Copyright (c) Aditya Challamarad.  All rights reserved.
+//
+//*****************************************************************************
+
+#ifndef _STACKMON_H_
+#define _STACKMON_H_
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+// Pattern ResetISR fills the stack with, anything else has been used.
+#define STACK_PAINT             0xDEADBEEF
+
+// Bytes at the top of the stack left unpainted for ResetISR's own frame.
+#define STACK_PAINT_MARGIN      64
+
+// Size of the no access MPU region at the bottom of the stack.  The linker
+// command file aligns .stack to this so the region can sit right on it.
+#define STACK_GUARD_SIZE        32
+
+// SRAM usage, all in bytes.
+typedef struct
+{
+    uint32_t ui32SRAM;          // total SRAM
+    uint32_t ui32Vtable;        // RAM vector table
+    uint32_t ui32Data;          // initialized data
+    uint32_t ui32Bss;           // zero initialized data
+    uint32_t ui32RamFunc;       // code copied to SRAM at startup
+    uint32_t ui32NoInit;        // not cleared at startup (crash record)
+    uint32_t ui32Heap;          // heap, .sysmem
+    uint32_t ui32Stack;         // stack, including the guard
+    uint32_t ui32StackUsed;     // deepest stack use seen so far
+    uint32_t ui32Free;          // SRAM not claimed by any section
+} tRAMBudget;
+
+extern void StackMonInit(void);
+extern uint32_t StackHighWater(void);
+extern void RAMBudgetGet(tRAMBudget *psBudget);
+extern void RAMBudgetPrint(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
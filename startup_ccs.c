@@ -22,19 +22,21 @@
 //
 //*****************************************************************************
 
+#include <stdbool.h>
 #include <stdint.h>
 #include "inc/hw_nvic.h"
 #include "inc/hw_types.h"
+#include "fault.h"
+#include "stackmon.h"
 
 //*****************************************************************************
 //
-// Forward declaration of the default fault handlers.
+// Forward declaration of the reset handler.  The NMI, fault and unexpected
+// interrupt handlers are in fault.c; they record the fault and reset through
+// the watchdog instead of stopping.
 //
 //*****************************************************************************
 void ResetISR(void);
-static void NmiSR(void);
-static void FaultISR(void);
-static void IntDefaultHandler(void);
 
 //*****************************************************************************
 //
@@ -46,9 +48,10 @@ extern void _c_int00(void);
 
 //*****************************************************************************
 //
-// Linker variable that marks the top of the stack.
+// Linker variables that mark the bottom and top of the stack.
 //
 //*****************************************************************************
+extern uint32_t __stack;
 extern uint32_t __STACK_TOP;
 
 //*****************************************************************************
@@ -58,6 +61,28 @@ extern uint32_t __STACK_TOP;
 //*****************************************************************************
 extern void UARTStdioIntHandler(void);
 extern void USB0DeviceIntHandler(void);
+extern void SuspendGPIOIntHandler(void);
+extern void SuspendTimerIntHandler(void);
+extern void SupervisorIntHandler(void);
+extern void RGBBlinkIntHandler(void);
+extern void ReplayTimerIntHandler(void);
+extern void MacroTimerIntHandler(void);
+
+//*****************************************************************************
+//
+// When built with ISR_PROFILE the profiled handlers are reached through the
+// timing wrappers in isrprof.c instead of directly.
+//
+//*****************************************************************************
+#ifdef ISR_PROFILE
+extern void ISRProfUARTStdioIntHandler(void);
+extern void ISRProfUSB0DeviceIntHandler(void);
+#define UART0_HANDLER           ISRProfUARTStdioIntHandler
+#define USB0_HANDLER            ISRProfUSB0DeviceIntHandler
+#else
+#define UART0_HANDLER           UARTStdioIntHandler
+#define USB0_HANDLER            USB0DeviceIntHandler
+#endif
 
 //*****************************************************************************
 //
@@ -86,12 +111,12 @@ void (* const g_pfnVectors[])(void) =
     0,                                      // Reserved
     IntDefaultHandler,                      // The PendSV handler
     IntDefaultHandler,                      // The SysTick handler
-    IntDefaultHandler,                      // GPIO Port A
-    IntDefaultHandler,                      // GPIO Port B
-    IntDefaultHandler,                      // GPIO Port C
+    SuspendGPIOIntHandler,                  // GPIO Port A
+    SuspendGPIOIntHandler,                  // GPIO Port B
+    SuspendGPIOIntHandler,                  // GPIO Port C
     IntDefaultHandler,                      // GPIO Port D
     IntDefaultHandler,                      // GPIO Port E
-    UARTStdioIntHandler,                    // UART0 Rx and Tx
+    UART0_HANDLER,                          // UART0 Rx and Tx
     IntDefaultHandler,                      // UART1 Rx and Tx
     IntDefaultHandler,                      // SSI0 Rx and Tx
     IntDefaultHandler,                      // I2C0 Master and Slave
@@ -104,24 +129,24 @@ void (* const g_pfnVectors[])(void) =
     IntDefaultHandler,                      // ADC Sequence 1
     IntDefaultHandler,                      // ADC Sequence 2
     IntDefaultHandler,                      // ADC Sequence 3
-    IntDefaultHandler,                      // Watchdog timer
+    SupervisorIntHandler,                   // Watchdog timer
     IntDefaultHandler,                      // Timer 0 subtimer A
     IntDefaultHandler,                      // Timer 0 subtimer B
     IntDefaultHandler,                      // Timer 1 subtimer A
     IntDefaultHandler,                      // Timer 1 subtimer B
-    IntDefaultHandler,                      // Timer 2 subtimer A
+    SuspendTimerIntHandler,                 // Timer 2 subtimer A
     IntDefaultHandler,                      // Timer 2 subtimer B
     IntDefaultHandler,                      // Analog Comparator 0
     IntDefaultHandler,                      // Analog Comparator 1
     IntDefaultHandler,                      // Analog Comparator 2
     IntDefaultHandler,                      // System Control (PLL, OSC, BO)
     IntDefaultHandler,                      // FLASH Control
-    IntDefaultHandler,                      // GPIO Port F
+    SuspendGPIOIntHandler,                  // GPIO Port F
     IntDefaultHandler,                      // GPIO Port G
     IntDefaultHandler,                      // GPIO Port H
     IntDefaultHandler,                      // UART2 Rx and Tx
     IntDefaultHandler,                      // SSI1 Rx and Tx
-    IntDefaultHandler,                      // Timer 3 subtimer A
+    ReplayTimerIntHandler,                  // Timer 3 subtimer A
     IntDefaultHandler,                      // Timer 3 subtimer B
     IntDefaultHandler,                      // I2C1 Master and Slave
     IntDefaultHandler,                      // Quadrature Encoder 1
@@ -130,7 +155,7 @@ void (* const g_pfnVectors[])(void) =
     0,                                      // Reserved
     0,                                      // Reserved
     IntDefaultHandler,                      // Hibernate
-    USB0DeviceIntHandler,                   // USB0
+    USB0_HANDLER,                           // USB0
     IntDefaultHandler,                      // PWM Generator 3
     IntDefaultHandler,                      // uDMA Software Transfer
     IntDefaultHandler,                      // uDMA Error
@@ -156,7 +181,7 @@ void (* const g_pfnVectors[])(void) =
     0,                                      // Reserved
     IntDefaultHandler,                      // I2C2 Master and Slave
     IntDefaultHandler,                      // I2C3 Master and Slave
-    IntDefaultHandler,                      // Timer 4 subtimer A
+    MacroTimerIntHandler,                   // Timer 4 subtimer A
     IntDefaultHandler,                      // Timer 4 subtimer B
     0,                                      // Reserved
     0,                                      // Reserved
@@ -191,7 +216,7 @@ void (* const g_pfnVectors[])(void) =
     IntDefaultHandler,                      // Wide Timer 4 subtimer A
     IntDefaultHandler,                      // Wide Timer 4 subtimer B
     IntDefaultHandler,                      // Wide Timer 5 subtimer A
-    IntDefaultHandler,                      // Wide Timer 5 subtimer B
+    RGBBlinkIntHandler,                     // Wide Timer 5 subtimer B
     IntDefaultHandler,                      // FPU
     0,                                      // Reserved
     0,                                      // Reserved
@@ -240,64 +265,22 @@ void (* const g_pfnVectors[])(void) =
 void
 ResetISR(void)
 {
-    //
-    // Jump to the CCS C initialization routine.  This will enable the
-    // floating-point unit as well, so that does not need to be done here.
-    //
-    __asm("    .global _c_int00\n"
-          "    b.w     _c_int00");
-}
-
-//*****************************************************************************
-//
-// This is the code that gets called when the processor receives a NMI.  This
-// simply enters an infinite loop, preserving the system state for examination
-// by a debugger.
-//
-//*****************************************************************************
-static void
-NmiSR(void)
-{
-    //
-    // Enter an infinite loop.
-    //
-    while(1)
-    {
-    }
-}
+    uint32_t *pui32Fill;
 
-//*****************************************************************************
-//
-// This is the code that gets called when the processor receives a fault
-// interrupt.  This simply enters an infinite loop, preserving the system state
-// for examination by a debugger.
-//
-//*****************************************************************************
-static void
-FaultISR(void)
-{
     //
-    // Enter an infinite loop.
+    // Paint the stack so the high water mark can be found later.  The stack
+    // pointer starts at the top, so everything below the margin is free.
     //
-    while(1)
+    for(pui32Fill = &__stack;
+        pui32Fill < (&__STACK_TOP - (STACK_PAINT_MARGIN / 4)); pui32Fill++)
     {
+        *pui32Fill = STACK_PAINT;
     }
-}
 
-//*****************************************************************************
-//
-// This is the code that gets called when the processor receives an unexpected
-// interrupt.  This simply enters an infinite loop, preserving the system state
-// for examination by a debugger.
-//
-//*****************************************************************************
-static void
-IntDefaultHandler(void)
-{
     //
-    // Go into an infinite loop.
+    // Jump to the CCS C initialization routine.  This will enable the
+    // floating-point unit as well, so that does not need to be done here.
     //
-    while(1)
-    {
-    }
+    __asm("    .global _c_int00\n"
+          "    b.w     _c_int00");
 }
@@ -0,0 +1,197 @@
+//*****************************************************************************
+//
+// supervisor.c - Watchdog supervisor for the report pipeline.
+//
+// Copyright (c) Aditya Challamarad.  All rights reserved.
+//
+// WATCHDOG0 is never fed from the main loop.  Its first timeout raises an
+// interrupt every SUPERVISOR_PERIOD_MS, and SupervisorIntHandler() checks
+// that each stage of the pipeline has moved on since the last period:
+//
+//  - the main loop has made a pass (SupervisorLoop())
+//  - a report handed to usblib has completed (SupervisorTxDone()), or the
+//    endpoint does not look stuck
+//
+// A report can wait for TX complete for as long as the host likes, a host
+// that has nothing reading the device stops polling it.  Only a report the
+// endpoint has lost, with the bus still running, counts as stuck.  That
+// gets a soft USB restart, run from the main loop through
+// SupervisorRecoverUSB().  If that does not clear it, if the endpoint
+// sticks again after SUPERVISOR_USB_RESTARTS restarts with no report
+// completed in between, or the main loop itself has stopped, the system is
+// reset through FaultReset() so the crash record says why.  Until then the watchdog is fed, the reset is left to the
+// supervisor so it is recorded.  If interrupts are masked for good the
+// handler never runs and the second timeout resets the system on its own.
+//
+// The watchdog runs from the system clock, so a clock governor hook
+// reloads it whenever the clock changes.  It is not clocked in deep sleep
+// and stalls while the debugger has the core halted.
+//
+//*****************************************************************************
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "inc/hw_ints.h"
+#include "inc/hw_memmap.h"
+#include "inc/hw_types.h"
+#include "driverlib/interrupt.h"
+#include "driverlib/rom.h"
+#include "driverlib/rom_map.h"
+#include "driverlib/sysctl.h"
+#include "driverlib/watchdog.h"
+#include "utils/uartstdio.h"
+#include "clockgov.h"
+#include "fault.h"
+#include "supervisor.h"
+
+tSupervisorStats g_sSupervisorStats;
+
+static tSupervisorStuck g_pfnSupervisorTxStuck;
+
+// Progress counters bumped by the pipeline and their values at the last
+// check.
+static volatile uint32_t g_ui32SupervisorLoops;
+static volatile uint32_t g_ui32SupervisorTxDone;
+static uint32_t g_ui32SupervisorLastLoops;
+static uint32_t g_ui32SupervisorLastTxDone;
+
+// Periods without progress for each stage.
+static uint32_t g_ui32SupervisorLoopStall;
+static uint32_t g_ui32SupervisorTxStall;
+
+// USB restarts asked for since a report last completed.
+static uint32_t g_ui32SupervisorRestarts;
+
+// Set by the handler for the main loop to restart the USB stack.
+static volatile bool g_bSupervisorRecover;
+
+// Watchdog load for one period at the given system clock.
+static void SupervisorClockSet(uint32_t ui32SysClock)
+{
+    MAP_WatchdogReloadSet(WATCHDOG0_BASE,
+                          (ui32SysClock / 1000) * SUPERVISOR_PERIOD_MS);
+}
+
+// Start the watchdog.  Call just before the main loop, once nothing slow is
+// left to do.  pfnTxStuck tells the supervisor when the report endpoint is
+// stuck.
+void SupervisorInit(tSupervisorStuck pfnTxStuck)
+{
+    g_pfnSupervisorTxStuck = pfnTxStuck;
+
+    // WDOG0 is clocked by BoardInit().
+    if(MAP_WatchdogLockState(WATCHDOG0_BASE))
+    {
+        MAP_WatchdogUnlock(WATCHDOG0_BASE);
+    }
+
+    SupervisorClockSet(SysCtlClockGet());
+
+    if(!ClockGovHookRegister(SupervisorClockSet))
+    {
+        FaultReset(FAULT_TYPE_SETUP);
+    }
+
+    MAP_WatchdogStallEnable(WATCHDOG0_BASE);
+    MAP_WatchdogResetEnable(WATCHDOG0_BASE);
+    MAP_WatchdogIntEnable(WATCHDOG0_BASE);
+    MAP_IntEnable(INT_WATCHDOG);
+    MAP_WatchdogEnable(WATCHDOG0_BASE);
+}
+
+// The main loop has made a pass.
+void SupervisorLoop(void)
+{
+    g_ui32SupervisorLoops++;
+}
+
+// A report has completed.  Called from the USB event handler.
+void SupervisorTxDone(void)
+{
+    g_ui32SupervisorTxDone++;
+}
+
+// True once if the handler wants the USB stack restarted.  The caller is
+// expected to do it straight away.
+bool SupervisorRecoverUSB(void)
+{
+    if(!g_bSupervisorRecover)
+    {
+        return(false);
+    }
+
+    g_bSupervisorRecover = false;
+    g_sSupervisorStats.ui32USBRecoveries++;
+
+    return(true);
+}
+
+// Watchdog first timeout, once per period.
+void SupervisorIntHandler(void)
+{
+    uint32_t ui32Loops = g_ui32SupervisorLoops;
+    uint32_t ui32TxDone = g_ui32SupervisorTxDone;
+
+    g_sSupervisorStats.ui32Checks++;
+
+    // main loop
+    if(ui32Loops != g_ui32SupervisorLastLoops)
+    {
+        g_ui32SupervisorLoopStall = 0;
+    }
+    else if(++g_ui32SupervisorLoopStall >= SUPERVISOR_LOOP_PERIODS)
+    {
+        FaultReset(FAULT_TYPE_SUPERVISOR);
+    }
+
+    // only a completed report shows a restart helped
+    if(ui32TxDone != g_ui32SupervisorLastTxDone)
+    {
+        g_ui32SupervisorRestarts = 0;
+    }
+
+    // the endpoint lost a report and none has finished since the last check
+    if(g_pfnSupervisorTxStuck() &&
+       (ui32TxDone == g_ui32SupervisorLastTxDone))
+    {
+        g_ui32SupervisorTxStall++;
+
+        if(g_ui32SupervisorTxStall > g_sSupervisorStats.ui32MaxTxPeriods)
+        {
+            g_sSupervisorStats.ui32MaxTxPeriods = g_ui32SupervisorTxStall;
+        }
+
+        if((g_ui32SupervisorTxStall >= SUPERVISOR_TX_RESET) ||
+           ((g_ui32SupervisorTxStall == SUPERVISOR_TX_RECOVER) &&
+            (g_ui32SupervisorRestarts >= SUPERVISOR_USB_RESTARTS)))
+        {
+            FaultReset(FAULT_TYPE_SUPERVISOR);
+        }
+        else if(g_ui32SupervisorTxStall == SUPERVISOR_TX_RECOVER)
+        {
+            g_ui32SupervisorRestarts++;
+            g_bSupervisorRecover = true;
+        }
+    }
+    else
+    {
+        g_ui32SupervisorTxStall = 0;
+    }
+
+    g_ui32SupervisorLastLoops = ui32Loops;
+    g_ui32SupervisorLastTxDone = ui32TxDone;
+
+    // the main loop is moving and any stuck endpoint is being handled, feed
+    // the watchdog
+    MAP_WatchdogIntClear(WATCHDOG0_BASE);
+}
+
+// Dump the supervisor statistics to the UART console.
+void SupervisorPrint(void)
+{
+    UARTprintf("\nwatchdog %ums: %u checks, %u usb restarts, "
+               "longest stuck %u periods\n", SUPERVISOR_PERIOD_MS,
+               g_sSupervisorStats.ui32Checks,
+               g_sSupervisorStats.ui32USBRecoveries,
+               g_sSupervisorStats.ui32MaxTxPeriods);
+}
@@ -0,0 +1,61 @@
+//*****************************************************************************
+//
+// supervisor.h - Watchdog supervisor for the report pipeline.
+//
+// Copyright (c) Aditya Challamarad.  All rights reserved.
+//
+//*****************************************************************************
+
+#ifndef _SUPERVISOR_H_
+#define _SUPERVISOR_H_
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+// Watchdog period.  Every stage is checked once per period and the watchdog
+// is only fed if all of them are healthy.
+#define SUPERVISOR_PERIOD_MS    100
+
+// Periods the main loop may go without a pass.  Allows for SuspendEnter()
+// draining the UART buffer.
+#define SUPERVISOR_LOOP_PERIODS 2
+
+// Periods the report endpoint may look stuck before the USB stack is
+// restarted, and before the system is reset if that did not help.
+#define SUPERVISOR_TX_RECOVER   2
+#define SUPERVISOR_TX_RESET     10
+
+// USB restarts in a row, with no report completed since the first, before
+// the next one is a system reset instead.  A restart clears the stuck count,
+// so an endpoint that sticks again after every enumeration only ends here.
+#define SUPERVISOR_USB_RESTARTS 3
+
+// Returns true while a report is waiting for TX complete and the endpoint
+// shows it will not get one: the bus is running but the packet has left the
+// FIFO, or the endpoint stalled.  A report waiting for a host that is not
+// polling does not count.  Called from the watchdog interrupt once a period.
+typedef bool (*tSupervisorStuck)(void);
+
+typedef struct
+{
+    uint32_t ui32Checks;        // watchdog periods checked
+    uint32_t ui32USBRecoveries; // soft USB restarts for a stuck endpoint
+    uint32_t ui32MaxTxPeriods;  // longest the endpoint looked stuck, in periods
+} tSupervisorStats;
+
+extern tSupervisorStats g_sSupervisorStats;
+
+extern void SupervisorInit(tSupervisorStuck pfnTxStuck);
+extern void SupervisorLoop(void);
+extern void SupervisorTxDone(void);
+extern bool SupervisorRecoverUSB(void);
+extern void SupervisorPrint(void);
+extern void SupervisorIntHandler(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
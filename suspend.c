@@ -0,0 +1,350 @@
+//*****************************************************************************
+//
+// suspend.c - USB suspend low power mode and remote wakeup.
+//
+// Copyright (c) Aditya Challamarad.  All rights reserved.
+//
+// When the host suspends the bus the main loop calls SuspendEnter() and then
+// SuspendSleep() until the bus is resumed or there is input.  The core sits
+// in deep sleep with only the button GPIO ports, the USB controller and the
+// poll timer clocked, all from the 30kHz internal oscillator.  Flash and
+// SRAM are put in their low power modes.
+//
+// A button edge wakes the core through the GPIO interrupt.  The sticks and
+// potentiometer cannot raise an interrupt, so Timer 2A, clocked from PIOSC
+// so it keeps the same rate asleep and awake, wakes the core every
+// SUSPEND_POLL_MS to take one ADC sample and compare it with the sample
+// taken at suspend.
+//
+// Wake to first report time is measured in microseconds rather than cycles,
+// as the clock changes on the way.
+//
+//*****************************************************************************
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "inc/hw_memmap.h"
+#include "inc/hw_ints.h"
+#include "inc/hw_types.h"
+#include "driverlib/adc.h"
+#include "driverlib/gpio.h"
+#include "driverlib/interrupt.h"
+#include "driverlib/rom.h"
+#include "driverlib/rom_map.h"
+#include "driverlib/sysctl.h"
+#include "driverlib/timer.h"
+#include "usblib/usblib.h"
+#include "usblib/device/usbdevice.h"
+#include "drivers/buttons.h"
+#include "drivers/cycles.h"
+#include "utils/uartstdio.h"
+#include "clockgov.h"
+#include "hal.h"
+#include "latency.h"
+#include "suspend.h"
+
+// PIOSC, the poll timer's clock.
+#define SUSPEND_TIMER_CLOCK     16000000
+
+tSuspendStats g_sSuspendStats;
+
+// Set from the interrupt handlers, cleared by SuspendSleep().
+static volatile bool g_bSuspendButton;
+static volatile bool g_bSuspendPoll;
+
+// A remote wakeup has been signalled and the host has not resumed yet.
+static bool g_bSuspendWakePending;
+
+// ADC sample taken at suspend, later samples are compared with it.
+static uint32_t g_pui32SuspendADC[3];
+
+// Wake to first report measurement.  Microseconds so far, plus a cycle
+// count and the clock it is running at for the current leg.
+static bool g_bSuspendTiming;
+static uint32_t g_ui32SuspendWakeUs;
+static uint32_t g_ui32SuspendLegStart;
+static uint32_t g_ui32SuspendLegClock;
+
+// Start a timing leg at the current clock.
+static void SuspendLegStart(void)
+{
+    g_ui32SuspendLegStart = CyclesGet();
+    g_ui32SuspendLegClock = SysCtlClockGet() / 1000000;
+}
+
+// Add the current leg to the total.
+static void SuspendLegEnd(void)
+{
+    g_ui32SuspendWakeUs += CyclesSince(g_ui32SuspendLegStart) /
+                           g_ui32SuspendLegClock;
+}
+
+// Take one conversion of all three channels and wait for it.
+static void SuspendADCSample(uint32_t *pui32Data)
+{
+    HALADCClear(ADC0_BASE, 0);
+    HALADCTrigger(ADC0_BASE, 0);
+
+    while(!HALADCDone(ADC0_BASE, 0))
+    {
+    }
+
+    HALADCClear(ADC0_BASE, 0);
+    HALADCRead(ADC0_BASE, 0, pui32Data);
+}
+
+// Sample the sticks, true if any channel moved far enough to wake for.
+static bool SuspendADCMoved(void)
+{
+    uint32_t pui32Data[3], ui32Chan;
+    int32_t i32Delta;
+
+    MAP_SysCtlPeripheralEnable(SYSCTL_PERIPH_ADC0);
+    while(!MAP_SysCtlPeripheralReady(SYSCTL_PERIPH_ADC0))
+    {
+    }
+
+    SuspendADCSample(pui32Data);
+    MAP_SysCtlPeripheralDisable(SYSCTL_PERIPH_ADC0);
+
+    g_sSuspendStats.ui32Polls++;
+
+    for(ui32Chan = 0; ui32Chan < 3; ui32Chan++)
+    {
+        i32Delta = (int32_t)pui32Data[ui32Chan] -
+                   (int32_t)g_pui32SuspendADC[ui32Chan];
+
+        if((i32Delta > SUSPEND_ADC_THRESHOLD) ||
+           (i32Delta < -SUSPEND_ADC_THRESHOLD))
+        {
+            return(true);
+        }
+    }
+
+    return(false);
+}
+
+// Set up the deep sleep clocks and the wake sources, all left disabled until
+// the bus is suspended.
+void SuspendInit(void)
+{
+    // Deep sleep runs from the 30kHz oscillator.  PIOSC stays up for the poll
+    // timer, the main oscillator for a quick PLL relock on wake.
+    MAP_SysCtlPeripheralClockGating(true);
+    SysCtlDeepSleepClockSet(SYSCTL_DSLP_DIV_1 | SYSCTL_DSLP_OSC_INT30);
+    SysCtlDeepSleepPowerSet(SYSCTL_FLASH_LOW_POWER | SYSCTL_SRAM_LOW_POWER);
+
+    // Only the wake sources are clocked in deep sleep.
+    MAP_SysCtlPeripheralDeepSleepEnable(BUTTON1_GPIO_PERIPH);
+    MAP_SysCtlPeripheralDeepSleepEnable(BUTTON3_GPIO_PERIPH);
+    MAP_SysCtlPeripheralDeepSleepEnable(BUTTON4_GPIO_PERIPH);
+    MAP_SysCtlPeripheralDeepSleepEnable(JOYSTICK_SW_PERIPH);
+    MAP_SysCtlPeripheralDeepSleepEnable(SYSCTL_PERIPH_USB0);
+    MAP_SysCtlPeripheralDeepSleepEnable(SYSCTL_PERIPH_TIMER2);
+
+    // Any button edge wakes.
+    MAP_GPIOIntTypeSet(BUTTON1_GPIO_BASE, PORTF_BUTTONS, GPIO_BOTH_EDGES);
+    MAP_GPIOIntTypeSet(BUTTON3_GPIO_BASE, BUTTON3_PIN, GPIO_BOTH_EDGES);
+    MAP_GPIOIntTypeSet(BUTTON4_GPIO_BASE, BUTTON4_PIN, GPIO_BOTH_EDGES);
+    MAP_GPIOIntTypeSet(JOYSTICK_SW_GPIO_BASE, JOYSTICK_SW_PIN, GPIO_BOTH_EDGES);
+
+    // Stick poll timer, clocked by BoardInit().
+    TimerClockSourceSet(TIMER2_BASE, TIMER_CLOCK_PIOSC);
+    MAP_TimerConfigure(TIMER2_BASE, TIMER_CFG_PERIODIC);
+    MAP_TimerLoadSet(TIMER2_BASE, TIMER_A,
+                     (SUSPEND_TIMER_CLOCK / 1000) * SUSPEND_POLL_MS);
+    MAP_TimerIntEnable(TIMER2_BASE, TIMER_TIMA_TIMEOUT);
+}
+
+// The bus has just been suspended.  Take the reference stick sample, drop
+// the clock and arm the wake sources.
+void SuspendEnter(void)
+{
+    g_sSuspendStats.ui32Suspends++;
+    g_bSuspendButton = false;
+    g_bSuspendPoll = false;
+
+    SuspendADCSample(g_pui32SuspendADC);
+
+    // let the console drain while the UART still has a clock
+    UARTFlushTx(false);
+
+    // nothing else touches the ADC until SuspendExit()
+    MAP_SysCtlPeripheralDisable(SYSCTL_PERIPH_ADC0);
+
+    ClockGovIdle();
+
+    MAP_GPIOIntClear(BUTTON1_GPIO_BASE, PORTF_BUTTONS);
+    MAP_GPIOIntClear(BUTTON3_GPIO_BASE, BUTTON3_PIN);
+    MAP_GPIOIntClear(BUTTON4_GPIO_BASE, BUTTON4_PIN);
+    MAP_GPIOIntClear(JOYSTICK_SW_GPIO_BASE, JOYSTICK_SW_PIN);
+    MAP_GPIOIntEnable(BUTTON1_GPIO_BASE, PORTF_BUTTONS);
+    MAP_GPIOIntEnable(BUTTON3_GPIO_BASE, BUTTON3_PIN);
+    MAP_GPIOIntEnable(BUTTON4_GPIO_BASE, BUTTON4_PIN);
+    MAP_GPIOIntEnable(JOYSTICK_SW_GPIO_BASE, JOYSTICK_SW_PIN);
+    MAP_IntEnable(INT_GPIOA);
+    MAP_IntEnable(INT_GPIOB);
+    MAP_IntEnable(INT_GPIOC);
+    MAP_IntEnable(INT_GPIOF);
+
+    MAP_TimerEnable(TIMER2_BASE, TIMER_A);
+    MAP_IntEnable(INT_TIMER2A);
+}
+
+// Deep sleep until something happens.  Returns true if there was input to
+// wake the host for, false for anything else, such as a USB interrupt or a
+// poll that found the sticks where they were.
+bool SuspendSleep(void)
+{
+    bool bButton, bPoll;
+
+    // Check and sleep with interrupts masked, so an edge that lands between
+    // the check and the sleep still wakes the core.  WFI returns on a
+    // pending interrupt even while masked.
+    IntMasterDisable();
+
+    if(!g_bSuspendButton && !g_bSuspendPoll)
+    {
+        SysCtlDeepSleep();
+    }
+
+    IntMasterEnable();
+
+    bButton = g_bSuspendButton;
+    bPoll = g_bSuspendPoll;
+    g_bSuspendButton = false;
+    g_bSuspendPoll = false;
+
+    if(bButton || (bPoll && SuspendADCMoved()))
+    {
+        if(!g_bSuspendTiming)
+        {
+            g_bSuspendTiming = true;
+            g_ui32SuspendWakeUs = 0;
+            SuspendLegStart();
+        }
+
+        return(true);
+    }
+
+    return(false);
+}
+
+// Leave low power mode.  If bRemoteWake is set the bus is still suspended
+// and there was input, so ask the host to resume.
+void SuspendExit(bool bRemoteWake)
+{
+    MAP_IntDisable(INT_TIMER2A);
+    MAP_TimerDisable(TIMER2_BASE, TIMER_A);
+
+    MAP_IntDisable(INT_GPIOA);
+    MAP_IntDisable(INT_GPIOB);
+    MAP_IntDisable(INT_GPIOC);
+    MAP_IntDisable(INT_GPIOF);
+    MAP_GPIOIntDisable(BUTTON1_GPIO_BASE, PORTF_BUTTONS);
+    MAP_GPIOIntDisable(BUTTON3_GPIO_BASE, BUTTON3_PIN);
+    MAP_GPIOIntDisable(BUTTON4_GPIO_BASE, BUTTON4_PIN);
+    MAP_GPIOIntDisable(JOYSTICK_SW_GPIO_BASE, JOYSTICK_SW_PIN);
+
+    // full speed for the report that is about to go out
+    if(g_bSuspendTiming)
+    {
+        SuspendLegEnd();
+    }
+
+    ClockGovActivity();
+
+    if(g_bSuspendTiming)
+    {
+        SuspendLegStart();
+    }
+
+    // the main loop expects a conversion in flight
+    MAP_SysCtlPeripheralEnable(SYSCTL_PERIPH_ADC0);
+    while(!MAP_SysCtlPeripheralReady(SYSCTL_PERIPH_ADC0))
+    {
+    }
+    HALADCClear(ADC0_BASE, 0);
+    HALADCTrigger(ADC0_BASE, 0);
+    LatencyStamp(LATENCY_POINT_ADCTRIG);
+
+    if(!bRemoteWake)
+    {
+        return;
+    }
+
+    // Only allowed if the host enabled remote wakeup with SET_FEATURE.  If
+    // it did not, the main loop goes back to sleep.
+    if(USBDCDRemoteWakeupRequest(0))
+    {
+        g_bSuspendWakePending = true;
+        g_sSuspendStats.ui32RemoteWakes++;
+    }
+    else
+    {
+        g_bSuspendTiming = false;
+        g_sSuspendStats.ui32WakeRefused++;
+    }
+}
+
+// True while waiting for the host to resume after a remote wakeup, the main
+// loop must not go back to sleep meanwhile.
+bool SuspendWakePending(void)
+{
+    return(g_bSuspendWakePending);
+}
+
+// The bus was resumed, or reset, by the host.
+void SuspendResumed(void)
+{
+    g_bSuspendWakePending = false;
+}
+
+// A report went out.  Closes the wake to first report measurement if one is
+// running.
+void SuspendReportSent(void)
+{
+    if(!g_bSuspendTiming)
+    {
+        return;
+    }
+
+    SuspendLegEnd();
+    g_bSuspendTiming = false;
+
+    g_sSuspendStats.ui32LastWakeUs = g_ui32SuspendWakeUs;
+    if(g_ui32SuspendWakeUs > g_sSuspendStats.ui32MaxWakeUs)
+    {
+        g_sSuspendStats.ui32MaxWakeUs = g_ui32SuspendWakeUs;
+    }
+}
+
+// Dump the suspend statistics to the UART console.
+void SuspendPrint(void)
+{
+    UARTprintf("\nsuspends %u polls %u wakes %u refused %u\n",
+               g_sSuspendStats.ui32Suspends, g_sSuspendStats.ui32Polls,
+               g_sSuspendStats.ui32RemoteWakes,
+               g_sSuspendStats.ui32WakeRefused);
+    UARTprintf("wake to report %uus (max %uus)\n",
+               g_sSuspendStats.ui32LastWakeUs, g_sSuspendStats.ui32MaxWakeUs);
+}
+
+// Button edge while suspended, shared by all the button ports.
+void SuspendGPIOIntHandler(void)
+{
+    MAP_GPIOIntClear(BUTTON1_GPIO_BASE, PORTF_BUTTONS);
+    MAP_GPIOIntClear(BUTTON3_GPIO_BASE, BUTTON3_PIN);
+    MAP_GPIOIntClear(BUTTON4_GPIO_BASE, BUTTON4_PIN);
+    MAP_GPIOIntClear(JOYSTICK_SW_GPIO_BASE, JOYSTICK_SW_PIN);
+
+    g_bSuspendButton = true;
+}
+
+// Time to sample the sticks.
+void SuspendTimerIntHandler(void)
+{
+    MAP_TimerIntClear(TIMER2_BASE, TIMER_TIMA_TIMEOUT);
+
+    g_bSuspendPoll = true;
+}
@@ -0,0 +1,51 @@
+//*****************************************************************************
+//
+// suspend.h - USB suspend low power mode and remote wakeup.
+//
+// Copyright (c) Aditya Challamarad.  All rights reserved.
+//
+//*****************************************************************************
+
+#ifndef _SUSPEND_H_
+#define _SUSPEND_H_
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+// How often the sticks are sampled while suspended, buttons wake at once.
+#define SUSPEND_POLL_MS         50
+
+// ADC counts an axis has to move from where it was at suspend to wake the
+// host.  Well above the noise, about two report counts.
+#define SUSPEND_ADC_THRESHOLD   48
+
+typedef struct
+{
+    uint32_t ui32Suspends;      // times the bus was suspended
+    uint32_t ui32Polls;         // stick samples taken while suspended
+    uint32_t ui32RemoteWakes;   // remote wakeups signalled to the host
+    uint32_t ui32WakeRefused;   // input seen but the host disallowed wakeup
+    uint32_t ui32LastWakeUs;    // input to first report after the last wake
+    uint32_t ui32MaxWakeUs;     // longest input to first report
+} tSuspendStats;
+
+extern tSuspendStats g_sSuspendStats;
+
+extern void SuspendInit(void);
+extern void SuspendEnter(void);
+extern bool SuspendSleep(void);
+extern void SuspendExit(bool bRemoteWake);
+extern bool SuspendWakePending(void);
+extern void SuspendResumed(void);
+extern void SuspendReportSent(void);
+extern void SuspendPrint(void);
+extern void SuspendGPIOIntHandler(void);
+extern void SuspendTimerIntHandler(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
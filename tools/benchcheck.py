@@ -0,0 +1,150 @@
+#!/usr/bin/env python3
+#
+# benchcheck.py - Regression check for the hot path micro-benchmarks.
+#
+# Copyright (c) Aditya Challamarad.  All rights reserved.
+#
+# Reads one set of benchmark results and compares it with a saved baseline,
+# exiting non-zero when a kernel got slower by more than the tolerance.
+# The results are either the JSON gamepad_bench -j writes on the host, in
+# nanoseconds per input, or a capture of the target's UART after pressing
+# 'k' on the console, in cycles per input.  Lines of a capture that are not
+# benchmark results are ignored, so a whole terminal log will do.
+#
+# Host results are only compared with a baseline from the same machine and
+# compiler; anything else is reported and skipped.  Target cycle counts do
+# not depend on the PC and are compared as they are.  They do depend on the
+# clock profile, so keep one baseline per profile.
+#
+# Only the Python standard library is used so it runs wherever CCS does.
+#
+# usage:
+#   benchcheck.py bench.json --baseline bench_host.json
+#   benchcheck.py uart.log --baseline bench_target.json
+#   benchcheck.py uart.log --save-baseline bench_target.json
+#
+
+import argparse
+import json
+import re
+import sys
+
+# "bench <kernel> <cycles per input>" from BenchPrint() in bench.c
+TARGET_LINE = re.compile(r'^bench (\S+) (\d+\.\d+)\s*$')
+
+
+def load_results(path):
+    """Results as a dict with kind, machine, compiler and kernels."""
+    with open(path) as f:
+        text = f.read()
+
+    if text.lstrip().startswith('{'):
+        data = json.loads(text)
+        kernels = {}
+        for name, value in data['kernels'].items():
+            kernels[name] = value['ns_per_sample'] if isinstance(value, dict) \
+                else value
+        return {'kind': data.get('kind', 'host'),
+                'machine': data.get('machine', ''),
+                'compiler': data.get('compiler', ''),
+                'kernels': kernels}
+
+    kernels = {}
+    for line in text.splitlines():
+        match = TARGET_LINE.match(line.strip())
+        if match:
+            # a later run in the same capture replaces an earlier one
+            kernels[match.group(1)] = float(match.group(2))
+    return {'kind': 'target', 'machine': 'TM4C123GH6PM', 'compiler': '',
+            'kernels': kernels}
+
+
+def compare(res, base, tolerance, slack):
+    unit = 'ns' if res['kind'] == 'host' else 'cycles'
+    failures = []
+
+    print('%-20s %12s %12s %8s' % ('kernel', 'baseline', 'now', 'change'))
+    for name in sorted(set(res['kernels']) | set(base['kernels'])):
+        now = res['kernels'].get(name)
+        was = base['kernels'].get(name)
+        if now is None or was is None:
+            print('%-20s %12s %12s %8s' % (name,
+                  '-' if was is None else '%.2f' % was,
+                  '-' if now is None else '%.2f' % now,
+                  'new' if was is None else 'gone'))
+            continue
+
+        change = ((now - was) * 100.0 / was) if was else 0.0
+        print('%-20s %12.2f %12.2f %+7.1f%%' % (name, was, now, change))
+        if now > (was * (1.0 + tolerance / 100.0)) + slack:
+            failures.append('%s %.2f %s per input, was %.2f (%+.1f%%)'
+                            % (name, now, unit, was, change))
+
+    return failures
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description='Micro-benchmark regression check.')
+    parser.add_argument('results',
+                        help='gamepad_bench -j output or a target UART log')
+    parser.add_argument('--baseline', help='JSON results to compare against')
+    parser.add_argument('--save-baseline', metavar='FILE',
+                        help='write these results as a new baseline')
+    parser.add_argument('--tolerance', type=float,
+                        help='percent slower allowed (host 20, target 5)')
+    parser.add_argument('--slack', type=float,
+                        help='ns or cycles per input allowed on top, for the '
+                        'kernels too short for a percentage (host 0.5, '
+                        'target 0.25)')
+    args = parser.parse_args()
+
+    res = load_results(args.results)
+    if not res['kernels']:
+        print('no benchmark results in %s' % args.results)
+        return 1
+
+    host = res['kind'] == 'host'
+    tolerance = args.tolerance if args.tolerance is not None else \
+        (20.0 if host else 5.0)
+    slack = args.slack if args.slack is not None else (0.5 if host else 0.25)
+
+    failures = []
+    base = None
+    if args.baseline:
+        try:
+            base = load_results(args.baseline)
+        except IOError:
+            print('no baseline at %s, skipping comparison' % args.baseline)
+
+    if base is not None:
+        if base['kind'] != res['kind']:
+            print('baseline is %s results, these are %s, skipping comparison'
+                  % (base['kind'], res['kind']))
+        elif host and (base['machine'] != res['machine'] or
+                       base['compiler'] != res['compiler']):
+            print('baseline is from %s, %s; this is %s, %s; skipping '
+                  'comparison' % (base['machine'], base['compiler'],
+                                  res['machine'], res['compiler']))
+        else:
+            failures = compare(res, base, tolerance, slack)
+
+    if args.save_baseline:
+        with open(args.save_baseline, 'w') as f:
+            json.dump(res, f, indent=1, sort_keys=True)
+            f.write('\n')
+        print('baseline written to %s' % args.save_baseline)
+
+    if failures:
+        print('\nBENCHMARK REGRESSION (over %.0f%% + %.2f)' % (tolerance, slack))
+        for failure in failures:
+            print('  ' + failure)
+        return 1
+
+    if base is not None:
+        print('\nbenchmarks ok')
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,303 @@
+#!/usr/bin/env python3
+#
+# linkinfo.py - Flash/SRAM footprint report and size gate for the gamepad.
+#
+# Copyright (c) Aditya Challamarad.  All rights reserved.
+#
+# Reads the XML link information the TI linker writes with --xml_link_info
+# (Debug/usb_dev_gamepad_linkInfo.xml) and reports memory use per memory
+# area, output section, object file and function.  With --budget it checks
+# the totals against the limits in a JSON budget file and exits non-zero
+# when one is exceeded, so the CCS post-build step fails the build.  With
+# --baseline it prints what changed against a previously saved report.
+#
+# Only the Python standard library is used so it runs wherever CCS does.
+#
+# usage:
+#   linkinfo.py usb_dev_gamepad_linkInfo.xml
+#   linkinfo.py usb_dev_gamepad_linkInfo.xml --budget size_budget.json
+#   linkinfo.py usb_dev_gamepad_linkInfo.xml --baseline size_baseline.json
+#   linkinfo.py usb_dev_gamepad_linkInfo.xml --save-baseline size_baseline.json
+#
+
+import argparse
+import json
+import sys
+import xml.etree.ElementTree as ET
+
+# Output sections rolled up into each budget category.  Anything placed in
+# a memory area but not listed here still counts towards the area total.
+CATEGORIES = {
+    'text': ['.intvecs', '.text', '.TI.ramfunc', '.binit'],
+    'const': ['.const', '.cinit', '.pinit', '.init_array'],
+    'data': ['.data', '.vtable'],
+    'bss': ['.bss', '.TI.noinit', '.TI.persistent', '.sysmem'],
+    'stack': ['.stack'],
+}
+
+
+def hexint(text):
+    return int(text, 0) if text else 0
+
+
+def section_category(section):
+    for cat, sections in CATEGORIES.items():
+        if section in sections:
+            return cat
+    return 'other'
+
+
+class LinkInfo(object):
+    """Memory map pulled out of one linkInfo XML file."""
+
+    def __init__(self, path):
+        root = ET.parse(path).getroot()
+
+        # input file id -> display name, archive members as lib(member)
+        self.files = {}
+        for node in root.iter('input_file'):
+            name = node.findtext('name') or node.findtext('file') or '?'
+            if node.findtext('kind') == 'archive':
+                name = '%s(%s)' % (node.findtext('file'), name)
+            self.files[node.get('id')] = name
+
+        # object component id -> (name, run address, size, input file)
+        self.components = {}
+        for node in root.iter('object_component'):
+            ref = node.find('input_file_ref')
+            self.components[node.get('id')] = (
+                node.findtext('name') or '',
+                hexint(node.findtext('run_address')),
+                hexint(node.findtext('size')),
+                self.files.get(ref.get('idref')) if ref is not None else '?')
+
+        # logical group id -> (name, size, [component ids], [group ids])
+        self.groups = {}
+        for tag in ('logical_group', 'load_segment'):
+            for node in root.iter(tag):
+                contents = node.find('contents')
+                comps, subs = [], []
+                if contents is not None:
+                    comps = [r.get('idref') for r in
+                             contents.findall('object_component_ref')]
+                    subs = [r.get('idref') for r in
+                            contents.findall('logical_group_ref')]
+                self.groups[node.get('id')] = (
+                    node.findtext('name'), hexint(node.findtext('size')),
+                    comps, subs)
+
+        # memory area name -> (origin, length, used, [top level group ids])
+        self.areas = {}
+        for node in root.iter('memory_area'):
+            groups = [r.get('idref') for r in node.iter('logical_group_ref')]
+            self.areas[node.findtext('name')] = (
+                hexint(node.findtext('origin')),
+                hexint(node.findtext('length')),
+                hexint(node.findtext('used_space')),
+                groups)
+
+        self._place()
+
+    def _walk(self, group_id, section, area, seen):
+        if group_id in seen or group_id not in self.groups:
+            return
+        seen.add(group_id)
+        name, _, comps, subs = self.groups[group_id]
+        if section is None:
+            section = name
+        for comp in comps:
+            if comp in self.components:
+                self.placed.append((comp, section, area))
+        for sub in subs:
+            self._walk(sub, section, area, seen)
+
+    def _place(self):
+        """Work out which section and memory area every component is in."""
+        self.placed = []
+        self.sections = {}
+        seen = set()
+        for area, (_, _, _, groups) in self.areas.items():
+            for group in groups:
+                # Take output section sizes from the group rather than the
+                # components in it, the linker pads .stack to --stack_size.
+                if group in self.groups and group not in seen:
+                    name, size = self.groups[group][:2]
+                    if size:
+                        self.sections[name] = \
+                            self.sections.get(name, 0) + size
+                self._walk(group, None, area, seen)
+
+    def report(self):
+        """Summarise the map into a JSON friendly dict."""
+        out = {'areas': {}, 'sections': {}, 'categories': {},
+               'objects': {}, 'functions': {}}
+
+        for area, (origin, length, used, _) in self.areas.items():
+            out['areas'][area] = {'origin': origin, 'length': length,
+                                  'used': used}
+
+        for section, size in self.sections.items():
+            category = section_category(section)
+            out['sections'][section] = size
+            out['categories'][category] = \
+                out['categories'].get(category, 0) + size
+
+        for comp, section, area in self.placed:
+            name, addr, size, obj = self.components[comp]
+            category = section_category(section)
+            per_obj = out['objects'].setdefault(obj, {})
+            per_obj[category] = per_obj.get(category, 0) + size
+
+            # --gen_func_subsections puts every function in .text:<name>
+            if ':' in name and category == 'text':
+                func = name.split(':', 1)[1]
+                out['functions'][func] = {'size': size, 'address': addr,
+                                          'area': area, 'object': obj,
+                                          'section': section}
+        return out
+
+
+def print_report(rep, top):
+    print('Memory areas')
+    for area, info in sorted(rep['areas'].items()):
+        pct = 100.0 * info['used'] / info['length'] if info['length'] else 0
+        print('  %-8s %7d / %7d bytes (%5.1f%%)' %
+              (area, info['used'], info['length'], pct))
+
+    print('\nCategories')
+    for cat, size in sorted(rep['categories'].items()):
+        print('  %-8s %7d' % (cat, size))
+
+    print('\nOutput sections')
+    for sec, size in sorted(rep['sections'].items(), key=lambda i: -i[1]):
+        print('  %-16s %7d' % (sec, size))
+
+    print('\nObject files (text const data bss)')
+    objs = sorted(rep['objects'].items(),
+                  key=lambda i: -sum(i[1].values()))
+    for obj, cats in objs[:top]:
+        print('  %-40s %6d %6d %6d %6d' %
+              (obj[:40], cats.get('text', 0), cats.get('const', 0),
+               cats.get('data', 0), cats.get('bss', 0)))
+
+    print('\nLargest functions')
+    funcs = sorted(rep['functions'].items(), key=lambda i: -i[1]['size'])
+    for func, info in funcs[:top]:
+        print('  %-36s %6d  0x%08x %-6s %s' %
+              (func[:36], info['size'], info['address'], info['area'],
+               info['object']))
+
+
+def print_hot(rep, hot, require_sram):
+    """Show where the hot path functions ended up.  Returns failures."""
+    failures = []
+    print('\nHot path placement')
+    for func in hot:
+        info = rep['functions'].get(func)
+        if info is None:
+            print('  %-36s not linked' % func)
+            continue
+        print('  %-36s %6d  0x%08x %s' %
+              (func, info['size'], info['address'], info['area']))
+        if require_sram and info['area'] != 'SRAM':
+            failures.append('%s runs from %s, expected SRAM' %
+                            (func, info['area']))
+    return failures
+
+
+def print_delta(rep, base, top):
+    print('\nChange against baseline')
+    for cat in sorted(set(rep['categories']) | set(base['categories'])):
+        now = rep['categories'].get(cat, 0)
+        was = base['categories'].get(cat, 0)
+        print('  %-8s %7d -> %7d (%+d)' % (cat, was, now, now - was))
+
+    deltas = []
+    for func in set(rep['functions']) | set(base['functions']):
+        now = rep['functions'].get(func, {}).get('size', 0)
+        was = base['functions'].get(func, {}).get('size', 0)
+        if now != was:
+            deltas.append((now - was, func, was, now))
+    deltas.sort(key=lambda d: -abs(d[0]))
+    for delta, func, was, now in deltas[:top]:
+        print('  %-36s %6d -> %6d (%+d)' % (func[:36], was, now, delta))
+
+
+def check_budget(rep, budget, base):
+    """Compare the report with the budget file.  Returns failures."""
+    failures = []
+
+    for cat, limit in budget.get('categories', {}).items():
+        size = rep['categories'].get(cat, 0)
+        if size > limit:
+            failures.append('%s is %d bytes, budget %d' % (cat, size, limit))
+
+    for area, limit in budget.get('areas', {}).items():
+        used = rep['areas'].get(area, {}).get('used', 0)
+        if used > limit:
+            failures.append('%s uses %d bytes, budget %d' %
+                            (area, used, limit))
+
+    if base is not None:
+        for cat, limit in budget.get('max_growth', {}).items():
+            grew = rep['categories'].get(cat, 0) - \
+                base['categories'].get(cat, 0)
+            if grew > limit:
+                failures.append('%s grew %d bytes since the baseline, '
+                                'limit %d' % (cat, grew, limit))
+    return failures
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description='Flash/SRAM footprint report and size gate.')
+    parser.add_argument('linkinfo', help='linker --xml_link_info output')
+    parser.add_argument('--budget', help='JSON budget file to enforce')
+    parser.add_argument('--baseline', help='JSON report to compare against')
+    parser.add_argument('--save-baseline', metavar='FILE',
+                        help='write this build\'s report as a new baseline')
+    parser.add_argument('--top', type=int, default=15,
+                        help='rows to show in the per object/function lists')
+    args = parser.parse_args()
+
+    rep = LinkInfo(args.linkinfo).report()
+    print_report(rep, args.top)
+
+    budget = {}
+    if args.budget:
+        with open(args.budget) as f:
+            budget = json.load(f)
+
+    base = None
+    if args.baseline:
+        try:
+            with open(args.baseline) as f:
+                base = json.load(f)
+        except IOError:
+            print('\nno baseline at %s, skipping comparison' % args.baseline)
+    if base is not None:
+        print_delta(rep, base, args.top)
+
+    failures = print_hot(rep, budget.get('hot', []),
+                         budget.get('hot_in_sram', False))
+    failures += check_budget(rep, budget, base)
+
+    if args.save_baseline:
+        with open(args.save_baseline, 'w') as f:
+            json.dump(rep, f, indent=1, sort_keys=True)
+            f.write('\n')
+        print('\nbaseline written to %s' % args.save_baseline)
+
+    if failures:
+        print('\nSIZE BUDGET EXCEEDED')
+        for failure in failures:
+            print('  ' + failure)
+        return 1
+
+    if args.budget:
+        print('\nsize budget ok')
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
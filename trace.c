@@ -0,0 +1,228 @@
+//*****************************************************************************
+//
+// trace.c - Timestamped input trace encoder and decoder.
+//
+// Copyright (c) Aditya Challamarad.  All rights reserved.
+//
+// Plain C with no hardware access, built into the firmware for the flash
+// recorder and into the host tools that read the recordings.  See trace.h
+// for the format.
+//
+//*****************************************************************************
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "trace.h"
+
+// Fields an axis step record can name, x, y, LT and RT.
+#define TRACE_AXES              4
+
+// Smallest and largest axis step.
+#define TRACE_STEP_MIN          -8
+#define TRACE_STEP_MAX          7
+
+static void PutU32(uint8_t *pui8Data, uint32_t ui32Value)
+{
+    pui8Data[0] = (uint8_t)ui32Value;
+    pui8Data[1] = (uint8_t)(ui32Value >> 8);
+    pui8Data[2] = (uint8_t)(ui32Value >> 16);
+    pui8Data[3] = (uint8_t)(ui32Value >> 24);
+}
+
+uint32_t TraceGetU32(const uint8_t *pui8Data)
+{
+    return((uint32_t)pui8Data[0] | ((uint32_t)pui8Data[1] << 8) |
+           ((uint32_t)pui8Data[2] << 16) | ((uint32_t)pui8Data[3] << 24));
+}
+
+// Start a trace, the first record carries the whole report.
+void TraceStart(tTraceState *psState)
+{
+    uint32_t ui32Idx;
+
+    psState->ui64TimeUs = 0;
+    psState->bStart = true;
+
+    for(ui32Idx = 0; ui32Idx < TRACE_REPORT_SIZE; ui32Idx++)
+    {
+        psState->pui8Report[ui32Idx] = 0;
+    }
+}
+
+// Encode pui8Report, sent at ui64TimeUs, into pui8Out, which has room for
+// TRACE_RECORD_MAX bytes.  Returns the record length, 0 if the report has
+// not changed.  The time must not go backwards.
+uint32_t TraceEncode(tTraceState *psState, uint64_t ui64TimeUs,
+                     const uint8_t *pui8Report, uint8_t *pui8Out)
+{
+    uint32_t ui32Idx, ui32Changed = 0, ui32Len = 1, ui32Field = 0;
+    uint64_t ui64Delta;
+    int32_t i32Step;
+
+    for(ui32Idx = 0; ui32Idx < TRACE_REPORT_SIZE; ui32Idx++)
+    {
+        if(psState->bStart ||
+           (pui8Report[ui32Idx] != psState->pui8Report[ui32Idx]))
+        {
+            ui32Changed |= 1 << ui32Idx;
+            ui32Field = ui32Idx;
+        }
+    }
+
+    if(!ui32Changed)
+    {
+        return(0);
+    }
+
+    i32Step = (int8_t)(pui8Report[ui32Field] - psState->pui8Report[ui32Field]);
+
+    if((ui32Changed & (ui32Changed - 1)) == 0)
+    {
+        // one field, use a short form if it fits
+        if((ui32Field == TRACE_FIELD_BUTTONS) &&
+           (pui8Report[ui32Field] <= TRACE_TAG_FULL_MASK))
+        {
+            pui8Out[0] = TRACE_TAG_BUTTONS | pui8Report[ui32Field];
+            ui32Changed = 0;
+        }
+        else if((ui32Field < TRACE_AXES) && (i32Step >= TRACE_STEP_MIN) &&
+                (i32Step <= TRACE_STEP_MAX))
+        {
+            pui8Out[0] = (uint8_t)(TRACE_TAG_AXIS | (ui32Field << 4) |
+                                   (i32Step & 0x0f));
+            ui32Changed = 0;
+        }
+    }
+
+    if(ui32Changed)
+    {
+        pui8Out[0] = (uint8_t)(TRACE_TAG_FULL | ui32Changed);
+    }
+
+    // time since the last record
+    ui64Delta = ui64TimeUs - psState->ui64TimeUs;
+
+    while(ui64Delta >= 0x80)
+    {
+        pui8Out[ui32Len++] = (uint8_t)(ui64Delta | 0x80);
+        ui64Delta >>= 7;
+    }
+
+    pui8Out[ui32Len++] = (uint8_t)ui64Delta;
+
+    for(ui32Idx = 0; ui32Idx < TRACE_REPORT_SIZE; ui32Idx++)
+    {
+        if(ui32Changed & (1 << ui32Idx))
+        {
+            pui8Out[ui32Len++] = pui8Report[ui32Idx];
+        }
+
+        psState->pui8Report[ui32Idx] = pui8Report[ui32Idx];
+    }
+
+    psState->ui64TimeUs = ui64TimeUs;
+    psState->bStart = false;
+
+    return(ui32Len);
+}
+
+// Decode the record at pui8Data, ui32Size bytes available, into psState.
+// Returns the record length, TRACE_END at the end of the trace,
+// TRACE_TRUNCATED if the record runs past ui32Size, or TRACE_BAD.
+int32_t TraceDecode(tTraceState *psState, const uint8_t *pui8Data,
+                    uint32_t ui32Size)
+{
+    uint32_t ui32Tag, ui32Idx, ui32Len = 1, ui32Shift = 0;
+    uint64_t ui64Delta = 0;
+    uint8_t ui8Byte;
+
+    if(!ui32Size)
+    {
+        return(TRACE_TRUNCATED);
+    }
+
+    ui32Tag = pui8Data[0];
+
+    if((ui32Tag == TRACE_TAG_END) || (ui32Tag == TRACE_TAG_ERASED))
+    {
+        return(TRACE_END);
+    }
+
+    if(((ui32Tag > TRACE_TAG_FULL_MASK) && (ui32Tag < TRACE_TAG_AXIS)) ||
+       (ui32Tag > (TRACE_TAG_BUTTONS | TRACE_TAG_FULL_MASK)))
+    {
+        return(TRACE_BAD);
+    }
+
+    do
+    {
+        if(ui32Len >= ui32Size)
+        {
+            return(TRACE_TRUNCATED);
+        }
+
+        if(ui32Shift > 63)
+        {
+            return(TRACE_BAD);
+        }
+
+        ui8Byte = pui8Data[ui32Len++];
+        ui64Delta |= (uint64_t)(ui8Byte & 0x7f) << ui32Shift;
+        ui32Shift += 7;
+    }
+    while(ui8Byte & 0x80);
+
+    if(ui32Tag < TRACE_TAG_AXIS)
+    {
+        for(ui32Idx = 0; ui32Idx < TRACE_REPORT_SIZE; ui32Idx++)
+        {
+            if(ui32Tag & (1 << ui32Idx))
+            {
+                if(ui32Len >= ui32Size)
+                {
+                    return(TRACE_TRUNCATED);
+                }
+
+                psState->pui8Report[ui32Idx] = pui8Data[ui32Len++];
+            }
+        }
+    }
+    else if(ui32Tag < TRACE_TAG_BUTTONS)
+    {
+        // sign extend the 4 bit step
+        ui32Idx = (ui32Tag >> 4) & 3;
+        psState->pui8Report[ui32Idx] +=
+            (uint8_t)(((int32_t)(ui32Tag << 28)) >> 28);
+    }
+    else
+    {
+        psState->pui8Report[TRACE_FIELD_BUTTONS] =
+            (uint8_t)(ui32Tag & TRACE_TAG_FULL_MASK);
+    }
+
+    psState->ui64TimeUs += ui64Delta;
+    psState->bStart = false;
+
+    return((int32_t)ui32Len);
+}
+
+// Fill in a header for ui32Bytes of records, TRACE_OPEN for a trace still
+// being written.
+void TraceHeader(uint8_t *pui8Header, uint32_t ui32Bytes, uint32_t ui32Records)
+{
+    PutU32(&pui8Header[0], TRACE_MAGIC);
+    pui8Header[4] = TRACE_VERSION;
+    pui8Header[5] = TRACE_REPORT_SIZE;
+    pui8Header[6] = 0xff;
+    pui8Header[7] = 0xff;
+    PutU32(&pui8Header[8], ui32Bytes);
+    PutU32(&pui8Header[12], ui32Records);
+}
+
+// True if pui8Header starts a trace this code can read.
+bool TraceHeaderValid(const uint8_t *pui8Header)
+{
+    return((TraceGetU32(pui8Header) == TRACE_MAGIC) &&
+           (pui8Header[4] == TRACE_VERSION) &&
+           (pui8Header[5] == TRACE_REPORT_SIZE));
+}
@@ -0,0 +1,101 @@
+//*****************************************************************************
+//
+// trace.h - Timestamped input trace format, shared by the firmware and the
+//           host tools.
+//
+// Copyright (c) Aditya Challamarad.  All rights reserved.
+//
+//*****************************************************************************
+
+#ifndef _TRACE_H_
+#define _TRACE_H_
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+//
+// A trace is the sequence of reports a gamepad sent, each with the time it
+// went out in microseconds.  Only changes are stored.  It is laid out for
+// NOR flash: a 16 byte header, then records packed end to end and never
+// rewritten.  Erased flash reads 0xff, which is never a valid tag, so a
+// trace cut short by a reset ends where the writes stopped.
+//
+// Header, little endian words:
+//
+//  0   TRACE_MAGIC
+//  4   version, report size, two reserved bytes left erased
+//  8   bytes of records, TRACE_OPEN until the trace is closed
+//  12  records, TRACE_OPEN until the trace is closed
+//
+// Each record is a tag byte, the time since the previous record as an
+// unsigned LEB128 varint (7 bits a byte, low bits first), then whatever
+// the tag says follows.  The first record's time is from the start of the
+// recording.  Report fields are in tGamepadReport order: x, y, LT, RT,
+// buttons.
+//
+//  0x00-0x1f   full: bit n set, field n follows as its new value
+//  0x80-0xbf   one axis moved by a small step: bits 5-4 the field (x, y,
+//              LT, RT), bits 3-0 the step, -8 to 7, added modulo 256
+//  0xc0-0xdf   buttons only: bits 4-0 the new button byte
+//  0xfe        end of trace, no time follows
+//  0xff        erased flash, also the end
+//
+// Everything else is reserved.  Stick noise and single button edges, most
+// of a real trace, take a tag and a one or two byte time each.
+//
+
+#define TRACE_MAGIC             0x43525447  // "GTRC"
+#define TRACE_VERSION           1
+#define TRACE_HEADER_SIZE       16
+
+// Header length and record count of a trace still being written.
+#define TRACE_OPEN              0xffffffff
+
+#define TRACE_REPORT_SIZE       5
+#define TRACE_FIELD_BUTTONS     4
+
+// Longest record: tag, a 64 bit varint and every field.
+#define TRACE_RECORD_MAX        (1 + 10 + TRACE_REPORT_SIZE)
+
+#define TRACE_TAG_FULL          0x00
+#define TRACE_TAG_FULL_MASK     0x1f
+#define TRACE_TAG_AXIS          0x80
+#define TRACE_TAG_BUTTONS       0xc0
+#define TRACE_TAG_END           0xfe
+#define TRACE_TAG_ERASED        0xff
+
+// TraceDecode() results other than a record length.
+#define TRACE_END               0
+#define TRACE_TRUNCATED         -1
+#define TRACE_BAD               -2
+
+//
+// Where a trace is up to: the time and report after the last record.  The
+// encoder and decoder each keep one.
+//
+typedef struct
+{
+    uint64_t ui64TimeUs;
+    uint8_t pui8Report[TRACE_REPORT_SIZE];
+
+    // No record yet, the next one carries every field.
+    bool bStart;
+} tTraceState;
+
+extern void TraceStart(tTraceState *psState);
+extern uint32_t TraceEncode(tTraceState *psState, uint64_t ui64TimeUs,
+                            const uint8_t *pui8Report, uint8_t *pui8Out);
+extern int32_t TraceDecode(tTraceState *psState, const uint8_t *pui8Data,
+                           uint32_t ui32Size);
+extern void TraceHeader(uint8_t *pui8Header, uint32_t ui32Bytes,
+                        uint32_t ui32Records);
+extern bool TraceHeaderValid(const uint8_t *pui8Header);
+extern uint32_t TraceGetU32(const uint8_t *pui8Data);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
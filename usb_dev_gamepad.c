@@ -10,6 +10,7 @@
 #include "inc/hw_memmap.h"
 #include "inc/hw_types.h"
 #include "inc/hw_gpio.h"
+#include "inc/hw_ints.h"
 #include "inc/hw_sysctl.h"
 #include "driverlib/adc.h"
 #include "driverlib/debug.h"
@@ -20,22 +21,55 @@
 #include "driverlib/rom_map.h"
 #include "driverlib/sysctl.h"
 #include "driverlib/uart.h"
+#include "driverlib/usb.h"
 #include "usblib/usblib.h"
 #include "usblib/usbhid.h"
 #include "usblib/device/usbdevice.h"
 #include "usblib/device/usbdhid.h"
 #include "usblib/device/usbdhidgamepad.h"
 #include "usb_gamepad_structs.h"
+#include "gamepad_input.h"
+#include "gamepad_feature.h"
+#include "latency.h"
+#include "isrprof.h"
+#include "stackmon.h"
+#include "hotpath.h"
+#include "clockgov.h"
+#include "suspend.h"
+#include "boot.h"
+#include "board.h"
+#include "fault.h"
+#include "hal.h"
+#include "supervisor.h"
+#include "bench.h"
+#include "recorder.h"
+#include "replay.h"
+#include "macro.h"
+#include "remap.h"
 #include "drivers/buttons.h"
+#include "drivers/rgb.h"
+#include "drivers/cycles.h"
 #include "utils/uartstdio.h"
 
 
 static tGamepadReport sReport; // The report structure that is passed to the HID gamepad driver.
 
+static tGamepadReport g_sInput; // buttons and axes as sampled, before the remap builds sReport from them
+
 
 static uint32_t g_pui32ADCData[3]; // The HID gamepad polled ADC data for the X/Y/Z coordinates. X = Joystick X, Y = Joystick Y, Z = Potentiometer
 
-static uint32_t g_ui32Updates; // An activity counter to slow the LED blink down to a visible rate.
+static uint32_t g_pui32ADCFilter[3]; // low pass filter state for each ADC channel
+
+static uint32_t g_ui32LastReportFrame; // USB frame number of the last report sent, for the report interval
+
+static bool g_bSlowClock; // clock governor has the clock down, for the status LED
+
+static tGamepadReport g_sLastInput; // input as of the last activity, for the clock governor
+
+static uint32_t g_ui32TxCheckFrame; // USB frame at the supervisor's last look at the endpoint
+
+extern void (* const g_pfnVectors[])(void); // flash vector table in startup_ccs.c
 
 
 volatile enum // holds the various states of the gamepad. volatile as it is changed in interrupt.
@@ -54,6 +88,15 @@ volatile enum // holds the various states of the gamepad. volatile as it is chan
 } g_iGamepadState;
 
 
+// Status LED. Only red is driven, green and blue share PF2/PF3 with buttons 1 and 2.
+#define LED_INTENSITY           (RGB_FULL / 4)
+#define LED_WAIT_PERIOD_MS      1000 // breathing while waiting for the host
+#define LED_SLOW_PERIOD_MS      4000 // slow breathing while the clock is down
+#define LED_HEARTBEAT_REPORTS   40   // reports per flicker
+
+static uint32_t g_pui32LEDColor[3] = { 0xFFFF, 0, 0 };
+
+
 #ifdef DEBUG
 void
 __error__(char *pcFilename, uint32_t ui32Line)
@@ -62,9 +105,45 @@ __error__(char *pcFilename, uint32_t ui32Line)
 #endif
 
 
-// This maps the values from the ADC that range from 0 to 2047 over to 127 to -128.
-#define Convert8Bit(ui32Value)  ((int8_t)((0x7ff - ui32Value) >> 4))
+// Show the connection state and clock profile on the LED. The patterns and the
+// report heartbeat run from the LED driver's timer, this only picks one, so it is
+// called on state and clock changes and never from the loop.
+static void StatusLEDUpdate(void)
+{
+    switch(g_iGamepadState)
+    {
+        case eStateNotConfigured:
+        {
+            RGBEnable();
+            RGBPatternSet(RGB_PATTERN_PULSE, LED_WAIT_PERIOD_MS);
+            break;
+        }
 
+        // the LED timers are not clocked in deep sleep
+        case eStateSuspend:
+        {
+            RGBDisable();
+            break;
+        }
+
+        default:
+        {
+            RGBEnable();
+            RGBPatternSet(g_bSlowClock ? RGB_PATTERN_PULSE : RGB_PATTERN_SOLID,
+                          LED_SLOW_PERIOD_MS);
+            break;
+        }
+    }
+}
+
+// Clock governor hook, keeps the LED animation speed and shows the clock profile.
+static void StatusLEDClock(uint32_t ui32SysClock)
+{
+    RGBClockSet(ui32SysClock);
+
+    g_bSlowClock = ui32SysClock < (HOTPATH_CLOCK_MHZ * 1000000);
+    StatusLEDUpdate();
+}
 
 
 // Handles asynchronous events from the HID gamepad driver.
@@ -83,17 +162,27 @@ __error__(char *pcFilename, uint32_t ui32Line)
 // of particular asynchronous events related to operation of the gamepad HID
 // device.
 //
-// \return Returns 0 in all cases.
+// \return Returns the size of the report for feature GET_REPORT requests, the
+// report buffer for GET_REPORT_BUFFER and 0 in all other cases.
 
-uint32_t GamepadHandler(void *pvCBData, uint32_t ui32Event, uint32_t ui32MsgData,
+HOT_FUNC uint32_t GamepadHandler(void *pvCBData, uint32_t ui32Event, uint32_t ui32MsgData,
                void *pvMsgData)
 {
+    uint32_t ui32Start = CyclesGet(); // time spent here is the ISR cost
+    uint32_t ui32Ret = 0;
+    uint32_t ui32Cycles;
+
+    (void)pvCBData;
+
     switch (ui32Event)
     {
         // host connected
         case USB_EVENT_CONNECTED:
         {
             g_iGamepadState = eStateIdle;
+            SuspendResumed();
+            BootMark(BOOT_CONFIGURED);
+            StatusLEDUpdate();
 
             UARTprintf("\nHost Connected...\n");
 
@@ -104,7 +193,8 @@ uint32_t GamepadHandler(void *pvCBData, uint32_t ui32Event, uint32_t ui32MsgData
         case USB_EVENT_DISCONNECTED:
         {
             g_iGamepadState = eStateNotConfigured;
-
+            SuspendResumed();
+            StatusLEDUpdate();
 
             UARTprintf("\nHost Disconnected...\n");
 
@@ -115,11 +205,11 @@ uint32_t GamepadHandler(void *pvCBData, uint32_t ui32Event, uint32_t ui32MsgData
 
         case USB_EVENT_TX_COMPLETE:
         {
+            LatencyCommit(); // report is on the wire, close its latency trace
+            SupervisorTxDone();
             
             g_iGamepadState = eStateIdle; // enter idle state
 
-            MAP_GPIOPinWrite(GPIO_PORTF_BASE, GPIO_PIN_1, 0);
-
             break;
         }
 
@@ -131,7 +221,7 @@ uint32_t GamepadHandler(void *pvCBData, uint32_t ui32Event, uint32_t ui32MsgData
 
             UARTprintf("\nBus Suspended\n");
 
-            MAP_GPIOPinWrite(GPIO_PORTF_BASE, GPIO_PIN_1, 0);
+            StatusLEDUpdate();
 
             break;
         }
@@ -143,6 +233,8 @@ uint32_t GamepadHandler(void *pvCBData, uint32_t ui32Event, uint32_t ui32MsgData
         {
             // Return to the idle state.
             g_iGamepadState = eStateIdle;
+            SuspendResumed(); // also ends a remote wakeup
+            StatusLEDUpdate();
 
     
             UARTprintf("\nBus Resume\n");
@@ -151,13 +243,37 @@ uint32_t GamepadHandler(void *pvCBData, uint32_t ui32Event, uint32_t ui32MsgData
         }
 
         // Return the pointer to the current report.  This call is
-        // rarely made but is required by the USB HID spec.
+        // rarely made but is required by the USB HID spec.  The high byte
+        // of ui32MsgData is the report type, feature reads get the
+        // selected configuration/statistics page.
         case USBD_HID_EVENT_GET_REPORT:
         {
+            if((ui32MsgData >> 8) == USB_HID_REPORT_FEATURE)
+            {
+                *(void **)pvMsgData = (void *)GamepadFeatureGet();
+                ui32Ret = GAMEPAD_FEATURE_SIZE;
+                break;
+            }
+
             *(void **)pvMsgData = (void *)&sReport;
             break;
         }
 
+        // The host is about to send a feature report, pvMsgData holds its
+        // length.  Hand back a buffer to receive it.
+        case USBD_HID_EVENT_GET_REPORT_BUFFER:
+        {
+            ui32Ret = (uint32_t)GamepadFeatureBuffer((uint32_t)pvMsgData);
+            break;
+        }
+
+        // A feature report from the host has arrived.
+        case USBD_HID_EVENT_SET_REPORT:
+        {
+            GamepadFeatureSet((const uint8_t *)pvMsgData, ui32MsgData);
+            break;
+        }
+
         // ignore everything else
         default:
         {
@@ -165,24 +281,166 @@ uint32_t GamepadHandler(void *pvCBData, uint32_t ui32Event, uint32_t ui32MsgData
         }
     }
 
-    return(0);
+    ui32Cycles = CyclesSince(ui32Start);
+    if(ui32Cycles > g_sGamepadStats.ui32MaxISRCycles)
+    {
+        g_sGamepadStats.ui32MaxISRCycles = ui32Cycles;
+    }
+
+    return(ui32Ret);
 }
 
-// uart config
-void ConfigureUART(void)
+// Handle single key commands from the UART console. Only reads when a key is
+// waiting so it never blocks the loop.
+static void ConsolePoll(void)
 {
-    // enable PORT A used for UART0
-    MAP_SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOA);
+    if(UARTRxBytesAvail() == 0)
+    {
+        return;
+    }
+
+    switch(UARTgetc())
+    {
+        // print the latency histograms
+        case 'l':
+        {
+            LatencyPrint();
+            break;
+        }
 
-    // enable UART0
-    MAP_SysCtlPeripheralEnable(SYSCTL_PERIPH_UART0);
+        // print the interrupt profile and CPU load
+        case 'i':
+        {
+            ISRProfPrint();
+            break;
+        }
 
-    // Configure the pin muxing for UART0 functions on port A0 and A1.
-    MAP_GPIOPinConfigure(GPIO_PA0_U0RX);
-    MAP_GPIOPinConfigure(GPIO_PA1_U0TX);
+        // print the stack high water mark and SRAM budget
+        case 's':
+        {
+            RAMBudgetPrint();
+            break;
+        }
 
-    // Select the alternate (UART) function for these pins.
-    MAP_GPIOPinTypeUART(GPIO_PORTA_BASE, GPIO_PIN_0 | GPIO_PIN_1);
+        // print the clock governor state
+        case 'g':
+        {
+            ClockGovPrint();
+            break;
+        }
+
+        // print the boot milestones
+        case 'b':
+        {
+            BootPrint();
+            break;
+        }
+
+        // print the crash record from the last fault reset
+        case 'f':
+        {
+            FaultPrint();
+            break;
+        }
+
+        // print the watchdog supervisor statistics
+        case 'w':
+        {
+            SupervisorPrint();
+            break;
+        }
+
+        // print the suspend and remote wakeup statistics
+        case 'u':
+        {
+            SuspendPrint();
+            break;
+        }
+
+        // start recording the reports to flash, or stop and close the trace
+        case 'r':
+        {
+            if(RecorderState() == RECORDER_IDLE)
+            {
+                RecorderStart(0);
+                UARTprintf("\nrecording to flash\n");
+            }
+            else
+            {
+                RecorderStop();
+            }
+            break;
+        }
+
+        // play the trace in flash once, or stop playing
+        case 'p':
+        {
+            if(ReplayState() == REPLAY_IDLE)
+            {
+                ReplayStart(false);
+            }
+            else
+            {
+                ReplayStop();
+            }
+            break;
+        }
+
+        // play the trace in flash round and round until stopped
+        case 'P':
+        {
+            if(ReplayState() == REPLAY_IDLE)
+            {
+                ReplayStart(true);
+            }
+            else
+            {
+                ReplayStop();
+            }
+            break;
+        }
+
+        // print the macro sequences, turbo rates and frame timing
+        case 'm':
+        {
+            MacroPrint();
+            break;
+        }
+
+        // print the button and axis remap layout
+        case 'M':
+        {
+            RemapPrint();
+            break;
+        }
+
+        // run the hot path micro-benchmarks
+        case 'k':
+        {
+            BenchPrint();
+            break;
+        }
+
+        // clear the latency histograms and interrupt profile
+        case 'c':
+        {
+            LatencyReset();
+            ISRProfReset();
+            UARTprintf("\nlatency and isr profile cleared\n");
+            break;
+        }
+
+        default:
+        {
+            break;
+        }
+    }
+}
+
+// uart config
+void ConfigureUART(void)
+{
+    // UART0 and its pins on A0/A1 are set up by BoardInit().
 
     // Useinternal 16MHz clock for UART.
     UARTClockSourceSet(UART0_BASE, UART_CLOCK_PIOSC);
@@ -194,22 +452,12 @@ void ConfigureUART(void)
 // Initialize the ADC inputs used by the game pad device. GamePad uses E: 1,4,5 (AIN: 2,9,8)
 void ADCInit(void)
 {
-    // enable GPIO port E for ADC inputs
-    MAP_SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOE); // enable port Potentiometer and Joystick VRx/VRy
-
-    
-    // use AHB for GPIO
-    SysCtlGPIOAHBEnable(SYSCTL_PERIPH_GPIOE); // high performance bus
-
-    MAP_SysCtlPeripheralEnable(SYSCTL_PERIPH_ADC0);
+    // Port E (on AHB), its analog pins and ADC0 are enabled by BoardInit().
     MAP_SysCtlPeripheralReset(SYSCTL_PERIPH_ADC0);
 
     // select external ref for ADC
     MAP_ADCReferenceSet(ADC0_BASE, ADC_REF_EXT_3V);
 
-    // Configure the pins which are used as analog inputs.
-    MAP_GPIOPinTypeADC(GPIO_PORTE_AHB_BASE, GPIO_PIN_5 | GPIO_PIN_4 | GPIO_PIN_1);
-
     // Configure the sequencer for 3 steps.
     MAP_ADCSequenceStepConfigure(ADC0_BASE, 0, 0, ADC_CTL_CH8);
 
@@ -222,43 +470,222 @@ void ADCInit(void)
     MAP_ADCSequenceEnable(ADC0_BASE, 0);
 }
 
+// Read a finished ADC conversion, start the next one and put the filtered
+// samples in the input. Returns true if there was a new sample.
+HOT_FUNC static bool ADCUpdate(void)
+{
+    uint8_t ui8LT, ui8RT; // trigger split
+
+    // check if ADC done converting
+    if(!HALADCDone(ADC0_BASE, 0))
+    {
+        return(false);
+    }
+
+    // clear ADC int, the time since the trigger is the age of this sample
+    HALADCClear(ADC0_BASE, 0);
+    LatencyRecord(LATENCY_STAGE_ADC, CyclesSince(g_pui32LatencyStamp[LATENCY_POINT_ADCTRIG]));
+
+    // read data and trigger new sample
+    HALADCRead(ADC0_BASE, 0, &g_pui32ADCData[0]);
+    HALADCTrigger(ADC0_BASE, 0);
+    LatencyStamp(LATENCY_POINT_ADCTRIG);
+
+    // update the input with filtered ADC data, dead zones and curves come from the live config
+    g_sInput.i8XPos = GamepadStickMap(GamepadTrim(GAMEPAD_AXIS_X,
+                         GamepadFilter(&g_pui32ADCFilter[0], g_pui32ADCData[0])));
+    g_sInput.i8YPos = GamepadStickMap(GamepadTrim(GAMEPAD_AXIS_Y,
+                         GamepadFilter(&g_pui32ADCFilter[2], g_pui32ADCData[2])));
+
+    // pot is 0 to 4095, below middle is LT and above is RT
+    GamepadTriggerMap(GamepadFilter(&g_pui32ADCFilter[1], g_pui32ADCData[1]), &ui8LT, &ui8RT);
+    g_sInput.i8LT = ui8LT;
+    g_sInput.i8RT = ui8RT;
+
+    return(true);
+}
+
+// Average a few samples of each stick at boot, when nobody should be holding
+// them, and take that as the rest position. A stick too far off center is
+// left uncalibrated.
+static void StickCalibrate(void)
+{
+    uint32_t ui32SumX = 0, ui32SumY = 0;
+    uint32_t ui32Sample;
+
+    for(ui32Sample = 0; ui32Sample < GAMEPAD_CAL_SAMPLES; ui32Sample++)
+    {
+        HALADCClear(ADC0_BASE, 0);
+        HALADCTrigger(ADC0_BASE, 0);
+
+        while(!HALADCDone(ADC0_BASE, 0))
+        {
+        }
+
+        HALADCRead(ADC0_BASE, 0, &g_pui32ADCData[0]);
+        ui32SumX += g_pui32ADCData[0];
+        ui32SumY += g_pui32ADCData[2];
+    }
+
+    HALADCClear(ADC0_BASE, 0);
+
+    GamepadCalibrate(GAMEPAD_AXIS_X, ui32SumX / GAMEPAD_CAL_SAMPLES);
+    GamepadCalibrate(GAMEPAD_AXIS_Y, ui32SumY / GAMEPAD_CAL_SAMPLES);
+}
+
+// Tells the supervisor whether the report endpoint is stuck: a report is waiting for
+// TX complete, the bus is running, and the packet is no longer in EP1's FIFO or the
+// endpoint stalled. A host that has stopped polling, which Linux does while nothing
+// has the device open, leaves the packet waiting in the FIFO and is not stuck.
+// Called from the watchdog interrupt once a period.
+static bool TxStuck(void)
+{
+    uint32_t ui32Frame, ui32Status;
+    bool bRunning;
+
+    ui32Frame = HALUSBFrame(USB0_BASE);
+    bRunning = (ui32Frame != g_ui32TxCheckFrame);
+    g_ui32TxCheckFrame = ui32Frame;
+
+    if((g_iGamepadState != eStateSending) || !bRunning)
+    {
+        return(false);
+    }
+
+    ui32Status = MAP_USBEndpointStatus(USB0_BASE, USB_EP_1);
+
+    return(!(ui32Status & USB_DEV_TX_TXPKTRDY) ||
+           (ui32Status & USB_DEV_TX_SENT_STALL));
+}
+
+// Restart the USB stack after the supervisor found the endpoint stuck. The
+// host sees the device go away and enumerates it again.
+static void USBRestart(void)
+{
+    UARTprintf("\nUSB stuck, restarting\n");
+
+    USBDHIDGamepadTerm(&g_sGamepadDevice);
+    g_iGamepadState = eStateNotConfigured;
+    StatusLEDUpdate();
+
+    USBDHIDGamepadInit(0, &g_sGamepadDevice);
+}
+
+// Returns true if a button changed or an axis moved past the noise threshold
+// since the last time this returned true.
+static bool InputActive(void)
+{
+    int32_t i32Delta;
+
+    if(sReport.ui8Buttons != g_sLastInput.ui8Buttons)
+    {
+        g_sLastInput = sReport;
+        return(true);
+    }
+
+    i32Delta = (int32_t)sReport.i8XPos - g_sLastInput.i8XPos;
+    if((i32Delta > CLOCKGOV_AXIS_THRESHOLD) || (i32Delta < -CLOCKGOV_AXIS_THRESHOLD))
+    {
+        g_sLastInput = sReport;
+        return(true);
+    }
+
+    i32Delta = (int32_t)sReport.i8YPos - g_sLastInput.i8YPos;
+    if((i32Delta > CLOCKGOV_AXIS_THRESHOLD) || (i32Delta < -CLOCKGOV_AXIS_THRESHOLD))
+    {
+        g_sLastInput = sReport;
+        return(true);
+    }
+
+    // triggers are 0 to 255 in the report and never both pressed, LT - RT is one axis
+    i32Delta = (int32_t)(uint8_t)sReport.i8LT - (uint8_t)g_sLastInput.i8LT;
+    i32Delta -= (int32_t)(uint8_t)sReport.i8RT - (uint8_t)g_sLastInput.i8RT;
+    if((i32Delta > CLOCKGOV_AXIS_THRESHOLD) || (i32Delta < -CLOCKGOV_AXIS_THRESHOLD))
+    {
+        g_sLastInput = sReport;
+        return(true);
+    }
+
+    return(false);
+}
+
 
 int main(void) // this runs the main code
 {
-    uint8_t ui8ButtonsChanged, ui8Buttons; // button state variables
+    uint8_t ui8Buttons; // button state variable
+    uint8_t ui8MacroButtons = 0; // remapped buttons the macros last saw
+    uint32_t ui32LoopStart, ui32Cycles, ui32Frame;
     bool bUpdate;
 
-    // Set the clocking to run from the PLL at 50MHz
-    MAP_SysCtlClockSet(SYSCTL_SYSDIV_4 | SYSCTL_USE_PLL | SYSCTL_OSC_MAIN |
+    // Set the clocking to run from the PLL at 50MHz, 80MHz in the performance profile
+    MAP_SysCtlClockSet(HOTPATH_SYSDIV | SYSCTL_USE_PLL | SYSCTL_OSC_MAIN |
                        SYSCTL_XTAL_16MHZ);
 
-    // Enable the GPIO port that is used for the on-board LED.
-    MAP_SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOF);
+    // Keep the crash record only if this boot follows a fault reset.
+    FaultInit();
 
-    // Enable the GPIO pin for the RED LED (PF1).
-    MAP_GPIOPinTypeGPIOOutput(GPIO_PORTF_BASE, GPIO_PIN_1);
+    // Start the cycle counter used for the loop/ISR statistics, latency traces
+    // and boot milestones.
+    CyclesInit();
+    BootInit();
+    LatencyReset();
+    ISRProfReset();
 
-    // UART0 config
-    ConfigureUART();
+    // Arm the MPU guard at the bottom of the stack.
+    StackMonInit();
 
-    UARTprintf("\033[2JGAMEPAD\n"); // clear screen then print
-    UARTprintf("---------------------------------\n\n");
+    // Full speed until the controller has been left alone for a while.
+    ClockGovInit(HOTPATH_SYSDIV);
+
+    // Clock every port and peripheral in the board resource table once and
+    // set up all the pins.
+    BoardInit();
+
+    // Everything the USB event handler touches has to be ready before USB
+    // starts: the state, the report, the LED and the UART.
 
     // Not configured initially
     g_iGamepadState = eStateNotConfigured;
 
-    // Enable the GPIO peripheral used for USB, and configure the USB
-    MAP_SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOD);
-    SysCtlGPIOAHBEnable(SYSCTL_PERIPH_GPIOD);
-    MAP_GPIOPinTypeUSBAnalog(GPIO_PORTD_AHB_BASE, GPIO_PIN_4 | GPIO_PIN_5);
+    // Zero out the initial report
+    sReport.ui8Buttons = 0;
+    sReport.i8XPos = 0;
+    sReport.i8YPos = 0;
+    sReport.i8LT = 0;
+    sReport.i8RT = 0;
 
-    // init function for buttons
-    ButtonsInit();
+    // Red LED (PF1) on Timer 0B PWM, animated from Wide Timer 5B. The report
+    // heartbeat reads the sent counter, so sending costs nothing extra.
+    RGBInit(RGB_RED_EN, SysCtlClockGet());
+    RGBSet(g_pui32LEDColor, LED_INTENSITY);
+    RGBHeartbeatSet(&g_sGamepadStats.ui32ReportsSent, LED_HEARTBEAT_REPORTS);
 
-    // Initialize the ADC channels.
-    ADCInit();
+    if(!ClockGovHookRegister(StatusLEDClock))
+    {
+        FaultReset(FAULT_TYPE_SETUP);
+    }
+
+    StatusLEDUpdate();
+
+    // UART0 config. Output is buffered and sent from the UART interrupt, so
+    // printing only costs a copy into the buffer.
+    ConfigureUART();
+
+    UARTprintf("\033[2JGAMEPAD\n"); // clear screen then print
+    UARTprintf("---------------------------------\n");
+
+#ifdef PERF_PROFILE
+    // Move the vector table to SRAM. IntRegister copies the flash table into
+    // .vtable and points VTOR at the copy, registering the flash entry again
+    // keeps the USB0 handler (or its profiling wrapper) unchanged.
+    IntRegister(INT_USB0, g_pfnVectors[INT_USB0]);
+#endif
+
+    // Start USB first. Enumeration is interrupt driven and the host spends
+    // tens of milliseconds on reset and descriptor requests, so the rest of
+    // bring-up runs in its shadow.
 
-    UARTprintf("Configuring USB\n");
+    // The USB pins on D4/D5 were set up by BoardInit().
 
     // Set the USB stack mode to Device mode.
     USBStackModeSet(0, eUSBModeForceDevice, 0);
@@ -266,111 +693,210 @@ int main(void) // this runs the main code
     // Initialize the HID gamepad device.
     USBDHIDGamepadInit(0, &g_sGamepadDevice);
 
-    // Zero out the initial report
-    sReport.ui8Buttons = 0;
-    sReport.i8XPos = 0;
-    sReport.i8YPos = 0;
-    sReport.i8LT = 0;
-    sReport.i8RT = 0;
+    IntMasterEnable(); // enable interrupts
+    BootMark(BOOT_USB_INIT);
+
+    // init function for buttons
+    ButtonsInit();
+
+    // Initialize the ADC channels.
+    ADCInit();
+
+    // Deep sleep clocks and wake sources for USB suspend.
+    SuspendInit();
 
-    UARTprintf("\nWaiting For Host...\n");
+    // Input recorder and replay, idle until started from the console or the
+    // host.
+    RecorderInit();
+    ReplayInit();
+
+    // Macro and turbo timer, only runs while a sequence or turbo button needs
+    // it.
+    MacroInit();
+
+    // Button and axis remap, the identity until the host writes a layout.
+    RemapInit();
+    BootMark(BOOT_PERIPH);
+
+    // Find the stick rest position while the host is still enumerating.
+    StickCalibrate();
+    BootMark(BOOT_CALIBRATED);
 
-    IntMasterEnable(); // enale interrupts
     // Trigger ADC sample
-    ADCProcessorTrigger(ADC0_BASE, 0);
+    HALADCTrigger(ADC0_BASE, 0);
+    LatencyStamp(LATENCY_POINT_ADCTRIG);
+
+    // The rest of the banner, now that there is something to say.
+    UARTprintf("%uMHz, hot path in %s, ready in %uus\n", SysCtlClockGet() / 1000000,
+               HotPathInSRAM(GamepadHandler) ? "sram" : "flash",
+               g_pui32BootUs[BOOT_CALIBRATED]);
+    UARTprintf("stick trim x %d y %d\n", g_pi16GamepadTrim[GAMEPAD_AXIS_X],
+               g_pi16GamepadTrim[GAMEPAD_AXIS_Y]);
+
+    if(g_iGamepadState == eStateNotConfigured)
+    {
+        UARTprintf("\nWaiting For Host...\n");
+    }
+
+    // Watchdog on from here, it is only fed while the pipeline keeps moving.
+    SupervisorInit(TxStuck);
 
     while(1)
     {
+        HALLoop();
+        ui32LoopStart = CyclesGet();
+        ISRProfLoopBegin();
+        bUpdate = false;
+        SupervisorLoop();
+
+        ConsolePoll();
+
+        // a report never completed, start USB over
+        if(SupervisorRecoverUSB())
+        {
+            USBRestart();
+        }
+
+        // bus suspended, sleep until the host resumes it or there is input to
+        // wake it up for
+        if((g_iGamepadState == eStateSuspend) && !SuspendWakePending())
+        {
+            SuspendEnter();
+
+            while((g_iGamepadState == eStateSuspend) && !SuspendSleep())
+            {
+                SupervisorLoop();
+            }
+
+            SuspendExit(g_iGamepadState == eStateSuspend);
+
+            // time asleep is not loop time
+            ui32LoopStart = CyclesGet();
+        }
+
         // wait till connected
         if(g_iGamepadState == eStateIdle)
         {
-            
-            bUpdate = false;
+            // a crash record is reported once the host has us back
+            FaultReport();
+
+            LatencyStamp(LATENCY_POINT_SAMPLE);
 
             // poll buttons to see if clicked
-            ButtonsPoll(&ui8ButtonsChanged, &ui8Buttons);
-            ui8Buttons ^= JOYSTICK_MASK;  // Invert the joystick switch bit as it is active low
+            ButtonsPoll(0, &ui8Buttons);
+            LatencyStamp(LATENCY_POINT_DEBOUNCE);
 
-            sReport.ui8Buttons = 0; // initially reset buttons
+            // set the report bit of each pressed button, the joystick switch is active low
+            g_sInput.ui8Buttons = GamepadButtonsPack(ui8Buttons);
 
+            // pick up a finished ADC conversion
+            bUpdate = ADCUpdate();
 
-            if(ui8Buttons & BUTTON1_MASK) //  if button 1 clicked
-            {
-                sReport.ui8Buttons |= BUTTON1_MASK; // set button 1 bit
-            }
+            // the report is the input through the remap layout, rebuilt every pass
+            RemapApply((const uint8_t *)&g_sInput, (uint8_t *)&sReport);
 
-            if(ui8Buttons & BUTTON2_MASK) // if button 2 clicked
+            // chords start macros and turbo buttons start their timing, only on a change,
+            // from the remapped buttons, as the masks apply to the remapped report.  An
+            // axis press or a layer change counts as a change too
+            if(sReport.ui8Buttons != ui8MacroButtons)
             {
-                sReport.ui8Buttons |= BUTTON2_MASK; // set button 2 bit
+                ui8MacroButtons = sReport.ui8Buttons;
+                MacroButtons(ui8MacroButtons);
             }
 
-            if(ui8Buttons & BUTTON3_MASK) // if button 3 clicked
+            // a trace being replayed stands in for the sampled inputs
+            if(ReplayApply((uint8_t *)&sReport))
             {
-                sReport.ui8Buttons |= BUTTON3_MASK; // set button 3 bit
+                bUpdate = true;
             }
 
-            if(ui8Buttons & BUTTON4_MASK) // if button 4 clicked
+            // a running macro or a turbo button overrides parts of the report
+            if(MacroApply((uint8_t *)&sReport))
             {
-                sReport.ui8Buttons |= BUTTON4_MASK; //  set button 4 bit
+                bUpdate = true;
             }
 
-            if(ui8Buttons & JOYSTICK_MASK) // if joystick clicked
+            // back to full speed on the first input, drop the clock after a quiet spell
+            if(InputActive())
             {
-                sReport.ui8Buttons |= JOYSTICK_MASK; // set joystick button bit
+                ClockGovActivity();
             }
+            ClockGovPoll(HALUSBFrame(USB0_BASE));
 
+            LatencyStamp(LATENCY_POINT_PACK);
 
-            // check if ADC done converting
-            if(ADCIntStatus(ADC0_BASE, 0, false) != 0)
+            // hold the report back if the configured report interval has not passed yet,
+            // the next ADC sample will pick it up
+            if(bUpdate && g_sGamepadConfig.ui8ReportInterval)
             {
-                // clear ADC int
-                ADCIntClear(ADC0_BASE, 0);
+                ui32Frame = HALUSBFrame(USB0_BASE);
 
-                // read data and trigger new sample
-                ADCSequenceDataGet(ADC0_BASE, 0, &g_pui32ADCData[0]);
-                ADCProcessorTrigger(ADC0_BASE, 0);
-
-                // update the report with ADC data
-                sReport.i8XPos = Convert8Bit(g_pui32ADCData[0]);
-                sReport.i8YPos = Convert8Bit(g_pui32ADCData[2]);
-                int32_t pot = g_pui32ADCData[1]; // 0 to 4095 
+                if(((ui32Frame - g_ui32LastReportFrame) & 0x7ff) < g_sGamepadConfig.ui8ReportInterval)
+                {
+                    bUpdate = false;
+                }
+                else
+                {
+                    g_ui32LastReportFrame = ui32Frame;
+                }
+            }
 
-                if (pot < 2048) { // if pot less than middle, left is triggered 
-                    sReport.i8LT = (uint8_t)((2048 - pot) * 255 / 2048);   // trigger strength in LT
-                    sReport.i8RT = 0;      
+            // send report if updated values.
+            if(bUpdate)
+            {
+                // change state to sending before the report goes out, the TX complete
+                // interrupt can arrive before USBDHIDGamepadSendReport returns
+                g_iGamepadState = eStateSending; 
+                LatencyArm();
 
-                } else if (pot > 2048) { // if pot more than middle, right is triggered
-                    sReport.i8LT = 0;  
-                    sReport.i8RT = (uint8_t)((pot - 2048) * 255 / 2047);    // trigger strength in RT
+                bUpdate = (USBDHIDGamepadSendReport(&g_sGamepadDevice, &sReport,
+                                                    sizeof(sReport)) == USBDGAMEPAD_SUCCESS);
 
-                } else {
-                    sReport.i8LT = 0;
-                    sReport.i8RT = 0;
+                // driver refused the report (not configured or busy), go back to idle unless
+                // a bus event moved the state on meanwhile, and try again
+                if(!bUpdate)
+                {
+                    IntMasterDisable(); // disable interrupts because changing state
+                    if(g_iGamepadState == eStateSending)
+                    {
+                        g_iGamepadState = eStateIdle;
+                    }
+                    IntMasterEnable(); // enable interrupts
+
+                    g_sGamepadStats.ui32ReportsDropped++;
                 }
-                bUpdate = true; 
             }
 
-            // send report if updated values.
             if(bUpdate)
             {
-                USBDHIDGamepadSendReport(&g_sGamepadDevice, &sReport,
-                                         sizeof(sReport));
+                LatencyStamp(LATENCY_POINT_SEND);
+                g_sGamepadStats.ui32ReportsSent++;
+                SuspendReportSent();
+                BootMark(BOOT_FIRST_REPORT);
+                RecorderReport((const uint8_t *)&sReport);
+                ReplaySent();
+            }
+        }
 
-                // change state to sending 
-                IntMasterDisable(); // disable interrupts because changing state
-                g_iGamepadState = eStateSending; 
-                IntMasterEnable(); // enable interrupts
+        // keep the boot clock from wrapping until the host has its first report
+        BootPoll();
 
-                // Limit the blink rate of the LED.
-                if(g_ui32Updates++ == 40) // slow down LED blink
-                {
+        // program recorded reports into flash, nothing to do unless recording
+        RecorderPoll();
 
-                    // Turn on the RED LED.
-                    MAP_GPIOPinWrite(GPIO_PORTF_BASE, GPIO_PIN_1, GPIO_PIN_1);
+        // start, stop and finish a replay
+        ReplayPoll();
 
-                    g_ui32Updates = 0;
-                }
-            }
+        // compile a remap layout the host wrote, between two reports
+        RemapPoll();
+
+        ui32Cycles = CyclesSince(ui32LoopStart);
+        if(ui32Cycles > g_sGamepadStats.ui32MaxLoopCycles)
+        {
+            g_sGamepadStats.ui32MaxLoopCycles = ui32Cycles;
         }
+
+        // a pass that sent nothing was idle time
+        ISRProfLoopEnd(bUpdate);
     }
 }
@@ -44,7 +44,10 @@
 MEMORY
 {
     /* Application stored in and executes from internal flash */
-    FLASH (RX) : origin = APP_BASE, length = 0x00040000
+    FLASH (RX) : origin = APP_BASE, length = 0x00020000
+    /* Input recorder trace (recorder.h), erased and programmed at run time, */
+    /* never linked into.  RECORDER_FLASH_BASE and _SIZE must match.         */
+    TRACE (R)  : origin = 0x00020000, length = 0x00020000
     /* Application uses internal RAM for data */
     SRAM (RWX) : origin = 0x20000000, length = 0x00008000
 }
@@ -60,16 +63,58 @@ SECTIONS
     .pinit  :   > FLASH
     .init_array : > FLASH
 
-    .vtable :   > RAM_BASE
-    .data   :   > SRAM
-    .bss    :   > SRAM
-    .sysmem :   > SRAM
-    .stack  :   > SRAM
+    .vtable :   > RAM_BASE, RUN_SIZE(__vtable_size)
+    .data   :   > SRAM, RUN_SIZE(__data_size)
+    .bss    :   > SRAM, RUN_SIZE(__bss_size)
+    .sysmem :   > SRAM, RUN_SIZE(__sysmem_size)
+
+    /* Crash record (fault.c), not cleared at startup so it survives the     */
+    /* watchdog reset that follows a fault.                                  */
+    .TI.noinit : > SRAM, RUN_SIZE(__noinit_size)
+
+    /* Aligned to STACK_GUARD_SIZE (stackmon.h) so the MPU guard region can  */
+    /* sit on the bottom of the stack.                                       */
+    .stack  :   > SRAM, align(32)
 #ifdef  __TI_COMPILER_VERSION__
 #if     __TI_COMPILER_VERSION__ >= 15009000
-    .TI.ramfunc : {} load=FLASH, run=SRAM, table(BINIT)
+#ifdef  PERF_PROFILE
+    /* Performance profile (hotpath.h): besides the HOT_FUNC functions, copy */
+    /* the driverlib/usblib functions on the USB interrupt and report send   */
+    /* paths to SRAM.  The libraries are built with function subsections,    */
+    /* so each one can be picked out by name.  The ADC, button and frame     */
+    /* number reads are inlined register accesses (hal.h) and need no entry. */
+    .TI.ramfunc :
+    {
+        *(.TI.ramfunc)
+        *(.text:USB0DeviceIntHandler)
+        *(.text:USBDeviceIntHandlerInternal)
+        *(.text:USBIntStatusControl)
+        *(.text:USBIntStatusEndpoint)
+        *(.text:USBEndpointStatus)
+        *(.text:USBDevEndpointStatusClear)
+        *(.text:InternalUSBStartOfFrameTick)
+        *(.text:HIDTickHandler)
+        *(.text:ProcessIdleTimers)
+        *(.text:HandleEndpoints)
+        *(.text:ProcessDataToHost)
+        *(.text:HIDGamepadTxHandler)
+        *(.text:USBDHIDGamepadSendReport)
+        *(.text:USBDHIDReportWrite)
+        *(.text:ScheduleReportTransmission)
+        *(.text:USBEndpointDataPut)
+        *(.text:USBEndpointDataSend)
+    } load=FLASH, run=SRAM, RUN_SIZE(__ramfunc_size), table(BINIT)
+#else
+    .TI.ramfunc : {} load=FLASH, run=SRAM, RUN_SIZE(__ramfunc_size),
+                     table(BINIT)
+#endif
 #endif
 #endif
 }
 
 __STACK_TOP = __stack + 1024;
+
+/* Older compilers have no .TI.ramfunc, so nothing runs from SRAM.           */
+#if !defined(__TI_COMPILER_VERSION__) || (__TI_COMPILER_VERSION__ < 15009000)
+__ramfunc_size = 0;
+#endif
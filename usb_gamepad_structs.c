@@ -9,6 +9,7 @@
 #include "usblib/device/usbdhid.h"
 #include "usblib/device/usbdhidgamepad.h"
 #include "usb_gamepad_structs.h"
+#include "gamepad_feature.h"
 
 const uint8_t g_pui8LangDescriptor[] =
 {
@@ -78,6 +79,10 @@ const uint8_t * const g_ppui8StringDescriptors[] =
 
 #define NUM_STRING_DESCRIPTORS (sizeof(g_ppui8StringDescriptors) / sizeof(uint8_t *))
 
+// Vendor defined usage page (0xFF00) for the configuration feature report.
+// The usblib UsagePage() macro only takes a one byte page.
+#define UsagePageVendor         0x06, 0x00, 0xff
+
 // The HID game pad device initialization and customization structures.
 
 uint8_t g_pui8MyCustomReportDescriptor[] =
@@ -120,6 +125,15 @@ uint8_t g_pui8MyCustomReportDescriptor[] =
         ReportCount(3),
         Input(USB_HID_INPUT_CONSTANT | USB_HID_INPUT_ARRAY | USB_HID_INPUT_ABS),
 
+        // vendor feature report for tuning and statistics, see gamepad_feature.h
+        UsagePageVendor,
+        Usage(0x01),
+        LogicalMinimum(-128),
+        LogicalMaximum(127),
+        ReportSize(8),
+        ReportCount(GAMEPAD_FEATURE_SIZE),
+        Feature(USB_HID_FEATURE_DATA | USB_HID_FEATURE_VARIABLE | USB_HID_FEATURE_ABS),
+
     EndCollection
 };
 
@@ -128,7 +142,7 @@ tUSBDHIDGamepadDevice g_sGamepadDevice = {// gamepad device structure {
     USB_VID_TI_1CBE,
     USB_PID_GAMEPAD,
     0,
-    USB_CONF_ATTR_SELF_PWR,
+    USB_CONF_ATTR_SELF_PWR | USB_CONF_ATTR_RWAKE,
     GamepadHandler,
     (void *)&g_sGamepadDevice,
     g_ppui8StringDescriptors,